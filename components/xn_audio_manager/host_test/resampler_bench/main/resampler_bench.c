@@ -0,0 +1,250 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-06
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-06
+ * @FilePath: \xn_voice_wake_up\components\xn_audio_manager\host_test\resampler_bench\main\resampler_bench.c
+ * @Description: 重采样器主机端基准 - 每个输出采样点的耗时 / 周期数
+ *
+ * 对比对象为直接型实现：输入插零到 L 倍采样率后，用完整的 L * taps 原型滤波器
+ * 计算每个保留下来的输出点（即多相分解之前的做法）。多相版本按 10ms 分块流式处理，
+ * 与播放 / 录音路径的调用方式一致。
+ *
+ * 运行：idf.py --preview set-target linux build && ./build/resampler_bench.elf
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC 1
+#else
+#define BENCH_HAS_TSC 0
+#endif
+
+#include "resampler.h"
+
+#define BENCH_SECONDS       0.5     ///< 每个用例的输入时长
+#define BENCH_REPEAT        5       ///< 重复次数，取最快一次
+#define BENCH_DIRECT_TAPS   16      ///< 直接型每相抽头数（与 MEDIUM 档一致）
+
+typedef struct {
+    uint32_t in_rate;
+    uint32_t out_rate;
+} bench_case_t;
+
+static const bench_case_t s_cases[] = {
+    {24000, 16000},     // 云端 TTS -> 扬声器
+    {16000, 48000},     // 麦克风 -> 高采样率编码
+    {44100, 16000},
+    {48000, 16000},
+};
+
+static const char *s_quality_names[] = {"low", "medium", "high"};
+
+typedef struct {
+    uint64_t ns;
+    uint64_t cycles;
+} bench_time_t;
+
+static bench_time_t bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    bench_time_t t = {(uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec, 0};
+#if BENCH_HAS_TSC
+    t.cycles = __rdtsc();
+#endif
+    return t;
+}
+
+static void bench_report(const char *name, const char *quality, bench_time_t best, size_t out_samples)
+{
+    printf("  %-10s %-7s %10.2f ns/sample", name, quality, (double)best.ns / out_samples);
+#if BENCH_HAS_TSC
+    printf(" %10.1f cycles/sample", (double)best.cycles / out_samples);
+#endif
+    printf("\n");
+}
+
+static bench_time_t bench_min(bench_time_t a, bench_time_t b)
+{
+    return (b.ns < a.ns) ? b : a;
+}
+
+static uint32_t bench_gcd(uint32_t a, uint32_t b)
+{
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/**
+ * @brief 直接型：插零后用完整原型滤波器计算每个输出点
+ * @return 输出采样点数，失败返回 0
+ */
+static size_t bench_direct(const bench_case_t *c, const float *in, size_t in_samples,
+                           float *out, size_t out_capacity, bench_time_t *elapsed)
+{
+    uint32_t g = bench_gcd(c->in_rate, c->out_rate);
+    size_t L = c->out_rate / g, M = c->in_rate / g, N = L * BENCH_DIRECT_TAPS;
+
+    float *h = (float *)malloc(N * sizeof(float));
+    float *up = (float *)calloc(in_samples * L, sizeof(float));
+    if (!h || !up) {
+        free(h);
+        free(up);
+        return 0;
+    }
+
+    // 加窗 sinc 原型（只比较耗时，窗形状不影响计算量），增益补偿插零的 1/L
+    double nyquist = (c->in_rate < c->out_rate ? c->in_rate : c->out_rate) / 2.0;
+    double fc = 0.88 * nyquist / ((double)L * c->in_rate);
+    for (size_t n = 0; n < N; n++) {
+        double x = n - (N - 1) / 2.0;
+        double sinc = (x == 0.0) ? 1.0 : sin(2.0 * M_PI * fc * x) / (2.0 * M_PI * fc * x);
+        double r = 2.0 * n / (N - 1) - 1.0;
+        h[n] = (float)(2.0 * fc * L * sinc * (1.0 - r * r));
+    }
+
+    bench_time_t t0 = bench_now();
+    for (size_t i = 0; i < in_samples; i++) {
+        up[i * L] = in[i];
+    }
+    size_t produced = 0;
+    for (size_t t = N - 1; t < in_samples * L && produced < out_capacity; t += M) {
+        float acc = 0.0f;
+        for (size_t n = 0; n < N; n++) {
+            acc += h[n] * up[t - n];
+        }
+        out[produced++] = acc;
+    }
+    bench_time_t t1 = bench_now();
+
+    elapsed->ns = t1.ns - t0.ns;
+    elapsed->cycles = t1.cycles - t0.cycles;
+    free(h);
+    free(up);
+    return produced;
+}
+
+/**
+ * @brief 多相流式：按 10ms 分块调用 resampler_process_*
+ */
+static size_t bench_polyphase(const bench_case_t *c, resampler_quality_t quality, resampler_format_t format,
+                              const float *in_f32, const int16_t *in_s16, size_t in_samples,
+                              void *out, size_t out_capacity, bench_time_t *elapsed)
+{
+    resampler_config_t cfg = {
+        .in_rate = c->in_rate,
+        .out_rate = c->out_rate,
+        .quality = quality,
+        .format = format,
+    };
+    resampler_handle_t rs = resampler_create(&cfg);
+    if (!rs) {
+        return 0;
+    }
+
+    size_t chunk = c->in_rate / 100;
+    size_t produced = 0;
+    bench_time_t t0 = bench_now();
+    for (size_t off = 0; off < in_samples; off += chunk) {
+        size_t n = (in_samples - off < chunk) ? in_samples - off : chunk;
+        if (format == RESAMPLER_FORMAT_F32) {
+            produced += resampler_process_f32(rs, in_f32 + off, n, (float *)out + produced,
+                                              out_capacity - produced);
+        } else {
+            produced += resampler_process_s16(rs, in_s16 + off, n, (int16_t *)out + produced,
+                                              out_capacity - produced);
+        }
+    }
+    bench_time_t t1 = bench_now();
+
+    elapsed->ns = t1.ns - t0.ns;
+    elapsed->cycles = t1.cycles - t0.cycles;
+    resampler_destroy(rs);
+    return produced;
+}
+
+static int bench_case(const bench_case_t *c)
+{
+    size_t in_samples = (size_t)(c->in_rate * BENCH_SECONDS);
+    size_t out_capacity = (size_t)((double)in_samples * c->out_rate / c->in_rate) + 64;
+
+    float *in_f32 = (float *)malloc(in_samples * sizeof(float));
+    int16_t *in_s16 = (int16_t *)malloc(in_samples * sizeof(int16_t));
+    float *out = (float *)malloc(out_capacity * sizeof(float));
+    if (!in_f32 || !in_s16 || !out) {
+        free(in_f32);
+        free(in_s16);
+        free(out);
+        return 1;
+    }
+
+    // 两个正弦叠加少量噪声，避免全零输入被特殊处理
+    srand(1);
+    for (size_t i = 0; i < in_samples; i++) {
+        double v = 0.4 * sin(2.0 * M_PI * 440.0 * i / c->in_rate) +
+                   0.2 * sin(2.0 * M_PI * 3100.0 * i / c->in_rate) +
+                   0.01 * ((rand() % 2001) - 1000) / 1000.0;
+        in_f32[i] = (float)v;
+        in_s16[i] = (int16_t)lrint(v * 32767.0);
+    }
+
+    printf("%u -> %u Hz\n", (unsigned)c->in_rate, (unsigned)c->out_rate);
+
+    int ret = 0;
+    bench_time_t best = {UINT64_MAX, UINT64_MAX}, t = {0, 0};
+    size_t produced = 0;
+    for (int r = 0; r < BENCH_REPEAT; r++) {
+        produced = bench_direct(c, in_f32, in_samples, out, out_capacity, &t);
+        best = bench_min(best, t);
+    }
+    if (produced == 0) {
+        ret = 1;
+    } else {
+        bench_report("direct", "medium", best, produced);
+    }
+
+    for (int q = RESAMPLER_QUALITY_LOW; q <= RESAMPLER_QUALITY_HIGH; q++) {
+        for (int f = RESAMPLER_FORMAT_S16; f <= RESAMPLER_FORMAT_F32; f++) {
+            best = (bench_time_t){UINT64_MAX, UINT64_MAX};
+            for (int r = 0; r < BENCH_REPEAT; r++) {
+                produced = bench_polyphase(c, (resampler_quality_t)q, (resampler_format_t)f,
+                                           in_f32, in_s16, in_samples, out, out_capacity, &t);
+                best = bench_min(best, t);
+            }
+            if (produced == 0) {
+                ret = 1;
+                continue;
+            }
+            bench_report(f == RESAMPLER_FORMAT_F32 ? "poly-f32" : "poly-s16", s_quality_names[q],
+                         best, produced);
+        }
+    }
+
+    free(in_f32);
+    free(in_s16);
+    free(out);
+    return ret;
+}
+
+void app_main(void)
+{
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(s_cases) / sizeof(s_cases[0]); i++) {
+        failed |= bench_case(&s_cases[i]);
+    }
+    printf(failed ? "resampler bench: FAILED\n" : "resampler bench: done\n");
+    exit(failed);
+}
@@ -64,7 +64,7 @@ typedef struct {
     afe_record_callback_t record_callback;      ///< 录音回调
     void *record_ctx;                           ///< 录音回调上下文
     bool *running_ptr;                          ///< 运行状态指针（外部管理）
-    bool *recording_ptr;                        ///< 录音状态指针（外部管理）
+    bool *recording_ptr;                        ///< 录音状态指针（外部管理，NULL 表示始终回调）
 } afe_wrapper_config_t;
 
 /** AFE 包装器句柄 */
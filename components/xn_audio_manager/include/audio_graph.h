@@ -0,0 +1,172 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-08
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-08
+ * @FilePath: \xn_voice_wake_up\components\xn_audio_manager\include\audio_graph.h
+ * @Description: 音频处理图 - 静态数据流图，组合采集链路上的处理节点
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include "esp_err.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_GRAPH_MAX_FANOUT      4   ///< 每个节点最多连接的下游节点数
+#define AUDIO_GRAPH_CORE_INLINE     (-1) ///< 节点在上游调用者的任务中同步执行
+
+/** 节点类型 */
+typedef enum {
+    AUDIO_GRAPH_NODE_SOURCE = 0,    ///< 源节点：由 audio_graph_push() 注入数据
+    AUDIO_GRAPH_NODE_FILTER,        ///< 处理节点：输入一帧，输出一帧
+    AUDIO_GRAPH_NODE_SINK,          ///< 终端节点：只消费数据
+} audio_graph_node_type_t;
+
+/** 在节点间传递的音频帧（16bit 单声道） */
+typedef struct {
+    const int16_t *data;            ///< 帧数据（只读，可能被多个下游共享）
+    size_t samples;                 ///< 采样点数（不超过端口帧长）
+} audio_graph_frame_t;
+
+/**
+ * @brief 节点处理函数
+ * @param in 输入帧（源节点为注入的数据）
+ * @param out 输出帧：
+ *            - 默认 out->data 指向节点预分配的输出缓冲区（容量 frame_samples），
+ *              写入后设置 out->samples
+ *            - 直通（零拷贝）：令 *out = *in
+ *            - out->samples = 0 表示本帧不向下游传递
+ * @param user_ctx 节点用户上下文
+ * @return ESP_OK 继续向下游传递，其他值丢弃本帧
+ * @note 源节点和终端节点的 out 为 NULL
+ */
+typedef esp_err_t (*audio_graph_process_fn)(const audio_graph_frame_t *in,
+                                            audio_graph_frame_t *out, void *user_ctx);
+
+/** 节点配置 */
+typedef struct {
+    const char *name;               ///< 节点名称（用于统计输出）
+    audio_graph_node_type_t type;   ///< 节点类型
+    size_t frame_samples;           ///< 输出端口帧长（源节点为注入分帧长度）
+    audio_graph_process_fn process; ///< 处理函数（源节点可为 NULL）
+    void *user_ctx;                 ///< 处理函数上下文
+    int core;                       ///< 运行核心：AUDIO_GRAPH_CORE_INLINE 或 0/1（独立任务）
+    uint8_t priority;               ///< 独立任务优先级
+    uint32_t stack_size;            ///< 独立任务栈大小
+    uint8_t queue_depth;            ///< 独立任务输入队列深度（帧数）
+} audio_graph_node_config_t;
+
+#define AUDIO_GRAPH_DEFAULT_NODE_CONFIG()                            \
+    (audio_graph_node_config_t){                                     \
+        .name = "node",                                              \
+        .type = AUDIO_GRAPH_NODE_FILTER,                             \
+        .frame_samples = 512,                                        \
+        .process = NULL,                                             \
+        .user_ctx = NULL,                                            \
+        .core = AUDIO_GRAPH_CORE_INLINE,                             \
+        .priority = 6,                                               \
+        .stack_size = 4 * 1024,                                      \
+        .queue_depth = 4,                                            \
+    }
+
+/** 节点运行统计 */
+typedef struct {
+    const char *name;               ///< 节点名称
+    uint32_t frames;                ///< 已处理帧数
+    uint64_t total_cycles;          ///< 累计 CPU 周期
+    uint32_t max_cycles;            ///< 单帧最大 CPU 周期
+    uint32_t dropped_frames;        ///< 因输入队列满丢弃的帧数
+} audio_graph_node_stats_t;
+
+/** 音频处理图句柄 */
+typedef struct audio_graph_s *audio_graph_handle_t;
+
+/**
+ * @brief 创建音频处理图
+ * @param max_nodes 最大节点数
+ * @return 图句柄，失败返回 NULL
+ */
+audio_graph_handle_t audio_graph_create(size_t max_nodes);
+
+/**
+ * @brief 销毁音频处理图（会先停止）
+ * @param graph 图句柄
+ */
+void audio_graph_destroy(audio_graph_handle_t graph);
+
+/**
+ * @brief 添加节点（仅在启动前）
+ * @param graph 图句柄
+ * @param config 节点配置
+ * @param out_id 输出节点 ID
+ * @return ESP_OK 成功
+ */
+esp_err_t audio_graph_add_node(audio_graph_handle_t graph, const audio_graph_node_config_t *config,
+                               int *out_id);
+
+/**
+ * @brief 连接两个节点（仅在启动前）
+ * @param graph 图句柄
+ * @param from_id 上游节点 ID
+ * @param to_id 下游节点 ID，必须晚于上游添加（保证无环）
+ * @return ESP_OK 成功
+ */
+esp_err_t audio_graph_connect(audio_graph_handle_t graph, int from_id, int to_id);
+
+/**
+ * @brief 启动：分配帧缓冲区，创建绑核任务，之后拓扑不可修改
+ * @param graph 图句柄
+ * @return ESP_OK 成功
+ */
+esp_err_t audio_graph_start(audio_graph_handle_t graph);
+
+/**
+ * @brief 停止：结束所有节点任务
+ * @param graph 图句柄
+ */
+void audio_graph_stop(audio_graph_handle_t graph);
+
+/**
+ * @brief 检查是否已启动
+ * @param graph 图句柄
+ * @return true 已启动
+ */
+bool audio_graph_is_started(audio_graph_handle_t graph);
+
+/**
+ * @brief 向源节点注入数据（超过帧长时自动分帧）
+ * @param graph 图句柄
+ * @param source_id 源节点 ID
+ * @param pcm 数据
+ * @param samples 采样点数
+ * @return ESP_OK 成功
+ */
+esp_err_t audio_graph_push(audio_graph_handle_t graph, int source_id, const int16_t *pcm, size_t samples);
+
+/**
+ * @brief 获取节点运行统计
+ * @param graph 图句柄
+ * @param node_id 节点 ID
+ * @param out_stats 输出统计
+ * @return ESP_OK 成功
+ */
+esp_err_t audio_graph_get_node_stats(audio_graph_handle_t graph, int node_id,
+                                     audio_graph_node_stats_t *out_stats);
+
+/**
+ * @brief 获取节点数量
+ * @param graph 图句柄
+ * @return 节点数量
+ */
+size_t audio_graph_get_node_count(audio_graph_handle_t graph);
+
+#ifdef __cplusplus
+}
+#endif
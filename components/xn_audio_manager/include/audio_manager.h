@@ -12,6 +12,11 @@
 
 #include "esp_err.h"
 #include "audio_bsp.h"
+#include "ring_buffer.h"
+#include "playback_controller.h"
+#include "resampler.h"
+#include "audio_graph.h"
+#include "audio_sched.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
@@ -22,8 +27,13 @@ extern "C" {
 
 // ============ 调度与缓冲配置宏 ============
 
-#define AUDIO_MANAGER_TASK_STACK_SIZE        (6 * 1024)
-#define AUDIO_MANAGER_TASK_PRIORITY          7
+/**
+ * @deprecated 音频管理器任务的栈与优先级已改由 sched_config.stages[AUDIO_SCHED_STAGE_MANAGER]
+ *             配置，以下两个宏仅作为默认值的兼容别名保留，修改它们不会影响任务创建
+ */
+#define AUDIO_MANAGER_TASK_STACK_SIZE        AUDIO_SCHED_MANAGER_STACK_SIZE
+#define AUDIO_MANAGER_TASK_PRIORITY          AUDIO_SCHED_MANAGER_PRIORITY
+
 #define AUDIO_MANAGER_EVENT_QUEUE_LENGTH     16
 #define AUDIO_MANAGER_STEP_INTERVAL_MS       100
 #define AUDIO_MANAGER_DEFAULT_VOLUME         80
@@ -31,6 +41,16 @@ extern "C" {
 #define AUDIO_MANAGER_PLAYBACK_FRAME_SAMPLES 1024
 #define AUDIO_MANAGER_PLAYBACK_BUFFER_BYTES  (512 * 1024)
 #define AUDIO_MANAGER_REFERENCE_BUFFER_BYTES (16 * 1024)
+#define AUDIO_MANAGER_PLAYBACK_WRITE_TIMEOUT_MS 1000  ///< 播放缓冲区满时写入的默认等待时间
+#define AUDIO_MANAGER_RESAMPLE_CHUNK_SAMPLES 256      ///< 录音重采样每次处理的输入采样点数
+
+#define AUDIO_MANAGER_STATS_REPORT_INTERVAL_MS 5000   ///< 缓冲区统计上报周期（仅异常时打印）
+#define AUDIO_MANAGER_SCHED_REPORT_INTERVAL_MS 30000  ///< CPU 负载 / 截止时间统计打印周期
+
+#define AUDIO_MANAGER_GRAPH_MAX_NODES        8        ///< 采集处理图最大节点数
+#define AUDIO_MANAGER_GRAPH_FRAME_SAMPLES    512      ///< 采集处理图源节点帧长
+#define AUDIO_MANAGER_GRAPH_SOURCE_NODE      0        ///< 采集处理图源节点 ID（AFE 输出）
+#define AUDIO_MANAGER_GRAPH_RECORD_NODE      1        ///< 录音回调终端节点 ID
 
 // ============ 状态机定义 ============
 
@@ -93,11 +113,30 @@ typedef struct {
     int afe_mode;                   ///< AFE 模式（0=LOW_COST, 1=HIGH_QUALITY）
 } audio_mgr_afe_config_t;
 
+/** 播放配置 */
+typedef struct {
+    uint32_t write_timeout_ms;      ///< 缓冲区满时写入等待时间（0=不等待，只写能容纳的部分）
+    bool low_latency;               ///< 低延迟流式模式（小帧 + jitter buffer）
+    uint32_t jitter_buffer_ms;      ///< 低延迟模式预缓冲时长
+    uint32_t conceal_max_ms;        ///< 低延迟模式欠载补偿最长时长
+    playback_underrun_policy_t underrun_policy; ///< 低延迟模式欠载补偿策略
+} audio_mgr_playback_config_t;
+
+/** 采样率转换配置 */
+typedef struct {
+    uint32_t playback_source_rate;  ///< 播放数据采样率（0=与扬声器相同，如 TTS 返回 24000）
+    uint32_t record_output_rate;    ///< 录音回调输出采样率（0=与麦克风相同）
+    resampler_quality_t quality;    ///< 重采样质量 / 延迟档位
+} audio_mgr_resample_config_t;
+
 /** 音频管理器配置 */
 typedef struct {
     audio_mgr_hw_config_t      hw_config;       ///< 硬件配置
     audio_mgr_vad_config_t     vad_config;      ///< VAD 配置
     audio_mgr_afe_config_t     afe_config;      ///< AFE 配置
+    audio_mgr_playback_config_t playback_config; ///< 播放配置
+    audio_mgr_resample_config_t resample_config; ///< 采样率转换配置
+    audio_sched_config_t       sched_config;    ///< 各阶段核心 / 优先级 / 截止时间
     audio_mgr_event_cb_t       event_callback;  ///< 事件回调
     audio_mgr_state_cb_t       state_callback;  ///< 状态机回调
     void                      *user_ctx;        ///< 用户上下文
@@ -136,16 +175,41 @@ typedef struct {
         .afe_mode = 1,                                               \
     }
 
+#define AUDIO_MANAGER_DEFAULT_PLAYBACK_CONFIG()                      \
+    (audio_mgr_playback_config_t){                                   \
+        .write_timeout_ms = AUDIO_MANAGER_PLAYBACK_WRITE_TIMEOUT_MS, \
+        .low_latency = false,                                        \
+        .jitter_buffer_ms = 60,                                      \
+        .conceal_max_ms = 100,                                       \
+        .underrun_policy = PLAYBACK_UNDERRUN_FADE_OUT,               \
+    }
+
+#define AUDIO_MANAGER_DEFAULT_RESAMPLE_CONFIG()                      \
+    (audio_mgr_resample_config_t){                                   \
+        .playback_source_rate = 0,                                   \
+        .record_output_rate = 0,                                     \
+        .quality = RESAMPLER_QUALITY_MEDIUM,                         \
+    }
+
 #define AUDIO_MANAGER_DEFAULT_CONFIG()                               \
     (audio_mgr_config_t){                                            \
         .hw_config = AUDIO_MANAGER_DEFAULT_HW_CONFIG(),              \
         .vad_config = AUDIO_MANAGER_DEFAULT_VAD_CONFIG(),            \
         .afe_config = AUDIO_MANAGER_DEFAULT_AFE_CONFIG(),            \
+        .playback_config = AUDIO_MANAGER_DEFAULT_PLAYBACK_CONFIG(),  \
+        .resample_config = AUDIO_MANAGER_DEFAULT_RESAMPLE_CONFIG(),  \
+        .sched_config = AUDIO_SCHED_DEFAULT_CONFIG(),                \
         .event_callback = NULL,                                      \
         .state_callback = NULL,                                      \
         .user_ctx = NULL,                                            \
     }
 
+/** 音频缓冲区统计汇总 */
+typedef struct {
+    ring_buffer_stats_t playback;       ///< 播放缓冲区统计
+    ring_buffer_stats_t reference;      ///< 回采缓冲区统计
+} audio_mgr_buffer_stats_t;
+
 // ============ API 接口 ============
 
 /**
@@ -184,15 +248,39 @@ esp_err_t audio_manager_start_recording(void);
 esp_err_t audio_manager_stop_recording(void);
 
 /**
- * @brief 播放音频数据
+ * @brief 播放音频数据（缓冲区满时按 write_timeout_ms 等待，不丢数据）
  */
 esp_err_t audio_manager_play_audio(const int16_t *pcm_data, size_t sample_count);
 
+/**
+ * @brief 播放音频数据（指定等待时间，返回实际写入量）
+ */
+esp_err_t audio_manager_play_audio_timeout(const int16_t *pcm_data, size_t sample_count,
+                                           uint32_t timeout_ms, size_t *out_written);
+
+/**
+ * @brief 设置后续播放数据的采样率（0=与扬声器相同），自动重采样到扬声器采样率
+ */
+esp_err_t audio_manager_set_playback_source_rate(uint32_t sample_rate);
+
+/**
+ * @brief 获取采集处理图（AFE 输出为源节点 AUDIO_MANAGER_GRAPH_SOURCE_NODE）
+ * @note 在 audio_manager_start() 前添加并连接节点，启动后拓扑冻结；
+ *       源节点每帧都会推送，不受录音状态影响。KWS / 网络发送节点可用
+ *       audio_sched_apply_to_node() 按调度配置决定核心与流水线模式
+ */
+audio_graph_handle_t audio_manager_get_capture_graph(void);
+
 /**
  * @brief 获取播放缓冲区可用空间
  */
 size_t audio_manager_get_playback_free_space(void);
 
+/**
+ * @brief 等待播放缓冲区可用空间达到指定采样点数
+ */
+esp_err_t audio_manager_wait_playback_space(size_t min_samples, uint32_t timeout_ms);
+
 /**
  * @brief 开始播放
  */
@@ -238,10 +326,16 @@ bool audio_manager_is_playing(void);
  */
 audio_mgr_state_t audio_manager_get_state(void);
 
+/**
+ * @brief 获取音频缓冲区统计（溢出、欠载、水位等）
+ */
+esp_err_t audio_manager_get_buffer_stats(audio_mgr_buffer_stats_t *out_stats);
+
 // ============ 录音数据回调 ============
 
 /**
  * @brief 录音数据回调函数类型
+ * @note 采样率为 resample_config.record_output_rate（未配置时与麦克风相同）
  */
 typedef void (*audio_record_callback_t)(const int16_t *pcm_data, size_t sample_count, void *user_ctx);
 
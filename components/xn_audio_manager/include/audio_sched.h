@@ -0,0 +1,165 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-09
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-09
+ * @FilePath: \xn_voice_wake_up\components\xn_audio_manager\include\audio_sched.h
+ * @Description: 音频调度配置 - 集中管理各阶段的核心 / 优先级 / 截止时间，统计 CPU 负载
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include "esp_err.h"
+#include "audio_graph.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_SCHED_SLICE_US         32000  ///< AFE 单片时长（512 点 @16kHz）
+#define AUDIO_SCHED_MAX_LOAD_TASKS   32     ///< CPU 负载报告最多统计的任务数
+
+#define AUDIO_SCHED_MANAGER_STACK_SIZE (6 * 1024) ///< 音频管理器任务默认栈大小
+#define AUDIO_SCHED_MANAGER_PRIORITY   7          ///< 音频管理器任务默认优先级
+
+/** 调度阶段 */
+typedef enum {
+    AUDIO_SCHED_STAGE_AFE_FEED = 0,     ///< AFE 喂数据任务（I2S 读取 + 回采对齐）
+    AUDIO_SCHED_STAGE_AFE_FETCH,        ///< AFE 取结果任务（VAD + 采集处理图源节点）
+    AUDIO_SCHED_STAGE_MANAGER,          ///< 音频管理器状态机任务
+    AUDIO_SCHED_STAGE_PLAYBACK,         ///< 播放任务
+    AUDIO_SCHED_STAGE_KWS,              ///< 唤醒词推理（采集处理图节点）
+    AUDIO_SCHED_STAGE_NET_SEND,         ///< 网络发送（采集处理图节点）
+    AUDIO_SCHED_STAGE_MAX,
+} audio_sched_stage_t;
+
+/** 单个阶段的调度参数 */
+typedef struct {
+    int core;                       ///< 绑定核心（0/1），处理图节点可为 AUDIO_GRAPH_CORE_INLINE
+    uint8_t priority;               ///< 任务优先级
+    uint32_t stack_size;            ///< 任务栈大小
+    uint32_t deadline_us;           ///< 单次处理截止时间（0=不检查）
+} audio_sched_stage_config_t;
+
+/** 调度配置 */
+typedef struct {
+    audio_sched_stage_config_t stages[AUDIO_SCHED_STAGE_MAX]; ///< 各阶段参数
+    bool kws_pipelined;             ///< KWS 流水线模式：第 N 片推理与第 N+1 片取数在不同核心并行
+} audio_sched_config_t;
+
+/**
+ * 默认布局：
+ *  - core 1: AFE feed(8) / playback(7) / KWS(7，流水线模式)
+ *  - core 0: AFE fetch(8) / audio_mgr(7) / net_send(5)
+ */
+#define AUDIO_SCHED_DEFAULT_CONFIG()                                                              \
+    (audio_sched_config_t){                                                                       \
+        .stages = {                                                                               \
+            [AUDIO_SCHED_STAGE_AFE_FEED]  = { .core = 1, .priority = 8, .stack_size = 10 * 1024,  \
+                                              .deadline_us = AUDIO_SCHED_SLICE_US },              \
+            [AUDIO_SCHED_STAGE_AFE_FETCH] = { .core = 0, .priority = 8, .stack_size = 8 * 1024,   \
+                                              .deadline_us = AUDIO_SCHED_SLICE_US },              \
+            [AUDIO_SCHED_STAGE_MANAGER]   = { .core = 0, .priority = AUDIO_SCHED_MANAGER_PRIORITY, \
+                                              .stack_size = AUDIO_SCHED_MANAGER_STACK_SIZE,       \
+                                              .deadline_us = 0 },                                 \
+            [AUDIO_SCHED_STAGE_PLAYBACK]  = { .core = 1, .priority = 7, .stack_size = 5 * 1024,   \
+                                              .deadline_us = 0 },                                 \
+            [AUDIO_SCHED_STAGE_KWS]       = { .core = 1, .priority = 7, .stack_size = 8 * 1024,   \
+                                              .deadline_us = AUDIO_SCHED_SLICE_US },              \
+            [AUDIO_SCHED_STAGE_NET_SEND]  = { .core = 0, .priority = 5, .stack_size = 6 * 1024,   \
+                                              .deadline_us = 100000 },                            \
+        },                                                                                        \
+        .kws_pipelined = true,                                                                    \
+    }
+
+/** 阶段运行时统计 */
+typedef struct {
+    uint32_t runs;                  ///< 已上报的执行次数
+    uint32_t deadline_misses;       ///< 超过截止时间的次数
+    uint32_t last_us;               ///< 最近一次耗时
+    uint32_t max_us;                ///< 最大耗时
+} audio_sched_stage_stats_t;
+
+/** 单个任务的 CPU 负载 */
+typedef struct {
+    const char *name;               ///< 任务名称（指向 FreeRTOS 内部字符串）
+    int core;                       ///< 绑定核心（-1 表示未绑定）
+    uint8_t priority;               ///< 当前优先级
+    uint16_t load_permille;         ///< 统计区间内占单核时间的千分比
+} audio_sched_task_load_t;
+
+/**
+ * @brief 应用调度配置（在创建各任务前调用）
+ * @param config 调度配置，NULL 恢复默认
+ * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t audio_sched_set_config(const audio_sched_config_t *config);
+
+/**
+ * @brief 获取阶段调度参数
+ * @param stage 阶段
+ * @return 调度参数（始终有效）
+ */
+const audio_sched_stage_config_t *audio_sched_get_stage(audio_sched_stage_t stage);
+
+/**
+ * @brief 是否启用 KWS 流水线模式
+ */
+bool audio_sched_kws_pipelined(void);
+
+/**
+ * @brief 按阶段参数填充处理图节点的 core / priority / stack / queue_depth
+ *
+ * KWS 阶段在流水线模式下绑定到独立核心且队列深度为 1（端到端延迟不超过一片），
+ * 非流水线模式下内联运行在取数任务中。
+ *
+ * @param stage 阶段
+ * @param node_cfg 待填充的节点配置
+ */
+void audio_sched_apply_to_node(audio_sched_stage_t stage, audio_graph_node_config_t *node_cfg);
+
+/**
+ * @brief 上报一次阶段处理耗时（用于截止时间检查）
+ * @param stage 阶段
+ * @param elapsed_us 耗时（微秒）
+ */
+void audio_sched_report_runtime(audio_sched_stage_t stage, uint32_t elapsed_us);
+
+/**
+ * @brief 注册阶段运行指标（xn_audio_stage_duration_us 直方图、deadline 超时计数）
+ * @return ESP_OK 成功，ESP_ERR_NO_MEM 指标槽位不足
+ * @note 可重复调用；未注册时 audio_sched_report_runtime() 不产生指标开销
+ */
+esp_err_t audio_sched_register_metrics(void);
+
+/**
+ * @brief 获取阶段运行时统计
+ * @param stage 阶段
+ * @param out_stats 输出统计
+ * @return ESP_OK 成功
+ */
+esp_err_t audio_sched_get_stage_stats(audio_sched_stage_t stage, audio_sched_stage_stats_t *out_stats);
+
+/**
+ * @brief 采样各任务自上次调用以来的 CPU 负载
+ * @param out 输出数组
+ * @param max 数组容量
+ * @param out_count 实际输出数量
+ * @return
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_NOT_SUPPORTED: 未开启 CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS / USE_TRACE_FACILITY
+ */
+esp_err_t audio_sched_sample_load(audio_sched_task_load_t *out, size_t max, size_t *out_count);
+
+/**
+ * @brief 打印 CPU 负载和截止时间统计
+ */
+void audio_sched_log_report(void);
+
+#ifdef __cplusplus
+}
+#endif
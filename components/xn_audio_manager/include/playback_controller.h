@@ -13,6 +13,7 @@
 #include "esp_err.h"
 #include "ring_buffer.h"
 #include "audio_bsp.h"
+#include "resampler.h"
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -23,6 +24,12 @@ extern "C" {
 /** 播放控制器句柄 */
 typedef struct playback_controller_s *playback_controller_handle_t;
 
+/** 欠载（缓冲区播空）时的补偿策略 */
+typedef enum {
+    PLAYBACK_UNDERRUN_SILENCE = 0,   ///< 补静音
+    PLAYBACK_UNDERRUN_FADE_OUT,      ///< 从最后一个样本平滑衰减到 0 后补静音（避免爆音）
+} playback_underrun_policy_t;
+
 /** 回采数据回调函数类型 */
 typedef void (*playback_reference_callback_t)(const int16_t *samples, size_t count, void *user_ctx);
 
@@ -35,6 +42,14 @@ typedef struct {
     playback_reference_callback_t reference_callback; ///< 回采数据回调（可选，用于AFE）
     void *reference_ctx;                             ///< 回采回调上下文
     uint8_t *volume_ptr;                             ///< 音量指针（外部管理）
+    uint32_t sample_rate;                            ///< 播放采样率（用于毫秒与采样点换算）
+    uint32_t write_timeout_ms;                       ///< playback_controller_write 等待空间的超时（0 表示不等待，只写能容纳的部分）
+    bool low_latency;                                ///< 低延迟流式模式（小帧 + jitter buffer）
+    uint32_t jitter_buffer_ms;                       ///< 低延迟模式：开始/恢复播放前的预缓冲时长
+    uint32_t conceal_max_ms;                         ///< 低延迟模式：欠载后最长补偿时长，超过则视为流结束
+    playback_underrun_policy_t underrun_policy;      ///< 低延迟模式：欠载补偿策略
+    uint32_t source_sample_rate;                     ///< 写入数据的采样率（0 或等于 sample_rate 时不重采样）
+    resampler_quality_t resample_quality;            ///< 重采样质量 / 延迟档位
 } playback_controller_config_t;
 
 /**
@@ -69,11 +84,44 @@ esp_err_t playback_controller_stop(playback_controller_handle_t controller);
  * @param controller 播放控制器句柄
  * @param pcm_data PCM 数据（16bit, 单声道）
  * @param sample_count 采样点数
- * @return ESP_OK 成功
+ * @return ESP_OK 全部写入，ESP_ERR_TIMEOUT 超时仅部分写入
+ * @note 缓冲区满时按 write_timeout_ms 阻塞等待，不会覆盖未播放的数据
  */
 esp_err_t playback_controller_write(playback_controller_handle_t controller, 
                                      const int16_t *pcm_data, size_t sample_count);
 
+/**
+ * @brief 写入音频数据到播放缓冲区（指定超时）
+ * @param controller 播放控制器句柄
+ * @param pcm_data PCM 数据（16bit, 单声道）
+ * @param sample_count 采样点数
+ * @param timeout_ms 等待空间的超时时间（毫秒），0 表示只写入当前可容纳的部分
+ * @param out_written 实际写入的采样点数（可选）
+ * @return ESP_OK 全部写入，ESP_ERR_TIMEOUT 超时仅部分写入
+ */
+esp_err_t playback_controller_write_timeout(playback_controller_handle_t controller,
+                                             const int16_t *pcm_data, size_t sample_count,
+                                             uint32_t timeout_ms, size_t *out_written);
+
+/**
+ * @brief 设置写入数据的采样率（如云端 TTS 返回 24kHz）
+ * @param controller 播放控制器句柄
+ * @param source_rate 写入数据的采样率，0 表示与播放采样率相同
+ * @return ESP_OK 成功
+ * @note 不能与 playback_controller_write 并发调用
+ */
+esp_err_t playback_controller_set_source_rate(playback_controller_handle_t controller, uint32_t source_rate);
+
+/**
+ * @brief 等待播放缓冲区空闲空间达到指定值
+ * @param controller 播放控制器句柄
+ * @param min_samples 期望的最少空闲采样点数
+ * @param timeout_ms 超时时间（毫秒）
+ * @return ESP_OK 空间足够，ESP_ERR_TIMEOUT 超时
+ */
+esp_err_t playback_controller_wait_free_space(playback_controller_handle_t controller,
+                                               size_t min_samples, uint32_t timeout_ms);
+
 /**
  * @brief 清空播放缓冲区
  * @param controller 播放控制器句柄
@@ -102,6 +150,13 @@ size_t playback_controller_get_free_space(playback_controller_handle_t controlle
  */
 ring_buffer_handle_t playback_controller_get_reference_buffer(playback_controller_handle_t controller);
 
+/**
+ * @brief 获取播放缓冲区（用于统计查询）
+ * @param controller 播放控制器句柄
+ * @return 播放缓冲区句柄
+ */
+ring_buffer_handle_t playback_controller_get_playback_buffer(playback_controller_handle_t controller);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,109 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-06
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-06
+ * @FilePath: \xn_voice_wake_up\components\xn_audio_manager\include\resampler.h
+ * @Description: 采样率转换模块 - 多相加窗 sinc 流式重采样（定点 / 浮点）
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include "esp_err.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RESAMPLER_MAX_PHASES 512   ///< 插值因子上限（约分后的 out_rate / gcd）
+
+/** 重采样质量（滤波器长度越长，阻带抑制越好，延迟越大） */
+typedef enum {
+    RESAMPLER_QUALITY_LOW = 0,      ///< 每相 8 抽头，延迟最小
+    RESAMPLER_QUALITY_MEDIUM,       ///< 每相 16 抽头
+    RESAMPLER_QUALITY_HIGH,         ///< 每相 32 抽头
+} resampler_quality_t;
+
+/** 样本格式 */
+typedef enum {
+    RESAMPLER_FORMAT_S16 = 0,       ///< 16bit 定点（Q14 系数，32bit 累加）
+    RESAMPLER_FORMAT_F32,           ///< 32bit 浮点
+} resampler_format_t;
+
+/** 重采样器配置 */
+typedef struct {
+    uint32_t in_rate;               ///< 输入采样率
+    uint32_t out_rate;              ///< 输出采样率
+    resampler_quality_t quality;    ///< 质量 / 延迟档位
+    resampler_format_t format;      ///< 样本格式
+} resampler_config_t;
+
+/** 重采样器句柄 */
+typedef struct resampler_s *resampler_handle_t;
+
+/**
+ * @brief 创建重采样器
+ * @param config 配置参数
+ * @return 重采样器句柄，失败返回 NULL
+ * @note 采样率比值约分后插值因子不得超过 RESAMPLER_MAX_PHASES
+ */
+resampler_handle_t resampler_create(const resampler_config_t *config);
+
+/**
+ * @brief 销毁重采样器
+ * @param rs 重采样器句柄
+ */
+void resampler_destroy(resampler_handle_t rs);
+
+/**
+ * @brief 清空内部历史状态（开始新的音频流时调用）
+ * @param rs 重采样器句柄
+ */
+void resampler_reset(resampler_handle_t rs);
+
+/**
+ * @brief 计算处理 in_samples 个输入最多产生的输出采样点数
+ * @param rs 重采样器句柄
+ * @param in_samples 输入采样点数
+ * @return 输出缓冲区所需的最小容量
+ */
+size_t resampler_get_max_output(resampler_handle_t rs, size_t in_samples);
+
+/**
+ * @brief 获取重采样引入的群延迟
+ * @param rs 重采样器句柄
+ * @return 延迟（输入采样点数）
+ */
+size_t resampler_get_latency(resampler_handle_t rs);
+
+/**
+ * @brief 16bit 定点流式重采样
+ * @param rs 重采样器句柄（format 必须为 RESAMPLER_FORMAT_S16）
+ * @param in 输入数据
+ * @param in_samples 输入采样点数
+ * @param out 输出缓冲区
+ * @param out_capacity 输出缓冲区容量，应不小于 resampler_get_max_output()
+ * @return 实际输出的采样点数
+ */
+size_t resampler_process_s16(resampler_handle_t rs, const int16_t *in, size_t in_samples,
+                             int16_t *out, size_t out_capacity);
+
+/**
+ * @brief 浮点流式重采样
+ * @param rs 重采样器句柄（format 必须为 RESAMPLER_FORMAT_F32）
+ * @param in 输入数据
+ * @param in_samples 输入采样点数
+ * @param out 输出缓冲区
+ * @param out_capacity 输出缓冲区容量，应不小于 resampler_get_max_output()
+ * @return 实际输出的采样点数
+ */
+size_t resampler_process_f32(resampler_handle_t rs, const float *in, size_t in_samples,
+                             float *out, size_t out_capacity);
+
+#ifdef __cplusplus
+}
+#endif
@@ -23,10 +23,25 @@ extern "C" {
 /** 环形缓冲区句柄 */
 typedef struct ring_buffer_s *ring_buffer_handle_t;
 
+/**
+ * @brief 环形缓冲区运行统计
+ *
+ * 计数器为 32 位无符号数，长时间运行后会回绕；
+ * 计算区间增量时直接相减即可（无符号减法天然处理回绕）。
+ */
+typedef struct {
+    uint32_t samples_written;     ///< 累计写入采样点数
+    uint32_t samples_read;        ///< 累计读出采样点数
+    uint32_t samples_overwritten; ///< 因缓冲区满被覆盖（丢弃）的采样点数
+    uint32_t underrun_reads;      ///< 读取到的数据少于请求量的次数
+    uint32_t mutex_timeouts;      ///< 获取互斥锁超时次数（该次读写被放弃）
+    size_t high_water_mark;       ///< 历史最高水位（采样点数）
+} ring_buffer_stats_t;
+
 /**
  * @brief 创建环形缓冲区
  * @param samples 缓冲区容量（采样点数）
- * @param with_sem 是否使用信号量（用于阻塞读取）
+ * @param with_sem 是否使用信号量（用于阻塞读取/阻塞写入）
  * @return 环形缓冲区句柄，失败返回NULL
  */
 ring_buffer_handle_t ring_buffer_create(size_t samples, bool with_sem);
@@ -47,6 +62,17 @@ void ring_buffer_destroy(ring_buffer_handle_t rb);
  */
 size_t ring_buffer_write(ring_buffer_handle_t rb, const int16_t *data, size_t samples);
 
+/**
+ * @brief 写入数据到环形缓冲区（不覆盖，空间不足时等待）
+ * @param rb 环形缓冲区句柄
+ * @param data 数据指针
+ * @param samples 采样点数
+ * @param timeout_ms 等待空间的超时时间（毫秒），0表示只写入当前可容纳的部分
+ * @return 实际写入的采样点数（超时时可能小于 samples）
+ * @note 阻塞等待需要创建时 with_sem = true
+ */
+size_t ring_buffer_write_wait(ring_buffer_handle_t rb, const int16_t *data, size_t samples, uint32_t timeout_ms);
+
 /**
  * @brief 从环形缓冲区读取数据
  * @param rb 环形缓冲区句柄
@@ -64,6 +90,31 @@ size_t ring_buffer_read(ring_buffer_handle_t rb, int16_t *out, size_t samples, u
  */
 size_t ring_buffer_available(ring_buffer_handle_t rb);
 
+/**
+ * @brief 获取环形缓冲区剩余可写空间（不覆盖旧数据）
+ * @param rb 环形缓冲区句柄
+ * @return 可写入的采样点数
+ */
+size_t ring_buffer_get_free(ring_buffer_handle_t rb);
+
+/**
+ * @brief 等待缓冲区中的数据量达到指定值
+ * @param rb 环形缓冲区句柄
+ * @param min_samples 期望的最少数据量（超过容量时按容量计算）
+ * @param timeout_ms 超时时间（毫秒）
+ * @return true 数据量已满足，false 超时
+ */
+bool ring_buffer_wait_available(ring_buffer_handle_t rb, size_t min_samples, uint32_t timeout_ms);
+
+/**
+ * @brief 等待缓冲区剩余空间达到指定值
+ * @param rb 环形缓冲区句柄
+ * @param min_free 期望的最少剩余空间（超过容量时按容量计算）
+ * @param timeout_ms 超时时间（毫秒）
+ * @return true 空间已满足，false 超时
+ */
+bool ring_buffer_wait_free(ring_buffer_handle_t rb, size_t min_free, uint32_t timeout_ms);
+
 /**
  * @brief 清空环形缓冲区
  * @param rb 环形缓冲区句柄
@@ -78,6 +129,20 @@ esp_err_t ring_buffer_clear(ring_buffer_handle_t rb);
  */
 size_t ring_buffer_get_size(ring_buffer_handle_t rb);
 
+/**
+ * @brief 获取环形缓冲区运行统计（无锁快照）
+ * @param rb 环形缓冲区句柄
+ * @param out_stats 输出统计数据
+ * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t ring_buffer_get_stats(ring_buffer_handle_t rb, ring_buffer_stats_t *out_stats);
+
+/**
+ * @brief 清零环形缓冲区运行统计
+ * @param rb 环形缓冲区句柄
+ */
+void ring_buffer_reset_stats(ring_buffer_handle_t rb);
+
 #ifdef __cplusplus
 }
 #endif
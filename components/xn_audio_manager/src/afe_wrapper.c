@@ -9,7 +9,10 @@
  * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved. 
  */
 #include "afe_wrapper.h"
+#include "audio_sched.h"
+#include "metrics_trace.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_gmf_afe_manager.h"
 #include "esp_afe_sr_iface.h"
 #include "esp_afe_config.h"
@@ -81,6 +84,16 @@ static int32_t afe_read_callback(void *buffer, int buf_sz, void *user_ctx, TickT
             ESP_LOGI(TAG, "MIC 数据: samples=%d, min=%d, max=%d", (int)mic_got, min_val, max_val);
         }
 
+        // 追踪开启时在时间线上画出每帧麦克风峰值
+        if (metrics_trace_is_enabled()) {
+            int32_t peak = 0;
+            for (size_t i = 0; i < mic_got; i++) {
+                int32_t v = wrapper->mic_buffer[i] < 0 ? -(int32_t)wrapper->mic_buffer[i] : wrapper->mic_buffer[i];
+                if (v > peak) peak = v;
+            }
+            metrics_trace_counter("audio", "mic_peak", peak);
+        }
+
         size_t ref_got = ring_buffer_read(wrapper->reference_rb, wrapper->ref_buffer, mic_got, 0);
         if (ref_got < mic_got) {
             memset(wrapper->ref_buffer + ref_got, 0, (mic_got - ref_got) * sizeof(int16_t));
@@ -105,6 +118,8 @@ static void afe_result_callback(afe_fetch_result_t *result, void *user_ctx)
     afe_wrapper_t *wrapper = (afe_wrapper_t *)user_ctx;
     if (!result || !wrapper || !wrapper->event_callback) return;
 
+    int64_t start_us = esp_timer_get_time();
+    metrics_trace_begin("audio", "afe_result");
     afe_event_t event = {0};
     static bool vad_active = false;
 
@@ -119,12 +134,16 @@ static void afe_result_callback(afe_fetch_result_t *result, void *user_ctx)
         wrapper->event_callback(&event, wrapper->event_ctx);
     }
 
-    // 处理录音数据回调
-    if (wrapper->recording_ptr && *wrapper->recording_ptr && 
+    // 处理录音数据回调（recording_ptr 为 NULL 时每帧都回调，由上层自行过滤）
+    if ((!wrapper->recording_ptr || *wrapper->recording_ptr) &&
         result->data && result->data_size > 0 && wrapper->record_callback) {
         size_t samples = result->data_size / sizeof(int16_t);
         wrapper->record_callback((const int16_t *)result->data, samples, wrapper->record_ctx);
     }
+
+    // 包含同步执行的采集处理图内联节点，超过一片时长会拖慢 AFE 取数
+    audio_sched_report_runtime(AUDIO_SCHED_STAGE_AFE_FETCH, (uint32_t)(esp_timer_get_time() - start_us));
+    metrics_trace_end("audio", "afe_result");
 }
 
 /**
@@ -169,8 +188,10 @@ afe_wrapper_handle_t afe_wrapper_create(const afe_wrapper_config_t *config)
     afe_config->vad_min_speech_ms = config->vad_config.min_speech_ms;
     afe_config->vad_min_noise_ms = config->vad_config.min_silence_ms;
     afe_config->wakenet_init = false;  // 禁用唤醒词
-    afe_config->afe_perferred_core = 0;
-    afe_config->afe_perferred_priority = 8;
+    const audio_sched_stage_config_t *feed_sched = audio_sched_get_stage(AUDIO_SCHED_STAGE_AFE_FEED);
+    const audio_sched_stage_config_t *fetch_sched = audio_sched_get_stage(AUDIO_SCHED_STAGE_AFE_FETCH);
+    afe_config->afe_perferred_core = fetch_sched->core;
+    afe_config->afe_perferred_priority = fetch_sched->priority;
     afe_config->memory_alloc_mode = AFE_MEMORY_ALLOC_MORE_PSRAM;
     afe_config->agc_init = config->feature_config.agc_enabled;
     afe_config->ns_init = config->feature_config.ns_enabled;
@@ -183,14 +204,14 @@ afe_wrapper_handle_t afe_wrapper_create(const afe_wrapper_config_t *config)
         .read_cb = afe_read_callback,
         .read_ctx = wrapper,
         .feed_task_setting = {
-            .stack_size = 10 * 1024,
-            .prio = 8,
-            .core = 1,
+            .stack_size = feed_sched->stack_size,
+            .prio = feed_sched->priority,
+            .core = feed_sched->core,
         },
         .fetch_task_setting = {
-            .stack_size = 8 * 1024,
-            .prio = 8,
-            .core = 0,
+            .stack_size = fetch_sched->stack_size,
+            .prio = fetch_sched->priority,
+            .core = fetch_sched->core,
         },
     };
 
@@ -0,0 +1,518 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-08
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-08
+ * @FilePath: \xn_voice_wake_up\components\xn_audio_manager\src\audio_graph.c
+ * @Description: 音频处理图实现
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#include "audio_graph.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "metrics_trace.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "AUDIO_GRAPH";
+
+#define AUDIO_GRAPH_TASK_JOIN_TIMEOUT_MS 500   ///< 停止时等待节点任务退出的超时
+#define AUDIO_GRAPH_MSG_STOP             SIZE_MAX ///< 任务退出消息（samples 字段）
+
+/** 节点任务队列消息 */
+typedef struct {
+    const int16_t *data;            ///< 指向节点输入槽位
+    size_t samples;                 ///< 采样点数，AUDIO_GRAPH_MSG_STOP 表示退出
+} audio_graph_msg_t;
+
+/**
+ * @brief 节点上下文结构体
+ *
+ * 内联节点在上游所在任务中同步执行，帧以指针传递（零拷贝）；
+ * 绑核节点拥有独立任务和输入槽位池，跨任务边界时才拷贝一次。
+ */
+typedef struct {
+    audio_graph_node_config_t cfg;          ///< 节点配置
+    int sinks[AUDIO_GRAPH_MAX_FANOUT];      ///< 下游节点 ID
+    uint8_t sink_count;                     ///< 下游节点数量
+    int context;                            ///< 执行上下文（所在任务对应的节点 ID），启动时计算
+    int producer;                           ///< 绑核节点：向其入队的上游执行上下文（槽位池只支持单生产者）
+    size_t in_samples;                      ///< 输入帧最大长度（所有上游帧长的最大值）
+    int16_t *out_buf;                       ///< 输出缓冲区（处理节点）
+    TaskHandle_t task;                      ///< 绑核任务
+    QueueHandle_t queue;                    ///< 绑核任务输入队列
+    SemaphoreHandle_t exit_sem;             ///< 绑核任务退出信号
+    int16_t *slots;                         ///< 输入槽位池（queue_depth + 1 个）
+    uint8_t slot_next;                      ///< 下一个可用槽位
+    audio_graph_node_stats_t stats;         ///< 运行统计
+} audio_graph_node_t;
+
+/**
+ * @brief 音频处理图上下文结构体
+ */
+typedef struct audio_graph_s {
+    audio_graph_node_t *nodes;              ///< 节点数组
+    size_t max_nodes;                       ///< 最大节点数
+    size_t count;                           ///< 当前节点数
+    bool started;                           ///< 是否已启动（启动后拓扑冻结）
+    portMUX_TYPE stats_lock;                ///< 统计数据自旋锁
+} audio_graph_t;
+
+typedef struct {
+    audio_graph_t *graph;
+    int id;
+} audio_graph_task_arg_t;
+
+static void audio_graph_dispatch(audio_graph_t *graph, int id, const audio_graph_frame_t *frame);
+
+/**
+ * @brief 执行一个节点并把输出分发给下游
+ */
+static void audio_graph_run_node(audio_graph_t *graph, int id, const audio_graph_frame_t *in)
+{
+    audio_graph_node_t *node = &graph->nodes[id];
+    audio_graph_frame_t out = *in;
+    esp_err_t ret = ESP_OK;
+
+    metrics_trace_begin("audio", node->stats.name);
+    esp_cpu_cycle_count_t start = esp_cpu_get_cycle_count();
+    if (node->cfg.process) {
+        if (node->cfg.type == AUDIO_GRAPH_NODE_FILTER) {
+            out.data = node->out_buf;
+            out.samples = 0;
+            ret = node->cfg.process(in, &out, node->cfg.user_ctx);
+        } else {
+            ret = node->cfg.process(in, NULL, node->cfg.user_ctx);
+        }
+    }
+    uint32_t cycles = (uint32_t)(esp_cpu_get_cycle_count() - start);
+    metrics_trace_end("audio", node->stats.name);
+
+    portENTER_CRITICAL(&graph->stats_lock);
+    node->stats.frames++;
+    node->stats.total_cycles += cycles;
+    if (cycles > node->stats.max_cycles) {
+        node->stats.max_cycles = cycles;
+    }
+    portEXIT_CRITICAL(&graph->stats_lock);
+
+    if (node->cfg.type == AUDIO_GRAPH_NODE_SINK || ret != ESP_OK || out.samples == 0) {
+        return;
+    }
+    if (out.samples > node->cfg.frame_samples) {
+        out.samples = node->cfg.frame_samples;
+    }
+
+    for (uint8_t i = 0; i < node->sink_count; i++) {
+        audio_graph_dispatch(graph, node->sinks[i], &out);
+    }
+}
+
+/**
+ * @brief 把一帧交给节点：内联节点直接执行，绑核节点拷入槽位后入队
+ */
+static void audio_graph_dispatch(audio_graph_t *graph, int id, const audio_graph_frame_t *frame)
+{
+    audio_graph_node_t *node = &graph->nodes[id];
+    if (!node->task) {
+        audio_graph_run_node(graph, id, frame);
+        return;
+    }
+
+    // 队列满时直接丢帧：此时下一个槽位可能仍在队列中或正被节点任务处理，不能覆盖
+    if (uxQueueSpacesAvailable(node->queue) == 0) {
+        portENTER_CRITICAL(&graph->stats_lock);
+        node->stats.dropped_frames++;
+        portEXIT_CRITICAL(&graph->stats_lock);
+        return;
+    }
+
+    size_t samples = frame->samples < node->in_samples ? frame->samples : node->in_samples;
+    int16_t *slot = &node->slots[(size_t)node->slot_next * node->in_samples];
+    memcpy(slot, frame->data, samples * sizeof(int16_t));
+
+    audio_graph_msg_t msg = { .data = slot, .samples = samples };
+    if (xQueueSend(node->queue, &msg, 0) != pdTRUE) {
+        portENTER_CRITICAL(&graph->stats_lock);
+        node->stats.dropped_frames++;
+        portEXIT_CRITICAL(&graph->stats_lock);
+        return;
+    }
+    node->slot_next = (uint8_t)((node->slot_next + 1) % (node->cfg.queue_depth + 1));
+}
+
+/**
+ * @brief 绑核节点任务
+ */
+static void audio_graph_node_task(void *arg)
+{
+    audio_graph_task_arg_t task_arg = *(audio_graph_task_arg_t *)arg;
+    free(arg);
+    audio_graph_node_t *node = &task_arg.graph->nodes[task_arg.id];
+    audio_graph_msg_t msg;
+
+    while (true) {
+        if (xQueueReceive(node->queue, &msg, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        if (msg.samples == AUDIO_GRAPH_MSG_STOP) {
+            break;
+        }
+        audio_graph_frame_t frame = { .data = msg.data, .samples = msg.samples };
+        audio_graph_run_node(task_arg.graph, task_arg.id, &frame);
+    }
+
+    xSemaphoreGive(node->exit_sem);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 创建音频处理图
+ *
+ * @param max_nodes 最大节点数
+ * @return 图句柄，失败返回 NULL
+ */
+audio_graph_handle_t audio_graph_create(size_t max_nodes)
+{
+    if (max_nodes == 0) {
+        ESP_LOGE(TAG, "无效的节点数量");
+        return NULL;
+    }
+
+    audio_graph_t *graph = (audio_graph_t *)calloc(1, sizeof(audio_graph_t));
+    if (!graph) {
+        ESP_LOGE(TAG, "处理图分配失败");
+        return NULL;
+    }
+
+    graph->nodes = (audio_graph_node_t *)calloc(max_nodes, sizeof(audio_graph_node_t));
+    if (!graph->nodes) {
+        ESP_LOGE(TAG, "节点数组分配失败");
+        free(graph);
+        return NULL;
+    }
+
+    graph->max_nodes = max_nodes;
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    graph->stats_lock = lock;
+    return graph;
+}
+
+/**
+ * @brief 销毁音频处理图
+ *
+ * @param graph 图句柄，允许为 NULL
+ */
+void audio_graph_destroy(audio_graph_handle_t graph)
+{
+    if (!graph) return;
+    audio_graph_stop(graph);
+    free(graph->nodes);
+    free(graph);
+}
+
+/**
+ * @brief 添加节点
+ *
+ * @param graph 图句柄
+ * @param config 节点配置
+ * @param out_id 输出节点 ID（可选）
+ * @return
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 参数无效（帧长为 0，处理节点缺少处理函数等）
+ *   - ESP_ERR_INVALID_STATE: 图已启动
+ *   - ESP_ERR_NO_MEM: 节点数已达上限
+ */
+esp_err_t audio_graph_add_node(audio_graph_handle_t graph, const audio_graph_node_config_t *config,
+                               int *out_id)
+{
+    if (!graph || !config || config->frame_samples == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config->type != AUDIO_GRAPH_NODE_SOURCE && !config->process) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (graph->started) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (graph->count >= graph->max_nodes) {
+        ESP_LOGE(TAG, "节点数已达上限 %u", (unsigned)graph->max_nodes);
+        return ESP_ERR_NO_MEM;
+    }
+
+    int id = (int)graph->count++;
+    audio_graph_node_t *node = &graph->nodes[id];
+    memset(node, 0, sizeof(*node));
+    node->cfg = *config;
+    if (node->cfg.queue_depth == 0) {
+        node->cfg.queue_depth = 1;
+    }
+    node->stats.name = config->name ? config->name : "node";
+    node->in_samples = (config->type == AUDIO_GRAPH_NODE_SOURCE) ? config->frame_samples : 0;
+
+    if (out_id) {
+        *out_id = id;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 连接两个节点
+ *
+ * 要求下游节点晚于上游节点添加，从结构上保证图无环，
+ * 并使按 ID 顺序遍历即为拓扑序。
+ *
+ * @param graph 图句柄
+ * @param from_id 上游节点 ID（不能是终端节点）
+ * @param to_id 下游节点 ID（不能是源节点）
+ * @return ESP_OK 成功
+ */
+esp_err_t audio_graph_connect(audio_graph_handle_t graph, int from_id, int to_id)
+{
+    if (!graph || from_id < 0 || to_id < 0 ||
+        (size_t)from_id >= graph->count || (size_t)to_id >= graph->count || from_id >= to_id) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (graph->started) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    audio_graph_node_t *from = &graph->nodes[from_id];
+    audio_graph_node_t *to = &graph->nodes[to_id];
+    if (from->cfg.type == AUDIO_GRAPH_NODE_SINK || to->cfg.type == AUDIO_GRAPH_NODE_SOURCE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (from->sink_count >= AUDIO_GRAPH_MAX_FANOUT) {
+        ESP_LOGE(TAG, "节点 %s 下游数量已达上限", from->stats.name);
+        return ESP_ERR_NO_MEM;
+    }
+
+    from->sinks[from->sink_count++] = to_id;
+    if (from->cfg.frame_samples > to->in_samples) {
+        to->in_samples = from->cfg.frame_samples;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 计算执行上下文并检查并发安全
+ *
+ * 每个节点的执行上下文为自身（绑核或源节点）或上游的上下文。
+ * 内联节点的所有上游必须处于同一上下文，否则其输出缓冲区会被
+ * 多个任务同时写入，此时应把该节点改为绑核节点。
+ */
+static esp_err_t audio_graph_resolve_contexts(audio_graph_t *graph)
+{
+    for (size_t i = 0; i < graph->count; i++) {
+        graph->nodes[i].context = -1;
+        graph->nodes[i].producer = -1;
+    }
+
+    for (size_t i = 0; i < graph->count; i++) {
+        audio_graph_node_t *node = &graph->nodes[i];
+        if (node->cfg.type == AUDIO_GRAPH_NODE_SOURCE || node->cfg.core != AUDIO_GRAPH_CORE_INLINE) {
+            node->context = (int)i;
+        } else if (node->context < 0) {
+            ESP_LOGW(TAG, "节点 %s 没有上游，不会被执行", node->stats.name);
+            continue;
+        }
+        for (uint8_t s = 0; s < node->sink_count; s++) {
+            audio_graph_node_t *sink = &graph->nodes[node->sinks[s]];
+            if (sink->cfg.core != AUDIO_GRAPH_CORE_INLINE) {
+                if (sink->producer >= 0 && sink->producer != node->context) {
+                    ESP_LOGE(TAG, "绑核节点 %s 的上游位于不同任务，只支持单一生产者", sink->stats.name);
+                    return ESP_ERR_INVALID_STATE;
+                }
+                sink->producer = node->context;
+                continue;
+            }
+            if (sink->context >= 0 && sink->context != node->context) {
+                ESP_LOGE(TAG, "内联节点 %s 的上游位于不同任务，请为其指定 core", sink->stats.name);
+                return ESP_ERR_INVALID_STATE;
+            }
+            sink->context = node->context;
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 启动音频处理图
+ *
+ * 一次性分配所有帧缓冲区和槽位池并创建绑核任务，运行期不再分配内存。
+ *
+ * @param graph 图句柄
+ * @return
+ *   - ESP_OK: 成功（重复启动也返回成功）
+ *   - ESP_ERR_INVALID_STATE: 拓扑不满足并发约束
+ *   - ESP_ERR_NO_MEM: 内存或任务创建失败
+ */
+esp_err_t audio_graph_start(audio_graph_handle_t graph)
+{
+    if (!graph) return ESP_ERR_INVALID_ARG;
+    if (graph->started) return ESP_OK;
+
+    esp_err_t ret = audio_graph_resolve_contexts(graph);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    for (size_t i = 0; i < graph->count; i++) {
+        audio_graph_node_t *node = &graph->nodes[i];
+
+        if (node->cfg.type == AUDIO_GRAPH_NODE_FILTER) {
+            node->out_buf = (int16_t *)malloc(node->cfg.frame_samples * sizeof(int16_t));
+            if (!node->out_buf) goto fail;
+        }
+
+        if (node->cfg.core == AUDIO_GRAPH_CORE_INLINE || node->in_samples == 0) {
+            continue;
+        }
+
+        node->slots = (int16_t *)malloc((size_t)(node->cfg.queue_depth + 1) * node->in_samples * sizeof(int16_t));
+        // 队列只有 queue_depth 项，多出的一个槽位留给节点任务正在处理的帧
+        node->queue = xQueueCreate(node->cfg.queue_depth, sizeof(audio_graph_msg_t));
+        node->exit_sem = xSemaphoreCreateBinary();
+        audio_graph_task_arg_t *arg = (audio_graph_task_arg_t *)malloc(sizeof(audio_graph_task_arg_t));
+        if (!node->slots || !node->queue || !node->exit_sem || !arg) {
+            free(arg);
+            goto fail;
+        }
+        arg->graph = graph;
+        arg->id = (int)i;
+        if (xTaskCreatePinnedToCore(audio_graph_node_task, node->stats.name, node->cfg.stack_size,
+                                    arg, node->cfg.priority, &node->task, node->cfg.core) != pdPASS) {
+            free(arg);
+            goto fail;
+        }
+    }
+
+    graph->started = true;
+    ESP_LOGI(TAG, "✅ 处理图启动: %u 个节点", (unsigned)graph->count);
+    return ESP_OK;
+
+fail:
+    ESP_LOGE(TAG, "处理图启动失败");
+    graph->started = true;
+    audio_graph_stop(graph);
+    return ESP_ERR_NO_MEM;
+}
+
+/**
+ * @brief 停止音频处理图
+ *
+ * 向每个绑核任务发送退出消息并等待其结束，然后释放运行期资源。
+ * 停止后可以继续修改拓扑并再次启动。
+ *
+ * @param graph 图句柄
+ * @note 调用前应确保不再有 audio_graph_push() 调用
+ */
+void audio_graph_stop(audio_graph_handle_t graph)
+{
+    if (!graph || !graph->started) return;
+
+    graph->started = false;
+    for (size_t i = 0; i < graph->count; i++) {
+        audio_graph_node_t *node = &graph->nodes[i];
+        if (node->task) {
+            audio_graph_msg_t stop = { .data = NULL, .samples = AUDIO_GRAPH_MSG_STOP };
+            xQueueSend(node->queue, &stop, portMAX_DELAY);
+            if (xSemaphoreTake(node->exit_sem, pdMS_TO_TICKS(AUDIO_GRAPH_TASK_JOIN_TIMEOUT_MS)) != pdTRUE) {
+                ESP_LOGE(TAG, "节点 %s 任务退出超时", node->stats.name);
+            }
+            node->task = NULL;
+        }
+        if (node->queue) {
+            vQueueDelete(node->queue);
+            node->queue = NULL;
+        }
+        if (node->exit_sem) {
+            vSemaphoreDelete(node->exit_sem);
+            node->exit_sem = NULL;
+        }
+        free(node->slots);
+        node->slots = NULL;
+        node->slot_next = 0;
+        free(node->out_buf);
+        node->out_buf = NULL;
+    }
+}
+
+/**
+ * @brief 检查是否已启动
+ */
+bool audio_graph_is_started(audio_graph_handle_t graph)
+{
+    return graph ? graph->started : false;
+}
+
+/**
+ * @brief 向源节点注入数据
+ *
+ * 按源节点帧长切分后依次执行，下游内联节点在调用者任务中同步运行。
+ *
+ * @param graph 图句柄
+ * @param source_id 源节点 ID
+ * @param pcm 数据
+ * @param samples 采样点数
+ * @return
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_STATE: 图未启动
+ *   - ESP_ERR_INVALID_ARG: 参数无效或节点不是源节点
+ */
+esp_err_t audio_graph_push(audio_graph_handle_t graph, int source_id, const int16_t *pcm, size_t samples)
+{
+    if (!graph || !pcm || source_id < 0 || (size_t)source_id >= graph->count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!graph->started) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    audio_graph_node_t *node = &graph->nodes[source_id];
+    if (node->cfg.type != AUDIO_GRAPH_NODE_SOURCE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (size_t off = 0; off < samples; off += node->cfg.frame_samples) {
+        size_t n = samples - off;
+        if (n > node->cfg.frame_samples) n = node->cfg.frame_samples;
+        audio_graph_frame_t frame = { .data = &pcm[off], .samples = n };
+        audio_graph_dispatch(graph, source_id, &frame);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取节点运行统计
+ *
+ * @param graph 图句柄
+ * @param node_id 节点 ID
+ * @param out_stats 输出统计
+ * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
+ *
+ * @note 绑核节点的周期数包含被更高优先级任务抢占的时间
+ */
+esp_err_t audio_graph_get_node_stats(audio_graph_handle_t graph, int node_id,
+                                     audio_graph_node_stats_t *out_stats)
+{
+    if (!graph || !out_stats || node_id < 0 || (size_t)node_id >= graph->count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&graph->stats_lock);
+    *out_stats = graph->nodes[node_id].stats;
+    portEXIT_CRITICAL(&graph->stats_lock);
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取节点数量
+ */
+size_t audio_graph_get_node_count(audio_graph_handle_t graph)
+{
+    return graph ? graph->count : 0;
+}
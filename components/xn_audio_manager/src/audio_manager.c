@@ -13,10 +13,12 @@
 #include "playback_controller.h"
 #include "button_handler.h"
 #include "afe_wrapper.h"
+#include "metrics_registry.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include <stdlib.h>
 #include <string.h>
 
 static const char *TAG = "AUDIO_MGR";
@@ -42,6 +44,7 @@ typedef struct {
     button_handler_handle_t button_handler;
     afe_wrapper_handle_t afe_wrapper;
     ring_buffer_handle_t reference_rb;
+    ring_buffer_handle_t playback_rb;
     bool initialized;
     bool running;
     bool recording;
@@ -52,8 +55,15 @@ typedef struct {
     TickType_t vad_deadline_tick;
     audio_record_callback_t record_callback;
     void *record_ctx;
+    resampler_handle_t record_resampler;
+    int16_t *record_resample_buf;
+    size_t record_resample_buf_samples;
+    audio_graph_handle_t capture_graph;
     QueueHandle_t event_queue;
     TaskHandle_t manager_task;
+    TickType_t stats_report_tick;
+    TickType_t sched_report_tick;
+    audio_mgr_buffer_stats_t stats_last;
 } audio_manager_ctx_t;
 
 static audio_manager_ctx_t s_ctx = {0};
@@ -67,6 +77,7 @@ static void audio_manager_task(void *arg);
 static void audio_manager_tick(void);
 static void audio_manager_arm_vad_timer(int duration_ms);
 static void audio_manager_clear_vad_timer(void);
+static void audio_manager_report_stats(void);
 
 
 static void audio_manager_set_state(audio_mgr_state_t new_state)
@@ -139,6 +150,45 @@ static void audio_manager_tick(void)
     }
 }
 
+static void audio_manager_report_one(const char *name, const ring_buffer_stats_t *now,
+                                     const ring_buffer_stats_t *last, size_t capacity)
+{
+    uint32_t overwritten = now->samples_overwritten - last->samples_overwritten;
+    uint32_t timeouts = now->mutex_timeouts - last->mutex_timeouts;
+    if (overwritten == 0 && timeouts == 0) return;
+    ESP_LOGW(TAG, "⚠️ %s 缓冲区异常: 覆盖 %u 样本, 锁超时 %u 次, 最高水位 %u/%u",
+             name, (unsigned)overwritten, (unsigned)timeouts,
+             (unsigned)now->high_water_mark, (unsigned)capacity);
+}
+
+/**
+ * @brief 周期性检查缓冲区统计，仅在出现溢出/锁超时时限频打印
+ *
+ * 运行在状态机任务中，远离音频热路径，过载时不会因日志本身加重负载。
+ */
+static void audio_manager_report_stats(void)
+{
+    TickType_t now = xTaskGetTickCount();
+    if ((TickType_t)(now - s_ctx.sched_report_tick) >= pdMS_TO_TICKS(AUDIO_MANAGER_SCHED_REPORT_INTERVAL_MS)) {
+        s_ctx.sched_report_tick = now;
+        audio_sched_log_report();
+    }
+
+    if ((TickType_t)(now - s_ctx.stats_report_tick) < pdMS_TO_TICKS(AUDIO_MANAGER_STATS_REPORT_INTERVAL_MS)) {
+        return;
+    }
+    s_ctx.stats_report_tick = now;
+
+    audio_mgr_buffer_stats_t stats = {0};
+    if (audio_manager_get_buffer_stats(&stats) != ESP_OK) return;
+
+    audio_manager_report_one("播放", &stats.playback, &s_ctx.stats_last.playback,
+                             ring_buffer_get_size(s_ctx.playback_rb));
+    audio_manager_report_one("回采", &stats.reference, &s_ctx.stats_last.reference,
+                             ring_buffer_get_size(s_ctx.reference_rb));
+    s_ctx.stats_last = stats;
+}
+
 static void button_event_handler(button_event_type_t event, void *user_ctx)
 {
     audio_mgr_internal_msg_t msg = {
@@ -165,13 +215,177 @@ static void afe_event_handler(const afe_event_t *event, void *user_ctx)
     audio_manager_post_event(&msg);
 }
 
-static void afe_record_handler(const int16_t *pcm_data, size_t samples, void *user_ctx)
+/**
+ * @brief 录音终端节点：仅在录音状态下把数据交给用户回调（必要时重采样）
+ */
+static esp_err_t graph_record_sink(const audio_graph_frame_t *in, audio_graph_frame_t *out, void *user_ctx)
 {
-    if (s_ctx.record_callback) {
-        s_ctx.record_callback(pcm_data, samples, s_ctx.record_ctx);
+    if (!s_ctx.recording || !s_ctx.record_callback) return ESP_OK;
+    if (!s_ctx.record_resampler) {
+        s_ctx.record_callback(in->data, in->samples, s_ctx.record_ctx);
+        return ESP_OK;
+    }
+
+    // 分块重采样到录音输出采样率，使用预分配缓冲区
+    for (size_t off = 0; off < in->samples; off += AUDIO_MANAGER_RESAMPLE_CHUNK_SAMPLES) {
+        size_t chunk = in->samples - off;
+        if (chunk > AUDIO_MANAGER_RESAMPLE_CHUNK_SAMPLES) chunk = AUDIO_MANAGER_RESAMPLE_CHUNK_SAMPLES;
+        size_t n = resampler_process_s16(s_ctx.record_resampler, &in->data[off], chunk,
+                                         s_ctx.record_resample_buf, s_ctx.record_resample_buf_samples);
+        if (n > 0) {
+            s_ctx.record_callback(s_ctx.record_resample_buf, n, s_ctx.record_ctx);
+        }
     }
+    return ESP_OK;
+}
+
+static void afe_record_handler(const int16_t *pcm_data, size_t samples, void *user_ctx)
+{
+    if (!audio_graph_is_started(s_ctx.capture_graph)) return;
+    audio_graph_push(s_ctx.capture_graph, AUDIO_MANAGER_GRAPH_SOURCE_NODE, pcm_data, samples);
+}
+
+/**
+ * @brief 创建采集处理图：AFE 源节点 -> 录音终端节点
+ */
+static esp_err_t audio_manager_create_capture_graph(void)
+{
+    s_ctx.capture_graph = audio_graph_create(AUDIO_MANAGER_GRAPH_MAX_NODES);
+    if (!s_ctx.capture_graph) return ESP_ERR_NO_MEM;
+
+    audio_graph_node_config_t node_cfg = AUDIO_GRAPH_DEFAULT_NODE_CONFIG();
+    node_cfg.name = "afe";
+    node_cfg.type = AUDIO_GRAPH_NODE_SOURCE;
+    node_cfg.frame_samples = AUDIO_MANAGER_GRAPH_FRAME_SAMPLES;
+    esp_err_t ret = audio_graph_add_node(s_ctx.capture_graph, &node_cfg, NULL);
+    if (ret != ESP_OK) return ret;
+
+    node_cfg = AUDIO_GRAPH_DEFAULT_NODE_CONFIG();
+    node_cfg.name = "record";
+    node_cfg.type = AUDIO_GRAPH_NODE_SINK;
+    node_cfg.frame_samples = AUDIO_MANAGER_GRAPH_FRAME_SAMPLES;
+    node_cfg.process = graph_record_sink;
+    ret = audio_graph_add_node(s_ctx.capture_graph, &node_cfg, NULL);
+    if (ret != ESP_OK) return ret;
+
+    return audio_graph_connect(s_ctx.capture_graph, AUDIO_MANAGER_GRAPH_SOURCE_NODE,
+                               AUDIO_MANAGER_GRAPH_RECORD_NODE);
+}
+
+/* -------------------- 运行指标 -------------------- */
+
+/**
+ * @brief 读取播放（ctx == NULL）或回采（ctx != NULL）缓冲区统计
+ */
+static bool audio_manager_metric_rb_stats(void *ctx, ring_buffer_stats_t *out)
+{
+    audio_mgr_buffer_stats_t stats;
+    if (!s_ctx.initialized || audio_manager_get_buffer_stats(&stats) != ESP_OK) return false;
+    *out = ctx ? stats.reference : stats.playback;
+    return true;
+}
+
+static int64_t audio_manager_read_rb_overwritten(void *ctx)
+{
+    ring_buffer_stats_t st;
+    return audio_manager_metric_rb_stats(ctx, &st) ? st.samples_overwritten : 0;
+}
+
+static int64_t audio_manager_read_rb_underruns(void *ctx)
+{
+    ring_buffer_stats_t st;
+    return audio_manager_metric_rb_stats(ctx, &st) ? st.underrun_reads : 0;
+}
+
+static int64_t audio_manager_read_rb_mutex_timeouts(void *ctx)
+{
+    ring_buffer_stats_t st;
+    return audio_manager_metric_rb_stats(ctx, &st) ? st.mutex_timeouts : 0;
 }
 
+static int64_t audio_manager_read_rb_high_water(void *ctx)
+{
+    ring_buffer_stats_t st;
+    return audio_manager_metric_rb_stats(ctx, &st) ? (int64_t)st.high_water_mark : 0;
+}
+
+/**
+ * @brief 读取采集处理图节点统计（ctx 为节点 ID）
+ */
+static bool audio_manager_metric_node_stats(void *ctx, audio_graph_node_stats_t *out)
+{
+    return s_ctx.initialized &&
+           audio_graph_get_node_stats(s_ctx.capture_graph, (int)(intptr_t)ctx, out) == ESP_OK;
+}
+
+static int64_t audio_manager_read_node_frames(void *ctx)
+{
+    audio_graph_node_stats_t st;
+    return audio_manager_metric_node_stats(ctx, &st) ? st.frames : 0;
+}
+
+static int64_t audio_manager_read_node_dropped(void *ctx)
+{
+    audio_graph_node_stats_t st;
+    return audio_manager_metric_node_stats(ctx, &st) ? st.dropped_frames : 0;
+}
+
+static int64_t audio_manager_read_node_max_cycles(void *ctx)
+{
+    audio_graph_node_stats_t st;
+    return audio_manager_metric_node_stats(ctx, &st) ? st.max_cycles : 0;
+}
+
+/** 回调型指标表：复用已有的原子统计，采集时才读取，实时路径没有额外开销 */
+typedef struct {
+    metrics_desc_t desc;
+    metrics_type_t type;
+    metrics_read_fn read;
+    void *ctx;
+} audio_manager_metric_t;
+
+#define AUDIO_RB_METRICS(label, ctx)                                                                       \
+    {{"xn_audio_rb_overwritten_samples_total", "rb=\"" label "\"", "Samples dropped because the ring buffer was full"}, \
+     METRICS_TYPE_COUNTER, audio_manager_read_rb_overwritten, ctx},                                        \
+    {{"xn_audio_rb_underruns_total", "rb=\"" label "\"", "Reads that returned less data than requested"},  \
+     METRICS_TYPE_COUNTER, audio_manager_read_rb_underruns, ctx},                                          \
+    {{"xn_audio_rb_mutex_timeouts_total", "rb=\"" label "\"", "Ring buffer operations dropped on lock timeout"}, \
+     METRICS_TYPE_COUNTER, audio_manager_read_rb_mutex_timeouts, ctx},                                     \
+    {{"xn_audio_rb_high_water_samples", "rb=\"" label "\"", "Ring buffer high water mark"},                \
+     METRICS_TYPE_GAUGE, audio_manager_read_rb_high_water, ctx}
+
+#define AUDIO_NODE_METRICS(label, id)                                                                      \
+    {{"xn_audio_node_frames_total", "node=\"" label "\"", "Frames processed by capture graph node"},       \
+     METRICS_TYPE_COUNTER, audio_manager_read_node_frames, (void *)(intptr_t)(id)},                        \
+    {{"xn_audio_node_dropped_frames_total", "node=\"" label "\"", "Frames dropped on full node queue"},    \
+     METRICS_TYPE_COUNTER, audio_manager_read_node_dropped, (void *)(intptr_t)(id)},                       \
+    {{"xn_audio_node_max_cycles", "node=\"" label "\"", "Worst-case CPU cycles per frame"},                \
+     METRICS_TYPE_GAUGE, audio_manager_read_node_max_cycles, (void *)(intptr_t)(id)}
+
+static const audio_manager_metric_t s_audio_metrics[] = {
+    AUDIO_RB_METRICS("playback", NULL),
+    AUDIO_RB_METRICS("reference", (void *)1),
+    AUDIO_NODE_METRICS("afe", AUDIO_MANAGER_GRAPH_SOURCE_NODE),
+    AUDIO_NODE_METRICS("record", AUDIO_MANAGER_GRAPH_RECORD_NODE),
+};
+
+/**
+ * @brief 注册音频运行指标（环形缓冲区溢出 / 欠载、处理图节点、各阶段耗时）
+ *
+ * 指标缺失不影响音频功能，失败只记录警告。
+ */
+static void audio_manager_register_metrics(void)
+{
+    esp_err_t ret = audio_sched_register_metrics();
+    for (size_t i = 0; i < sizeof(s_audio_metrics) / sizeof(s_audio_metrics[0]); i++) {
+        const audio_manager_metric_t *m = &s_audio_metrics[i];
+        esp_err_t r = metrics_register_callback(&m->desc, m->type, m->read, m->ctx);
+        if (r != ESP_OK) ret = r;
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "部分音频指标注册失败: %s", esp_err_to_name(ret));
+    }
+}
 
 static void audio_manager_handle_internal_event(const audio_mgr_internal_msg_t *msg)
 {
@@ -242,6 +456,7 @@ static void audio_manager_task(void *arg)
             audio_manager_handle_internal_event(&msg);
         }
         audio_manager_tick();
+        audio_manager_report_stats();
     }
 }
 
@@ -262,6 +477,13 @@ esp_err_t audio_manager_init(const audio_mgr_config_t *config)
     s_ctx.volume = AUDIO_MANAGER_DEFAULT_VOLUME;
     s_ctx.state = AUDIO_MGR_STATE_DISABLED;
 
+    // 调度配置需在创建任何任务前生效
+    ret = audio_sched_set_config(&s_ctx.config.sched_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "调度配置无效");
+        return ret;
+    }
+
     audio_bsp_hw_config_t bsp_cfg = {
         .mic = s_ctx.config.hw_config.mic,
         .speaker = s_ctx.config.hw_config.speaker,
@@ -282,6 +504,14 @@ esp_err_t audio_manager_init(const audio_mgr_config_t *config)
         .reference_callback = NULL,
         .reference_ctx = NULL,
         .volume_ptr = &s_ctx.volume,
+        .sample_rate = (uint32_t)s_ctx.config.hw_config.speaker.sample_rate,
+        .write_timeout_ms = s_ctx.config.playback_config.write_timeout_ms,
+        .low_latency = s_ctx.config.playback_config.low_latency,
+        .jitter_buffer_ms = s_ctx.config.playback_config.jitter_buffer_ms,
+        .conceal_max_ms = s_ctx.config.playback_config.conceal_max_ms,
+        .underrun_policy = s_ctx.config.playback_config.underrun_policy,
+        .source_sample_rate = s_ctx.config.resample_config.playback_source_rate,
+        .resample_quality = s_ctx.config.resample_config.quality,
     };
 
     s_ctx.playback_ctrl = playback_controller_create(&playback_cfg);
@@ -292,6 +522,38 @@ esp_err_t audio_manager_init(const audio_mgr_config_t *config)
     }
 
     s_ctx.reference_rb = playback_controller_get_reference_buffer(s_ctx.playback_ctrl);
+    s_ctx.playback_rb = playback_controller_get_playback_buffer(s_ctx.playback_ctrl);
+    s_ctx.stats_report_tick = xTaskGetTickCount();
+    s_ctx.sched_report_tick = s_ctx.stats_report_tick;
+
+    uint32_t mic_rate = (uint32_t)s_ctx.config.hw_config.mic.sample_rate;
+    uint32_t record_rate = s_ctx.config.resample_config.record_output_rate;
+    if (record_rate && record_rate != mic_rate) {
+        resampler_config_t rs_cfg = {
+            .in_rate = mic_rate,
+            .out_rate = record_rate,
+            .quality = s_ctx.config.resample_config.quality,
+            .format = RESAMPLER_FORMAT_S16,
+        };
+        s_ctx.record_resampler = resampler_create(&rs_cfg);
+        if (s_ctx.record_resampler) {
+            s_ctx.record_resample_buf_samples = resampler_get_max_output(s_ctx.record_resampler,
+                                                                         AUDIO_MANAGER_RESAMPLE_CHUNK_SAMPLES);
+            s_ctx.record_resample_buf = (int16_t *)malloc(s_ctx.record_resample_buf_samples * sizeof(int16_t));
+        }
+        if (!s_ctx.record_resampler || !s_ctx.record_resample_buf) {
+            ESP_LOGE(TAG, "录音重采样器创建失败");
+            ret = ESP_ERR_NO_MEM;
+            goto fail;
+        }
+    }
+
+    ret = audio_manager_create_capture_graph();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "采集处理图创建失败");
+        goto fail;
+    }
+    audio_manager_register_metrics();
 
     s_ctx.event_queue = xQueueCreate(AUDIO_MANAGER_EVENT_QUEUE_LENGTH, sizeof(audio_mgr_internal_msg_t));
     if (!s_ctx.event_queue) {
@@ -300,8 +562,9 @@ esp_err_t audio_manager_init(const audio_mgr_config_t *config)
         goto fail;
     }
 
-    if (xTaskCreatePinnedToCore(audio_manager_task, "audio_mgr", AUDIO_MANAGER_TASK_STACK_SIZE,
-                                NULL, AUDIO_MANAGER_TASK_PRIORITY, &s_ctx.manager_task, 0) != pdPASS) {
+    const audio_sched_stage_config_t *mgr_sched = audio_sched_get_stage(AUDIO_SCHED_STAGE_MANAGER);
+    if (xTaskCreatePinnedToCore(audio_manager_task, "audio_mgr", mgr_sched->stack_size,
+                                NULL, mgr_sched->priority, &s_ctx.manager_task, mgr_sched->core) != pdPASS) {
         ESP_LOGE(TAG, "状态机任务创建失败");
         ret = ESP_ERR_NO_MEM;
         goto fail;
@@ -327,7 +590,7 @@ esp_err_t audio_manager_init(const audio_mgr_config_t *config)
         .record_callback = afe_record_handler,
         .record_ctx = NULL,
         .running_ptr = &s_ctx.running,
-        .recording_ptr = &s_ctx.recording,
+        .recording_ptr = NULL,  // 每帧都送入采集处理图，录音过滤在终端节点完成
     };
 
     s_ctx.afe_wrapper = afe_wrapper_create(&afe_cfg);
@@ -389,6 +652,7 @@ void audio_manager_deinit(void)
         afe_wrapper_destroy(s_ctx.afe_wrapper);
         s_ctx.afe_wrapper = NULL;
     }
+    audio_graph_destroy(s_ctx.capture_graph);
     if (s_ctx.playback_ctrl) {
         playback_controller_destroy(s_ctx.playback_ctrl);
         s_ctx.playback_ctrl = NULL;
@@ -397,6 +661,8 @@ void audio_manager_deinit(void)
         audio_bsp_destroy(s_ctx.bsp);
         s_ctx.bsp = NULL;
     }
+    resampler_destroy(s_ctx.record_resampler);
+    free(s_ctx.record_resample_buf);
     memset(&s_ctx, 0, sizeof(s_ctx));
     ESP_LOGI(TAG, "音频管理器已销毁");
 }
@@ -404,6 +670,11 @@ void audio_manager_deinit(void)
 esp_err_t audio_manager_start(void)
 {
     if (!s_ctx.initialized) return ESP_ERR_INVALID_STATE;
+    esp_err_t ret = audio_graph_start(s_ctx.capture_graph);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "采集处理图启动失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
     audio_mgr_internal_msg_t msg = { .type = AUDIO_INT_EVT_START_LISTEN };
     audio_manager_post_event(&msg);
     return ESP_OK;
@@ -449,12 +720,37 @@ esp_err_t audio_manager_play_audio(const int16_t *pcm_data, size_t sample_count)
     return playback_controller_write(s_ctx.playback_ctrl, pcm_data, sample_count);
 }
 
+esp_err_t audio_manager_play_audio_timeout(const int16_t *pcm_data, size_t sample_count,
+                                           uint32_t timeout_ms, size_t *out_written)
+{
+    if (!s_ctx.initialized || !pcm_data || sample_count == 0) return ESP_ERR_INVALID_ARG;
+    return playback_controller_write_timeout(s_ctx.playback_ctrl, pcm_data, sample_count,
+                                             timeout_ms, out_written);
+}
+
+audio_graph_handle_t audio_manager_get_capture_graph(void)
+{
+    return s_ctx.capture_graph;
+}
+
+esp_err_t audio_manager_set_playback_source_rate(uint32_t sample_rate)
+{
+    if (!s_ctx.initialized) return ESP_ERR_INVALID_STATE;
+    return playback_controller_set_source_rate(s_ctx.playback_ctrl, sample_rate);
+}
+
 size_t audio_manager_get_playback_free_space(void)
 {
     if (!s_ctx.initialized || !s_ctx.playback_ctrl) return 0;
     return playback_controller_get_free_space(s_ctx.playback_ctrl);
 }
 
+esp_err_t audio_manager_wait_playback_space(size_t min_samples, uint32_t timeout_ms)
+{
+    if (!s_ctx.initialized) return ESP_ERR_INVALID_STATE;
+    return playback_controller_wait_free_space(s_ctx.playback_ctrl, min_samples, timeout_ms);
+}
+
 esp_err_t audio_manager_start_playback(void)
 {
     if (!s_ctx.initialized) return ESP_ERR_INVALID_STATE;
@@ -496,6 +792,16 @@ bool audio_manager_is_recording(void) { return s_ctx.recording; }
 bool audio_manager_is_playing(void) { return playback_controller_is_running(s_ctx.playback_ctrl); }
 audio_mgr_state_t audio_manager_get_state(void) { return s_ctx.state; }
 
+esp_err_t audio_manager_get_buffer_stats(audio_mgr_buffer_stats_t *out_stats)
+{
+    if (!out_stats) return ESP_ERR_INVALID_ARG;
+    if (!s_ctx.playback_ctrl) return ESP_ERR_INVALID_STATE;
+    memset(out_stats, 0, sizeof(*out_stats));
+    ring_buffer_get_stats(s_ctx.playback_rb, &out_stats->playback);
+    ring_buffer_get_stats(s_ctx.reference_rb, &out_stats->reference);
+    return ESP_OK;
+}
+
 void audio_manager_set_record_callback(audio_record_callback_t callback, void *user_ctx)
 {
     s_ctx.record_callback = callback;
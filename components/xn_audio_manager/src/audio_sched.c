@@ -0,0 +1,327 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-09
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-09
+ * @FilePath: \xn_voice_wake_up\components\xn_audio_manager\src\audio_sched.c
+ * @Description: 音频调度配置实现
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#include "audio_sched.h"
+#include "metrics_registry.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+
+static const char *TAG = "AUDIO_SCHED";
+
+/** 上一次负载采样时的任务运行计数 */
+typedef struct {
+    TaskHandle_t handle;
+    uint32_t run_time;
+} audio_sched_task_sample_t;
+
+/**
+ * @brief 调度模块上下文
+ *
+ * 配置在任务创建前写入、运行期只读；阶段统计由各自任务上报，
+ * 负载采样只在状态机任务中调用，不需要额外加锁。
+ */
+typedef struct {
+    audio_sched_config_t config;                                    ///< 当前调度配置
+    audio_sched_stage_stats_t stats[AUDIO_SCHED_STAGE_MAX];         ///< 阶段运行时统计
+    portMUX_TYPE stats_lock;                                        ///< 统计自旋锁
+    audio_sched_task_sample_t prev[AUDIO_SCHED_MAX_LOAD_TASKS];     ///< 上次采样的任务计数
+    size_t prev_count;                                              ///< 上次采样的任务数
+    uint32_t prev_total;                                            ///< 上次采样的总运行时间
+} audio_sched_ctx_t;
+
+static audio_sched_ctx_t s_sched = {
+    .config = AUDIO_SCHED_DEFAULT_CONFIG(),
+    .stats_lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static const char *const s_stage_names[AUDIO_SCHED_STAGE_MAX] = {
+    [AUDIO_SCHED_STAGE_AFE_FEED] = "afe_feed",
+    [AUDIO_SCHED_STAGE_AFE_FETCH] = "afe_fetch",
+    [AUDIO_SCHED_STAGE_MANAGER] = "audio_mgr",
+    [AUDIO_SCHED_STAGE_PLAYBACK] = "playback",
+    [AUDIO_SCHED_STAGE_KWS] = "kws",
+    [AUDIO_SCHED_STAGE_NET_SEND] = "net_send",
+};
+
+/* 阶段耗时直方图桶上界（微秒），覆盖到单片时长的数倍 */
+static const int32_t s_stage_hist_bounds_us[] = {500, 1000, 2000, 5000, 10000, 20000, 32000, 50000, 100000};
+
+#define AUDIO_SCHED_STAGE_METRIC(label)                                                         \
+    {"xn_audio_stage_duration_us", "stage=\"" label "\"", "Audio stage processing time per run"}
+#define AUDIO_SCHED_MISS_METRIC(label)                                                          \
+    {"xn_audio_stage_deadline_misses_total", "stage=\"" label "\"", "Audio stage runs over deadline"}
+
+static const metrics_desc_t s_stage_hist_desc[AUDIO_SCHED_STAGE_MAX] = {
+    [AUDIO_SCHED_STAGE_AFE_FEED] = AUDIO_SCHED_STAGE_METRIC("afe_feed"),
+    [AUDIO_SCHED_STAGE_AFE_FETCH] = AUDIO_SCHED_STAGE_METRIC("afe_fetch"),
+    [AUDIO_SCHED_STAGE_MANAGER] = AUDIO_SCHED_STAGE_METRIC("audio_mgr"),
+    [AUDIO_SCHED_STAGE_PLAYBACK] = AUDIO_SCHED_STAGE_METRIC("playback"),
+    [AUDIO_SCHED_STAGE_KWS] = AUDIO_SCHED_STAGE_METRIC("kws"),
+    [AUDIO_SCHED_STAGE_NET_SEND] = AUDIO_SCHED_STAGE_METRIC("net_send"),
+};
+
+static const metrics_desc_t s_stage_miss_desc[AUDIO_SCHED_STAGE_MAX] = {
+    [AUDIO_SCHED_STAGE_AFE_FEED] = AUDIO_SCHED_MISS_METRIC("afe_feed"),
+    [AUDIO_SCHED_STAGE_AFE_FETCH] = AUDIO_SCHED_MISS_METRIC("afe_fetch"),
+    [AUDIO_SCHED_STAGE_MANAGER] = AUDIO_SCHED_MISS_METRIC("audio_mgr"),
+    [AUDIO_SCHED_STAGE_PLAYBACK] = AUDIO_SCHED_MISS_METRIC("playback"),
+    [AUDIO_SCHED_STAGE_KWS] = AUDIO_SCHED_MISS_METRIC("kws"),
+    [AUDIO_SCHED_STAGE_NET_SEND] = AUDIO_SCHED_MISS_METRIC("net_send"),
+};
+
+/** 阶段耗时直方图句柄（未注册时为 NULL，观测为空操作） */
+static metrics_handle_t s_stage_hist[AUDIO_SCHED_STAGE_MAX];
+
+/**
+ * @brief 应用调度配置
+ *
+ * 只影响之后创建的任务，已在运行的任务不会迁移。流水线模式下
+ * KWS 必须与 AFE 取数任务位于不同核心，否则两者只能串行执行。
+ *
+ * @param config 调度配置，NULL 恢复默认
+ * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 核心或优先级无效
+ */
+esp_err_t audio_sched_set_config(const audio_sched_config_t *config)
+{
+    audio_sched_config_t cfg = config ? *config : AUDIO_SCHED_DEFAULT_CONFIG();
+
+    for (int i = 0; i < AUDIO_SCHED_STAGE_MAX; i++) {
+        const audio_sched_stage_config_t *stage = &cfg.stages[i];
+        bool graph_stage = (i == AUDIO_SCHED_STAGE_KWS || i == AUDIO_SCHED_STAGE_NET_SEND);
+        bool core_ok = (stage->core == 0 || stage->core == 1 ||
+                        (graph_stage && stage->core == AUDIO_GRAPH_CORE_INLINE));
+        if (!core_ok || stage->priority >= configMAX_PRIORITIES || stage->stack_size == 0) {
+            ESP_LOGE(TAG, "阶段 %s 调度参数无效", s_stage_names[i]);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    if (cfg.kws_pipelined &&
+        cfg.stages[AUDIO_SCHED_STAGE_KWS].core == cfg.stages[AUDIO_SCHED_STAGE_AFE_FETCH].core) {
+        ESP_LOGW(TAG, "KWS 与 AFE 取数位于同一核心，流水线模式无法并行");
+    }
+
+    s_sched.config = cfg;
+    memset(s_sched.stats, 0, sizeof(s_sched.stats));
+    return ESP_OK;
+}
+
+const audio_sched_stage_config_t *audio_sched_get_stage(audio_sched_stage_t stage)
+{
+    if (stage >= AUDIO_SCHED_STAGE_MAX) {
+        stage = AUDIO_SCHED_STAGE_MANAGER;
+    }
+    return &s_sched.config.stages[stage];
+}
+
+bool audio_sched_kws_pipelined(void)
+{
+    return s_sched.config.kws_pipelined;
+}
+
+/**
+ * @brief 按阶段参数填充处理图节点
+ *
+ * 流水线模式下 KWS 节点队列深度为 1：取数任务交出第 N 片后立即去取
+ * 第 N+1 片，推理在另一个核心上进行；若推理超过一片时长，新片会被
+ * 丢弃并计入节点 dropped_frames，而不是让延迟无限累积。
+ *
+ * @param stage 阶段
+ * @param node_cfg 待填充的节点配置
+ */
+void audio_sched_apply_to_node(audio_sched_stage_t stage, audio_graph_node_config_t *node_cfg)
+{
+    if (!node_cfg || stage >= AUDIO_SCHED_STAGE_MAX) return;
+
+    const audio_sched_stage_config_t *sc = &s_sched.config.stages[stage];
+    node_cfg->core = sc->core;
+    node_cfg->priority = sc->priority;
+    node_cfg->stack_size = sc->stack_size;
+
+    if (stage == AUDIO_SCHED_STAGE_KWS) {
+        if (s_sched.config.kws_pipelined) {
+            node_cfg->queue_depth = 1;
+        } else {
+            node_cfg->core = AUDIO_GRAPH_CORE_INLINE;
+        }
+    }
+}
+
+/**
+ * @brief 上报一次阶段处理耗时
+ *
+ * @param stage 阶段
+ * @param elapsed_us 耗时（微秒）
+ */
+void audio_sched_report_runtime(audio_sched_stage_t stage, uint32_t elapsed_us)
+{
+    if (stage >= AUDIO_SCHED_STAGE_MAX) return;
+
+    uint32_t deadline = s_sched.config.stages[stage].deadline_us;
+    audio_sched_stage_stats_t *st = &s_sched.stats[stage];
+
+    portENTER_CRITICAL(&s_sched.stats_lock);
+    st->runs++;
+    st->last_us = elapsed_us;
+    if (elapsed_us > st->max_us) {
+        st->max_us = elapsed_us;
+    }
+    if (deadline > 0 && elapsed_us > deadline) {
+        st->deadline_misses++;
+    }
+    portEXIT_CRITICAL(&s_sched.stats_lock);
+
+    metrics_histogram_observe(s_stage_hist[stage], (int32_t)elapsed_us);
+}
+
+esp_err_t audio_sched_get_stage_stats(audio_sched_stage_t stage, audio_sched_stage_stats_t *out_stats)
+{
+    if (stage >= AUDIO_SCHED_STAGE_MAX || !out_stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&s_sched.stats_lock);
+    *out_stats = s_sched.stats[stage];
+    portEXIT_CRITICAL(&s_sched.stats_lock);
+    return ESP_OK;
+}
+
+static int64_t audio_sched_read_deadline_misses(void *ctx)
+{
+    return s_sched.stats[(intptr_t)ctx].deadline_misses;
+}
+
+/**
+ * @brief 注册阶段耗时直方图与截止时间超时计数
+ *
+ * 直方图观测在 audio_sched_report_runtime() 中完成，只是几次原子加；
+ * 超时次数复用已有统计，采集时读取。
+ *
+ * @return ESP_OK 成功，ESP_ERR_NO_MEM 指标槽位不足
+ */
+esp_err_t audio_sched_register_metrics(void)
+{
+    esp_err_t ret = ESP_OK;
+    for (int i = 0; i < AUDIO_SCHED_STAGE_MAX; i++) {
+        esp_err_t r = metrics_register_histogram(&s_stage_hist_desc[i], s_stage_hist_bounds_us,
+                                                 sizeof(s_stage_hist_bounds_us) / sizeof(s_stage_hist_bounds_us[0]),
+                                                 &s_stage_hist[i]);
+        if (r == ESP_OK) {
+            r = metrics_register_callback(&s_stage_miss_desc[i], METRICS_TYPE_COUNTER,
+                                          audio_sched_read_deadline_misses, (void *)(intptr_t)i);
+        }
+        if (r != ESP_OK) {
+            ret = r;
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief 采样各任务 CPU 负载
+ *
+ * 基于 FreeRTOS 运行时统计，计算两次调用之间每个任务占用单核时间的千分比。
+ * 首次调用（或任务新建）时以创建以来的累计值计算。
+ *
+ * @param out 输出数组
+ * @param max 数组容量
+ * @param out_count 实际输出数量
+ * @return
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 参数无效
+ *   - ESP_ERR_NOT_SUPPORTED: 未开启运行时统计
+ *
+ * @note 非可重入，只应在单个任务中周期调用
+ */
+esp_err_t audio_sched_sample_load(audio_sched_task_load_t *out, size_t max, size_t *out_count)
+{
+    if (!out || !out_count || max == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_count = 0;
+
+#if (configUSE_TRACE_FACILITY == 1) && (configGENERATE_RUN_TIME_STATS == 1)
+    static TaskStatus_t status[AUDIO_SCHED_MAX_LOAD_TASKS];
+    uint32_t total = 0;
+    UBaseType_t n = uxTaskGetSystemState(status, AUDIO_SCHED_MAX_LOAD_TASKS, &total);
+    if (n == 0) {
+        ESP_LOGW(TAG, "任务数超过 %d，无法采样负载", AUDIO_SCHED_MAX_LOAD_TASKS);
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t total_delta = total - s_sched.prev_total;
+    if (total_delta == 0) total_delta = 1;
+
+    size_t count = 0;
+    for (UBaseType_t i = 0; i < n && count < max; i++) {
+        uint32_t prev = 0;
+        for (size_t j = 0; j < s_sched.prev_count; j++) {
+            if (s_sched.prev[j].handle == status[i].xHandle) {
+                prev = s_sched.prev[j].run_time;
+                break;
+            }
+        }
+        uint64_t permille = (uint64_t)(status[i].ulRunTimeCounter - prev) * 1000u / total_delta;
+
+        out[count].name = status[i].pcTaskName;
+        out[count].priority = (uint8_t)status[i].uxCurrentPriority;
+        out[count].load_permille = (uint16_t)(permille > 1000 ? 1000 : permille);
+#if configTASKLIST_INCLUDE_COREID
+        out[count].core = (status[i].xCoreID == tskNO_AFFINITY) ? -1 : (int)status[i].xCoreID;
+#else
+        out[count].core = -1;
+#endif
+        count++;
+    }
+
+    for (UBaseType_t i = 0; i < n; i++) {
+        s_sched.prev[i].handle = status[i].xHandle;
+        s_sched.prev[i].run_time = status[i].ulRunTimeCounter;
+    }
+    s_sched.prev_count = n;
+    s_sched.prev_total = total;
+    *out_count = count;
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/**
+ * @brief 打印 CPU 负载和截止时间统计
+ *
+ * 负载按核心分组打印，截止时间只打印有上报的阶段。
+ */
+void audio_sched_log_report(void)
+{
+    static audio_sched_task_load_t loads[AUDIO_SCHED_MAX_LOAD_TASKS];
+    size_t count = 0;
+    esp_err_t ret = audio_sched_sample_load(loads, AUDIO_SCHED_MAX_LOAD_TASKS, &count);
+    if (ret == ESP_OK) {
+        for (size_t i = 0; i < count; i++) {
+            if (loads[i].load_permille == 0) continue;
+            ESP_LOGI(TAG, "core %2d | %-16s | prio %2u | %3u.%u%%",
+                     loads[i].core, loads[i].name, loads[i].priority,
+                     loads[i].load_permille / 10, loads[i].load_permille % 10);
+        }
+    } else if (ret == ESP_ERR_NOT_SUPPORTED) {
+        ESP_LOGD(TAG, "未开启 FreeRTOS 运行时统计，跳过 CPU 负载报告");
+    }
+
+    for (int i = 0; i < AUDIO_SCHED_STAGE_MAX; i++) {
+        audio_sched_stage_stats_t st;
+        audio_sched_get_stage_stats((audio_sched_stage_t)i, &st);
+        if (st.runs == 0) continue;
+        ESP_LOGI(TAG, "%-10s | 次数 %u | 最大 %u us | 超时 %u (截止 %u us)",
+                 s_stage_names[i], (unsigned)st.runs, (unsigned)st.max_us,
+                 (unsigned)st.deadline_misses, (unsigned)s_sched.config.stages[i].deadline_us);
+    }
+}
@@ -9,14 +9,22 @@
  * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved. 
  */
 #include "playback_controller.h"
+#include "audio_sched.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include <stdlib.h>
 #include <string.h>
 
 static const char *TAG = "PLAYBACK_CTRL";
 
+#define PLAYBACK_DEFAULT_SAMPLE_RATE     16000  ///< 未配置采样率时的默认值
+#define PLAYBACK_DEFAULT_JITTER_MS       60     ///< 低延迟模式默认预缓冲时长
+#define PLAYBACK_LL_PERIODS_PER_JITTER   3      ///< 低延迟模式：jitter buffer 划分为几个输出周期
+#define PLAYBACK_TASK_JOIN_TIMEOUT_MS    1000   ///< 停止时等待播放任务退出的超时
+#define PLAYBACK_RESAMPLE_CHUNK_SAMPLES  256    ///< 重采样时每次处理的输入采样点数
+
 /**
  * @brief 播放控制器上下文结构体
  * 
@@ -32,8 +40,104 @@ typedef struct playback_controller_s {
     playback_reference_callback_t reference_callback; ///< 回采回调函数，用于将音频数据传递给AFE
     void *reference_ctx;                            ///< 回采回调上下文，传递给回调函数的用户数据
     uint8_t *volume_ptr;                            ///< 音量指针，指向音量值（0-100）
+    SemaphoreHandle_t task_exit_sem;                ///< 播放任务退出信号，用于 stop 时确定性等待
+    uint32_t write_timeout_ms;                      ///< 默认写入超时（毫秒）
+    bool low_latency;                               ///< 低延迟流式模式
+    size_t period_samples;                          ///< 低延迟模式：每次输出的采样点数
+    uint32_t period_ms;                             ///< 低延迟模式：输出周期（毫秒）
+    size_t prebuffer_samples;                       ///< 低延迟模式：预缓冲采样点数（jitter buffer）
+    uint32_t conceal_max_periods;                   ///< 低延迟模式：欠载后最多补偿的周期数
+    playback_underrun_policy_t underrun_policy;     ///< 低延迟模式：欠载补偿策略
+    int16_t last_sample;                            ///< 最后输出的样本，用于淡出补偿
+    uint32_t sample_rate;                           ///< 播放采样率
+    resampler_quality_t resample_quality;           ///< 重采样质量
+    resampler_handle_t resampler;                   ///< 写入端重采样器（源采样率 != 播放采样率时有效）
+    int16_t *resample_buf;                          ///< 重采样输出缓冲区
+    size_t resample_buf_samples;                    ///< 重采样输出缓冲区容量
 } playback_controller_t;
 
+/**
+ * @brief 输出一帧：先回采给 AFE，再写入扬声器
+ */
+static void playback_output(playback_controller_t *ctrl, const int16_t *frame, size_t samples)
+{
+    // 先回采给 AFE（通过回调或写入缓冲区）
+    // 回采的目的是让AFE能够处理播放的音频，用于回声消除等功能
+    if (ctrl->reference_callback) {
+        ctrl->reference_callback(frame, samples, ctrl->reference_ctx);
+    } else {
+        ring_buffer_write(ctrl->reference_rb, frame, samples);
+    }
+
+    // 获取音量值，如果未设置音量指针则使用默认值80
+    uint8_t volume = ctrl->volume_ptr ? *ctrl->volume_ptr : 80;
+    audio_bsp_write_speaker(ctrl->bsp_handle, frame, samples, volume);
+    ctrl->last_sample = frame[samples - 1];
+}
+
+/**
+ * @brief 欠载补偿：用补偿数据填充 frame[from, to)
+ */
+static void playback_conceal(playback_controller_t *ctrl, int16_t *frame, size_t from, size_t to)
+{
+    if (from >= to) return;
+
+    if (ctrl->underrun_policy == PLAYBACK_UNDERRUN_FADE_OUT) {
+        // 从最后一个有效样本线性衰减到 0，消除断流处的阶跃爆音
+        int32_t start = (from > 0) ? frame[from - 1] : ctrl->last_sample;
+        size_t len = to - from;
+        for (size_t i = 0; i < len; i++) {
+            frame[from + i] = (int16_t)(start * (int32_t)(len - 1 - i) / (int32_t)len);
+        }
+    } else {
+        memset(&frame[from], 0, (to - from) * sizeof(int16_t));
+    }
+}
+
+/**
+ * @brief 低延迟模式的一次调度
+ * 
+ * 状态说明：
+ * - 未就绪（primed=false）：等待缓冲达到 jitter 水位；等待一个周期仍不足时，
+ *   有残余数据则直接输出（流尾），无数据则在限额内输出补偿帧，之后静默空闲
+ * - 就绪（primed=true）：每周期取固定 period_samples 输出；不足即欠载，
+ *   用补偿策略补齐并回到未就绪状态重新积累 jitter buffer
+ */
+static void playback_step_low_latency(playback_controller_t *ctrl, int16_t *frame,
+                                      bool *primed, uint32_t *conceal_left)
+{
+    const size_t period = ctrl->period_samples;
+
+    if (!*primed) {
+        if (ring_buffer_wait_available(ctrl->playback_rb, ctrl->prebuffer_samples, ctrl->period_ms)) {
+            *primed = true;
+            *conceal_left = ctrl->conceal_max_periods;
+            return;
+        }
+
+        // 一个周期内未积累到水位：先播残余数据，再按限额补偿，最后空闲
+        size_t got = ring_buffer_read(ctrl->playback_rb, frame, period, 0);
+        if (got > 0) {
+            playback_conceal(ctrl, frame, got, period);
+            playback_output(ctrl, frame, period);
+        } else if (*conceal_left > 0) {
+            (*conceal_left)--;
+            playback_conceal(ctrl, frame, 0, period);
+            playback_output(ctrl, frame, period);
+        }
+        return;
+    }
+
+    size_t got = ring_buffer_read(ctrl->playback_rb, frame, period, 0);
+    if (got < period) {
+        // 欠载：补齐本周期并重新积累 jitter buffer
+        playback_conceal(ctrl, frame, got, period);
+        *primed = false;
+    }
+    playback_output(ctrl, frame, period);
+}
+
+
 /**
  * @brief 播放任务函数
  * 
@@ -49,39 +153,35 @@ static void playback_task(void *arg)
     int16_t *frame = (int16_t *)malloc(ctrl->frame_samples * sizeof(int16_t));
     if (!frame) {
         ESP_LOGE(TAG, "播放任务内存分配失败");
+        ctrl->running = false;
+        xSemaphoreGive(ctrl->task_exit_sem);
         vTaskDelete(NULL);
         return;
     }
 
-    ESP_LOGI(TAG, "播放任务启动");
+    ESP_LOGI(TAG, "播放任务启动%s", ctrl->low_latency ? "（低延迟模式）" : "");
+
+    bool primed = false;
+    uint32_t conceal_left = 0;
 
     // 主循环：持续从播放缓冲区读取数据并播放
     while (ctrl->running) {
+        if (ctrl->low_latency) {
+            playback_step_low_latency(ctrl, frame, &primed, &conceal_left);
+            continue;
+        }
+
         // 从播放缓冲区读取一帧音频数据，超时时间200ms
         size_t got = ring_buffer_read(ctrl->playback_rb, frame, ctrl->frame_samples, 200);
-
         if (got > 0) {
-            // 先回采给 AFE（通过回调或写入缓冲区）
-            // 回采的目的是让AFE能够处理播放的音频，用于回声消除等功能
-            if (ctrl->reference_callback) {
-                // 如果设置了回调函数，直接调用回调函数传递音频数据
-                ctrl->reference_callback(frame, got, ctrl->reference_ctx);
-            } else {
-                // 否则将音频数据写入回采缓冲区，供AFE读取
-                ring_buffer_write(ctrl->reference_rb, frame, got);
-            }
-
-            // 再播放音频数据到扬声器
-            // 获取音量值，如果未设置音量指针则使用默认值80
-            uint8_t volume = ctrl->volume_ptr ? *ctrl->volume_ptr : 80;
-            // 通过 BSP 将音频数据写入扬声器
-            audio_bsp_write_speaker(ctrl->bsp_handle, frame, got, volume);
+            playback_output(ctrl, frame, got);
         }
     }
 
-    // 清理资源
+    // 清理资源，并通知 stop 任务已退出
     free(frame);
     ESP_LOGI(TAG, "播放任务结束");
+    xSemaphoreGive(ctrl->task_exit_sem);
     vTaskDelete(NULL);
 }
 
@@ -114,11 +214,35 @@ playback_controller_handle_t playback_controller_create(const playback_controlle
     ctrl->reference_callback = config->reference_callback;
     ctrl->reference_ctx = config->reference_ctx;
     ctrl->volume_ptr = config->volume_ptr;
+    ctrl->write_timeout_ms = config->write_timeout_ms;
+    ctrl->low_latency = config->low_latency;
+    ctrl->underrun_policy = config->underrun_policy;
+
+    // 低延迟模式参数：jitter buffer 划分为若干输出周期，周期不超过帧缓冲大小
+    uint32_t sample_rate = config->sample_rate ? config->sample_rate : PLAYBACK_DEFAULT_SAMPLE_RATE;
+    ctrl->sample_rate = sample_rate;
+    ctrl->resample_quality = config->resample_quality;
+    uint32_t jitter_ms = config->jitter_buffer_ms ? config->jitter_buffer_ms : PLAYBACK_DEFAULT_JITTER_MS;
+    ctrl->prebuffer_samples = (size_t)sample_rate * jitter_ms / 1000;
+    ctrl->period_samples = ctrl->prebuffer_samples / PLAYBACK_LL_PERIODS_PER_JITTER;
+    if (ctrl->period_samples == 0) ctrl->period_samples = 1;
+    if (ctrl->period_samples > ctrl->frame_samples) ctrl->period_samples = ctrl->frame_samples;
+    ctrl->period_ms = (uint32_t)(ctrl->period_samples * 1000 / sample_rate);
+    if (ctrl->period_ms == 0) ctrl->period_ms = 1;
+    ctrl->conceal_max_periods = config->conceal_max_ms / ctrl->period_ms;
+
+    ctrl->task_exit_sem = xSemaphoreCreateBinary();
+    if (!ctrl->task_exit_sem) {
+        ESP_LOGE(TAG, "任务退出信号量创建失败");
+        free(ctrl);
+        return NULL;
+    }
 
     // 创建播放缓冲区（阻塞模式）
     ctrl->playback_rb = ring_buffer_create(config->playback_buffer_samples, true);
     if (!ctrl->playback_rb) {
         ESP_LOGE(TAG, "播放缓冲区创建失败");
+        vSemaphoreDelete(ctrl->task_exit_sem);
         free(ctrl);
         return NULL;
     }
@@ -128,10 +252,25 @@ playback_controller_handle_t playback_controller_create(const playback_controlle
     if (!ctrl->reference_rb) {
         ESP_LOGE(TAG, "回采缓冲区创建失败");
         ring_buffer_destroy(ctrl->playback_rb);
+        vSemaphoreDelete(ctrl->task_exit_sem);
         free(ctrl);
         return NULL;
     }
 
+    if (playback_controller_set_source_rate(ctrl, config->source_sample_rate) != ESP_OK) {
+        ESP_LOGE(TAG, "重采样器创建失败");
+        ring_buffer_destroy(ctrl->reference_rb);
+        ring_buffer_destroy(ctrl->playback_rb);
+        vSemaphoreDelete(ctrl->task_exit_sem);
+        free(ctrl);
+        return NULL;
+    }
+
+    if (ctrl->low_latency) {
+        ESP_LOGI(TAG, "✅ 播放控制器创建成功（低延迟: jitter %u ms, 周期 %u 样本）",
+                 (unsigned)jitter_ms, (unsigned)ctrl->period_samples);
+        return ctrl;
+    }
     ESP_LOGI(TAG, "✅ 播放控制器创建成功");
     return ctrl;
 }
@@ -147,8 +286,12 @@ void playback_controller_destroy(playback_controller_handle_t controller)
 {
     if (!controller) return;
 
-    // 先停止播放任务
-    playback_controller_stop(controller);
+    // 先停止播放任务；超时说明任务仍在访问缓冲区，必须等它真正退出后才能释放资源
+    if (playback_controller_stop(controller) == ESP_ERR_TIMEOUT) {
+        ESP_LOGW(TAG, "等待播放任务退出后再销毁");
+        xSemaphoreTake(controller->task_exit_sem, portMAX_DELAY);
+        controller->playback_task = NULL;
+    }
 
     // 销毁播放缓冲区
     if (controller->playback_rb) {
@@ -160,6 +303,13 @@ void playback_controller_destroy(playback_controller_handle_t controller)
         ring_buffer_destroy(controller->reference_rb);
     }
 
+    if (controller->task_exit_sem) {
+        vSemaphoreDelete(controller->task_exit_sem);
+    }
+
+    resampler_destroy(controller->resampler);
+    free(controller->resample_buf);
+
     // 释放控制器内存
     free(controller);
     ESP_LOGI(TAG, "播放控制器已销毁");
@@ -187,10 +337,18 @@ esp_err_t playback_controller_start(playback_controller_handle_t controller)
     ESP_LOGI(TAG, "▶️ 启动播放器");
     controller->running = true;
 
-    // 创建播放任务，固定到 Core 1
-    // 任务优先级7，栈大小5KB
-    xTaskCreatePinnedToCore(playback_task, "playback", 5 * 1024, controller, 
-                            7, &controller->playback_task, 1);
+    // 清除上一次遗留的退出信号
+    xSemaphoreTake(controller->task_exit_sem, 0);
+
+    // 创建播放任务，核心 / 优先级 / 栈大小取自集中调度配置
+    const audio_sched_stage_config_t *sched = audio_sched_get_stage(AUDIO_SCHED_STAGE_PLAYBACK);
+    if (xTaskCreatePinnedToCore(playback_task, "playback", sched->stack_size, controller,
+                                sched->priority, &controller->playback_task, sched->core) != pdPASS) {
+        ESP_LOGE(TAG, "播放任务创建失败");
+        controller->running = false;
+        controller->playback_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
 
     return ESP_OK;
 }
@@ -198,10 +356,10 @@ esp_err_t playback_controller_start(playback_controller_handle_t controller)
 /**
  * @brief 停止播放控制器
  * 
- * 停止播放任务
+ * 停止播放任务，并等待任务真正退出（任务退出前会释放 task_exit_sem）
  * 
  * @param controller 播放控制器句柄
- * @return ESP_OK 成功
+ * @return ESP_OK 成功，ESP_ERR_TIMEOUT 任务未在超时内退出
  */
 esp_err_t playback_controller_stop(playback_controller_handle_t controller)
 {
@@ -212,9 +370,13 @@ esp_err_t playback_controller_stop(playback_controller_handle_t controller)
     ESP_LOGI(TAG, "⏹️ 停止播放器");
     controller->running = false;
 
-    // 等待任务结束
+    // 等待任务结束（任务每个周期最多阻塞 200ms 检查一次 running）
     if (controller->playback_task) {
-        vTaskDelay(pdMS_TO_TICKS(300));
+        if (xSemaphoreTake(controller->task_exit_sem,
+                           pdMS_TO_TICKS(PLAYBACK_TASK_JOIN_TIMEOUT_MS)) != pdTRUE) {
+            ESP_LOGE(TAG, "播放任务退出超时");
+            return ESP_ERR_TIMEOUT;
+        }
         controller->playback_task = NULL;
     }
 
@@ -224,25 +386,150 @@ esp_err_t playback_controller_stop(playback_controller_handle_t controller)
 /**
  * @brief 写入音频数据到播放缓冲区
  * 
- * 将PCM音频数据写入播放缓冲区，供播放任务读取
+ * 将PCM音频数据写入播放缓冲区，供播放任务读取。
+ * 缓冲区满时按配置的 write_timeout_ms 阻塞等待，不覆盖未播放的数据。
  * 
  * @param controller 播放控制器句柄
  * @param pcm_data PCM音频数据指针
  * @param sample_count 采样点数
- * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
+ * @return ESP_OK 成功，ESP_ERR_TIMEOUT 超时仅部分写入，ESP_ERR_INVALID_ARG 参数无效
  */
 esp_err_t playback_controller_write(playback_controller_handle_t controller, 
                                      const int16_t *pcm_data, size_t sample_count)
 {
+    if (!controller) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return playback_controller_write_timeout(controller, pcm_data, sample_count,
+                                             controller->write_timeout_ms, NULL);
+}
+
+/**
+ * @brief 写入音频数据到播放缓冲区（指定超时）
+ * 
+ * 为生产者提供背压：空间不足时等待播放任务消费，直到全部写入或超时。
+ * 超时返回时已写入的部分保留在缓冲区中，out_written 给出实际数量，
+ * 调用者可从该位置继续写入剩余数据。
+ * 
+ * @param controller 播放控制器句柄
+ * @param pcm_data PCM音频数据指针
+ * @param sample_count 采样点数
+ * @param timeout_ms 等待空间的超时（毫秒），0 表示只写入当前可容纳的部分
+ * @param out_written 实际写入的采样点数（可选）
+ * @return ESP_OK 全部写入，ESP_ERR_TIMEOUT 部分写入，ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t playback_controller_write_timeout(playback_controller_handle_t controller,
+                                             const int16_t *pcm_data, size_t sample_count,
+                                             uint32_t timeout_ms, size_t *out_written)
+{
+    if (out_written) {
+        *out_written = 0;
+    }
     if (!controller || !pcm_data || sample_count == 0) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    // 将音频数据写入播放缓冲区
-    ring_buffer_write(controller->playback_rb, pcm_data, sample_count);
+    size_t written = 0;
+    if (!controller->resampler) {
+        written = ring_buffer_write_wait(controller->playback_rb, pcm_data, sample_count, timeout_ms);
+    } else {
+        // 分块重采样：先等到能容纳整块输出再处理，保证重采样状态与已写入数据一致
+        const TickType_t start = xTaskGetTickCount();
+        while (written < sample_count) {
+            size_t chunk = sample_count - written;
+            if (chunk > PLAYBACK_RESAMPLE_CHUNK_SAMPLES) {
+                chunk = PLAYBACK_RESAMPLE_CHUNK_SAMPLES;
+            }
+            size_t need = resampler_get_max_output(controller->resampler, chunk);
+            uint32_t elapsed_ms = (uint32_t)((xTaskGetTickCount() - start) * portTICK_PERIOD_MS);
+            uint32_t remaining_ms = (elapsed_ms < timeout_ms) ? (timeout_ms - elapsed_ms) : 0;
+            if (!ring_buffer_wait_free(controller->playback_rb, need, remaining_ms)) {
+                break;
+            }
+            size_t out = resampler_process_s16(controller->resampler, &pcm_data[written], chunk,
+                                               controller->resample_buf, controller->resample_buf_samples);
+            ring_buffer_write_wait(controller->playback_rb, controller->resample_buf, out, 0);
+            written += chunk;
+        }
+    }
+
+    if (out_written) {
+        *out_written = written;
+    }
+    return (written == sample_count) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+/**
+ * @brief 设置写入数据的采样率
+ * 
+ * 源采样率与播放采样率不同时创建重采样器，写入时自动转换到播放采样率；
+ * 相同（或为 0）时释放重采样器，直接写入。每次调用都会重置重采样历史。
+ * 
+ * @param controller 播放控制器句柄
+ * @param source_rate 写入数据的采样率，0 表示与播放采样率相同
+ * @return ESP_OK 成功，ESP_ERR_NO_MEM 重采样器创建失败
+ */
+esp_err_t playback_controller_set_source_rate(playback_controller_handle_t controller, uint32_t source_rate)
+{
+    if (!controller) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    resampler_destroy(controller->resampler);
+    free(controller->resample_buf);
+    controller->resampler = NULL;
+    controller->resample_buf = NULL;
+    controller->resample_buf_samples = 0;
+
+    if (source_rate == 0 || source_rate == controller->sample_rate) {
+        return ESP_OK;
+    }
+
+    resampler_config_t rs_cfg = {
+        .in_rate = source_rate,
+        .out_rate = controller->sample_rate,
+        .quality = controller->resample_quality,
+        .format = RESAMPLER_FORMAT_S16,
+    };
+    controller->resampler = resampler_create(&rs_cfg);
+    if (!controller->resampler) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    controller->resample_buf_samples = resampler_get_max_output(controller->resampler,
+                                                                PLAYBACK_RESAMPLE_CHUNK_SAMPLES);
+    controller->resample_buf = (int16_t *)malloc(controller->resample_buf_samples * sizeof(int16_t));
+    if (!controller->resample_buf) {
+        resampler_destroy(controller->resampler);
+        controller->resampler = NULL;
+        controller->resample_buf_samples = 0;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "播放重采样: %u -> %u Hz", (unsigned)source_rate, (unsigned)controller->sample_rate);
     return ESP_OK;
 }
 
+/**
+ * @brief 等待播放缓冲区空闲空间
+ * 
+ * 供生产者在解码下一块数据前做流控，避免解码后无处可写。
+ * 
+ * @param controller 播放控制器句柄
+ * @param min_samples 期望的最少空闲采样点数
+ * @param timeout_ms 超时时间（毫秒）
+ * @return ESP_OK 空间足够，ESP_ERR_TIMEOUT 超时，ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t playback_controller_wait_free_space(playback_controller_handle_t controller,
+                                               size_t min_samples, uint32_t timeout_ms)
+{
+    if (!controller) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ring_buffer_wait_free(controller->playback_rb, min_samples, timeout_ms)
+           ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
 /**
  * @brief 清空播放缓冲区
  * 
@@ -293,11 +580,8 @@ size_t playback_controller_get_free_space(playback_controller_handle_t controlle
         return 0;
     }
     
-    // 计算可用空间 = 总容量 - 已占用
-    size_t total_size = ring_buffer_get_size(controller->playback_rb);
-    size_t used_size = ring_buffer_available(controller->playback_rb);
-    
-    return (total_size > used_size) ? (total_size - used_size) : 0;
+    // 可用空间（不覆盖未播放数据的前提下）
+    return ring_buffer_get_free(controller->playback_rb);
 }
 
 /**
@@ -313,3 +597,15 @@ ring_buffer_handle_t playback_controller_get_reference_buffer(playback_controlle
     return controller ? controller->reference_rb : NULL;
 }
 
+/**
+ * @brief 获取播放缓冲区句柄
+ * 
+ * 返回播放缓冲区句柄，供上层查询溢出/欠载统计
+ * 
+ * @param controller 播放控制器句柄
+ * @return 播放缓冲区句柄，参数无效返回NULL
+ */
+ring_buffer_handle_t playback_controller_get_playback_buffer(playback_controller_handle_t controller)
+{
+    return controller ? controller->playback_rb : NULL;
+}
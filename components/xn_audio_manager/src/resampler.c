@@ -0,0 +1,371 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-06
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-06
+ * @FilePath: \xn_voice_wake_up\components\xn_audio_manager\src\resampler.c
+ * @Description: 采样率转换模块实现 - 多相加窗 sinc 流式重采样
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#include "resampler.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static const char *TAG = "RESAMPLER";
+
+#define RESAMPLER_COEF_SHIFT 14   ///< 定点系数 Q14，32bit 累加留出 2bit 余量
+
+/**
+ * @brief 重采样器上下文结构体
+ *
+ * 转换比 out/in 约分为 L/M：概念上先 L 倍插零再低通，最后 M 倍抽取。
+ * 多相实现只计算被保留下来的输出点，每个输出只做 taps 次乘加。
+ *
+ * 历史数据使用双份存储（hist[i] 与 hist[i + taps] 相同），
+ * 使任意时刻的滤波窗口都是一段连续内存，内层循环可直接向量化。
+ */
+typedef struct resampler_s {
+    resampler_format_t format;  ///< 样本格式
+    bool bypass;                ///< 输入输出采样率相同，直接拷贝
+    uint32_t L;                 ///< 插值因子
+    uint32_t M;                 ///< 抽取因子
+    size_t taps;                ///< 每相抽头数
+    uint32_t frac;              ///< 当前输出点相对最新输入的相位（0..L-1 有效）
+    size_t pos;                 ///< 历史窗口起始位置（最旧样本）
+    int16_t *coef_q14;          ///< 定点多相系数 [L][taps]，已按窗口顺序（旧→新）排列
+    float *coef_f32;            ///< 浮点多相系数 [L][taps]
+    int16_t *hist_s16;          ///< 定点历史数据（2 * taps）
+    float *hist_f32;            ///< 浮点历史数据（2 * taps）
+} resampler_t;
+
+static uint32_t resampler_gcd(uint32_t a, uint32_t b)
+{
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/**
+ * @brief 零阶修正贝塞尔函数（Kaiser 窗使用）
+ */
+static double resampler_bessel_i0(double x)
+{
+    double sum = 1.0, term = 1.0, half = x / 2.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (half / k) * (half / k);
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+/**
+ * @brief 设计 Kaiser 窗 sinc 原型低通，并拆分为 L 相
+ *
+ * 原型长度 N = L * taps，工作在 L * in_rate 的插值域。
+ * 每相系数单独归一化为直流增益 1，避免量化后各相增益不一致产生的调制噪声。
+ */
+static bool resampler_design(resampler_t *rs, uint32_t in_rate, uint32_t out_rate,
+                             double rolloff, double beta)
+{
+    const size_t L = rs->L, taps = rs->taps, N = L * taps;
+    const double center = (N - 1) / 2.0;
+    const double nyquist = (in_rate < out_rate ? in_rate : out_rate) / 2.0;
+    const double fc = rolloff * nyquist / ((double)L * in_rate);  // 归一化截止频率（周期/样本）
+    const double i0_beta = resampler_bessel_i0(beta);
+
+    double *proto = (double *)malloc(N * sizeof(double));
+    if (!proto) return false;
+
+    for (size_t n = 0; n < N; n++) {
+        double x = n - center;
+        double sinc = (x == 0.0) ? 1.0 : sin(2.0 * M_PI * fc * x) / (2.0 * M_PI * fc * x);
+        double r = (N > 1) ? (2.0 * n / (N - 1) - 1.0) : 0.0;
+        double win = resampler_bessel_i0(beta * sqrt(1.0 - r * r)) / i0_beta;
+        proto[n] = 2.0 * fc * sinc * win;
+    }
+
+    for (size_t p = 0; p < L; p++) {
+        double sum = 0.0;
+        for (size_t k = 0; k < taps; k++) {
+            sum += proto[p + k * L];
+        }
+        if (sum == 0.0) sum = 1.0;
+        for (size_t k = 0; k < taps; k++) {
+            // 窗口按旧→新排列，k=0 对应最新样本，因此反向存放
+            double c = proto[p + k * L] / sum;
+            size_t j = taps - 1 - k;
+            if (rs->coef_f32) {
+                rs->coef_f32[p * taps + j] = (float)c;
+            } else {
+                long q = lround(c * (1 << RESAMPLER_COEF_SHIFT));
+                if (q > INT16_MAX) q = INT16_MAX;
+                if (q < INT16_MIN) q = INT16_MIN;
+                rs->coef_q14[p * taps + j] = (int16_t)q;
+            }
+        }
+    }
+
+    free(proto);
+    return true;
+}
+
+/**
+ * @brief 创建重采样器
+ *
+ * 根据质量档位选择每相抽头数、通带比例和 Kaiser β：
+ * - LOW:    8 抽头，rolloff 0.80，β=5（约 -50dB）
+ * - MEDIUM: 16 抽头，rolloff 0.88，β=7（约 -70dB）
+ * - HIGH:   32 抽头，rolloff 0.92，β=9（约 -90dB）
+ *
+ * @param config 配置参数
+ * @return 重采样器句柄，失败返回 NULL
+ */
+resampler_handle_t resampler_create(const resampler_config_t *config)
+{
+    if (!config || config->in_rate == 0 || config->out_rate == 0) {
+        ESP_LOGE(TAG, "无效的配置参数");
+        return NULL;
+    }
+
+    resampler_t *rs = (resampler_t *)calloc(1, sizeof(resampler_t));
+    if (!rs) {
+        ESP_LOGE(TAG, "重采样器分配失败");
+        return NULL;
+    }
+
+    rs->format = config->format;
+    uint32_t g = resampler_gcd(config->in_rate, config->out_rate);
+    rs->L = config->out_rate / g;
+    rs->M = config->in_rate / g;
+
+    if (config->in_rate == config->out_rate) {
+        rs->bypass = true;
+        return rs;
+    }
+
+    if (rs->L > RESAMPLER_MAX_PHASES) {
+        ESP_LOGE(TAG, "不支持的采样率比: %u -> %u (L=%u)",
+                 (unsigned)config->in_rate, (unsigned)config->out_rate, (unsigned)rs->L);
+        free(rs);
+        return NULL;
+    }
+
+    double rolloff, beta;
+    switch (config->quality) {
+    case RESAMPLER_QUALITY_LOW:
+        rs->taps = 8;  rolloff = 0.80; beta = 5.0;
+        break;
+    case RESAMPLER_QUALITY_HIGH:
+        rs->taps = 32; rolloff = 0.92; beta = 9.0;
+        break;
+    case RESAMPLER_QUALITY_MEDIUM:
+    default:
+        rs->taps = 16; rolloff = 0.88; beta = 7.0;
+        break;
+    }
+
+    size_t coef_count = (size_t)rs->L * rs->taps;
+    if (rs->format == RESAMPLER_FORMAT_F32) {
+        rs->coef_f32 = (float *)malloc(coef_count * sizeof(float));
+        rs->hist_f32 = (float *)calloc(2 * rs->taps, sizeof(float));
+    } else {
+        rs->coef_q14 = (int16_t *)malloc(coef_count * sizeof(int16_t));
+        rs->hist_s16 = (int16_t *)calloc(2 * rs->taps, sizeof(int16_t));
+    }
+
+    if ((!rs->coef_f32 && !rs->coef_q14) || (!rs->hist_f32 && !rs->hist_s16) ||
+        !resampler_design(rs, config->in_rate, config->out_rate, rolloff, beta)) {
+        ESP_LOGE(TAG, "滤波器系数分配失败");
+        resampler_destroy(rs);
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "重采样器: %u -> %u Hz (L=%u, M=%u, %u 抽头/相, %s)",
+             (unsigned)config->in_rate, (unsigned)config->out_rate,
+             (unsigned)rs->L, (unsigned)rs->M, (unsigned)rs->taps,
+             rs->format == RESAMPLER_FORMAT_F32 ? "f32" : "s16");
+    return rs;
+}
+
+/**
+ * @brief 销毁重采样器
+ *
+ * @param rs 重采样器句柄，允许为 NULL
+ */
+void resampler_destroy(resampler_handle_t rs)
+{
+    if (!rs) return;
+    free(rs->coef_q14);
+    free(rs->coef_f32);
+    free(rs->hist_s16);
+    free(rs->hist_f32);
+    free(rs);
+}
+
+/**
+ * @brief 清空内部历史状态
+ *
+ * 流之间不连续时调用，避免上一段音频的尾巴混入新流开头。
+ *
+ * @param rs 重采样器句柄
+ */
+void resampler_reset(resampler_handle_t rs)
+{
+    if (!rs) return;
+    rs->frac = 0;
+    rs->pos = 0;
+    if (rs->hist_s16) memset(rs->hist_s16, 0, 2 * rs->taps * sizeof(int16_t));
+    if (rs->hist_f32) memset(rs->hist_f32, 0, 2 * rs->taps * sizeof(float));
+}
+
+/**
+ * @brief 计算最大输出采样点数
+ *
+ * 每个输入样本最多产生 ceil(L/M) 个输出，这里给出保守上界。
+ *
+ * @param rs 重采样器句柄
+ * @param in_samples 输入采样点数
+ * @return 输出缓冲区所需的最小容量
+ */
+size_t resampler_get_max_output(resampler_handle_t rs, size_t in_samples)
+{
+    if (!rs) return 0;
+    if (rs->bypass) return in_samples;
+    return (size_t)(((uint64_t)in_samples * rs->L + rs->L) / rs->M) + 1;
+}
+
+/**
+ * @brief 获取群延迟（输入采样点数）
+ *
+ * @param rs 重采样器句柄
+ * @return 延迟，直通模式返回 0
+ */
+size_t resampler_get_latency(resampler_handle_t rs)
+{
+    if (!rs || rs->bypass) return 0;
+    return rs->taps / 2;
+}
+
+/**
+ * @brief 16bit 定点流式重采样
+ *
+ * 每个输入样本写入双份历史后，输出所有落在该样本区间内的相位点。
+ * 内层为 int16 x int16 -> int32 连续乘加，便于编译器 / SIMD 展开。
+ *
+ * @param rs 重采样器句柄
+ * @param in 输入数据
+ * @param in_samples 输入采样点数
+ * @param out 输出缓冲区
+ * @param out_capacity 输出缓冲区容量
+ * @return 实际输出的采样点数
+ *
+ * @note out_capacity 不足时多余输出被丢弃（状态仍正常推进），
+ *       调用者应按 resampler_get_max_output() 分配
+ */
+size_t resampler_process_s16(resampler_handle_t rs, const int16_t *in, size_t in_samples,
+                             int16_t *out, size_t out_capacity)
+{
+    if (!rs || !in || !out || rs->format != RESAMPLER_FORMAT_S16) return 0;
+
+    if (rs->bypass) {
+        size_t n = in_samples < out_capacity ? in_samples : out_capacity;
+        memcpy(out, in, n * sizeof(int16_t));
+        return n;
+    }
+
+    const size_t taps = rs->taps;
+    const uint32_t L = rs->L, M = rs->M;
+    int16_t *hist = rs->hist_s16;
+    size_t pos = rs->pos;
+    uint32_t frac = rs->frac;
+    size_t produced = 0;
+
+    for (size_t i = 0; i < in_samples; i++) {
+        hist[pos] = in[i];
+        hist[pos + taps] = in[i];
+        pos = (pos + 1 == taps) ? 0 : pos + 1;
+
+        const int16_t *win = &hist[pos];
+        while (frac < L) {
+            const int16_t *h = &rs->coef_q14[frac * taps];
+            int32_t acc = 1 << (RESAMPLER_COEF_SHIFT - 1);  // 四舍五入
+            for (size_t j = 0; j < taps; j++) {
+                acc += (int32_t)h[j] * win[j];
+            }
+            acc >>= RESAMPLER_COEF_SHIFT;
+            if (acc > INT16_MAX) acc = INT16_MAX;
+            if (acc < INT16_MIN) acc = INT16_MIN;
+            if (produced < out_capacity) {
+                out[produced++] = (int16_t)acc;
+            }
+            frac += M;
+        }
+        frac -= L;
+    }
+
+    rs->pos = pos;
+    rs->frac = frac;
+    return produced;
+}
+
+/**
+ * @brief 浮点流式重采样
+ *
+ * 与定点路径结构相同，适用于后续浮点处理链（如特征提取）。
+ *
+ * @param rs 重采样器句柄
+ * @param in 输入数据
+ * @param in_samples 输入采样点数
+ * @param out 输出缓冲区
+ * @param out_capacity 输出缓冲区容量
+ * @return 实际输出的采样点数
+ */
+size_t resampler_process_f32(resampler_handle_t rs, const float *in, size_t in_samples,
+                             float *out, size_t out_capacity)
+{
+    if (!rs || !in || !out || rs->format != RESAMPLER_FORMAT_F32) return 0;
+
+    if (rs->bypass) {
+        size_t n = in_samples < out_capacity ? in_samples : out_capacity;
+        memcpy(out, in, n * sizeof(float));
+        return n;
+    }
+
+    const size_t taps = rs->taps;
+    const uint32_t L = rs->L, M = rs->M;
+    float *hist = rs->hist_f32;
+    size_t pos = rs->pos;
+    uint32_t frac = rs->frac;
+    size_t produced = 0;
+
+    for (size_t i = 0; i < in_samples; i++) {
+        hist[pos] = in[i];
+        hist[pos + taps] = in[i];
+        pos = (pos + 1 == taps) ? 0 : pos + 1;
+
+        const float *win = &hist[pos];
+        while (frac < L) {
+            const float *h = &rs->coef_f32[frac * taps];
+            float acc = 0.0f;
+            for (size_t j = 0; j < taps; j++) {
+                acc += h[j] * win[j];
+            }
+            if (produced < out_capacity) {
+                out[produced++] = acc;
+            }
+            frac += M;
+        }
+        frac -= L;
+    }
+
+    rs->pos = pos;
+    rs->frac = frac;
+    return produced;
+}
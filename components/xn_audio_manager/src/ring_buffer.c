@@ -11,7 +11,9 @@
 #include "ring_buffer.h"
 #include "esp_log.h"
 #include "esp_heap_caps.h"
+#include "freertos/task.h"
 #include <string.h>
+#include <stdatomic.h>
 
 static const char *TAG = "RING_BUFFER";
 
@@ -22,8 +24,9 @@ static const char *TAG = "RING_BUFFER";
  * 特性：
  * - 使用 PSRAM 存储大容量音频数据
  * - 支持多线程并发访问（互斥锁保护）
- * - 可选的阻塞读取机制（信号量）
+ * - 可选的阻塞读取/阻塞写入机制（信号量）
  * - 缓冲区满时自动覆盖旧数据
+ * - 原子计数器记录溢出/欠载等统计，热路径不打印日志
  */
 typedef struct ring_buffer_s {
     int16_t *buffer;              ///< 数据缓冲区（PSRAM），存储音频采样点
@@ -32,8 +35,56 @@ typedef struct ring_buffer_s {
     volatile size_t read_pos;     ///< 读位置索引（消费者）
     SemaphoreHandle_t mutex;      ///< 互斥锁，保护读写位置的原子性
     SemaphoreHandle_t data_sem;   ///< 数据可用信号量（可选），用于阻塞读取
+    SemaphoreHandle_t space_sem;  ///< 空间可用信号量（可选），用于阻塞写入
+
+    // 运行统计（relaxed 原子操作，读取方无需加锁）
+    atomic_uint stat_written;     ///< 累计写入采样点数
+    atomic_uint stat_read;        ///< 累计读出采样点数
+    atomic_uint stat_overwritten; ///< 被覆盖的采样点数
+    atomic_uint stat_underruns;   ///< 欠载读取次数
+    atomic_uint stat_mutex_timeouts; ///< 互斥锁超时次数
+    atomic_size_t stat_high_water;   ///< 最高水位（采样点数）
 } ring_buffer_t;
 
+/**
+ * @brief 统计计数器累加（relaxed，仅保证原子性）
+ */
+static inline void ring_buffer_stat_add(atomic_uint *counter, uint32_t value)
+{
+    atomic_fetch_add_explicit(counter, value, memory_order_relaxed);
+}
+
+/**
+ * @brief 计算当前数据量（调用者需持有互斥锁）
+ */
+static inline size_t ring_buffer_used_locked(const ring_buffer_t *rb)
+{
+    return (rb->write_pos >= rb->read_pos)
+           ? (rb->write_pos - rb->read_pos)
+           : (rb->size - rb->read_pos + rb->write_pos);
+}
+
+/**
+ * @brief 更新最高水位统计
+ */
+static inline void ring_buffer_update_high_water(ring_buffer_t *rb, size_t used)
+{
+    size_t hwm = atomic_load_explicit(&rb->stat_high_water, memory_order_relaxed);
+    while (used > hwm &&
+           !atomic_compare_exchange_weak_explicit(&rb->stat_high_water, &hwm, used,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief 计算自 start 起剩余的等待节拍数，已超时返回 0
+ */
+static inline TickType_t ring_buffer_remaining_ticks(TickType_t start, TickType_t total)
+{
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    return (elapsed >= total) ? 0 : (total - elapsed);
+}
+
 /**
  * @brief 创建环形缓冲区
  * 
@@ -41,8 +92,9 @@ typedef struct ring_buffer_s {
  * 
  * @param samples 缓冲区容量（采样点数），建议值：16000（1秒@16kHz）
  * @param with_sem 是否创建信号量用于阻塞读取
- *                 - true: 支持 ring_buffer_read() 阻塞等待数据
- *                 - false: 仅支持非阻塞读取
+ *                 - true: 支持 ring_buffer_read() 阻塞等待数据，
+ *                         以及 ring_buffer_write_wait() 阻塞等待空间
+ *                 - false: 仅支持非阻塞读写
  * 
  * @return 环形缓冲区句柄，失败返回 NULL
  * 
@@ -58,8 +110,8 @@ ring_buffer_handle_t ring_buffer_create(size_t samples, bool with_sem)
         return NULL;
     }
 
-    // 分配句柄结构体（使用 IRAM）
-    ring_buffer_t *rb = (ring_buffer_t *)malloc(sizeof(ring_buffer_t));
+    // 分配句柄结构体（使用 IRAM，清零以初始化统计计数器）
+    ring_buffer_t *rb = (ring_buffer_t *)calloc(1, sizeof(ring_buffer_t));
     if (!rb) {
         ESP_LOGE(TAG, "环形缓冲区句柄分配失败");
         return NULL;
@@ -87,12 +139,16 @@ ring_buffer_handle_t ring_buffer_create(size_t samples, bool with_sem)
         return NULL;
     }
 
-    // 可选：创建数据可用信号量（用于阻塞读取）
+    // 可选：创建数据/空间可用信号量（用于阻塞读取和阻塞写入）
     rb->data_sem = NULL;
+    rb->space_sem = NULL;
     if (with_sem) {
         rb->data_sem = xSemaphoreCreateBinary();
-        if (!rb->data_sem) {
+        rb->space_sem = xSemaphoreCreateBinary();
+        if (!rb->data_sem || !rb->space_sem) {
             ESP_LOGE(TAG, "信号量创建失败");
+            if (rb->data_sem) vSemaphoreDelete(rb->data_sem);
+            if (rb->space_sem) vSemaphoreDelete(rb->space_sem);
             vSemaphoreDelete(rb->mutex);
             heap_caps_free(rb->buffer);
             free(rb);
@@ -131,6 +187,9 @@ void ring_buffer_destroy(ring_buffer_handle_t rb)
     if (rb->data_sem) {
         vSemaphoreDelete(rb->data_sem);
     }
+    if (rb->space_sem) {
+        vSemaphoreDelete(rb->space_sem);
+    }
     
     // 释放缓冲区内存
     if (rb->buffer) {
@@ -153,7 +212,8 @@ void ring_buffer_destroy(ring_buffer_handle_t rb)
  * @return 实际写入的采样点数（通常等于 samples）
  * 
  * @note 线程安全：内部使用互斥锁保护
- * @note 缓冲区溢出时会打印警告日志
+ * @note 缓冲区溢出只累加 samples_overwritten 计数，不在此处打印日志，
+ *       由上层通过 ring_buffer_get_stats() 在非实时路径上限频上报
  * @note 写入后会触发 data_sem 信号量（如果存在）
  */
 size_t ring_buffer_write(ring_buffer_handle_t rb, const int16_t *data, size_t samples)
@@ -164,6 +224,7 @@ size_t ring_buffer_write(ring_buffer_handle_t rb, const int16_t *data, size_t sa
 
     // 获取互斥锁（超时 10ms）
     if (xSemaphoreTake(rb->mutex, pdMS_TO_TICKS(10)) != pdTRUE) {
+        ring_buffer_stat_add(&rb->stat_mutex_timeouts, 1);
         return 0;
     }
 
@@ -181,14 +242,16 @@ size_t ring_buffer_write(ring_buffer_handle_t rb, const int16_t *data, size_t sa
         }
     }
 
+    size_t used = ring_buffer_used_locked(rb);
+
     xSemaphoreGive(rb->mutex);
 
-    // 缓冲区溢出警告（假设 16kHz 采样率）
+    // 更新统计（锁外完成，缩短临界区）
+    ring_buffer_stat_add(&rb->stat_written, (uint32_t)samples);
     if (overrun_count > 0) {
-        ESP_LOGW(TAG, "⚠️ 缓冲区溢出！丢弃 %u 样本 (%.1f ms)", 
-                 (unsigned)overrun_count, 
-                 (float)overrun_count / 16.0f);
+        ring_buffer_stat_add(&rb->stat_overwritten, (uint32_t)overrun_count);
     }
+    ring_buffer_update_high_water(rb, used);
 
     // 通知有数据可读（触发阻塞读取）
     if (rb->data_sem) {
@@ -198,6 +261,85 @@ size_t ring_buffer_write(ring_buffer_handle_t rb, const int16_t *data, size_t sa
     return samples;
 }
 
+/**
+ * @brief 写入数据到环形缓冲区（不覆盖旧数据）
+ * 
+ * 与 ring_buffer_write() 不同，空间不足时不会丢弃未读数据，而是写入当前
+ * 能容纳的部分，然后等待消费者读出数据后继续写入，直到全部写完或超时。
+ * 用于给生产者提供背压（例如 TTS 解码速度快于播放速度时）。
+ * 
+ * @param rb 环形缓冲区句柄
+ * @param data 待写入的数据指针（int16_t 数组）
+ * @param samples 采样点数
+ * @param timeout_ms 等待空间的总超时时间（毫秒）
+ *                   - 0: 非阻塞，只写入当前可容纳的部分
+ *                   - >0: 阻塞等待空间（需要 space_sem 信号量）
+ * 
+ * @return 实际写入的采样点数（超时或锁超时时可能小于 samples）
+ * 
+ * @note 线程安全：内部使用互斥锁保护，按块拷贝，临界区短
+ */
+size_t ring_buffer_write_wait(ring_buffer_handle_t rb, const int16_t *data, size_t samples, uint32_t timeout_ms)
+{
+    if (!rb || !data || samples == 0) {
+        return 0;
+    }
+
+    const TickType_t start = xTaskGetTickCount();
+    const TickType_t total = pdMS_TO_TICKS(timeout_ms);
+    size_t written = 0;
+
+    while (written < samples) {
+        if (xSemaphoreTake(rb->mutex, pdMS_TO_TICKS(10)) != pdTRUE) {
+            ring_buffer_stat_add(&rb->stat_mutex_timeouts, 1);
+            break;
+        }
+
+        // 可写空间：保留一个空位区分“满”和“空”
+        size_t space = rb->size - 1 - ring_buffer_used_locked(rb);
+        size_t n = samples - written;
+        if (n > space) {
+            n = space;
+        }
+
+        // 分两段拷贝（处理环形回绕）
+        size_t first = rb->size - rb->write_pos;
+        if (first > n) {
+            first = n;
+        }
+        memcpy(&rb->buffer[rb->write_pos], &data[written], first * sizeof(int16_t));
+        if (n > first) {
+            memcpy(rb->buffer, &data[written + first], (n - first) * sizeof(int16_t));
+        }
+        rb->write_pos = (rb->write_pos + n) % rb->size;
+
+        size_t used = ring_buffer_used_locked(rb);
+        xSemaphoreGive(rb->mutex);
+
+        if (n > 0) {
+            written += n;
+            ring_buffer_stat_add(&rb->stat_written, (uint32_t)n);
+            ring_buffer_update_high_water(rb, used);
+            if (rb->data_sem) {
+                xSemaphoreGive(rb->data_sem);
+            }
+        }
+
+        if (written == samples || !rb->space_sem) {
+            break;
+        }
+
+        // 等待消费者腾出空间
+        TickType_t remaining = ring_buffer_remaining_ticks(start, total);
+        if (remaining == 0) {
+            break;
+        }
+        xSemaphoreTake(rb->space_sem, remaining);
+    }
+
+    return written;
+}
+
 /**
  * @brief 从环形缓冲区读取数据
  * 
@@ -228,17 +370,18 @@ size_t ring_buffer_read(ring_buffer_handle_t rb, int16_t *out, size_t samples, u
 
     // 获取互斥锁（超时 10ms）
     if (xSemaphoreTake(rb->mutex, pdMS_TO_TICKS(10)) != pdTRUE) {
+        ring_buffer_stat_add(&rb->stat_mutex_timeouts, 1);
         return 0;
     }
 
     // 计算可用数据量
-    size_t avail = (rb->write_pos >= rb->read_pos)
-                   ? (rb->write_pos - rb->read_pos)
-                   : (rb->size - rb->read_pos + rb->write_pos);
+    size_t avail = ring_buffer_used_locked(rb);
 
     // 限制读取量为可用数据量
+    bool underrun = false;
     if (samples > avail) {
         samples = avail;
+        underrun = true;
     }
 
     // 读取数据
@@ -249,6 +392,16 @@ size_t ring_buffer_read(ring_buffer_handle_t rb, int16_t *out, size_t samples, u
 
     xSemaphoreGive(rb->mutex);
 
+    ring_buffer_stat_add(&rb->stat_read, (uint32_t)samples);
+    if (underrun) {
+        ring_buffer_stat_add(&rb->stat_underruns, 1);
+    }
+
+    // 通知有空间可写（唤醒阻塞写入的生产者）
+    if (samples > 0 && rb->space_sem) {
+        xSemaphoreGive(rb->space_sem);
+    }
+
     return samples;
 }
 
@@ -271,19 +424,107 @@ size_t ring_buffer_available(ring_buffer_handle_t rb)
 
     // 获取互斥锁（超时 10ms）
     if (xSemaphoreTake(rb->mutex, pdMS_TO_TICKS(10)) != pdTRUE) {
+        ring_buffer_stat_add(&rb->stat_mutex_timeouts, 1);
         return 0;
     }
 
     // 计算可用数据量（处理环形回绕）
-    size_t avail = (rb->write_pos >= rb->read_pos)
-                   ? (rb->write_pos - rb->read_pos)
-                   : (rb->size - rb->read_pos + rb->write_pos);
+    size_t avail = ring_buffer_used_locked(rb);
 
     xSemaphoreGive(rb->mutex);
 
     return avail;
 }
 
+/**
+ * @brief 获取环形缓冲区剩余可写空间
+ * 
+ * 返回不覆盖旧数据前提下还能写入的采样点数（容量 - 1 - 已用）。
+ * 
+ * @param rb 环形缓冲区句柄
+ * @return 可写入的采样点数
+ * 
+ * @note 返回值为瞬时快照
+ */
+size_t ring_buffer_get_free(ring_buffer_handle_t rb)
+{
+    if (!rb) {
+        return 0;
+    }
+    size_t used = ring_buffer_available(rb);
+    return (rb->size - 1 > used) ? (rb->size - 1 - used) : 0;
+}
+
+/**
+ * @brief 等待缓冲区中的数据量达到指定值
+ * 
+ * 用于播放端预缓冲（jitter buffer）：积累到目标水位后再开始输出。
+ * 
+ * @param rb 环形缓冲区句柄
+ * @param min_samples 期望的最少数据量，超过可用容量时按可用容量计算
+ * @param timeout_ms 超时时间（毫秒），0表示仅检查一次
+ * 
+ * @return true 数据量已满足，false 超时或参数无效
+ * 
+ * @note 阻塞等待需要 data_sem 信号量
+ */
+bool ring_buffer_wait_available(ring_buffer_handle_t rb, size_t min_samples, uint32_t timeout_ms)
+{
+    if (!rb) {
+        return false;
+    }
+    if (min_samples > rb->size - 1) {
+        min_samples = rb->size - 1;
+    }
+
+    const TickType_t start = xTaskGetTickCount();
+    const TickType_t total = pdMS_TO_TICKS(timeout_ms);
+
+    while (ring_buffer_available(rb) < min_samples) {
+        TickType_t remaining = ring_buffer_remaining_ticks(start, total);
+        if (remaining == 0 || !rb->data_sem) {
+            return false;
+        }
+        xSemaphoreTake(rb->data_sem, remaining);
+    }
+    return true;
+}
+
+/**
+ * @brief 等待缓冲区剩余空间达到指定值
+ * 
+ * 供生产者做流控：在写入一大块数据前等待足够空间，避免部分写入。
+ * 
+ * @param rb 环形缓冲区句柄
+ * @param min_free 期望的最少剩余空间，超过可用容量时按可用容量计算
+ * @param timeout_ms 超时时间（毫秒），0表示仅检查一次
+ * 
+ * @return true 空间已满足，false 超时或参数无效
+ * 
+ * @note 阻塞等待需要 space_sem 信号量
+ */
+bool ring_buffer_wait_free(ring_buffer_handle_t rb, size_t min_free, uint32_t timeout_ms)
+{
+    if (!rb) {
+        return false;
+    }
+    if (min_free > rb->size - 1) {
+        min_free = rb->size - 1;
+    }
+
+    const TickType_t start = xTaskGetTickCount();
+    const TickType_t total = pdMS_TO_TICKS(timeout_ms);
+
+    while (ring_buffer_get_free(rb) < min_free) {
+        TickType_t remaining = ring_buffer_remaining_ticks(start, total);
+        if (remaining == 0 || !rb->space_sem) {
+            return false;
+        }
+        xSemaphoreTake(rb->space_sem, remaining);
+    }
+    return true;
+}
+
 /**
  * @brief 清空环形缓冲区
  * 
@@ -306,6 +547,7 @@ esp_err_t ring_buffer_clear(ring_buffer_handle_t rb)
 
     // 获取互斥锁（超时 100ms）
     if (xSemaphoreTake(rb->mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        ring_buffer_stat_add(&rb->stat_mutex_timeouts, 1);
         return ESP_ERR_TIMEOUT;
     }
 
@@ -315,6 +557,11 @@ esp_err_t ring_buffer_clear(ring_buffer_handle_t rb)
 
     xSemaphoreGive(rb->mutex);
 
+    // 清空后空间全部可用，唤醒阻塞写入的生产者
+    if (rb->space_sem) {
+        xSemaphoreGive(rb->space_sem);
+    }
+
     return ESP_OK;
 }
 
@@ -335,3 +582,52 @@ size_t ring_buffer_get_size(ring_buffer_handle_t rb)
     }
     return rb->size;
 }
+
+/**
+ * @brief 获取环形缓冲区运行统计
+ * 
+ * 读取各原子计数器的快照，不获取互斥锁，可在任意任务中低成本调用。
+ * 各字段分别读取，彼此之间不保证严格一致，仅用于监控与诊断。
+ * 
+ * @param rb 环形缓冲区句柄
+ * @param out_stats 输出统计数据
+ * @return 
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 参数为 NULL
+ */
+esp_err_t ring_buffer_get_stats(ring_buffer_handle_t rb, ring_buffer_stats_t *out_stats)
+{
+    if (!rb || !out_stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    out_stats->samples_written = atomic_load_explicit(&rb->stat_written, memory_order_relaxed);
+    out_stats->samples_read = atomic_load_explicit(&rb->stat_read, memory_order_relaxed);
+    out_stats->samples_overwritten = atomic_load_explicit(&rb->stat_overwritten, memory_order_relaxed);
+    out_stats->underrun_reads = atomic_load_explicit(&rb->stat_underruns, memory_order_relaxed);
+    out_stats->mutex_timeouts = atomic_load_explicit(&rb->stat_mutex_timeouts, memory_order_relaxed);
+    out_stats->high_water_mark = atomic_load_explicit(&rb->stat_high_water, memory_order_relaxed);
+
+    return ESP_OK;
+}
+
+/**
+ * @brief 清零环形缓冲区运行统计
+ * 
+ * @param rb 环形缓冲区句柄，允许为 NULL
+ * 
+ * @note 不影响缓冲区中的数据和读写位置
+ */
+void ring_buffer_reset_stats(ring_buffer_handle_t rb)
+{
+    if (!rb) {
+        return;
+    }
+
+    atomic_store_explicit(&rb->stat_written, 0, memory_order_relaxed);
+    atomic_store_explicit(&rb->stat_read, 0, memory_order_relaxed);
+    atomic_store_explicit(&rb->stat_overwritten, 0, memory_order_relaxed);
+    atomic_store_explicit(&rb->stat_underruns, 0, memory_order_relaxed);
+    atomic_store_explicit(&rb->stat_mutex_timeouts, 0, memory_order_relaxed);
+    atomic_store_explicit(&rb->stat_high_water, 0, memory_order_relaxed);
+}
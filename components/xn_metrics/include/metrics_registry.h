@@ -0,0 +1,153 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-15
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-15
+ * @FilePath: \xn_voice_wake_up\components\xn_metrics\include\metrics_registry.h
+ * @Description: 指标注册表 - 无锁的计数器 / 仪表 / 直方图，供各组件注册并由 /api/metrics 导出
+ *
+ * 设计要点：
+ *  - 槽位为静态数组，注册通过原子自增占位，不加锁、不分配堆内存；
+ *  - 更新只是一次或两次 relaxed 原子加，可以放在实时路径上长期开启；
+ *  - 已有统计（如 ring_buffer_get_stats）可用回调型指标导出，采集时才读取，热路径零开销；
+ *  - name / labels / help 及直方图边界只保存指针，必须是静态生命周期的字符串 / 数组。
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include "esp_err.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define METRICS_MAX_METRICS         64      ///< 最多注册的指标数（同名不同标签各占一个）
+#define METRICS_MAX_BUCKETS         128     ///< 所有直方图共享的桶总数（每个直方图占 边界数 + 1）
+#define METRICS_MAX_HIST_BOUNDS     15      ///< 单个直方图最多的边界数（不含 +Inf）
+
+/** 指标类型 */
+typedef enum {
+    METRICS_TYPE_COUNTER = 0,       ///< 单调递增计数器
+    METRICS_TYPE_GAUGE,             ///< 可增可减的瞬时值
+    METRICS_TYPE_HISTOGRAM,         ///< 分布统计（累积桶 + 总和 + 次数）
+} metrics_type_t;
+
+/** 指标描述（字符串均需静态生命周期） */
+typedef struct {
+    const char *name;               ///< 指标名，如 "xn_heap_free_bytes"（[a-zA-Z_:][a-zA-Z0-9_:]*）
+    const char *labels;             ///< 固定标签，如 "caps=\"internal\""，可为 NULL；值中不能含引号
+    const char *help;               ///< 说明文字，可为 NULL
+} metrics_desc_t;
+
+/** 指标句柄（注册失败时为 NULL，所有更新函数对 NULL 安全） */
+typedef struct metrics_slot_s *metrics_handle_t;
+
+/**
+ * @brief 回调型指标的读取函数（在采集任务中调用，不要阻塞）
+ * @param ctx 注册时传入的上下文
+ * @return 当前值
+ */
+typedef int64_t (*metrics_read_fn)(void *ctx);
+
+/** 采集时的单个指标快照 */
+typedef struct {
+    const metrics_desc_t *desc;     ///< 指标描述
+    metrics_type_t type;            ///< 指标类型
+    bool first_of_family;           ///< 是否是同名指标中的第一个（用于只输出一次 HELP / TYPE）
+    int64_t value;                  ///< 计数器 / 仪表的值
+    int64_t sum;                    ///< 直方图：观测值总和
+    uint64_t count;                 ///< 直方图：观测次数
+    size_t bound_count;             ///< 直方图：边界数（不含 +Inf）
+    const int32_t *bounds;          ///< 直方图：各桶上界（升序）
+    const uint32_t *buckets;        ///< 直方图：累积计数，bound_count + 1 个，最后一个对应 +Inf
+} metrics_sample_t;
+
+/**
+ * @brief 遍历回调
+ * @param sample 指标快照（仅在回调期间有效）
+ * @param ctx 用户上下文
+ */
+typedef void (*metrics_visit_fn)(const metrics_sample_t *sample, void *ctx);
+
+/**
+ * @brief 注册计数器
+ * @param desc 指标描述
+ * @param out_handle 输出句柄；同名同标签同类型已注册时返回已有句柄
+ * @return ESP_OK 成功，ESP_ERR_NO_MEM 槽位用尽，ESP_ERR_INVALID_STATE 同名同标签但类型不同
+ */
+esp_err_t metrics_register_counter(const metrics_desc_t *desc, metrics_handle_t *out_handle);
+
+/**
+ * @brief 注册仪表（初值 0）
+ * @param desc 指标描述
+ * @param out_handle 输出句柄
+ * @return 同 metrics_register_counter()
+ */
+esp_err_t metrics_register_gauge(const metrics_desc_t *desc, metrics_handle_t *out_handle);
+
+/**
+ * @brief 注册直方图
+ * @param desc 指标描述
+ * @param bounds 各桶上界（升序，静态数组），观测值 <= bound 计入该桶
+ * @param bound_count 边界数（1 ~ METRICS_MAX_HIST_BOUNDS）
+ * @param out_handle 输出句柄
+ * @return 同 metrics_register_counter()，ESP_ERR_INVALID_ARG 边界无效
+ */
+esp_err_t metrics_register_histogram(const metrics_desc_t *desc, const int32_t *bounds, size_t bound_count,
+                                     metrics_handle_t *out_handle);
+
+/**
+ * @brief 注册回调型计数器 / 仪表：采集时调用 read 读取当前值
+ * @param desc 指标描述
+ * @param type METRICS_TYPE_COUNTER 或 METRICS_TYPE_GAUGE
+ * @param read 读取函数
+ * @param ctx 读取函数上下文
+ * @return 同 metrics_register_counter()
+ */
+esp_err_t metrics_register_callback(const metrics_desc_t *desc, metrics_type_t type,
+                                    metrics_read_fn read, void *ctx);
+
+/**
+ * @brief 计数器加 delta
+ */
+void metrics_counter_add(metrics_handle_t handle, uint32_t delta);
+
+/**
+ * @brief 计数器加 1
+ */
+static inline void metrics_counter_inc(metrics_handle_t handle)
+{
+    metrics_counter_add(handle, 1);
+}
+
+/**
+ * @brief 设置仪表值
+ */
+void metrics_gauge_set(metrics_handle_t handle, int32_t value);
+
+/**
+ * @brief 仪表加 delta（可为负）
+ */
+void metrics_gauge_add(metrics_handle_t handle, int32_t delta);
+
+/**
+ * @brief 记录一次直方图观测值
+ */
+void metrics_histogram_observe(metrics_handle_t handle, int32_t value);
+
+/**
+ * @brief 遍历所有指标：按指标族首次注册的顺序，同名指标连续给出
+ * @param visit 遍历回调
+ * @param ctx 用户上下文
+ * @return 遍历的指标数
+ * @note 快照不是原子的：直方图的总和与各桶可能相差正在进行中的几次观测
+ */
+size_t metrics_foreach(metrics_visit_fn visit, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,36 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-15
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-15
+ * @FilePath: \xn_voice_wake_up\components\xn_metrics\include\metrics_system.h
+ * @Description: 系统指标 - 堆 / PSRAM 余量与碎片、各核空闲时间、运行时长
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 注册系统指标（全部为回调型，采集时读取）
+ *
+ * - xn_heap_free_bytes / xn_heap_largest_free_block_bytes{caps="internal|psram"}：
+ *   两者的差距反映碎片程度；
+ * - xn_heap_min_free_bytes{caps="internal"}：启动以来的内部 RAM 最低余量；
+ * - xn_cpu_idle_us_total{core="0|1"} 与 xn_cpu_runtime_us_total：FreeRTOS 运行时统计，
+ *   用 rate(idle) / rate(runtime) 计算各核负载（32 位计数约 71 分钟回绕，表现为计数器重置）；
+ * - xn_uptime_seconds、xn_task_count。
+ *
+ * @return ESP_OK 成功，ESP_ERR_NO_MEM 指标槽位不足
+ * @note 可重复调用
+ */
+esp_err_t metrics_system_register(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,130 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-16
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-16
+ * @FilePath: \xn_voice_wake_up\components\xn_metrics\include\metrics_trace.h
+ * @Description: 时间线追踪 - 无锁的 trace 事件记录器，导出 Chrome trace JSON（chrome://tracing / Perfetto）
+ *
+ * 设计要点：
+ *  - 每个核心一个环形缓冲区，写入只做一次 relaxed 原子自增占位 + 填充 + release 发布，不加锁；
+ *    满了覆盖最旧的事件，导出时按序号校验，跳过正在被覆盖的槽位；
+ *  - 写入前后各有一次进行中计数，metrics_trace_start 先停止记录、等进行中的写入结束后再清空；
+ *  - 未启动（metrics_trace_start）时各记录函数只有一次原子读，可常驻在实时路径上；
+ *  - 时间戳为微秒（设备端 esp_timer_get_time，主机端 CLOCK_MONOTONIC）；
+ *  - 事件按任务分轨（Chrome trace 的 tid），任务名在首次出现时复制；args 中带上记录时所在核心；
+ *  - name / cat 只保存指针，必须是静态生命周期的字符串。
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include "esp_err.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define METRICS_TRACE_MAX_CORES         2       ///< 环形缓冲区个数（按核心号取模）
+#define METRICS_TRACE_EVENTS_PER_CORE   512     ///< 每个核心保留的事件数（2 的幂）
+#define METRICS_TRACE_MAX_TASKS         24      ///< 记录任务名的任务数，超出后以句柄值作为轨道名
+
+/** 事件类型（取值即 Chrome trace 的 ph 字段） */
+typedef enum {
+    METRICS_TRACE_BEGIN   = 'B',    ///< 区间开始（与同一任务的 END 配对，可嵌套）
+    METRICS_TRACE_END     = 'E',    ///< 区间结束
+    METRICS_TRACE_INSTANT = 'i',    ///< 瞬时事件
+    METRICS_TRACE_COUNTER = 'C',    ///< 计数器取值
+} metrics_trace_phase_t;
+
+/**
+ * @brief 导出输出回调
+ * @param ctx 用户上下文
+ * @param data 数据
+ * @param len 长度（> 0）
+ * @return ESP_OK 成功，其它值中止导出并由导出函数返回
+ */
+typedef esp_err_t (*metrics_trace_write_fn)(void *ctx, const char *data, size_t len);
+
+/**
+ * @brief 清空缓冲区并开始记录
+ *
+ * 先停止记录并等待进行中的写入完成（会让出 CPU），再清空，不要在中断或持锁时调用。
+ */
+void metrics_trace_start(void);
+
+/**
+ * @brief 停止记录（已记录的事件保留，可继续导出）
+ */
+void metrics_trace_stop(void);
+
+/**
+ * @brief 是否正在记录
+ */
+bool metrics_trace_is_enabled(void);
+
+/**
+ * @brief 记录一个事件（通常使用下面的便捷函数）
+ * @param phase 事件类型
+ * @param cat 分类，如 "audio" / "dsp" / "nn" / "net"，可为 NULL
+ * @param name 事件名
+ * @param value 计数器取值（其他类型忽略）
+ */
+void metrics_trace_record(metrics_trace_phase_t phase, const char *cat, const char *name, int32_t value);
+
+/**
+ * @brief 区间开始
+ */
+static inline void metrics_trace_begin(const char *cat, const char *name)
+{
+    metrics_trace_record(METRICS_TRACE_BEGIN, cat, name, 0);
+}
+
+/**
+ * @brief 区间结束（必须与同一任务中的 metrics_trace_begin 成对）
+ */
+static inline void metrics_trace_end(const char *cat, const char *name)
+{
+    metrics_trace_record(METRICS_TRACE_END, cat, name, 0);
+}
+
+/**
+ * @brief 瞬时事件
+ */
+static inline void metrics_trace_instant(const char *cat, const char *name)
+{
+    metrics_trace_record(METRICS_TRACE_INSTANT, cat, name, 0);
+}
+
+/**
+ * @brief 计数器（在时间线上显示为折线）
+ */
+static inline void metrics_trace_counter(const char *cat, const char *name, int32_t value)
+{
+    metrics_trace_record(METRICS_TRACE_COUNTER, cat, name, value);
+}
+
+/**
+ * @brief 以 Chrome trace JSON 导出所有保留的事件
+ * @param write 输出回调（内部按 256 字节左右分块调用）
+ * @param ctx 输出回调上下文
+ * @return ESP_OK 成功，或 write 返回的错误
+ * @note 可以在记录过程中导出，正在被覆盖的事件会被跳过；同一任务的区间在缓冲区
+ *       回绕后可能只剩 END，Chrome / Perfetto 会忽略这类不成对的事件
+ */
+esp_err_t metrics_trace_dump(metrics_trace_write_fn write, void *ctx);
+
+/**
+ * @brief 导出到 stdio 流：设备端传 stdout 即从串口输出，主机端可传打开的文件
+ * @param fp 输出流
+ * @return ESP_OK 成功，ESP_FAIL 写入失败
+ */
+esp_err_t metrics_trace_dump_stdio(FILE *fp);
+
+#ifdef __cplusplus
+}
+#endif
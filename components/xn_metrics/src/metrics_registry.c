@@ -0,0 +1,351 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-15
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-15
+ * @FilePath: \xn_voice_wake_up\components\xn_metrics\src\metrics_registry.c
+ * @Description: 指标注册表实现
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#include "metrics_registry.h"
+#include "esp_log.h"
+#include <stdatomic.h>
+#include <string.h>
+
+static const char *TAG = "METRICS";
+
+/*
+ * 64 位累加值拆成两个 32 位原子量：Xtensa 上 32 位原子操作是单条 S32C1I 循环，
+ * 64 位原子操作则需要临界区。低位回绕时给高位进位，读取时用 hi-lo-hi 重读，只排除
+ * "读 lo 前后高位已变化" 的撕裂；写者先加低位、后补进位，恰好在两步之间读取会得到
+ * 少 2^32 的值（高位仍是旧值，重读检测不到），下一次采集即恢复。计数器按秒级采集，
+ * 单次采样偏差可以接受，因此不再为此引入临界区。
+ */
+struct metrics_slot_s {
+    metrics_desc_t desc;            ///< 指标描述（字符串指针）
+    metrics_type_t type;            ///< 指标类型
+    metrics_read_fn read;           ///< 回调型指标的读取函数
+    void *ctx;                      ///< 读取函数上下文
+    _Atomic uint32_t lo;            ///< 计数器值 / 直方图总和的低 32 位；仪表值
+    _Atomic uint32_t hi;            ///< 计数器值 / 直方图总和的高 32 位
+    const int32_t *bounds;          ///< 直方图桶上界
+    uint8_t bound_count;            ///< 直方图边界数
+    _Atomic uint32_t *buckets;      ///< 直方图各桶计数（非累积），bound_count + 1 个
+    atomic_bool ready;              ///< 槽位已填充完毕，可被采集
+};
+
+static struct metrics_slot_s s_slots[METRICS_MAX_METRICS];
+static atomic_uint s_slot_count;
+static _Atomic uint32_t s_buckets[METRICS_MAX_BUCKETS];
+static atomic_uint s_bucket_used;
+
+static bool metrics_str_eq(const char *a, const char *b)
+{
+    if (a == NULL || b == NULL) {
+        return a == b || (a == NULL ? b[0] == '\0' : a[0] == '\0');
+    }
+    return strcmp(a, b) == 0;
+}
+
+static size_t metrics_slot_limit(void)
+{
+    unsigned n = atomic_load_explicit(&s_slot_count, memory_order_acquire);
+    return n < METRICS_MAX_METRICS ? n : METRICS_MAX_METRICS;
+}
+
+/**
+ * @brief 查找同名同标签的已注册指标
+ */
+static struct metrics_slot_s *metrics_find(const metrics_desc_t *desc)
+{
+    size_t n = metrics_slot_limit();
+    for (size_t i = 0; i < n; i++) {
+        struct metrics_slot_s *s = &s_slots[i];
+        if (atomic_load_explicit(&s->ready, memory_order_acquire) &&
+            strcmp(s->desc.name, desc->name) == 0 && metrics_str_eq(s->desc.labels, desc->labels)) {
+            return s;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 占用一个新槽位（或返回已有槽位）
+ *
+ * 同一指标被两个任务同时首次注册时可能占用两个槽位，采集结果会出现重复行；
+ * 注册通常在各组件初始化时进行，不会并发。
+ *
+ * @param desc 指标描述
+ * @param type 指标类型
+ * @param out_slot 输出槽位
+ * @param out_existing 是否为已有槽位
+ */
+static esp_err_t metrics_claim(const metrics_desc_t *desc, metrics_type_t type,
+                               struct metrics_slot_s **out_slot, bool *out_existing)
+{
+    if (desc == NULL || desc->name == NULL || desc->name[0] == '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct metrics_slot_s *found = metrics_find(desc);
+    if (found != NULL) {
+        if (found->type != type) {
+            ESP_LOGE(TAG, "metric %s registered with another type", desc->name);
+            return ESP_ERR_INVALID_STATE;
+        }
+        *out_slot = found;
+        *out_existing = true;
+        return ESP_OK;
+    }
+
+    unsigned idx = atomic_fetch_add_explicit(&s_slot_count, 1, memory_order_relaxed);
+    if (idx >= METRICS_MAX_METRICS) {
+        ESP_LOGE(TAG, "no metric slot for %s", desc->name);
+        return ESP_ERR_NO_MEM;
+    }
+
+    struct metrics_slot_s *s = &s_slots[idx];
+    s->desc = *desc;
+    s->type = type;
+    *out_slot = s;
+    *out_existing = false;
+    return ESP_OK;
+}
+
+static void metrics_publish(struct metrics_slot_s *s)
+{
+    atomic_store_explicit(&s->ready, true, memory_order_release);
+}
+
+esp_err_t metrics_register_counter(const metrics_desc_t *desc, metrics_handle_t *out_handle)
+{
+    if (out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_handle = NULL;
+
+    struct metrics_slot_s *s;
+    bool existing;
+    esp_err_t ret = metrics_claim(desc, METRICS_TYPE_COUNTER, &s, &existing);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (!existing) {
+        metrics_publish(s);
+    }
+    *out_handle = s;
+    return ESP_OK;
+}
+
+esp_err_t metrics_register_gauge(const metrics_desc_t *desc, metrics_handle_t *out_handle)
+{
+    if (out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_handle = NULL;
+
+    struct metrics_slot_s *s;
+    bool existing;
+    esp_err_t ret = metrics_claim(desc, METRICS_TYPE_GAUGE, &s, &existing);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (!existing) {
+        metrics_publish(s);
+    }
+    *out_handle = s;
+    return ESP_OK;
+}
+
+esp_err_t metrics_register_histogram(const metrics_desc_t *desc, const int32_t *bounds, size_t bound_count,
+                                     metrics_handle_t *out_handle)
+{
+    if (out_handle == NULL || bounds == NULL || bound_count == 0 || bound_count > METRICS_MAX_HIST_BOUNDS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 1; i < bound_count; i++) {
+        if (bounds[i] <= bounds[i - 1]) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    *out_handle = NULL;
+
+    struct metrics_slot_s *s;
+    bool existing;
+    esp_err_t ret = metrics_claim(desc, METRICS_TYPE_HISTOGRAM, &s, &existing);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (!existing) {
+        unsigned first = atomic_fetch_add_explicit(&s_bucket_used, (unsigned)bound_count + 1,
+                                                   memory_order_relaxed);
+        if (first + bound_count + 1 > METRICS_MAX_BUCKETS) {
+            /* 槽位不发布，采集时跳过 */
+            ESP_LOGE(TAG, "no histogram bucket for %s", desc->name);
+            return ESP_ERR_NO_MEM;
+        }
+        s->bounds = bounds;
+        s->bound_count = (uint8_t)bound_count;
+        s->buckets = &s_buckets[first];
+        metrics_publish(s);
+    }
+    *out_handle = s;
+    return ESP_OK;
+}
+
+esp_err_t metrics_register_callback(const metrics_desc_t *desc, metrics_type_t type,
+                                    metrics_read_fn read, void *ctx)
+{
+    if (read == NULL || (type != METRICS_TYPE_COUNTER && type != METRICS_TYPE_GAUGE)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct metrics_slot_s *s;
+    bool existing;
+    esp_err_t ret = metrics_claim(desc, type, &s, &existing);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (!existing) {
+        s->read = read;
+        s->ctx = ctx;
+        metrics_publish(s);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 64 位累加（拆分为两个 32 位原子加）
+ */
+static void metrics_add64(struct metrics_slot_s *s, uint32_t delta, bool negative)
+{
+    uint32_t old = atomic_fetch_add_explicit(&s->lo, delta, memory_order_relaxed);
+    /* 低位进位；负数按符号扩展，高位再加 0xFFFFFFFF */
+    uint32_t hi_add = ((uint32_t)(old + delta) < old ? 1u : 0u) + (negative ? UINT32_MAX : 0u);
+    if (hi_add != 0) {
+        atomic_fetch_add_explicit(&s->hi, hi_add, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief 64 位读取：高位在读低位前后一致才返回（进位尚未补上的窗口见文件头说明）
+ */
+static uint64_t metrics_read64(struct metrics_slot_s *s)
+{
+    uint32_t hi, lo;
+    do {
+        hi = atomic_load_explicit(&s->hi, memory_order_relaxed);
+        lo = atomic_load_explicit(&s->lo, memory_order_relaxed);
+    } while (hi != atomic_load_explicit(&s->hi, memory_order_relaxed));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+void metrics_counter_add(metrics_handle_t handle, uint32_t delta)
+{
+    if (handle != NULL) {
+        metrics_add64(handle, delta, false);
+    }
+}
+
+void metrics_gauge_set(metrics_handle_t handle, int32_t value)
+{
+    if (handle != NULL) {
+        atomic_store_explicit(&handle->lo, (uint32_t)value, memory_order_relaxed);
+    }
+}
+
+void metrics_gauge_add(metrics_handle_t handle, int32_t delta)
+{
+    if (handle != NULL) {
+        atomic_fetch_add_explicit(&handle->lo, (uint32_t)delta, memory_order_relaxed);
+    }
+}
+
+void metrics_histogram_observe(metrics_handle_t handle, int32_t value)
+{
+    if (handle == NULL) {
+        return;
+    }
+    size_t i = 0;
+    while (i < handle->bound_count && value > handle->bounds[i]) {
+        i++;
+    }
+    atomic_fetch_add_explicit(&handle->buckets[i], 1, memory_order_relaxed);
+    metrics_add64(handle, (uint32_t)value, value < 0);
+}
+
+/**
+ * @brief 填充单个指标的快照
+ */
+static void metrics_snapshot(struct metrics_slot_s *s, metrics_sample_t *sample, uint32_t *cumulative)
+{
+    if (s->read != NULL) {
+        sample->value = s->read(s->ctx);
+    } else if (s->type == METRICS_TYPE_COUNTER) {
+        sample->value = (int64_t)metrics_read64(s);
+    } else if (s->type == METRICS_TYPE_GAUGE) {
+        sample->value = (int32_t)atomic_load_explicit(&s->lo, memory_order_relaxed);
+    } else {
+        uint64_t count = 0;
+        for (size_t b = 0; b <= s->bound_count; b++) {
+            count += atomic_load_explicit(&s->buckets[b], memory_order_relaxed);
+            cumulative[b] = (uint32_t)count;
+        }
+        sample->sum = (int64_t)metrics_read64(s);
+        sample->count = count;
+        sample->bound_count = s->bound_count;
+        sample->bounds = s->bounds;
+        sample->buckets = cumulative;
+    }
+}
+
+static bool metrics_slot_ready(size_t i)
+{
+    return atomic_load_explicit(&s_slots[i].ready, memory_order_acquire);
+}
+
+/**
+ * @brief 按指标族遍历：同名指标连续输出（Prometheus 文本格式要求同族样本成组）
+ *
+ * 指标数很少（<= METRICS_MAX_METRICS），采集时的 O(n^2) 名字比较可以忽略。
+ */
+size_t metrics_foreach(metrics_visit_fn visit, void *ctx)
+{
+    if (visit == NULL) {
+        return 0;
+    }
+
+    uint32_t cumulative[METRICS_MAX_HIST_BOUNDS + 1];
+    size_t n = metrics_slot_limit();
+    size_t visited = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!metrics_slot_ready(i)) {
+            continue;
+        }
+        const char *family = s_slots[i].desc.name;
+        bool seen = false;
+        for (size_t j = 0; j < i && !seen; j++) {
+            seen = metrics_slot_ready(j) && strcmp(s_slots[j].desc.name, family) == 0;
+        }
+        if (seen) {
+            continue;
+        }
+
+        for (size_t j = i; j < n; j++) {
+            struct metrics_slot_s *s = &s_slots[j];
+            if (!metrics_slot_ready(j) || strcmp(s->desc.name, family) != 0) {
+                continue;
+            }
+            metrics_sample_t sample = {
+                .desc = &s->desc,
+                .type = s->type,
+                .first_of_family = (j == i),
+            };
+            metrics_snapshot(s, &sample, cumulative);
+            visit(&sample, ctx);
+            visited++;
+        }
+    }
+    return visited;
+}
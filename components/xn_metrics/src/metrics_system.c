@@ -0,0 +1,115 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-15
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-15
+ * @FilePath: \xn_voice_wake_up\components\xn_metrics\src\metrics_system.c
+ * @Description: 系统指标实现（全部为回调型，采集时读取）
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#include "metrics_system.h"
+#include "metrics_registry.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdint.h>
+
+#define METRICS_CAPS_INTERNAL   ((void *)(uintptr_t)MALLOC_CAP_INTERNAL)
+#define METRICS_CAPS_PSRAM      ((void *)(uintptr_t)MALLOC_CAP_SPIRAM)
+
+static int64_t read_heap_free(void *ctx)
+{
+    return (int64_t)heap_caps_get_free_size((uint32_t)(uintptr_t)ctx);
+}
+
+static int64_t read_heap_largest(void *ctx)
+{
+    return (int64_t)heap_caps_get_largest_free_block((uint32_t)(uintptr_t)ctx);
+}
+
+static int64_t read_heap_min_free(void *ctx)
+{
+    return (int64_t)heap_caps_get_minimum_free_size((uint32_t)(uintptr_t)ctx);
+}
+
+static int64_t read_uptime(void *ctx)
+{
+    (void)ctx;
+    return esp_timer_get_time() / 1000000;
+}
+
+static int64_t read_task_count(void *ctx)
+{
+    (void)ctx;
+    return (int64_t)uxTaskGetNumberOfTasks();
+}
+
+#if (configGENERATE_RUN_TIME_STATS == 1)
+static int64_t read_idle_runtime(void *ctx)
+{
+    TaskHandle_t idle = xTaskGetIdleTaskHandleForCore((BaseType_t)(intptr_t)ctx);
+    return (int64_t)ulTaskGetRunTimeCounter(idle);
+}
+
+static int64_t read_total_runtime(void *ctx)
+{
+    (void)ctx;
+    return (int64_t)(uint32_t)portGET_RUN_TIME_COUNTER_VALUE();
+}
+#endif
+
+esp_err_t metrics_system_register(void)
+{
+    static const metrics_desc_t heap_free_int = {
+        "xn_heap_free_bytes", "caps=\"internal\"", "Free heap bytes"};
+    static const metrics_desc_t heap_free_psram = {
+        "xn_heap_free_bytes", "caps=\"psram\"", "Free heap bytes"};
+    static const metrics_desc_t heap_largest_int = {
+        "xn_heap_largest_free_block_bytes", "caps=\"internal\"", "Largest free heap block (fragmentation)"};
+    static const metrics_desc_t heap_largest_psram = {
+        "xn_heap_largest_free_block_bytes", "caps=\"psram\"", "Largest free heap block (fragmentation)"};
+    static const metrics_desc_t heap_min_int = {
+        "xn_heap_min_free_bytes", "caps=\"internal\"", "Minimum free heap bytes since boot"};
+    static const metrics_desc_t uptime = {
+        "xn_uptime_seconds", NULL, "Seconds since boot"};
+    static const metrics_desc_t tasks = {
+        "xn_task_count", NULL, "Number of FreeRTOS tasks"};
+
+    esp_err_t ret = ESP_OK;
+    esp_err_t r;
+#define METRICS_SYSTEM_ADD(desc, type, fn, ctx)                         \
+    do {                                                                \
+        r = metrics_register_callback(&(desc), (type), (fn), (ctx));    \
+        if (r != ESP_OK) ret = r;                                       \
+    } while (0)
+
+    METRICS_SYSTEM_ADD(heap_free_int, METRICS_TYPE_GAUGE, read_heap_free, METRICS_CAPS_INTERNAL);
+    METRICS_SYSTEM_ADD(heap_free_psram, METRICS_TYPE_GAUGE, read_heap_free, METRICS_CAPS_PSRAM);
+    METRICS_SYSTEM_ADD(heap_largest_int, METRICS_TYPE_GAUGE, read_heap_largest, METRICS_CAPS_INTERNAL);
+    METRICS_SYSTEM_ADD(heap_largest_psram, METRICS_TYPE_GAUGE, read_heap_largest, METRICS_CAPS_PSRAM);
+    METRICS_SYSTEM_ADD(heap_min_int, METRICS_TYPE_GAUGE, read_heap_min_free, METRICS_CAPS_INTERNAL);
+    METRICS_SYSTEM_ADD(uptime, METRICS_TYPE_GAUGE, read_uptime, NULL);
+    METRICS_SYSTEM_ADD(tasks, METRICS_TYPE_GAUGE, read_task_count, NULL);
+
+#if (configGENERATE_RUN_TIME_STATS == 1)
+    static const metrics_desc_t idle_core0 = {
+        "xn_cpu_idle_us_total", "core=\"0\"", "Idle task run time (wraps at 2^32)"};
+    static const metrics_desc_t idle_core1 = {
+        "xn_cpu_idle_us_total", "core=\"1\"", "Idle task run time (wraps at 2^32)"};
+    static const metrics_desc_t runtime = {
+        "xn_cpu_runtime_us_total", NULL, "Run time counter (wraps at 2^32)"};
+
+    METRICS_SYSTEM_ADD(idle_core0, METRICS_TYPE_COUNTER, read_idle_runtime, (void *)(intptr_t)0);
+#if (portNUM_PROCESSORS > 1)
+    METRICS_SYSTEM_ADD(idle_core1, METRICS_TYPE_COUNTER, read_idle_runtime, (void *)(intptr_t)1);
+#else
+    (void)idle_core1;
+#endif
+    METRICS_SYSTEM_ADD(runtime, METRICS_TYPE_COUNTER, read_total_runtime, NULL);
+#endif
+
+#undef METRICS_SYSTEM_ADD
+    return ret;
+}
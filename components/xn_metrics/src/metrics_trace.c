@@ -0,0 +1,358 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-16
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-16
+ * @FilePath: \xn_voice_wake_up\components\xn_metrics\src\metrics_trace.c
+ * @Description: 时间线追踪实现
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#include "metrics_trace.h"
+#include "esp_log.h"
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#endif
+
+static const char *TAG = "METRICS_TRACE";
+
+#define TRACE_RING_MASK     (METRICS_TRACE_EVENTS_PER_CORE - 1)
+#define TRACE_TASK_NAME_LEN 16
+#define TRACE_TASK_OTHER    0xFFFF      ///< 任务表已满时使用的任务序号
+#define TRACE_OUT_BUF_SIZE  512
+#define TRACE_OUT_FLUSH_AT  256
+
+_Static_assert((METRICS_TRACE_EVENTS_PER_CORE & TRACE_RING_MASK) == 0,
+               "METRICS_TRACE_EVENTS_PER_CORE must be a power of two");
+
+/*
+ * 槽位按序号发布：写入者先把 seq 清零，填充字段后以 release 写入 "写入序号 + 1"；
+ * 导出时 seq 前后两次读取一致且等于期望序号，才认为读到的是完整的那一次写入。
+ */
+typedef struct {
+    _Atomic uint32_t seq;           ///< 写入序号 + 1，0 表示空或正在写入
+    int64_t ts_us;                  ///< 时间戳（微秒）
+    const char *cat;                ///< 分类
+    const char *name;               ///< 事件名
+    int32_t value;                  ///< 计数器取值
+    uint16_t task;                  ///< 任务表序号
+    uint8_t phase;                  ///< metrics_trace_phase_t
+    uint8_t core;                   ///< 记录时所在核心
+} trace_event_t;
+
+typedef struct {
+    _Atomic uint32_t head;          ///< 下一个写入序号
+    trace_event_t events[METRICS_TRACE_EVENTS_PER_CORE];
+} trace_ring_t;
+
+typedef struct {
+    atomic_uintptr_t handle;        ///< 任务句柄，0 表示尚未发布
+    char name[TRACE_TASK_NAME_LEN]; ///< 任务名副本（已替换掉 JSON 特殊字符）
+} trace_task_t;
+
+static trace_ring_t s_rings[METRICS_TRACE_MAX_CORES];
+static trace_task_t s_tasks[METRICS_TRACE_MAX_TASKS];
+static atomic_uint s_task_count;
+static atomic_bool s_enabled;
+static atomic_uint s_writers;           ///< 正在写入槽位的记录数
+
+/* -------------------- 平台相关 -------------------- */
+
+static int64_t trace_now_us(void)
+{
+#if defined(ESP_PLATFORM)
+    return esp_timer_get_time();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+static unsigned trace_core_id(void)
+{
+#if defined(ESP_PLATFORM)
+    return (unsigned)xPortGetCoreID();
+#else
+    return 0;
+#endif
+}
+
+static void trace_yield(void)
+{
+#if defined(ESP_PLATFORM)
+    vTaskDelay(1);
+#else
+    sched_yield();
+#endif
+}
+
+static uintptr_t trace_task_handle(void)
+{
+#if defined(ESP_PLATFORM)
+    return (uintptr_t)xTaskGetCurrentTaskHandle();
+#else
+    return (uintptr_t)pthread_self();
+#endif
+}
+
+static void trace_task_name(uintptr_t handle, unsigned idx, char *out, size_t size)
+{
+#if defined(ESP_PLATFORM)
+    (void)idx;
+    const char *name = pcTaskGetName((TaskHandle_t)handle);
+    strncpy(out, name ? name : "?", size - 1);
+    out[size - 1] = '\0';
+#else
+    (void)handle;
+    snprintf(out, size, "thread-%u", idx);
+#endif
+    /* 任务名原样写入 JSON，去掉需要转义的字符 */
+    for (char *p = out; *p; p++) {
+        if (*p == '"' || *p == '\\' || (unsigned char)*p < 0x20) {
+            *p = '_';
+        }
+    }
+}
+
+/* -------------------- 记录 -------------------- */
+
+/**
+ * @brief 查找（必要时登记）当前任务的序号
+ *
+ * 同一任务的事件是串行记录的，不会出现同一句柄被并发登记两次；
+ * 任务删除后句柄可能被新任务复用，此时沿用旧任务名。
+ */
+static uint16_t trace_task_index(void)
+{
+    uintptr_t handle = trace_task_handle();
+    unsigned n = atomic_load_explicit(&s_task_count, memory_order_acquire);
+    if (n > METRICS_TRACE_MAX_TASKS) {
+        n = METRICS_TRACE_MAX_TASKS;
+    }
+    for (unsigned i = 0; i < n; i++) {
+        if (atomic_load_explicit(&s_tasks[i].handle, memory_order_acquire) == handle) {
+            return (uint16_t)i;
+        }
+    }
+
+    unsigned idx = atomic_fetch_add_explicit(&s_task_count, 1, memory_order_relaxed);
+    if (idx >= METRICS_TRACE_MAX_TASKS) {
+        return TRACE_TASK_OTHER;
+    }
+    trace_task_name(handle, idx, s_tasks[idx].name, sizeof(s_tasks[idx].name));
+    atomic_store_explicit(&s_tasks[idx].handle, handle, memory_order_release);
+    return (uint16_t)idx;
+}
+
+void metrics_trace_start(void)
+{
+    /* 先停止，等已通过开关检查的写入者发布完，再清空，避免清空与写入交错 */
+    metrics_trace_stop();
+    while (atomic_load(&s_writers) != 0) {
+        trace_yield();
+    }
+    for (size_t c = 0; c < METRICS_TRACE_MAX_CORES; c++) {
+        for (size_t i = 0; i < METRICS_TRACE_EVENTS_PER_CORE; i++) {
+            atomic_store_explicit(&s_rings[c].events[i].seq, 0, memory_order_relaxed);
+        }
+        atomic_store_explicit(&s_rings[c].head, 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&s_enabled, true, memory_order_release);
+    ESP_LOGI(TAG, "trace started (%d events per core)", METRICS_TRACE_EVENTS_PER_CORE);
+}
+
+void metrics_trace_stop(void)
+{
+    atomic_store(&s_enabled, false);
+}
+
+bool metrics_trace_is_enabled(void)
+{
+    return atomic_load_explicit(&s_enabled, memory_order_relaxed);
+}
+
+void metrics_trace_record(metrics_trace_phase_t phase, const char *cat, const char *name, int32_t value)
+{
+    if (!atomic_load_explicit(&s_enabled, memory_order_relaxed) || name == NULL) {
+        return;
+    }
+    /* 先登记为写入者再复查开关（均为 seq_cst），与 metrics_trace_start 的 "停止后等待" 配对 */
+    atomic_fetch_add(&s_writers, 1);
+    if (!atomic_load(&s_enabled)) {
+        atomic_fetch_sub(&s_writers, 1);
+        return;
+    }
+
+    unsigned core = trace_core_id();
+    uint16_t task = trace_task_index();
+    trace_ring_t *ring = &s_rings[core % METRICS_TRACE_MAX_CORES];
+    uint32_t idx = atomic_fetch_add_explicit(&ring->head, 1, memory_order_relaxed);
+    trace_event_t *ev = &ring->events[idx & TRACE_RING_MASK];
+
+    atomic_store_explicit(&ev->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    ev->ts_us = trace_now_us();
+    ev->cat = cat;
+    ev->name = name;
+    ev->value = value;
+    ev->task = task;
+    ev->phase = (uint8_t)phase;
+    ev->core = (uint8_t)core;
+    atomic_store_explicit(&ev->seq, idx + 1, memory_order_release);
+    atomic_fetch_sub_explicit(&s_writers, 1, memory_order_release);
+}
+
+/* -------------------- 导出 -------------------- */
+
+typedef struct {
+    metrics_trace_write_fn write;
+    void *ctx;
+    esp_err_t err;
+    size_t len;
+    char buf[TRACE_OUT_BUF_SIZE];
+} trace_out_t;
+
+static void trace_out_flush(trace_out_t *out)
+{
+    if (out->len > 0 && out->err == ESP_OK) {
+        out->err = out->write(out->ctx, out->buf, out->len);
+    }
+    out->len = 0;
+}
+
+static void trace_out_printf(trace_out_t *out, const char *fmt, ...)
+{
+    if (out->err != ESP_OK) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(out->buf + out->len, sizeof(out->buf) - out->len, fmt, ap);
+    va_end(ap);
+    if (n < 0) {
+        out->err = ESP_FAIL;
+        return;
+    }
+    if ((size_t)n >= sizeof(out->buf) - out->len) {
+        /* 放不下：先发送已有内容再重写（单条事件远小于缓冲区） */
+        trace_out_flush(out);
+        va_start(ap, fmt);
+        n = vsnprintf(out->buf, sizeof(out->buf), fmt, ap);
+        va_end(ap);
+        if (n < 0 || (size_t)n >= sizeof(out->buf)) {
+            out->err = ESP_ERR_INVALID_SIZE;
+            return;
+        }
+    }
+    out->len += (size_t)n;
+    if (out->len >= TRACE_OUT_FLUSH_AT) {
+        trace_out_flush(out);
+    }
+}
+
+/**
+ * @brief 任务序号转为 Chrome trace 的 tid（0 留给任务表满后的其他任务）
+ */
+static unsigned trace_tid(uint16_t task)
+{
+    return task == TRACE_TASK_OTHER ? 0 : (unsigned)task + 1;
+}
+
+static void trace_dump_event(trace_out_t *out, const trace_event_t *ev, bool *first)
+{
+    trace_out_printf(out, "%s\n{\"ph\":\"%c\",\"name\":\"%s\",\"cat\":\"%s\",\"pid\":0,\"tid\":%u,"
+                     "\"ts\":%" PRId64, *first ? "" : ",", ev->phase, ev->name,
+                     ev->cat ? ev->cat : "", trace_tid(ev->task), ev->ts_us);
+    *first = false;
+    if (ev->phase == METRICS_TRACE_COUNTER) {
+        trace_out_printf(out, ",\"args\":{\"value\":%" PRId32 "}}", ev->value);
+    } else if (ev->phase == METRICS_TRACE_INSTANT) {
+        trace_out_printf(out, ",\"s\":\"t\",\"args\":{\"core\":%u}}", (unsigned)ev->core);
+    } else {
+        trace_out_printf(out, ",\"args\":{\"core\":%u}}", (unsigned)ev->core);
+    }
+}
+
+esp_err_t metrics_trace_dump(metrics_trace_write_fn write, void *ctx)
+{
+    if (write == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    trace_out_t out = {.write = write, .ctx = ctx, .err = ESP_OK, .len = 0};
+    bool first = true;
+    trace_out_printf(&out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    /* 轨道名 */
+    unsigned n = atomic_load_explicit(&s_task_count, memory_order_acquire);
+    for (unsigned i = 0; i < n && i < METRICS_TRACE_MAX_TASKS; i++) {
+        if (atomic_load_explicit(&s_tasks[i].handle, memory_order_acquire) == 0) {
+            continue;
+        }
+        trace_out_printf(&out, "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":%u,"
+                         "\"args\":{\"name\":\"%s\"}}", first ? "" : ",", i + 1, s_tasks[i].name);
+        first = false;
+    }
+    if (n > METRICS_TRACE_MAX_TASKS) {
+        trace_out_printf(&out, "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":0,"
+                         "\"args\":{\"name\":\"other\"}}", first ? "" : ",");
+        first = false;
+    }
+
+    /* 各核心从最旧的保留事件开始输出，查看器会按时间戳排序 */
+    for (size_t c = 0; c < METRICS_TRACE_MAX_CORES && out.err == ESP_OK; c++) {
+        trace_ring_t *ring = &s_rings[c];
+        uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        uint32_t start = head > METRICS_TRACE_EVENTS_PER_CORE ? head - METRICS_TRACE_EVENTS_PER_CORE : 0;
+        for (uint32_t idx = start; idx != head && out.err == ESP_OK; idx++) {
+            trace_event_t *slot = &ring->events[idx & TRACE_RING_MASK];
+            if (atomic_load_explicit(&slot->seq, memory_order_acquire) != idx + 1) {
+                continue;
+            }
+            trace_event_t ev;
+            ev.ts_us = slot->ts_us;
+            ev.cat = slot->cat;
+            ev.name = slot->name;
+            ev.value = slot->value;
+            ev.task = slot->task;
+            ev.phase = slot->phase;
+            ev.core = slot->core;
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&slot->seq, memory_order_relaxed) != idx + 1) {
+                continue;
+            }
+            trace_dump_event(&out, &ev, &first);
+        }
+    }
+
+    trace_out_printf(&out, "\n]}\n");
+    trace_out_flush(&out);
+    return out.err;
+}
+
+static esp_err_t trace_stdio_write(void *ctx, const char *data, size_t len)
+{
+    return fwrite(data, 1, len, (FILE *)ctx) == len ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t metrics_trace_dump_stdio(FILE *fp)
+{
+    if (fp == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = metrics_trace_dump(trace_stdio_write, fp);
+    fflush(fp);
+    return err;
+}
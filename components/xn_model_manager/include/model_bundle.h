@@ -0,0 +1,145 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-12
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-12
+ * @FilePath: \xn_voice_wake_up\components\xn_model_manager\include\model_bundle.h
+ * @Description: 模型包格式 - 版本化、带哈希的 KWS 模型包（权重 / 量化参数 / DSP 配置 / 标签 / 阈值）
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include "esp_err.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 模型包布局（小端序），由 ota_server/tools/xn_model_bundle.py 生成：
+ *
+ *   头部 64 字节：magic "XNMB" | u16 format_version | u16 section_count | u32 payload_size
+ *                 payload_sha256[32] | model_version[16] | u32 reserved
+ *   段表：section_count 个 { u16 type | u16 flags | u32 offset | u32 size }，offset 相对负载起点
+ *   负载：各段数据，WEIGHTS 段按 16 字节对齐（TFLM 要求）
+ *
+ * payload_sha256 覆盖段表和负载（头部之后的全部字节）。
+ * GRAPH 段记录导出权重时 EON 编译模型的常量张量布局指纹，绑定权重前与编译模型比对。
+ */
+#define MODEL_BUNDLE_MAGIC              "XNMB"
+#define MODEL_BUNDLE_FORMAT_VERSION     1
+#define MODEL_BUNDLE_HEADER_SIZE        64
+#define MODEL_BUNDLE_SECTION_SIZE       12
+#define MODEL_BUNDLE_VERSION_LEN        16
+#define MODEL_BUNDLE_SHA256_LEN         32
+#define MODEL_BUNDLE_MAX_LABELS         8
+#define MODEL_BUNDLE_WEIGHTS_ALIGN      16
+
+/** 段类型 */
+typedef enum {
+    MODEL_SECTION_WEIGHTS = 1,      ///< 模型权重（TFLite flatbuffer 或编译模型的常量表）
+    MODEL_SECTION_QUANT = 2,        ///< 输入 / 输出量化参数
+    MODEL_SECTION_DSP = 3,          ///< MFCC 特征提取配置
+    MODEL_SECTION_LABELS = 4,       ///< 标签（u32 数量 + '\0' 结尾字符串）
+    MODEL_SECTION_THRESHOLD = 5,    ///< 唤醒阈值（float）
+    MODEL_SECTION_GRAPH = 6,        ///< 权重对应的计算图指纹（u32，可选）
+} model_section_type_t;
+
+/** 量化参数段 */
+typedef struct {
+    float input_scale;              ///< 输入量化 scale
+    int32_t input_zero_point;       ///< 输入量化零点
+    float output_scale;             ///< 输出量化 scale
+    int32_t output_zero_point;      ///< 输出量化零点
+} model_quant_params_t;
+
+/** MFCC 配置段（字段与 ei_dsp_config_mfcc_t 对应） */
+typedef struct {
+    uint32_t num_cepstral;          ///< 倒谱系数个数
+    float frame_length;             ///< 帧长（秒）
+    float frame_stride;             ///< 帧移（秒）
+    uint32_t num_filters;           ///< 滤波器个数
+    uint32_t fft_length;            ///< FFT 长度
+    uint32_t win_size;              ///< 归一化窗口大小
+    uint32_t low_frequency;         ///< 最低频率
+    uint32_t high_frequency;        ///< 最高频率（0 表示采样率一半）
+    float pre_cof;                  ///< 预加重系数
+    uint32_t pre_shift;             ///< 预加重移位
+} model_dsp_params_t;
+
+/** 解析后的模型包（所有指针指向原始数据，不拷贝） */
+typedef struct {
+    char version[MODEL_BUNDLE_VERSION_LEN + 1];     ///< 模型版本
+    const uint8_t *weights;                         ///< 权重数据（16 字节对齐）
+    size_t weights_size;                            ///< 权重大小
+    model_quant_params_t quant;                     ///< 量化参数
+    model_dsp_params_t dsp;                         ///< DSP 配置
+    const char *labels[MODEL_BUNDLE_MAX_LABELS];    ///< 标签
+    size_t label_count;                             ///< 标签数量
+    float threshold;                                ///< 唤醒阈值
+    uint32_t graph_fingerprint;                     ///< 计算图指纹（无 GRAPH 段时为 0，不能绑定到 EON 编译模型）
+    size_t total_size;                              ///< 模型包总大小（头部 + 负载）
+} model_bundle_t;
+
+/** 模型包头部信息 */
+typedef struct {
+    size_t total_size;                              ///< 模型包总大小（头部 + 负载）
+    uint8_t payload_sha256[MODEL_BUNDLE_SHA256_LEN];///< 负载摘要
+    char version[MODEL_BUNDLE_VERSION_LEN + 1];     ///< 模型版本
+} model_bundle_header_t;
+
+/**
+ * @brief 只解析模型包头部（用于流式写入后的校验）
+ * @param header 至少 MODEL_BUNDLE_HEADER_SIZE 字节
+ * @param out 输出头部信息
+ * @return ESP_OK 成功，ESP_ERR_INVALID_VERSION 魔数或格式版本不符
+ */
+esp_err_t model_bundle_read_header(const uint8_t *header, model_bundle_header_t *out);
+
+/**
+ * @brief 解析并校验模型包
+ * @param data 模型包数据（需保持有效，bundle 中的指针指向它）
+ * @param len 数据长度
+ * @param verify_hash 是否校验 payload_sha256
+ * @param out 解析结果
+ * @return
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_VERSION: 魔数或格式版本不符
+ *   - ESP_ERR_INVALID_SIZE: 长度或段越界
+ *   - ESP_ERR_INVALID_CRC: 哈希不一致
+ *   - ESP_ERR_NOT_FOUND: 缺少必需段
+ */
+esp_err_t model_bundle_parse(const uint8_t *data, size_t len, bool verify_hash, model_bundle_t *out);
+
+#if !defined(ESP_PLATFORM)
+/** 主机端文件映射（设备端由 model_store 通过 esp_partition_mmap 映射） */
+typedef struct {
+    const void *addr;               ///< 映射起始地址
+    size_t size;                    ///< 映射长度
+} model_bundle_mapping_t;
+
+/**
+ * @brief 主机端：mmap() 只读映射模型包文件并解析（与设备端同样零拷贝）
+ * @param path 模型包路径
+ * @param verify_hash 是否校验 payload_sha256
+ * @param out_map 输出映射，使用完后调用 model_bundle_unmap_file()
+ * @param out 解析结果（指针在解除映射前有效）
+ * @return ESP_OK 成功，ESP_ERR_NOT_FOUND 文件无法打开，其他值同 model_bundle_parse()
+ */
+esp_err_t model_bundle_map_file(const char *path, bool verify_hash,
+                                model_bundle_mapping_t *out_map, model_bundle_t *out);
+
+/**
+ * @brief 主机端：解除模型包文件映射
+ * @param map 映射
+ */
+void model_bundle_unmap_file(model_bundle_mapping_t *map);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
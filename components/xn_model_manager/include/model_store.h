@@ -0,0 +1,148 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-12
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-12
+ * @FilePath: \xn_voice_wake_up\components\xn_model_manager\include\model_store.h
+ * @Description: 模型存储 - kws_a / kws_b 双槽模型分区，独立于固件的模型升级与回滚
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include "esp_err.h"
+#include "model_bundle.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODEL_STORE_PARTITION_SUBTYPE   0x40        ///< partitions.csv 中模型分区的 data 子类型
+#define MODEL_STORE_PARTITION_A         "kws_a"     ///< 槽 A 分区名
+#define MODEL_STORE_PARTITION_B         "kws_b"     ///< 槽 B 分区名
+#define MODEL_STORE_MAX_PENDING_BOOTS   2           ///< 新模型未确认时允许的最大加载次数，超过后自动回滚
+
+/** 模型槽 */
+typedef enum {
+    MODEL_SLOT_NONE = -1,           ///< 无可用模型
+    MODEL_SLOT_A = 0,               ///< 槽 A
+    MODEL_SLOT_B = 1,               ///< 槽 B
+} model_slot_t;
+
+/** 模型存储状态 */
+typedef struct {
+    model_slot_t active;                            ///< 当前生效的槽
+    bool pending;                                   ///< 新模型尚未确认（model_store_mark_valid）
+    char version[MODEL_BUNDLE_VERSION_LEN + 1];     ///< 当前模型版本，无模型时为空串
+    size_t size;                                    ///< 当前模型包大小
+    char previous_version[MODEL_BUNDLE_VERSION_LEN + 1]; ///< 可回滚的上一版本，无则为空串
+} model_store_info_t;
+
+/** 模型加载统计（冷启动开销） */
+typedef struct {
+    uint32_t map_us;                ///< 映射 + 解析耗时（微秒）
+    size_t mapped_bytes;            ///< 映射的 flash 字节数（不占用 RAM）
+    size_t heap_bytes;              ///< 加载过程占用的堆内存
+    bool verified;                  ///< 是否做了整包摘要校验（仅待确认期间）
+} model_store_load_stats_t;
+
+/** 模型更新会话句柄 */
+typedef struct model_store_update_s *model_store_update_handle_t;
+
+/**
+ * @brief 初始化模型存储（查找分区、读取 NVS 状态）
+ * @return ESP_OK 成功，ESP_ERR_NOT_FOUND 分区表中没有模型分区
+ * @note 需在 nvs_flash_init() 之后调用，可重复调用
+ */
+esp_err_t model_store_init(void);
+
+/**
+ * @brief 获取模型存储状态
+ * @param out_info 输出状态
+ * @return ESP_OK 成功
+ */
+esp_err_t model_store_get_info(model_store_info_t *out_info);
+
+/**
+ * @brief 开始写入新模型（写入非活动槽）
+ * @param size 模型包总大小
+ * @param sha256 整个模型包的 SHA-256，可为 NULL（此时只校验包内摘要）
+ * @param out_handle 输出会话句柄
+ * @return ESP_OK 成功，ESP_ERR_INVALID_SIZE 超出分区大小，
+ *         ESP_ERR_INVALID_STATE 目标槽仍被映射（上次更新后尚未重新加载）
+ */
+esp_err_t model_store_begin_update(size_t size, const uint8_t *sha256,
+                                   model_store_update_handle_t *out_handle);
+
+/**
+ * @brief 顺序写入模型数据
+ * @param handle 会话句柄
+ * @param data 数据
+ * @param len 长度
+ * @return ESP_OK 成功
+ */
+esp_err_t model_store_write(model_store_update_handle_t handle, const void *data, size_t len);
+
+/**
+ * @brief 完成写入：校验摘要和包格式，切换活动槽并标记为待确认
+ * @param handle 会话句柄（调用后失效）
+ * @return ESP_OK 成功，ESP_ERR_INVALID_CRC 摘要不一致，其他值为包格式错误
+ * @note 新模型在下一次 model_store_load() 时生效
+ */
+esp_err_t model_store_finish_update(model_store_update_handle_t handle);
+
+/**
+ * @brief 放弃写入
+ * @param handle 会话句柄（调用后失效）
+ */
+void model_store_abort_update(model_store_update_handle_t handle);
+
+/**
+ * @brief 加载活动槽中的模型
+ *
+ * 通过 esp_partition_mmap() 把模型包映射到数据地址空间，out_bundle 中的权重指针
+ * 直接指向 flash，可作为 TFLM kTfLiteMmapRo 张量的数据，RAM 中只需保留激活值 arena。
+ * 待确认的模型连续加载超过 MODEL_STORE_MAX_PENDING_BOOTS 次仍未确认，
+ * 或模型包解析失败时，自动回滚到上一槽位。
+ *
+ * @note 回滚依赖推理端在启动时调用本函数、首次推理成功后调用 model_store_mark_valid()。
+ *       当前固件的唤醒词识别在云端完成，没有本地推理端调用这两个接口，
+ *       模型包只会被下载、校验并切换活动槽，待确认计数不会增加，也不会自动回滚。
+ *
+ * @param out_bundle 输出解析结果（指针在 model_store_unload() 前有效）
+ * @return ESP_OK 成功，ESP_ERR_NOT_FOUND 没有可用模型
+ */
+esp_err_t model_store_load(model_bundle_t *out_bundle);
+
+/**
+ * @brief 解除 model_store_load() 建立的映射
+ */
+void model_store_unload(void);
+
+/**
+ * @brief 获取最近一次加载的统计信息
+ * @param out_stats 输出统计
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 当前没有已加载的模型
+ */
+esp_err_t model_store_get_load_stats(model_store_load_stats_t *out_stats);
+
+/**
+ * @brief 确认当前模型可用（首次成功推理后调用）
+ * @return ESP_OK 成功
+ * @note 当前固件中尚无调用方，见 model_store_load() 的说明
+ */
+esp_err_t model_store_mark_valid(void);
+
+/**
+ * @brief 回滚到上一槽位的模型
+ * @return ESP_OK 成功，ESP_ERR_NOT_FOUND 没有可回滚的模型
+ * @note 已加载的模型不受影响，下一次 model_store_load() 时生效
+ */
+esp_err_t model_store_rollback(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,264 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-12
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-12
+ * @FilePath: \xn_voice_wake_up\components\xn_model_manager\src\model_bundle.c
+ * @Description: 模型包解析实现
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#include "model_bundle.h"
+#include "esp_log.h"
+#include "mbedtls/sha256.h"
+#include <string.h>
+
+#if !defined(ESP_PLATFORM)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char *TAG = "MODEL_BUNDLE";
+
+/* 头部字段偏移 */
+#define HDR_OFF_FORMAT      4
+#define HDR_OFF_SECTIONS    6
+#define HDR_OFF_PAYLOAD     8
+#define HDR_OFF_SHA         12
+#define HDR_OFF_VERSION     44
+
+/* 各固定段的大小 */
+#define QUANT_SECTION_SIZE      16
+#define DSP_SECTION_SIZE        40
+#define THRESHOLD_SECTION_SIZE  4
+#define GRAPH_SECTION_SIZE      4
+
+static uint16_t rd_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t rd_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static float rd_f32(const uint8_t *p)
+{
+    uint32_t v = rd_u32(p);
+    float f;
+    memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+esp_err_t model_bundle_read_header(const uint8_t *header, model_bundle_header_t *out)
+{
+    if (header == NULL || out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (memcmp(header, MODEL_BUNDLE_MAGIC, 4) != 0 ||
+        rd_u16(header + HDR_OFF_FORMAT) != MODEL_BUNDLE_FORMAT_VERSION) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    out->total_size = MODEL_BUNDLE_HEADER_SIZE + (size_t)rd_u32(header + HDR_OFF_PAYLOAD);
+    memcpy(out->payload_sha256, header + HDR_OFF_SHA, MODEL_BUNDLE_SHA256_LEN);
+    memcpy(out->version, header + HDR_OFF_VERSION, MODEL_BUNDLE_VERSION_LEN);
+    out->version[MODEL_BUNDLE_VERSION_LEN] = '\0';
+    return ESP_OK;
+}
+
+/**
+ * @brief 解析标签段：u32 数量 + 连续的 '\0' 结尾字符串
+ */
+static esp_err_t parse_labels(const uint8_t *sec, uint32_t size, model_bundle_t *out)
+{
+    if (size < 4) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint32_t count = rd_u32(sec);
+    if (count == 0 || count > MODEL_BUNDLE_MAX_LABELS) {
+        ESP_LOGE(TAG, "invalid label count: %u", (unsigned)count);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const char *p = (const char *)sec + 4;
+    const char *end = (const char *)sec + size;
+    for (uint32_t i = 0; i < count; i++) {
+        const char *nul = memchr(p, '\0', (size_t)(end - p));
+        if (nul == NULL) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        out->labels[i] = p;
+        p = nul + 1;
+    }
+    out->label_count = count;
+    return ESP_OK;
+}
+
+esp_err_t model_bundle_parse(const uint8_t *data, size_t len, bool verify_hash, model_bundle_t *out)
+{
+    if (data == NULL || out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len < MODEL_BUNDLE_HEADER_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    model_bundle_header_t hdr;
+    esp_err_t ret = model_bundle_read_header(data, &hdr);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "bad bundle header");
+        return ret;
+    }
+    size_t total = hdr.total_size;
+    if (total > len) {
+        ESP_LOGE(TAG, "bundle truncated: %u > %u", (unsigned)total, (unsigned)len);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const uint8_t *payload = data + MODEL_BUNDLE_HEADER_SIZE;
+    size_t payload_size = total - MODEL_BUNDLE_HEADER_SIZE;
+    uint16_t section_count = rd_u16(data + HDR_OFF_SECTIONS);
+    if ((size_t)section_count * MODEL_BUNDLE_SECTION_SIZE > payload_size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    if (verify_hash) {
+        uint8_t digest[MODEL_BUNDLE_SHA256_LEN];
+        mbedtls_sha256(payload, payload_size, digest, 0);
+        if (memcmp(digest, hdr.payload_sha256, sizeof(digest)) != 0) {
+            ESP_LOGE(TAG, "bundle sha256 mismatch");
+            return ESP_ERR_INVALID_CRC;
+        }
+    }
+
+    memset(out, 0, sizeof(*out));
+    memcpy(out->version, hdr.version, sizeof(out->version));
+    out->total_size = total;
+
+    bool have_weights = false;
+    bool have_quant = false;
+    for (uint16_t i = 0; i < section_count; i++) {
+        const uint8_t *ent = payload + (size_t)i * MODEL_BUNDLE_SECTION_SIZE;
+        uint16_t type = rd_u16(ent);
+        uint32_t offset = rd_u32(ent + 4);
+        uint32_t size = rd_u32(ent + 8);
+        if (offset > payload_size || size > payload_size - offset) {
+            ESP_LOGE(TAG, "section %u out of range", i);
+            return ESP_ERR_INVALID_SIZE;
+        }
+        const uint8_t *sec = payload + offset;
+
+        switch (type) {
+        case MODEL_SECTION_WEIGHTS:
+            if (offset % MODEL_BUNDLE_WEIGHTS_ALIGN != 0) {
+                ESP_LOGE(TAG, "weights not aligned");
+                return ESP_ERR_INVALID_SIZE;
+            }
+            out->weights = sec;
+            out->weights_size = size;
+            have_weights = true;
+            break;
+        case MODEL_SECTION_QUANT:
+            if (size < QUANT_SECTION_SIZE) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            out->quant.input_scale = rd_f32(sec);
+            out->quant.input_zero_point = (int32_t)rd_u32(sec + 4);
+            out->quant.output_scale = rd_f32(sec + 8);
+            out->quant.output_zero_point = (int32_t)rd_u32(sec + 12);
+            have_quant = true;
+            break;
+        case MODEL_SECTION_DSP:
+            if (size < DSP_SECTION_SIZE) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            out->dsp.num_cepstral = rd_u32(sec);
+            out->dsp.frame_length = rd_f32(sec + 4);
+            out->dsp.frame_stride = rd_f32(sec + 8);
+            out->dsp.num_filters = rd_u32(sec + 12);
+            out->dsp.fft_length = rd_u32(sec + 16);
+            out->dsp.win_size = rd_u32(sec + 20);
+            out->dsp.low_frequency = rd_u32(sec + 24);
+            out->dsp.high_frequency = rd_u32(sec + 28);
+            out->dsp.pre_cof = rd_f32(sec + 32);
+            out->dsp.pre_shift = rd_u32(sec + 36);
+            break;
+        case MODEL_SECTION_LABELS:
+            ret = parse_labels(sec, size, out);
+            if (ret != ESP_OK) {
+                return ret;
+            }
+            break;
+        case MODEL_SECTION_THRESHOLD:
+            if (size < THRESHOLD_SECTION_SIZE) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            out->threshold = rd_f32(sec);
+            break;
+        case MODEL_SECTION_GRAPH:
+            if (size < GRAPH_SECTION_SIZE) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            out->graph_fingerprint = rd_u32(sec);
+            break;
+        default:
+            /* 未知段跳过，便于后续扩展 */
+            ESP_LOGW(TAG, "skip unknown section type %u", type);
+            break;
+        }
+    }
+
+    if (!have_weights || !have_quant || out->label_count == 0) {
+        ESP_LOGE(TAG, "bundle missing required section");
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+#if !defined(ESP_PLATFORM)
+esp_err_t model_bundle_map_file(const char *path, bool verify_hash,
+                                model_bundle_mapping_t *out_map, model_bundle_t *out)
+{
+    if (path == NULL || out_map == NULL || out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < MODEL_BUNDLE_HEADER_SIZE) {
+        close(fd);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    /* mmap 返回页对齐地址，权重段 16 字节对齐在主机端同样成立 */
+    void *addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return ESP_FAIL;
+    }
+
+    esp_err_t ret = model_bundle_parse(addr, (size_t)st.st_size, verify_hash, out);
+    if (ret != ESP_OK) {
+        munmap(addr, (size_t)st.st_size);
+        return ret;
+    }
+    out_map->addr = addr;
+    out_map->size = (size_t)st.st_size;
+    return ESP_OK;
+}
+
+void model_bundle_unmap_file(model_bundle_mapping_t *map)
+{
+    if (map != NULL && map->addr != NULL) {
+        munmap((void *)map->addr, map->size);
+        map->addr = NULL;
+        map->size = 0;
+    }
+}
+#endif
@@ -0,0 +1,505 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-12
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-12
+ * @FilePath: \xn_voice_wake_up\components\xn_model_manager\src\model_store.c
+ * @Description: 模型存储实现 - 双槽写入、校验、切换与回滚
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#include "model_store.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "mbedtls/sha256.h"
+#include <string.h>
+#include <stdlib.h>
+
+static const char *TAG = "MODEL_STORE";
+
+#define MODEL_STORE_NVS_NAMESPACE   "model_store"
+#define MODEL_STORE_NVS_KEY         "state"
+#define MODEL_STORE_SECTOR_SIZE     4096
+#define MODEL_STORE_VERIFY_BUF      1024
+
+/** 单个槽位的持久化信息 */
+typedef struct {
+    uint32_t size;                              ///< 模型包大小，0 表示槽位无效
+    char version[MODEL_BUNDLE_VERSION_LEN];     ///< 模型版本（不保证 '\0' 结尾）
+} model_store_slot_state_t;
+
+/** 持久化状态（NVS blob） */
+typedef struct {
+    int8_t active;                              ///< 活动槽，-1 表示无
+    uint8_t pending;                            ///< 新模型待确认
+    uint8_t pending_loads;                      ///< 待确认期间的加载次数
+    uint8_t reserved;
+    model_store_slot_state_t slots[2];          ///< 两个槽位的信息
+} model_store_state_t;
+
+/** 更新会话 */
+struct model_store_update_s {
+    const esp_partition_t *part;                ///< 目标分区
+    model_slot_t slot;                          ///< 目标槽
+    size_t size;                                ///< 期望总大小
+    size_t written;                             ///< 已写入字节数
+    bool check_sha;                             ///< 是否校验外部摘要
+    uint8_t expected_sha[MODEL_BUNDLE_SHA256_LEN]; ///< 外部摘要
+    mbedtls_sha256_context sha;                 ///< 整包摘要计算
+};
+
+/** 模块上下文 */
+typedef struct {
+    bool initialized;
+    const esp_partition_t *parts[2];            ///< 槽位分区
+    model_store_state_t state;                  ///< 持久化状态副本
+    bool mapped;                                ///< 是否已映射模型
+    model_slot_t mapped_slot;                   ///< 已映射的槽位
+    esp_partition_mmap_handle_t mmap_handle;    ///< 映射句柄
+    model_store_load_stats_t load_stats;        ///< 最近一次加载统计
+    bool updating;                              ///< 是否有更新会话
+} model_store_ctx_t;
+
+static model_store_ctx_t s_store = {
+    .mapped_slot = MODEL_SLOT_NONE,
+};
+
+static esp_err_t load_state(model_store_state_t *state)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(MODEL_STORE_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (ret == ESP_OK) {
+        size_t len = sizeof(*state);
+        ret = nvs_get_blob(handle, MODEL_STORE_NVS_KEY, state, &len);
+        nvs_close(handle);
+        if (ret == ESP_OK && len != sizeof(*state)) {
+            ret = ESP_ERR_NVS_INVALID_LENGTH;
+        }
+    }
+    if (ret != ESP_OK) {
+        memset(state, 0, sizeof(*state));
+        state->active = MODEL_SLOT_NONE;
+    }
+    return ret;
+}
+
+static esp_err_t save_state(const model_store_state_t *state)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(MODEL_STORE_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "nvs_open failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ret = nvs_set_blob(handle, MODEL_STORE_NVS_KEY, state, sizeof(*state));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return ret;
+}
+
+static void copy_version(char *dst, const char *src)
+{
+    memcpy(dst, src, MODEL_BUNDLE_VERSION_LEN);
+    dst[MODEL_BUNDLE_VERSION_LEN] = '\0';
+}
+
+static model_slot_t other_slot(model_slot_t slot)
+{
+    return slot == MODEL_SLOT_A ? MODEL_SLOT_B : MODEL_SLOT_A;
+}
+
+/**
+ * @brief 切回另一个有效槽位并清除待确认状态
+ */
+static esp_err_t do_rollback(void)
+{
+    model_store_state_t *st = &s_store.state;
+    if (st->active == MODEL_SLOT_NONE) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    model_slot_t prev = other_slot((model_slot_t)st->active);
+    if (st->slots[prev].size == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    char bad[MODEL_BUNDLE_VERSION_LEN + 1];
+    char good[MODEL_BUNDLE_VERSION_LEN + 1];
+    copy_version(bad, st->slots[st->active].version);
+    copy_version(good, st->slots[prev].version);
+    ESP_LOGW(TAG, "rollback model %s -> %s", bad, good);
+
+    /* 失败的槽位作废，避免再次回滚到它 */
+    st->slots[st->active].size = 0;
+    st->active = prev;
+    st->pending = 0;
+    st->pending_loads = 0;
+    return save_state(st);
+}
+
+esp_err_t model_store_init(void)
+{
+    if (s_store.initialized) {
+        return ESP_OK;
+    }
+
+    s_store.parts[MODEL_SLOT_A] = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           MODEL_STORE_PARTITION_SUBTYPE,
+                                                           MODEL_STORE_PARTITION_A);
+    s_store.parts[MODEL_SLOT_B] = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           MODEL_STORE_PARTITION_SUBTYPE,
+                                                           MODEL_STORE_PARTITION_B);
+    if (s_store.parts[MODEL_SLOT_A] == NULL || s_store.parts[MODEL_SLOT_B] == NULL) {
+        ESP_LOGE(TAG, "model partitions not found");
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    load_state(&s_store.state);
+    s_store.initialized = true;
+
+    model_store_info_t info;
+    model_store_get_info(&info);
+    ESP_LOGI(TAG, "model store ready: slot=%d version=%s pending=%d",
+             info.active, info.version[0] ? info.version : "-", info.pending);
+    return ESP_OK;
+}
+
+esp_err_t model_store_get_info(model_store_info_t *out_info)
+{
+    if (out_info == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_store.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const model_store_state_t *st = &s_store.state;
+    memset(out_info, 0, sizeof(*out_info));
+    out_info->active = (model_slot_t)st->active;
+    out_info->pending = st->pending != 0;
+    if (st->active != MODEL_SLOT_NONE) {
+        copy_version(out_info->version, st->slots[st->active].version);
+        out_info->size = st->slots[st->active].size;
+
+        model_slot_t prev = other_slot((model_slot_t)st->active);
+        if (st->slots[prev].size != 0) {
+            copy_version(out_info->previous_version, st->slots[prev].version);
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t model_store_begin_update(size_t size, const uint8_t *sha256,
+                                   model_store_update_handle_t *out_handle)
+{
+    if (out_handle == NULL || size < MODEL_BUNDLE_HEADER_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_store.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_store.updating) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    model_slot_t target = s_store.state.active == MODEL_SLOT_NONE ?
+                          MODEL_SLOT_A : other_slot((model_slot_t)s_store.state.active);
+    if (s_store.mapped && s_store.mapped_slot == target) {
+        /* 正在使用的映射不能被擦除：先 model_store_load() 切到新模型再更新 */
+        ESP_LOGE(TAG, "slot %d is still mapped, reload model before next update", target);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const esp_partition_t *part = s_store.parts[target];
+    if (size > part->size) {
+        ESP_LOGE(TAG, "bundle too large: %u > %u", (unsigned)size, (unsigned)part->size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    model_store_update_handle_t h = calloc(1, sizeof(*h));
+    if (h == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    h->part = part;
+    h->slot = target;
+    h->size = size;
+    if (sha256 != NULL) {
+        h->check_sha = true;
+        memcpy(h->expected_sha, sha256, sizeof(h->expected_sha));
+    }
+
+    /* 先作废目标槽位，写到一半断电也不会被当作有效回滚目标 */
+    if (s_store.state.slots[target].size != 0) {
+        s_store.state.slots[target].size = 0;
+        save_state(&s_store.state);
+    }
+
+    size_t erase_len = (size + MODEL_STORE_SECTOR_SIZE - 1) & ~(size_t)(MODEL_STORE_SECTOR_SIZE - 1);
+    esp_err_t ret = esp_partition_erase_range(part, 0, erase_len);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "erase %s failed: %s", part->label, esp_err_to_name(ret));
+        free(h);
+        return ret;
+    }
+
+    mbedtls_sha256_init(&h->sha);
+    mbedtls_sha256_starts(&h->sha, 0);
+    s_store.updating = true;
+    *out_handle = h;
+
+    ESP_LOGI(TAG, "model update begin: slot=%d size=%u", target, (unsigned)size);
+    return ESP_OK;
+}
+
+esp_err_t model_store_write(model_store_update_handle_t handle, const void *data, size_t len)
+{
+    if (handle == NULL || (data == NULL && len > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len > handle->size - handle->written) {
+        ESP_LOGE(TAG, "write beyond declared size");
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    esp_err_t ret = esp_partition_write(handle->part, handle->written, data, len);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "partition write failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    mbedtls_sha256_update(&handle->sha, data, len);
+    handle->written += len;
+    return ESP_OK;
+}
+
+/**
+ * @brief 从 flash 回读模型包并校验包内摘要与格式
+ */
+static esp_err_t verify_slot(const esp_partition_t *part, size_t size, model_bundle_header_t *out_hdr)
+{
+    uint8_t *buf = malloc(MODEL_STORE_VERIFY_BUF);
+    if (buf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = esp_partition_read(part, 0, buf, MODEL_BUNDLE_HEADER_SIZE);
+    if (ret == ESP_OK) {
+        ret = model_bundle_read_header(buf, out_hdr);
+    }
+    if (ret == ESP_OK && out_hdr->total_size != size) {
+        ESP_LOGE(TAG, "bundle size mismatch: header=%u download=%u",
+                 (unsigned)out_hdr->total_size, (unsigned)size);
+        ret = ESP_ERR_INVALID_SIZE;
+    }
+    if (ret != ESP_OK) {
+        goto out;
+    }
+
+    /* 头部之后的全部字节由包内 payload_sha256 覆盖 */
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    for (size_t off = MODEL_BUNDLE_HEADER_SIZE; off < size && ret == ESP_OK;) {
+        size_t n = size - off < MODEL_STORE_VERIFY_BUF ? size - off : MODEL_STORE_VERIFY_BUF;
+        ret = esp_partition_read(part, off, buf, n);
+        if (ret == ESP_OK) {
+            mbedtls_sha256_update(&sha, buf, n);
+            off += n;
+        }
+    }
+    uint8_t digest[MODEL_BUNDLE_SHA256_LEN];
+    mbedtls_sha256_finish(&sha, digest);
+    mbedtls_sha256_free(&sha);
+    if (ret == ESP_OK && memcmp(digest, out_hdr->payload_sha256, sizeof(digest)) != 0) {
+        ESP_LOGE(TAG, "bundle payload sha256 mismatch");
+        ret = ESP_ERR_INVALID_CRC;
+    }
+
+out:
+    free(buf);
+    return ret;
+}
+
+esp_err_t model_store_finish_update(model_store_update_handle_t handle)
+{
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    uint8_t digest[MODEL_BUNDLE_SHA256_LEN];
+    mbedtls_sha256_finish(&handle->sha, digest);
+
+    if (handle->written != handle->size) {
+        ESP_LOGE(TAG, "incomplete bundle: %u/%u", (unsigned)handle->written, (unsigned)handle->size);
+        ret = ESP_ERR_INVALID_SIZE;
+        goto out;
+    }
+    if (handle->check_sha && memcmp(digest, handle->expected_sha, sizeof(digest)) != 0) {
+        ESP_LOGE(TAG, "bundle sha256 mismatch");
+        ret = ESP_ERR_INVALID_CRC;
+        goto out;
+    }
+
+    model_bundle_header_t hdr;
+    ret = verify_slot(handle->part, handle->size, &hdr);
+    if (ret != ESP_OK) {
+        goto out;
+    }
+
+    model_store_state_t *st = &s_store.state;
+    st->slots[handle->slot].size = (uint32_t)handle->size;
+    memcpy(st->slots[handle->slot].version, hdr.version, MODEL_BUNDLE_VERSION_LEN);
+    st->active = handle->slot;
+    st->pending = 1;
+    st->pending_loads = 0;
+    ret = save_state(st);
+
+    ESP_LOGI(TAG, "model %s written to slot %d, pending confirmation", hdr.version, handle->slot);
+
+out:
+    mbedtls_sha256_free(&handle->sha);
+    free(handle);
+    s_store.updating = false;
+    return ret;
+}
+
+void model_store_abort_update(model_store_update_handle_t handle)
+{
+    if (handle == NULL) {
+        return;
+    }
+    mbedtls_sha256_free(&handle->sha);
+    free(handle);
+    s_store.updating = false;
+    ESP_LOGW(TAG, "model update aborted");
+}
+
+/**
+ * @brief 把活动槽映射到地址空间并解析（权重零拷贝，直接指向 flash）
+ *
+ * 整包摘要只在待确认期间校验：写入完成时已回读校验过一次，
+ * 确认后的冷启动不再遍历整个模型包，只解析头部和段表。
+ */
+static esp_err_t load_active(model_bundle_t *out_bundle)
+{
+    const model_store_state_t *st = &s_store.state;
+    if (st->active == MODEL_SLOT_NONE || st->slots[st->active].size == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    size_t size = st->slots[st->active].size;
+    size_t heap_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    int64_t start_us = esp_timer_get_time();
+
+    const void *addr = NULL;
+    esp_partition_mmap_handle_t handle;
+    esp_err_t ret = esp_partition_mmap(s_store.parts[st->active], 0, size, ESP_PARTITION_MMAP_DATA,
+                                       &addr, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "mmap %s failed: %s", s_store.parts[st->active]->label, esp_err_to_name(ret));
+        return ret;
+    }
+
+    bool verify = st->pending != 0;
+    ret = model_bundle_parse(addr, size, verify, out_bundle);
+    if (ret != ESP_OK) {
+        esp_partition_munmap(handle);
+        return ret;
+    }
+
+    s_store.mmap_handle = handle;
+    s_store.mapped = true;
+    s_store.mapped_slot = (model_slot_t)st->active;
+    s_store.load_stats.map_us = (uint32_t)(esp_timer_get_time() - start_us);
+    s_store.load_stats.mapped_bytes = size;
+    size_t heap_after = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    s_store.load_stats.heap_bytes = heap_before > heap_after ? heap_before - heap_after : 0;
+    s_store.load_stats.verified = verify;
+    return ESP_OK;
+}
+
+esp_err_t model_store_load(model_bundle_t *out_bundle)
+{
+    if (out_bundle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_store.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    model_store_unload();
+
+    model_store_state_t *st = &s_store.state;
+    if (st->pending) {
+        if (st->pending_loads >= MODEL_STORE_MAX_PENDING_BOOTS) {
+            ESP_LOGW(TAG, "pending model never confirmed");
+            do_rollback();
+        } else {
+            st->pending_loads++;
+            save_state(st);
+        }
+    }
+
+    esp_err_t ret = load_active(out_bundle);
+    if (ret != ESP_OK && st->pending) {
+        ESP_LOGW(TAG, "pending model failed to load: %s", esp_err_to_name(ret));
+        if (do_rollback() == ESP_OK) {
+            ret = load_active(out_bundle);
+        }
+    }
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "model %s mapped: weights=%u labels=%u threshold=%.2f, %u us, heap %u bytes%s",
+                 out_bundle->version, (unsigned)out_bundle->weights_size,
+                 (unsigned)out_bundle->label_count, out_bundle->threshold,
+                 (unsigned)s_store.load_stats.map_us, (unsigned)s_store.load_stats.heap_bytes,
+                 s_store.load_stats.verified ? ", verified" : "");
+    }
+    return ret;
+}
+
+void model_store_unload(void)
+{
+    if (s_store.mapped) {
+        esp_partition_munmap(s_store.mmap_handle);
+        s_store.mapped = false;
+        s_store.mapped_slot = MODEL_SLOT_NONE;
+    }
+}
+
+esp_err_t model_store_get_load_stats(model_store_load_stats_t *out_stats)
+{
+    if (out_stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_store.mapped) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    *out_stats = s_store.load_stats;
+    return ESP_OK;
+}
+
+esp_err_t model_store_mark_valid(void)
+{
+    if (!s_store.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!s_store.state.pending) {
+        return ESP_OK;
+    }
+    s_store.state.pending = 0;
+    s_store.state.pending_loads = 0;
+    ESP_LOGI(TAG, "model confirmed");
+    return save_state(&s_store.state);
+}
+
+esp_err_t model_store_rollback(void)
+{
+    if (!s_store.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return do_rollback();
+}
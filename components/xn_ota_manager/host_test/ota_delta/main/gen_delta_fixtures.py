@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+生成差分 OTA 主机测试的数据：基准 / 目标镜像，以及 xn_delta.py 产出的压缩、未压缩补丁。
+
+用法：
+    python3 gen_delta_fixtures.py <xn_delta.py> <out.c>
+
+目标镜像模拟一次真实的固件升级：前段不变，中段按固定间隔改写 4 字节（重定位后的地址），
+插入一段新代码，删除尾部一段并追加新数据。补丁生成后先用 xn_delta.apply() 回放校验。
+"""
+
+import importlib.util
+import random
+import sys
+
+OLD_SIZE = 40 * 1024
+
+
+def load_tool(path):
+    spec = importlib.util.spec_from_file_location("xn_delta", path)
+    module = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(module)
+    return module
+
+
+def make_images():
+    rng = random.Random(7)
+    old = bytes(rng.getrandbits(8) for _ in range(OLD_SIZE))
+
+    relocated = bytearray(old[8 * 1024:16 * 1024])
+    for i in range(0, len(relocated), 64):
+        for j in range(4):
+            relocated[i + j] = (relocated[i + j] + 0x10) & 0xFF
+
+    new = bytearray(old[:8 * 1024])
+    new += relocated
+    new += bytes(rng.getrandbits(8) for _ in range(3000))
+    new += old[16 * 1024:36 * 1024]
+    new += bytes(rng.getrandbits(8) for _ in range(2000))
+    return old, bytes(new)
+
+
+def c_array(name, data):
+    lines = ["const uint8_t %s[] = {" % name]
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    lines.append("};")
+    lines.append("const size_t %s_len = sizeof(%s);" % (name, name))
+    return "\n".join(lines)
+
+
+def main(argv):
+    if len(argv) != 3:
+        print(__doc__)
+        return 1
+    tool = load_tool(argv[1])
+    old, new = make_images()
+    ops = tool.make_ops(old, new)
+    patch_z = tool.encode(old, new, ops, compress=True)
+    patch_raw = tool.encode(old, new, ops, compress=False)
+    for patch in (patch_z, patch_raw):
+        if tool.apply(old, patch) != new:
+            raise SystemExit("round-trip verification failed")
+
+    with open(argv[2], "w") as f:
+        f.write("/* 由 gen_delta_fixtures.py 生成，请勿手动修改 */\n")
+        f.write("#include <stddef.h>\n#include <stdint.h>\n\n")
+        for name, data in (("delta_fixture_old", old), ("delta_fixture_new", new),
+                           ("delta_fixture_patch_z", patch_z), ("delta_fixture_patch_raw", patch_raw)):
+            f.write(c_array(name, data) + "\n\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,219 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-11
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-11
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\host_test\ota_delta\main\mocks\delta_mocks.c
+ * @Description: 主机测试替身实现
+ *
+ *  - esp_partition / esp_ota_ops：运行分区与 OTA 分区各一块内存，esp_ota_begin 擦除 OTA 分区，
+ *    esp_ota_write 顺序追加；
+ *  - esp_http_client：从内存缓冲区按固定块大小返回正文；
+ *  - http_ota_download_clear_resume：只计数。
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_http_client.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "http_ota_download.h"
+#include "delta_mocks.h"
+
+#define MOCK_OTA_HANDLE   1
+
+static esp_partition_t    s_running;
+static esp_partition_t    s_update;
+static delta_mock_stats_t s_stats;
+static bool               s_ota_open;
+
+static struct {
+	int            status;
+	const uint8_t *body;
+	size_t         len;
+	size_t         pos;
+	size_t         read_size;
+} s_http;
+
+/* -------------------- 控制接口 -------------------- */
+
+void delta_mock_reset(const uint8_t *image, size_t len, uint32_t partition_size)
+{
+	free(s_running.data);
+	free(s_update.data);
+	s_running.size = partition_size;
+	s_running.data = (uint8_t *)malloc(partition_size);
+	memset(s_running.data, 0xff, partition_size);
+	memcpy(s_running.data, image, len);
+	s_update.size = partition_size;
+	s_update.data = (uint8_t *)malloc(partition_size);
+	memset(s_update.data, 0xff, partition_size);
+	memset(&s_stats, 0, sizeof(s_stats));
+	s_ota_open = false;
+}
+
+const delta_mock_stats_t *delta_mock_get_stats(void)
+{
+	return &s_stats;
+}
+
+uint8_t *delta_mock_running_data(void)
+{
+	return s_running.data;
+}
+
+const uint8_t *delta_mock_update_data(void)
+{
+	return s_update.data;
+}
+
+void delta_mock_http_serve(int status, const uint8_t *body, size_t len, size_t read_size)
+{
+	s_http.status    = status;
+	s_http.body      = body;
+	s_http.len       = len;
+	s_http.pos       = 0;
+	s_http.read_size = read_size;
+}
+
+/* -------------------- 分区 -------------------- */
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+	if (src_offset + size > partition->size) {
+		return ESP_ERR_INVALID_SIZE;
+	}
+	memcpy(dst, partition->data + src_offset, size);
+	return ESP_OK;
+}
+
+const esp_partition_t *esp_ota_get_running_partition(void)
+{
+	return &s_running;
+}
+
+const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *start_from)
+{
+	(void)start_from;
+	return &s_update;
+}
+
+esp_err_t esp_ota_begin(const esp_partition_t *partition, size_t image_size, esp_ota_handle_t *out_handle)
+{
+	if (partition != &s_update || image_size > partition->size || s_ota_open) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	memset(s_update.data, 0xff, s_update.size);
+	s_stats.begins++;
+	s_stats.written = 0;
+	s_ota_open      = true;
+	*out_handle     = MOCK_OTA_HANDLE;
+	return ESP_OK;
+}
+
+esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size)
+{
+	if (handle != MOCK_OTA_HANDLE || !s_ota_open) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (s_stats.written + size > s_update.size) {
+		return ESP_ERR_INVALID_SIZE;
+	}
+	memcpy(s_update.data + s_stats.written, data, size);
+	s_stats.written += (uint32_t)size;
+	return ESP_OK;
+}
+
+esp_err_t esp_ota_end(esp_ota_handle_t handle)
+{
+	if (handle != MOCK_OTA_HANDLE || !s_ota_open) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	s_ota_open = false;
+	s_stats.ends++;
+	return ESP_OK;
+}
+
+esp_err_t esp_ota_abort(esp_ota_handle_t handle)
+{
+	if (handle != MOCK_OTA_HANDLE || !s_ota_open) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	s_ota_open = false;
+	s_stats.aborts++;
+	return ESP_OK;
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t *partition)
+{
+	if (partition != &s_update) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	s_stats.boot_sets++;
+	return ESP_OK;
+}
+
+/* -------------------- HTTP -------------------- */
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config)
+{
+	(void)config;
+	return (esp_http_client_handle_t)&s_http;
+}
+
+esp_err_t esp_http_client_open(esp_http_client_handle_t client, int write_len)
+{
+	(void)client;
+	(void)write_len;
+	s_http.pos = 0;
+	return ESP_OK;
+}
+
+int esp_http_client_fetch_headers(esp_http_client_handle_t client)
+{
+	(void)client;
+	return (int)s_http.len;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t client)
+{
+	(void)client;
+	return s_http.status;
+}
+
+int esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len)
+{
+	(void)client;
+	size_t n = s_http.len - s_http.pos;
+	if (n > (size_t)len) {
+		n = (size_t)len;
+	}
+	if (n > s_http.read_size) {
+		n = s_http.read_size;
+	}
+	memcpy(buffer, s_http.body + s_http.pos, n);
+	s_http.pos += n;
+	return (int)n;
+}
+
+esp_err_t esp_http_client_close(esp_http_client_handle_t client)
+{
+	(void)client;
+	return ESP_OK;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client)
+{
+	(void)client;
+	return ESP_OK;
+}
+
+/* -------------------- 其它 -------------------- */
+
+esp_err_t http_ota_download_clear_resume(void)
+{
+	s_stats.resume_clears++;
+	return ESP_OK;
+}
@@ -0,0 +1,47 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-11
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-11
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\host_test\ota_delta\main\mocks\include\delta_mocks.h
+ * @Description: 主机测试替身的控制接口（运行分区内容、OTA 写入统计、HTTP 响应）
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** OTA 写入替身的统计 */
+typedef struct {
+	int      begins;           ///< esp_ota_begin 调用次数
+	int      ends;             ///< esp_ota_end 成功次数
+	int      aborts;           ///< esp_ota_abort 调用次数
+	int      boot_sets;        ///< esp_ota_set_boot_partition 调用次数
+	int      resume_clears;    ///< http_ota_download_clear_resume 调用次数
+	uint32_t written;          ///< 写入 OTA 分区的字节数
+} delta_mock_stats_t;
+
+/**
+ * @brief 用 image 填充运行分区，擦除 OTA 分区，清空统计
+ */
+void delta_mock_reset(const uint8_t *image, size_t len, uint32_t partition_size);
+
+const delta_mock_stats_t *delta_mock_get_stats(void);
+
+/**
+ * @brief 运行分区内容（可改写以模拟基准不一致）
+ */
+uint8_t *delta_mock_running_data(void);
+
+/**
+ * @brief OTA 分区内容
+ */
+const uint8_t *delta_mock_update_data(void);
+
+/**
+ * @brief 设置 HTTP 替身返回的状态码与正文，每次 read 最多返回 read_size 字节
+ */
+void delta_mock_http_serve(int status, const uint8_t *body, size_t len, size_t read_size);
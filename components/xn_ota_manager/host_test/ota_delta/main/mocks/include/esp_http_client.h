@@ -0,0 +1,36 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-11
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-11
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\host_test\ota_delta\main\mocks\include\esp_http_client.h
+ * @Description: 主机测试替身 - 从内存缓冲区按块返回补丁的 HTTP 客户端
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include <stdbool.h>
+
+#include "esp_err.h"
+
+typedef enum {
+	HTTP_METHOD_GET = 0,
+} esp_http_client_method_t;
+
+typedef struct {
+	const char              *url;
+	int                      timeout_ms;
+	esp_http_client_method_t method;
+	bool                     skip_cert_common_name_check;
+} esp_http_client_config_t;
+
+typedef struct esp_http_client *esp_http_client_handle_t;
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config);
+esp_err_t esp_http_client_open(esp_http_client_handle_t client, int write_len);
+int esp_http_client_fetch_headers(esp_http_client_handle_t client);
+int esp_http_client_get_status_code(esp_http_client_handle_t client);
+int esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len);
+esp_err_t esp_http_client_close(esp_http_client_handle_t client);
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client);
@@ -0,0 +1,23 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-11
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-11
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\host_test\ota_delta\main\mocks\include\esp_partition.h
+ * @Description: 主机测试替身 - 内存中的运行分区与 OTA 分区
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef struct {
+	uint32_t size;
+	uint8_t *data;
+} esp_partition_t;
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size);
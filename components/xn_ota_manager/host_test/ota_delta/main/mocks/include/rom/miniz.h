@@ -0,0 +1,103 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-11
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-11
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\host_test\ota_delta\main\mocks\include\rom\miniz.h
+ * @Description: 主机测试替身 - 用系统 zlib 实现 http_ota_delta.c 用到的 tinfl 接口
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+/*
+ * 与 ROM tinfl 的差异：zlib 自带滑动窗口，输出直接写到 pOut_buf_next，不依赖环形字典；
+ * 解压器内部状态从结构体自带的内存池分配，调用方 free() 解压器即可全部释放，
+ * 与 tinfl 无需清理的用法一致。
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <zlib.h>
+
+#define TINFL_LZ_DICT_SIZE           32768
+#define TINFL_FLAG_PARSE_ZLIB_HEADER 1
+#define TINFL_FLAG_HAS_MORE_INPUT    2
+
+#define TINFL_MOCK_POOL_SIZE         (64 * 1024)  ///< inflate 状态 + 32KB 窗口
+
+typedef enum {
+	TINFL_STATUS_FAILED           = -1,
+	TINFL_STATUS_DONE             = 0,
+	TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+	TINFL_STATUS_HAS_MORE_OUTPUT  = 2,
+} tinfl_status;
+
+typedef struct {
+	z_stream zs;
+	int      active;
+	size_t   pool_used;
+	uint8_t  pool[TINFL_MOCK_POOL_SIZE];
+} tinfl_decompressor;
+
+static inline voidpf tinfl_mock_alloc(voidpf opaque, uInt items, uInt size)
+{
+	tinfl_decompressor *r   = (tinfl_decompressor *)opaque;
+	size_t              len = ((size_t)items * size + 15) & ~(size_t)15;
+	if (r->pool_used + len > sizeof(r->pool)) {
+		return Z_NULL;
+	}
+	voidpf p = &r->pool[r->pool_used];
+	r->pool_used += len;
+	return p;
+}
+
+static inline void tinfl_mock_free(voidpf opaque, voidpf address)
+{
+	(void)opaque;
+	(void)address;
+}
+
+static inline void tinfl_init(tinfl_decompressor *r)
+{
+	memset(&r->zs, 0, sizeof(r->zs));
+	r->zs.zalloc = tinfl_mock_alloc;
+	r->zs.zfree  = tinfl_mock_free;
+	r->zs.opaque = r;
+	r->pool_used = 0;
+	r->active    = inflateInit(&r->zs) == Z_OK;
+}
+
+static inline tinfl_status tinfl_decompress(tinfl_decompressor *r, const uint8_t *pIn_buf_next, size_t *pIn_buf_size,
+					    uint8_t *pOut_buf_start, uint8_t *pOut_buf_next, size_t *pOut_buf_size,
+					    const uint32_t decomp_flags)
+{
+	(void)pOut_buf_start;
+	(void)decomp_flags;
+	if (!r->active) {
+		*pIn_buf_size  = 0;
+		*pOut_buf_size = 0;
+		return TINFL_STATUS_FAILED;
+	}
+
+	r->zs.next_in   = (Bytef *)pIn_buf_next;
+	r->zs.avail_in  = (uInt)*pIn_buf_size;
+	r->zs.next_out  = pOut_buf_next;
+	r->zs.avail_out = (uInt)*pOut_buf_size;
+	int zr          = inflate(&r->zs, Z_NO_FLUSH);
+	*pIn_buf_size -= r->zs.avail_in;
+	*pOut_buf_size -= r->zs.avail_out;
+
+	if (zr == Z_STREAM_END) {
+		inflateEnd(&r->zs);
+		r->active = 0;
+		return TINFL_STATUS_DONE;
+	}
+	if (zr != Z_OK && zr != Z_BUF_ERROR) {
+		inflateEnd(&r->zs);
+		r->active = 0;
+		return TINFL_STATUS_FAILED;
+	}
+	return r->zs.avail_out == 0 ? TINFL_STATUS_HAS_MORE_OUTPUT : TINFL_STATUS_NEEDS_MORE_INPUT;
+}
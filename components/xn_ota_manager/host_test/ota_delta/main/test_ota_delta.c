@@ -0,0 +1,211 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-11
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-11
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\host_test\ota_delta\main\test_ota_delta.c
+ * @Description: 差分 OTA 补丁应用器主机测试
+ *
+ * 补丁由 ota_server/tools/xn_delta.py 在构建时生成，检查：
+ *  - 压缩 / 未压缩补丁以任意分块写入后，OTA 分区与目标镜像逐字节一致并设置启动分区；
+ *  - 基准镜像不一致时在擦除 OTA 分区前拒绝；
+ *  - 操作流被截断、出现未知操作码、ADD 越界、差值 / 压缩流被篡改时拒绝且不设置启动分区。
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "http_ota_delta.h"
+#include "delta_mocks.h"
+
+#define TEST_PARTITION_SIZE  (64 * 1024)
+#define TEST_FIRST_OP        HTTP_OTA_DELTA_HEADER_SIZE       ///< 未压缩补丁第一个操作码（ADD）的偏移
+#define TEST_FIRST_ADD_DATA  (TEST_FIRST_OP + 1 + 8)           ///< 第一个 ADD 差值数据的偏移
+
+/* 由 gen_delta_fixtures.py 生成 */
+extern const uint8_t delta_fixture_old[];
+extern const size_t  delta_fixture_old_len;
+extern const uint8_t delta_fixture_new[];
+extern const size_t  delta_fixture_new_len;
+extern const uint8_t delta_fixture_patch_z[];
+extern const size_t  delta_fixture_patch_z_len;
+extern const uint8_t delta_fixture_patch_raw[];
+extern const size_t  delta_fixture_patch_raw_len;
+
+static void fixture_reset(void)
+{
+	delta_mock_reset(delta_fixture_old, delta_fixture_old_len, TEST_PARTITION_SIZE);
+}
+
+/**
+ * @brief 以 chunk 字节为单位写入补丁并结束，返回第一个错误
+ */
+static esp_err_t apply_in_chunks(const uint8_t *patch, size_t len, size_t chunk)
+{
+	http_ota_delta_handle_t delta = http_ota_delta_create();
+	TEST_ASSERT_NOT_NULL(delta);
+
+	for (size_t pos = 0; pos < len; pos += chunk) {
+		size_t    n   = len - pos < chunk ? len - pos : chunk;
+		esp_err_t ret = http_ota_delta_write(delta, patch + pos, n);
+		if (ret != ESP_OK) {
+			http_ota_delta_abort(delta);
+			return ret;
+		}
+	}
+	return http_ota_delta_finish(delta);
+}
+
+/**
+ * @brief 复制补丁以便篡改
+ */
+static uint8_t *patch_copy(const uint8_t *patch, size_t len)
+{
+	uint8_t *copy = (uint8_t *)malloc(len);
+	TEST_ASSERT_NOT_NULL(copy);
+	memcpy(copy, patch, len);
+	return copy;
+}
+
+static void assert_image_installed(void)
+{
+	const delta_mock_stats_t *stats = delta_mock_get_stats();
+	TEST_ASSERT_EQUAL(delta_fixture_new_len, stats->written);
+	TEST_ASSERT_EQUAL_MEMORY(delta_fixture_new, delta_mock_update_data(), delta_fixture_new_len);
+	TEST_ASSERT_EQUAL(1, stats->ends);
+	TEST_ASSERT_EQUAL(1, stats->boot_sets);
+	TEST_ASSERT_EQUAL(1, stats->resume_clears);
+}
+
+static void assert_image_rejected(void)
+{
+	const delta_mock_stats_t *stats = delta_mock_get_stats();
+	TEST_ASSERT_EQUAL(0, stats->ends);
+	TEST_ASSERT_EQUAL(0, stats->boot_sets);
+	TEST_ASSERT_EQUAL(stats->begins, stats->aborts);
+}
+
+TEST_CASE("uncompressed patch reproduces the target image", "[ota_delta]")
+{
+	static const size_t chunks[] = { 1, 7, 1000, 4096, 1 << 20 };
+	for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+		fixture_reset();
+		TEST_ASSERT_EQUAL(ESP_OK, apply_in_chunks(delta_fixture_patch_raw, delta_fixture_patch_raw_len, chunks[i]));
+		assert_image_installed();
+	}
+}
+
+TEST_CASE("zlib patch reproduces the target image", "[ota_delta]")
+{
+	static const size_t chunks[] = { 1, 13, 512, 1 << 20 };
+	for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+		fixture_reset();
+		TEST_ASSERT_EQUAL(ESP_OK, apply_in_chunks(delta_fixture_patch_z, delta_fixture_patch_z_len, chunks[i]));
+		assert_image_installed();
+	}
+}
+
+TEST_CASE("http_ota_delta_run downloads and applies a patch", "[ota_delta]")
+{
+	fixture_reset();
+	delta_mock_http_serve(200, delta_fixture_patch_z, delta_fixture_patch_z_len, 1500);
+	TEST_ASSERT_EQUAL(ESP_OK, http_ota_delta_run("http://127.0.0.1/fw.xndp", 1000));
+	assert_image_installed();
+
+	fixture_reset();
+	delta_mock_http_serve(404, NULL, 0, 1500);
+	TEST_ASSERT_NOT_EQUAL(ESP_OK, http_ota_delta_run("http://127.0.0.1/fw.xndp", 1000));
+	TEST_ASSERT_EQUAL(0, delta_mock_get_stats()->begins);
+}
+
+TEST_CASE("patch for another base image is rejected before erasing", "[ota_delta]")
+{
+	fixture_reset();
+	delta_mock_running_data()[100] ^= 0x01;
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_VERSION,
+			  apply_in_chunks(delta_fixture_patch_z, delta_fixture_patch_z_len, 4096));
+	TEST_ASSERT_EQUAL(0, delta_mock_get_stats()->begins);
+	TEST_ASSERT_EQUAL(0, delta_mock_get_stats()->resume_clears);
+}
+
+TEST_CASE("truncated op stream is rejected", "[ota_delta]")
+{
+	/* 截在操作流中间：写入阶段无法察觉，结束时必须因长度不足拒绝 */
+	fixture_reset();
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+			  apply_in_chunks(delta_fixture_patch_raw, delta_fixture_patch_raw_len / 2, 4096));
+	assert_image_rejected();
+
+	/* 只差最后的 END 操作码 */
+	fixture_reset();
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+			  apply_in_chunks(delta_fixture_patch_raw, delta_fixture_patch_raw_len - 1, 4096));
+	assert_image_rejected();
+
+	fixture_reset();
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+			  apply_in_chunks(delta_fixture_patch_z, delta_fixture_patch_z_len / 2, 512));
+	assert_image_rejected();
+}
+
+TEST_CASE("unknown op code is rejected", "[ota_delta]")
+{
+	uint8_t *patch = patch_copy(delta_fixture_patch_raw, delta_fixture_patch_raw_len);
+	patch[TEST_FIRST_OP] = 0x7f;
+
+	fixture_reset();
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_RESPONSE, apply_in_chunks(patch, delta_fixture_patch_raw_len, 4096));
+	assert_image_rejected();
+	free(patch);
+}
+
+TEST_CASE("ADD beyond the base image is rejected", "[ota_delta]")
+{
+	uint8_t *patch = patch_copy(delta_fixture_patch_raw, delta_fixture_patch_raw_len);
+	TEST_ASSERT_EQUAL(0x01, patch[TEST_FIRST_OP]);
+	/* src_off = old_size - 1，长度不变 */
+	uint32_t src_off = (uint32_t)delta_fixture_old_len - 1;
+	for (int i = 0; i < 4; i++) {
+		patch[TEST_FIRST_OP + 1 + i] = (uint8_t)(src_off >> (8 * i));
+	}
+
+	fixture_reset();
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_RESPONSE, apply_in_chunks(patch, delta_fixture_patch_raw_len, 4096));
+	assert_image_rejected();
+	free(patch);
+}
+
+TEST_CASE("corrupt diff data fails the image digest", "[ota_delta]")
+{
+	uint8_t *patch = patch_copy(delta_fixture_patch_raw, delta_fixture_patch_raw_len);
+	patch[TEST_FIRST_ADD_DATA + 100] ^= 0x01;
+
+	fixture_reset();
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_CRC, apply_in_chunks(patch, delta_fixture_patch_raw_len, 4096));
+	assert_image_rejected();
+	free(patch);
+}
+
+TEST_CASE("corrupt zlib stream is rejected", "[ota_delta]")
+{
+	uint8_t *patch = patch_copy(delta_fixture_patch_z, delta_fixture_patch_z_len);
+	size_t   body  = delta_fixture_patch_z_len - HTTP_OTA_DELTA_HEADER_SIZE;
+	patch[HTTP_OTA_DELTA_HEADER_SIZE + body / 2] ^= 0x5a;
+
+	fixture_reset();
+	TEST_ASSERT_NOT_EQUAL(ESP_OK, apply_in_chunks(patch, delta_fixture_patch_z_len, 512));
+	assert_image_rejected();
+	free(patch);
+}
+
+void app_main(void)
+{
+	UNITY_BEGIN();
+	unity_run_all_tests();
+	int failures = UNITY_END();
+	exit(failures == 0 ? 0 : 1);
+}
@@ -0,0 +1,20 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-10
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-10
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\host_test\ota_resume\main\mocks\include\esp_http_client.h
+ * @Description: 主机测试替身 - 只保留 http_ota_download.c 用到的 esp_http_client 配置字段
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include <stdbool.h>
+
+typedef struct {
+	const char *url;
+	int         timeout_ms;
+	bool        keep_alive_enable;
+	bool        skip_cert_common_name_check;
+} esp_http_client_config_t;
@@ -0,0 +1,38 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-10
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-10
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\host_test\ota_resume\main\mocks\include\esp_https_ota.h
+ * @Description: 主机测试替身 - esp_https_ota 的 Range 下载子集（实现见 ota_mocks.c）
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_http_client.h"
+
+#define ESP_ERR_HTTPS_OTA_BASE         (0x9000)
+#define ESP_ERR_HTTPS_OTA_IN_PROGRESS  (ESP_ERR_HTTPS_OTA_BASE + 1)
+
+typedef void *esp_https_ota_handle_t;
+
+typedef struct {
+	const esp_http_client_config_t *http_config;
+	bool     partial_http_download;
+	int      max_http_request_size;
+	bool     ota_resumption;
+	uint32_t ota_image_bytes_written;
+} esp_https_ota_config_t;
+
+esp_err_t esp_https_ota_begin(const esp_https_ota_config_t *ota_config, esp_https_ota_handle_t *handle);
+esp_err_t esp_https_ota_perform(esp_https_ota_handle_t handle);
+bool esp_https_ota_is_complete_data_received(esp_https_ota_handle_t handle);
+esp_err_t esp_https_ota_finish(esp_https_ota_handle_t handle);
+esp_err_t esp_https_ota_abort(esp_https_ota_handle_t handle);
+int esp_https_ota_get_image_len_read(esp_https_ota_handle_t handle);
+int esp_https_ota_get_image_size(esp_https_ota_handle_t handle);
@@ -0,0 +1,15 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-10
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-10
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\host_test\ota_resume\main\mocks\include\esp_ota_ops.h
+ * @Description: 主机测试替身 - 返回内存 OTA 分区
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include "esp_partition.h"
+
+const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *start_from);
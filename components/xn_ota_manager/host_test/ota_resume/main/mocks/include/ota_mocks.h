@@ -0,0 +1,47 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-10
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-10
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\host_test\ota_resume\main\mocks\include\ota_mocks.h
+ * @Description: 主机测试替身的控制接口（分区 / NVS 复位、下载统计）
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define OTA_MOCK_MAX_BEGINS   16    ///< 记录的 esp_https_ota_begin 次数上限
+
+/** esp_https_ota 替身的统计 */
+typedef struct {
+	int      begins;                             ///< esp_https_ota_begin 调用次数
+	uint32_t begin_offsets[OTA_MOCK_MAX_BEGINS]; ///< 每次 begin 的续传偏移（0 表示从头）
+	int      finishes;                           ///< 成功 finish（设置启动分区）的次数
+	uint32_t bytes_received;                     ///< 所有会话收到的镜像字节数
+} ota_mock_stats_t;
+
+/**
+ * @brief 分配并擦除内存分区，清空 NVS 与统计
+ */
+void ota_mock_reset(uint32_t partition_size);
+
+/**
+ * @brief 清空统计（分区与 NVS 保留，模拟重启后再次调用下载）
+ */
+void ota_mock_clear_stats(void);
+
+const ota_mock_stats_t *ota_mock_get_stats(void);
+
+/**
+ * @brief 内存分区内容
+ */
+const uint8_t *ota_mock_partition_data(void);
+
+/**
+ * @brief NVS 中是否存在指定键
+ */
+bool ota_mock_nvs_has_key(const char *name, const char *key);
@@ -0,0 +1,400 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-10
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-10
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\host_test\ota_resume\main\mocks\ota_mocks.c
+ * @Description: 主机测试替身实现
+ *
+ *  - esp_https_ota：按 partial_http_download 语义对本地服务器发 Range 请求，写入内存分区；
+ *    ota_resumption 时从 ota_image_bytes_written 继续，否则整区擦除；连接中断即返回错误；
+ *  - esp_partition / esp_ota_ops：一块内存分区；
+ *  - nvs：少量 namespace/key -> blob 的内存表；
+ *  - metrics_trace_record：空实现。
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "esp_https_ota.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "metrics_trace.h"
+#include "ota_mocks.h"
+
+#define MOCK_RECV_SIZE        2048  ///< 每次 perform 最多读取的字节数
+#define MOCK_HEADER_MAX       1024  ///< 响应头最大长度
+#define MOCK_NVS_ENTRIES      4     ///< NVS 表项数
+#define MOCK_NVS_NAME_MAX     16
+#define MOCK_NVS_BLOB_MAX     512
+
+typedef struct {
+	uint16_t port;
+	char     path[128];
+	bool     partial;
+	uint32_t request_size;
+	uint32_t total;
+	uint32_t pos;       ///< 已写入分区的字节数
+	uint32_t req_end;   ///< 当前 Range 请求的结束位置（不含）
+	int      sock;      ///< 当前请求的连接，-1 表示无
+} mock_ota_t;
+
+typedef struct {
+	bool   used;
+	char   name[MOCK_NVS_NAME_MAX];
+	char   key[MOCK_NVS_NAME_MAX];
+	size_t len;
+	uint8_t blob[MOCK_NVS_BLOB_MAX];
+} mock_nvs_entry_t;
+
+static esp_partition_t   s_partition;
+static ota_mock_stats_t  s_stats;
+static mock_nvs_entry_t  s_nvs[MOCK_NVS_ENTRIES];
+static char              s_nvs_open_name[MOCK_NVS_ENTRIES][MOCK_NVS_NAME_MAX];
+
+/* -------------------- 控制接口 -------------------- */
+
+void ota_mock_reset(uint32_t partition_size)
+{
+	free(s_partition.data);
+	s_partition.size = partition_size;
+	s_partition.data = (uint8_t *)malloc(partition_size);
+	memset(s_partition.data, 0xff, partition_size);
+	memset(s_nvs, 0, sizeof(s_nvs));
+	ota_mock_clear_stats();
+}
+
+void ota_mock_clear_stats(void)
+{
+	memset(&s_stats, 0, sizeof(s_stats));
+}
+
+const ota_mock_stats_t *ota_mock_get_stats(void)
+{
+	return &s_stats;
+}
+
+const uint8_t *ota_mock_partition_data(void)
+{
+	return s_partition.data;
+}
+
+/* -------------------- 本地 HTTP 客户端 -------------------- */
+
+static int mock_connect(uint16_t port)
+{
+	int sock = socket(AF_INET, SOCK_STREAM, 0);
+	if (sock < 0) {
+		return -1;
+	}
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port   = htons(port),
+	};
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		close(sock);
+		return -1;
+	}
+	return sock;
+}
+
+/**
+ * @brief 发起 Range 请求并读完响应头
+ *
+ * @param[out] total 由 Content-Range 得到的镜像总大小
+ * @return 连接套接字，失败返回 -1
+ */
+static int mock_request(const mock_ota_t *ota, uint32_t first, uint32_t last, uint32_t *total)
+{
+	int sock = mock_connect(ota->port);
+	if (sock < 0) {
+		return -1;
+	}
+
+	char req[256];
+	int  n = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: 127.0.0.1\r\nRange: bytes=%u-%u\r\n"
+			  "Connection: close\r\n\r\n", ota->path, (unsigned)first, (unsigned)last);
+	if (send(sock, req, (size_t)n, 0) != n) {
+		close(sock);
+		return -1;
+	}
+
+	/* 逐字节读到空行，保证之后 recv 得到的都是正文 */
+	char   hdr[MOCK_HEADER_MAX];
+	size_t len = 0;
+	while (len + 1 < sizeof(hdr)) {
+		if (recv(sock, &hdr[len], 1, 0) != 1) {
+			close(sock);
+			return -1;
+		}
+		len++;
+		if (len >= 4 && memcmp(&hdr[len - 4], "\r\n\r\n", 4) == 0) {
+			break;
+		}
+	}
+	hdr[len] = '\0';
+
+	const char *range = strstr(hdr, "Content-Range: bytes ");
+	const char *slash = range ? strchr(range, '/') : NULL;
+	if (strncmp(hdr, "HTTP/1.1 206", 12) != 0 || !slash) {
+		close(sock);
+		return -1;
+	}
+	*total = (uint32_t)strtoul(slash + 1, NULL, 10);
+	return sock;
+}
+
+/* -------------------- esp_https_ota -------------------- */
+
+esp_err_t esp_https_ota_begin(const esp_https_ota_config_t *ota_config, esp_https_ota_handle_t *handle)
+{
+	mock_ota_t *ota = (mock_ota_t *)calloc(1, sizeof(mock_ota_t));
+	if (!ota) {
+		return ESP_ERR_NO_MEM;
+	}
+	ota->sock = -1;
+	if (sscanf(ota_config->http_config->url, "http://127.0.0.1:%hu%127s", &ota->port, ota->path) != 2) {
+		free(ota);
+		return ESP_ERR_INVALID_ARG;
+	}
+	ota->partial      = ota_config->partial_http_download;
+	ota->request_size = (uint32_t)ota_config->max_http_request_size;
+
+	/* 与 esp_https_ota 一样先请求一次拿到镜像大小 */
+	int sock = mock_request(ota, 0, 0, &ota->total);
+	if (sock < 0) {
+		free(ota);
+		return ESP_FAIL;
+	}
+	close(sock);
+	if (ota->total > s_partition.size) {
+		free(ota);
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	/* 续传从断点处擦除，否则整区擦除 */
+	ota->pos = ota_config->ota_resumption ? ota_config->ota_image_bytes_written : 0;
+	memset(s_partition.data + ota->pos, 0xff, s_partition.size - ota->pos);
+
+	if (s_stats.begins < OTA_MOCK_MAX_BEGINS) {
+		s_stats.begin_offsets[s_stats.begins] = ota->pos;
+	}
+	s_stats.begins++;
+	*handle = ota;
+	return ESP_OK;
+}
+
+esp_err_t esp_https_ota_perform(esp_https_ota_handle_t handle)
+{
+	mock_ota_t *ota = (mock_ota_t *)handle;
+	if (ota->pos >= ota->total) {
+		return ESP_OK;
+	}
+
+	if (ota->sock < 0) {
+		ota->req_end = ota->total;
+		if (ota->partial && ota->request_size > 0 && ota->pos + ota->request_size < ota->total) {
+			ota->req_end = ota->pos + ota->request_size;
+		}
+		uint32_t total;
+		ota->sock = mock_request(ota, ota->pos, ota->req_end - 1, &total);
+		if (ota->sock < 0) {
+			return ESP_FAIL;
+		}
+	}
+
+	uint32_t want = ota->req_end - ota->pos;
+	if (want > MOCK_RECV_SIZE) {
+		want = MOCK_RECV_SIZE;
+	}
+	ssize_t n = recv(ota->sock, s_partition.data + ota->pos, want, 0);
+	if (n <= 0) {
+		/* 连接在本次 Range 结束前断开 */
+		close(ota->sock);
+		ota->sock = -1;
+		return ESP_FAIL;
+	}
+	ota->pos += (uint32_t)n;
+	s_stats.bytes_received += (uint32_t)n;
+
+	if (ota->pos == ota->req_end) {
+		close(ota->sock);
+		ota->sock = -1;
+	}
+	return ota->pos == ota->total ? ESP_OK : ESP_ERR_HTTPS_OTA_IN_PROGRESS;
+}
+
+bool esp_https_ota_is_complete_data_received(esp_https_ota_handle_t handle)
+{
+	mock_ota_t *ota = (mock_ota_t *)handle;
+	return ota->pos == ota->total;
+}
+
+static void mock_ota_free(mock_ota_t *ota)
+{
+	if (ota->sock >= 0) {
+		close(ota->sock);
+	}
+	free(ota);
+}
+
+esp_err_t esp_https_ota_finish(esp_https_ota_handle_t handle)
+{
+	mock_ota_t *ota = (mock_ota_t *)handle;
+	esp_err_t   ret = esp_https_ota_is_complete_data_received(handle) ? ESP_OK : ESP_FAIL;
+	if (ret == ESP_OK) {
+		s_stats.finishes++;
+	}
+	mock_ota_free(ota);
+	return ret;
+}
+
+esp_err_t esp_https_ota_abort(esp_https_ota_handle_t handle)
+{
+	mock_ota_free((mock_ota_t *)handle);
+	return ESP_OK;
+}
+
+int esp_https_ota_get_image_len_read(esp_https_ota_handle_t handle)
+{
+	return (int)((mock_ota_t *)handle)->pos;
+}
+
+int esp_https_ota_get_image_size(esp_https_ota_handle_t handle)
+{
+	return (int)((mock_ota_t *)handle)->total;
+}
+
+/* -------------------- 分区 -------------------- */
+
+const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *start_from)
+{
+	(void)start_from;
+	return &s_partition;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+	if (src_offset + size > partition->size) {
+		return ESP_ERR_INVALID_SIZE;
+	}
+	memcpy(dst, partition->data + src_offset, size);
+	return ESP_OK;
+}
+
+/* -------------------- NVS -------------------- */
+
+static mock_nvs_entry_t *mock_nvs_find(const char *name, const char *key, bool create)
+{
+	for (int i = 0; i < MOCK_NVS_ENTRIES; i++) {
+		if (s_nvs[i].used && strcmp(s_nvs[i].name, name) == 0 && strcmp(s_nvs[i].key, key) == 0) {
+			return &s_nvs[i];
+		}
+	}
+	if (!create) {
+		return NULL;
+	}
+	for (int i = 0; i < MOCK_NVS_ENTRIES; i++) {
+		if (!s_nvs[i].used) {
+			s_nvs[i].used = true;
+			strncpy(s_nvs[i].name, name, MOCK_NVS_NAME_MAX - 1);
+			strncpy(s_nvs[i].key, key, MOCK_NVS_NAME_MAX - 1);
+			return &s_nvs[i];
+		}
+	}
+	return NULL;
+}
+
+bool ota_mock_nvs_has_key(const char *name, const char *key)
+{
+	return mock_nvs_find(name, key, false) != NULL;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+	(void)open_mode;
+	for (int i = 0; i < MOCK_NVS_ENTRIES; i++) {
+		if (s_nvs_open_name[i][0] == '\0' || strcmp(s_nvs_open_name[i], name) == 0) {
+			strncpy(s_nvs_open_name[i], name, MOCK_NVS_NAME_MAX - 1);
+			*out_handle = (nvs_handle_t)i;
+			return ESP_OK;
+		}
+	}
+	return ESP_ERR_NO_MEM;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+	mock_nvs_entry_t *e = mock_nvs_find(s_nvs_open_name[handle], key, false);
+	if (!e) {
+		return ESP_ERR_NVS_NOT_FOUND;
+	}
+	if (*length < e->len) {
+		return ESP_ERR_NVS_INVALID_LENGTH;
+	}
+	memcpy(out_value, e->blob, e->len);
+	*length = e->len;
+	return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+	if (length > MOCK_NVS_BLOB_MAX) {
+		return ESP_ERR_NVS_INVALID_LENGTH;
+	}
+	mock_nvs_entry_t *e = mock_nvs_find(s_nvs_open_name[handle], key, true);
+	if (!e) {
+		return ESP_ERR_NO_MEM;
+	}
+	memcpy(e->blob, value, length);
+	e->len = length;
+	return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+	mock_nvs_entry_t *e = mock_nvs_find(s_nvs_open_name[handle], key, false);
+	if (!e) {
+		return ESP_ERR_NVS_NOT_FOUND;
+	}
+	memset(e, 0, sizeof(*e));
+	return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+	(void)handle;
+	return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+	(void)handle;
+}
+
+/* -------------------- 其它 -------------------- */
+
+int64_t esp_timer_get_time(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void metrics_trace_record(metrics_trace_phase_t phase, const char *cat, const char *name, int32_t value)
+{
+	(void)phase;
+	(void)cat;
+	(void)name;
+	(void)value;
+}
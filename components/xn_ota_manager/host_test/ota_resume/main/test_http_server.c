@@ -0,0 +1,210 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-10
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-10
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\host_test\ota_resume\main\test_http_server.c
+ * @Description: 测试用本地 HTTP 服务器实现（单线程逐个处理连接，每个响应后关闭连接）
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#include "test_http_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define SERVER_SEND_SIZE   1024
+
+static struct {
+	const uint8_t *image;
+	size_t         size;
+	int            listen_sock;
+	pthread_t      thread;
+	pthread_mutex_t lock;
+	uint32_t       drop_after;
+	int            drop_count;
+	bool           corrupt;
+	uint32_t       corrupt_offset;
+	test_http_server_stats_t stats;
+} s_srv = {
+	.listen_sock = -1,
+	.lock        = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static bool send_all(int sock, const void *data, size_t len)
+{
+	const uint8_t *p = (const uint8_t *)data;
+	while (len > 0) {
+		ssize_t n = send(sock, p, len, MSG_NOSIGNAL);
+		if (n <= 0) {
+			return false;
+		}
+		p += n;
+		len -= (size_t)n;
+	}
+	return true;
+}
+
+static void serve_one(int sock)
+{
+	char   req[1024];
+	size_t len = 0;
+	while (len + 1 < sizeof(req)) {
+		ssize_t n = recv(sock, req + len, sizeof(req) - 1 - len, 0);
+		if (n <= 0) {
+			return;
+		}
+		len += (size_t)n;
+		req[len] = '\0';
+		if (strstr(req, "\r\n\r\n")) {
+			break;
+		}
+	}
+
+	uint32_t first = 0, last = (uint32_t)s_srv.size - 1;
+	const char *range = strstr(req, "Range: bytes=");
+	if (range) {
+		unsigned a = 0, b = 0;
+		int      got = sscanf(range, "Range: bytes=%u-%u", &a, &b);
+		first = a;
+		if (got == 2 && b < s_srv.size) {
+			last = b;
+		}
+	}
+	if (first > last) {
+		const char *resp = "HTTP/1.1 416 Range Not Satisfiable\r\nContent-Length: 0\r\n\r\n";
+		send_all(sock, resp, strlen(resp));
+		return;
+	}
+
+	uint32_t body = last - first + 1;
+	uint32_t limit = body;
+	bool     corrupt = false;
+	uint32_t corrupt_offset = 0;
+
+	pthread_mutex_lock(&s_srv.lock);
+	s_srv.stats.requests++;
+	if (s_srv.drop_count > 0 && body > s_srv.drop_after) {
+		s_srv.drop_count--;
+		s_srv.stats.drops++;
+		limit = s_srv.drop_after;
+	}
+	if (s_srv.corrupt && s_srv.corrupt_offset >= first && s_srv.corrupt_offset < first + limit) {
+		s_srv.corrupt  = false;
+		corrupt        = true;
+		corrupt_offset = s_srv.corrupt_offset;
+	}
+	pthread_mutex_unlock(&s_srv.lock);
+
+	char hdr[256];
+	int  n = snprintf(hdr, sizeof(hdr), "HTTP/1.1 206 Partial Content\r\nContent-Length: %u\r\n"
+			  "Content-Range: bytes %u-%u/%u\r\nConnection: close\r\n\r\n",
+			  (unsigned)body, (unsigned)first, (unsigned)last, (unsigned)s_srv.size);
+	if (!send_all(sock, hdr, (size_t)n)) {
+		return;
+	}
+
+	uint8_t buf[SERVER_SEND_SIZE];
+	for (uint32_t pos = 0; pos < limit; pos += sizeof(buf)) {
+		uint32_t chunk = (limit - pos) < sizeof(buf) ? (limit - pos) : sizeof(buf);
+		memcpy(buf, s_srv.image + first + pos, chunk);
+		if (corrupt && corrupt_offset >= first + pos && corrupt_offset < first + pos + chunk) {
+			buf[corrupt_offset - first - pos] ^= 0xff;
+		}
+		if (!send_all(sock, buf, chunk)) {
+			break;
+		}
+		pthread_mutex_lock(&s_srv.lock);
+		s_srv.stats.bytes_served += chunk;
+		pthread_mutex_unlock(&s_srv.lock);
+	}
+}
+
+static void *server_thread(void *arg)
+{
+	(void)arg;
+	while (true) {
+		int sock = accept(s_srv.listen_sock, NULL, NULL);
+		if (sock < 0) {
+			break;
+		}
+		serve_one(sock);
+		/* 断线注入时未发完的正文直接随连接关闭丢弃 */
+		close(sock);
+	}
+	return NULL;
+}
+
+uint16_t test_http_server_start(const uint8_t *image, size_t size)
+{
+	s_srv.image = image;
+	s_srv.size  = size;
+	s_srv.drop_count = 0;
+	s_srv.corrupt    = false;
+	memset(&s_srv.stats, 0, sizeof(s_srv.stats));
+
+	s_srv.listen_sock = socket(AF_INET, SOCK_STREAM, 0);
+	if (s_srv.listen_sock < 0) {
+		return 0;
+	}
+	int one = 1;
+	setsockopt(s_srv.listen_sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port   = 0,
+	};
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t addr_len = sizeof(addr);
+	if (bind(s_srv.listen_sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+	    listen(s_srv.listen_sock, 4) != 0 ||
+	    getsockname(s_srv.listen_sock, (struct sockaddr *)&addr, &addr_len) != 0 ||
+	    pthread_create(&s_srv.thread, NULL, server_thread, NULL) != 0) {
+		close(s_srv.listen_sock);
+		s_srv.listen_sock = -1;
+		return 0;
+	}
+	return ntohs(addr.sin_port);
+}
+
+void test_http_server_stop(void)
+{
+	if (s_srv.listen_sock < 0) {
+		return;
+	}
+	shutdown(s_srv.listen_sock, SHUT_RDWR);
+	close(s_srv.listen_sock);
+	pthread_join(s_srv.thread, NULL);
+	s_srv.listen_sock = -1;
+}
+
+void test_http_server_drop_after(uint32_t after_bytes, int count)
+{
+	pthread_mutex_lock(&s_srv.lock);
+	s_srv.drop_after = after_bytes;
+	s_srv.drop_count = count;
+	pthread_mutex_unlock(&s_srv.lock);
+}
+
+void test_http_server_corrupt_once(uint32_t offset)
+{
+	pthread_mutex_lock(&s_srv.lock);
+	s_srv.corrupt        = true;
+	s_srv.corrupt_offset = offset;
+	pthread_mutex_unlock(&s_srv.lock);
+}
+
+test_http_server_stats_t test_http_server_get_stats(void)
+{
+	pthread_mutex_lock(&s_srv.lock);
+	test_http_server_stats_t stats = s_srv.stats;
+	pthread_mutex_unlock(&s_srv.lock);
+	return stats;
+}
@@ -0,0 +1,41 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-10
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-10
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\host_test\ota_resume\main\test_http_server.h
+ * @Description: 测试用本地 HTTP 服务器 - 支持 Range，可注入断线和数据损坏
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** 服务器统计 */
+typedef struct {
+	int      requests;      ///< 收到的请求数
+	int      drops;         ///< 主动断开的响应数
+	uint32_t bytes_served;  ///< 发出的正文字节数
+} test_http_server_stats_t;
+
+/**
+ * @brief 在 127.0.0.1 的随机端口上启动服务器，GET 任意路径都返回 image
+ * @return 监听端口，失败返回 0
+ */
+uint16_t test_http_server_start(const uint8_t *image, size_t size);
+
+void test_http_server_stop(void);
+
+/**
+ * @brief 接下来 count 个正文不少于 after_bytes 的响应，在发出 after_bytes 字节后断开连接
+ */
+void test_http_server_drop_after(uint32_t after_bytes, int count);
+
+/**
+ * @brief 下一次发出镜像 offset 处的字节时将其取反（只生效一次）
+ */
+void test_http_server_corrupt_once(uint32_t offset);
+
+test_http_server_stats_t test_http_server_get_stats(void);
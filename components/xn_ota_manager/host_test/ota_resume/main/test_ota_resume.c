@@ -0,0 +1,247 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-10
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-10
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\host_test\ota_resume\main\test_ota_resume.c
+ * @Description: 断点续传 OTA 下载引擎主机测试
+ *
+ * 本地服务器按 Range 提供镜像并按需断线 / 篡改数据，检查：
+ *  - 断线后从 NVS 中已校验的偏移续传，而不是从头下载；
+ *  - 重试次数用尽时断点保留，下一次调用（模拟重启）继续；
+ *  - url / version 变化时丢弃旧断点；
+ *  - 分块摘要不一致时回退到该块重新下载，整包摘要 / 大小与清单不符时拒绝镜像；
+ *  - 限速生效，进度回调最终报告 100%。
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity.h"
+#include "esp_timer.h"
+#include "mbedtls/sha256.h"
+
+#include "http_ota_download.h"
+#include "ota_mocks.h"
+#include "test_http_server.h"
+
+#define TEST_CHUNK_SIZE      8192                        ///< 校验块大小
+#define TEST_CHUNKS          6                           ///< 分块数（最后一块不足整块）
+#define TEST_IMAGE_SIZE      (TEST_CHUNK_SIZE * 5 + 1234)
+#define TEST_REQUEST_SIZE    16384                       ///< 单次 Range 请求大小
+#define TEST_PARTITION_SIZE  (64 * 1024)
+
+static uint8_t  s_image[TEST_IMAGE_SIZE];
+static uint8_t  s_digests[TEST_CHUNKS * HTTP_OTA_SHA256_LEN];
+static uint8_t  s_image_sha256[HTTP_OTA_SHA256_LEN];
+static char     s_url[64];
+static uint32_t s_last_progress;
+static uint32_t s_last_total;
+
+static void on_progress(uint32_t written, uint32_t total, void *user_ctx)
+{
+	(void)user_ctx;
+	s_last_progress = written;
+	s_last_total    = total;
+}
+
+/**
+ * @brief 生成镜像与分块摘要，复位分区 / NVS，启动服务器
+ */
+static void fixture_start(void)
+{
+	srand(31);
+	for (size_t i = 0; i < sizeof(s_image); i++) {
+		s_image[i] = (uint8_t)rand();
+	}
+	for (size_t c = 0; c < TEST_CHUNKS; c++) {
+		size_t off = c * TEST_CHUNK_SIZE;
+		size_t len = sizeof(s_image) - off < TEST_CHUNK_SIZE ? sizeof(s_image) - off : TEST_CHUNK_SIZE;
+		mbedtls_sha256(s_image + off, len, &s_digests[c * HTTP_OTA_SHA256_LEN], 0);
+	}
+	mbedtls_sha256(s_image, sizeof(s_image), s_image_sha256, 0);
+
+	ota_mock_reset(TEST_PARTITION_SIZE);
+	s_last_progress = 0;
+	s_last_total    = 0;
+
+	uint16_t port = test_http_server_start(s_image, sizeof(s_image));
+	TEST_ASSERT_NOT_EQUAL(0, port);
+	snprintf(s_url, sizeof(s_url), "http://127.0.0.1:%u/fw.bin", (unsigned)port);
+}
+
+static http_ota_download_config_t fixture_config(const char *version, uint8_t max_retries)
+{
+	http_ota_download_config_t cfg = {
+		.url               = s_url,
+		.version           = version,
+		.image_size        = sizeof(s_image),
+		.image_sha256      = s_image_sha256,
+		.http_timeout_ms   = 5000,
+		.request_size      = TEST_REQUEST_SIZE,
+		.chunk_size        = TEST_CHUNK_SIZE,
+		.chunk_digests     = s_digests,
+		.chunk_count       = TEST_CHUNKS,
+		.max_bytes_per_sec = 0,
+		.max_retries       = max_retries,
+		.progress_cb       = on_progress,
+		.user_ctx          = NULL,
+	};
+	return cfg;
+}
+
+static void assert_image_installed(void)
+{
+	TEST_ASSERT_EQUAL_MEMORY(s_image, ota_mock_partition_data(), sizeof(s_image));
+	TEST_ASSERT_EQUAL(1, ota_mock_get_stats()->finishes);
+	TEST_ASSERT_FALSE(ota_mock_nvs_has_key("ota_resume", "state"));
+	TEST_ASSERT_EQUAL_UINT32(sizeof(s_image), s_last_progress);
+	TEST_ASSERT_EQUAL_UINT32(sizeof(s_image), s_last_total);
+}
+
+TEST_CASE("clean download installs the image in one session", "[ota_resume]")
+{
+	fixture_start();
+	http_ota_download_config_t cfg = fixture_config("1.0.0", 0);
+
+	TEST_ASSERT_EQUAL(ESP_OK, http_ota_download_run(&cfg));
+
+	const ota_mock_stats_t *stats = ota_mock_get_stats();
+	TEST_ASSERT_EQUAL(1, stats->begins);
+	TEST_ASSERT_EQUAL_UINT32(0, stats->begin_offsets[0]);
+	TEST_ASSERT_EQUAL_UINT32(sizeof(s_image), stats->bytes_received);
+	assert_image_installed();
+	test_http_server_stop();
+}
+
+TEST_CASE("disconnect mid-transfer resumes from the last verified chunk", "[ota_resume]")
+{
+	fixture_start();
+	http_ota_download_config_t cfg = fixture_config("1.0.0", 3);
+
+	/* 前两个 Range 响应各发 10000 字节后断开：第一次断在块 1 中间，第二次断在块 2 中间 */
+	test_http_server_drop_after(10000, 2);
+	TEST_ASSERT_EQUAL(ESP_OK, http_ota_download_run(&cfg));
+
+	const ota_mock_stats_t *stats = ota_mock_get_stats();
+	TEST_ASSERT_EQUAL(2, test_http_server_get_stats().drops);
+	TEST_ASSERT_EQUAL(3, stats->begins);
+	TEST_ASSERT_EQUAL_UINT32(0, stats->begin_offsets[0]);
+	TEST_ASSERT_EQUAL_UINT32(TEST_CHUNK_SIZE, stats->begin_offsets[1]);
+	TEST_ASSERT_EQUAL_UINT32(TEST_CHUNK_SIZE * 2, stats->begin_offsets[2]);
+	/* 只重下断点之后的数据 */
+	TEST_ASSERT_EQUAL_UINT32(10000 + 10000 + sizeof(s_image) - TEST_CHUNK_SIZE * 2, stats->bytes_received);
+	assert_image_installed();
+	test_http_server_stop();
+}
+
+TEST_CASE("resume record survives a failed run and is used by the next one", "[ota_resume]")
+{
+	fixture_start();
+	http_ota_download_config_t cfg = fixture_config("1.0.0", 0);
+
+	/* 不重试：断线后返回错误，断点保留在 NVS */
+	test_http_server_drop_after(10000, 1);
+	TEST_ASSERT_NOT_EQUAL(ESP_OK, http_ota_download_run(&cfg));
+	TEST_ASSERT_TRUE(ota_mock_nvs_has_key("ota_resume", "state"));
+	TEST_ASSERT_EQUAL(0, ota_mock_get_stats()->finishes);
+
+	/* 模拟重启后再次检查升级 */
+	ota_mock_clear_stats();
+	TEST_ASSERT_EQUAL(ESP_OK, http_ota_download_run(&cfg));
+
+	const ota_mock_stats_t *stats = ota_mock_get_stats();
+	TEST_ASSERT_EQUAL(1, stats->begins);
+	TEST_ASSERT_EQUAL_UINT32(TEST_CHUNK_SIZE, stats->begin_offsets[0]);
+	TEST_ASSERT_EQUAL_UINT32(sizeof(s_image) - TEST_CHUNK_SIZE, stats->bytes_received);
+	assert_image_installed();
+	test_http_server_stop();
+}
+
+TEST_CASE("resume record of another version is discarded", "[ota_resume]")
+{
+	fixture_start();
+	http_ota_download_config_t cfg = fixture_config("1.0.0", 0);
+
+	test_http_server_drop_after(10000, 1);
+	TEST_ASSERT_NOT_EQUAL(ESP_OK, http_ota_download_run(&cfg));
+	TEST_ASSERT_TRUE(ota_mock_nvs_has_key("ota_resume", "state"));
+
+	ota_mock_clear_stats();
+	cfg = fixture_config("1.0.1", 0);
+	TEST_ASSERT_EQUAL(ESP_OK, http_ota_download_run(&cfg));
+	TEST_ASSERT_EQUAL_UINT32(0, ota_mock_get_stats()->begin_offsets[0]);
+	assert_image_installed();
+	test_http_server_stop();
+}
+
+TEST_CASE("corrupted chunk is rolled back and downloaded again", "[ota_resume]")
+{
+	fixture_start();
+	http_ota_download_config_t cfg = fixture_config("1.0.0", 2);
+
+	test_http_server_corrupt_once(TEST_CHUNK_SIZE * 2 + 100);
+	TEST_ASSERT_EQUAL(ESP_OK, http_ota_download_run(&cfg));
+
+	const ota_mock_stats_t *stats = ota_mock_get_stats();
+	TEST_ASSERT_EQUAL(2, stats->begins);
+	TEST_ASSERT_EQUAL_UINT32(TEST_CHUNK_SIZE * 2, stats->begin_offsets[1]);
+	assert_image_installed();
+	test_http_server_stop();
+}
+
+TEST_CASE("image digest mismatch restarts from zero and never installs", "[ota_resume]")
+{
+	fixture_start();
+	http_ota_download_config_t cfg = fixture_config("1.0.0", 1);
+
+	uint8_t wrong[HTTP_OTA_SHA256_LEN];
+	memcpy(wrong, s_image_sha256, sizeof(wrong));
+	wrong[0] ^= 0xff;
+	cfg.image_sha256 = wrong;
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_CRC, http_ota_download_run(&cfg));
+
+	const ota_mock_stats_t *stats = ota_mock_get_stats();
+	TEST_ASSERT_EQUAL(2, stats->begins);
+	TEST_ASSERT_EQUAL_UINT32(0, stats->begin_offsets[1]);
+	TEST_ASSERT_EQUAL(0, stats->finishes);
+	test_http_server_stop();
+}
+
+TEST_CASE("image size differing from the manifest is rejected", "[ota_resume]")
+{
+	fixture_start();
+	http_ota_download_config_t cfg = fixture_config("1.0.0", 0);
+	cfg.image_size = sizeof(s_image) + 1;
+
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, http_ota_download_run(&cfg));
+	TEST_ASSERT_EQUAL(0, ota_mock_get_stats()->bytes_received);
+	TEST_ASSERT_EQUAL(0, ota_mock_get_stats()->finishes);
+	test_http_server_stop();
+}
+
+TEST_CASE("throttle limits the download rate", "[ota_resume]")
+{
+	fixture_start();
+	http_ota_download_config_t cfg = fixture_config("1.0.0", 0);
+	cfg.max_bytes_per_sec = 64 * 1024;
+
+	int64_t start_us = esp_timer_get_time();
+	TEST_ASSERT_EQUAL(ESP_OK, http_ota_download_run(&cfg));
+	int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+	/* 42 KB @ 64 KB/s 约 0.64 s，留出最后一次读取不再等待的余量 */
+	TEST_ASSERT_GREATER_OR_EQUAL(500000, elapsed_us);
+	assert_image_installed();
+	test_http_server_stop();
+}
+
+void app_main(void)
+{
+	UNITY_BEGIN();
+	unity_run_all_tests();
+	int failures = UNITY_END();
+	exit(failures == 0 ? 0 : 1);
+}
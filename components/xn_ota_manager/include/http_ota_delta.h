@@ -0,0 +1,99 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-11
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-11
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\include\http_ota_delta.h
+ * @Description: 差分 OTA - 以运行分区为基准流式应用补丁到空闲 OTA 分区
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef HTTP_OTA_DELTA_H
+#define HTTP_OTA_DELTA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 补丁格式（XNDP v1，小端序），由 ota_server/tools/xn_delta.py 生成
+ *
+ *  头部（80 字节，不压缩）：
+ *    magic "XNDP" | u8 version | u8 compression(0=无,1=zlib) | u16 reserved
+ *    u32 old_size | u32 new_size | old_sha256[32] | new_sha256[32]
+ *  操作流（compression=1 时整体 zlib 压缩）：
+ *    0x01 ADD    u32 src_off u32 len + len 字节差值：new[i] = old[src_off + i] + diff[i]
+ *    0x02 INSERT u32 len + len 字节原始数据
+ *    0x00 END
+ */
+#define HTTP_OTA_DELTA_MAGIC        "XNDP"
+#define HTTP_OTA_DELTA_VERSION      1
+#define HTTP_OTA_DELTA_HEADER_SIZE  80
+
+/** 差分补丁应用器句柄 */
+typedef struct http_ota_delta_s *http_ota_delta_handle_t;
+
+/**
+ * @brief 创建补丁应用器（按需分配解压字典，约 44KB）
+ *
+ * @return 句柄，失败返回 NULL
+ */
+http_ota_delta_handle_t http_ota_delta_create(void);
+
+/**
+ * @brief 流式写入补丁数据
+ *
+ * 头部收齐后校验运行分区与补丁基准一致，并开始写入空闲 OTA 分区。
+ *
+ * @param delta 句柄
+ * @param data  补丁数据
+ * @param len   数据长度
+ *
+ * @return
+ *  - ESP_OK                   : 成功
+ *  - ESP_ERR_INVALID_VERSION  : 补丁基准与运行分区不一致
+ *  - ESP_ERR_INVALID_RESPONSE : 补丁格式错误
+ *  - 其它 esp_err_t           : Flash 写入失败
+ */
+esp_err_t http_ota_delta_write(http_ota_delta_handle_t delta, const void *data, size_t len);
+
+/**
+ * @brief 结束补丁应用：校验新镜像 SHA-256 并设置为下次启动分区
+ *
+ * @param delta 句柄（无论成功与否都会被释放）
+ *
+ * @return
+ *  - ESP_OK              : 成功
+ *  - ESP_ERR_INVALID_CRC : 新镜像摘要不一致
+ *  - 其它 esp_err_t      : 补丁不完整或 OTA 结束失败
+ */
+esp_err_t http_ota_delta_finish(http_ota_delta_handle_t delta);
+
+/**
+ * @brief 放弃补丁应用并释放句柄
+ *
+ * @param delta 句柄，允许为 NULL
+ */
+void http_ota_delta_abort(http_ota_delta_handle_t delta);
+
+/**
+ * @brief 下载并应用差分补丁
+ *
+ * @param url             补丁下载地址
+ * @param http_timeout_ms HTTP 超时时间（毫秒）
+ *
+ * @return ESP_OK 成功，其它见 http_ota_delta_write / http_ota_delta_finish
+ */
+esp_err_t http_ota_delta_run(const char *url, int http_timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HTTP_OTA_DELTA_H */
@@ -0,0 +1,89 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-10
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-10
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\include\http_ota_download.h
+ * @Description: 可续传的分块 OTA 下载引擎（HTTP Range + NVS 断点 + 分块 SHA-256 校验）
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef HTTP_OTA_DOWNLOAD_H
+#define HTTP_OTA_DOWNLOAD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HTTP_OTA_SHA256_LEN          32             ///< SHA-256 摘要长度
+#define HTTP_OTA_RESUME_ALIGN        4096           ///< 断点偏移对齐（Flash 扇区大小，续传时整扇区重擦）
+
+/**
+ * @brief 下载进度回调
+ *
+ * @param written  已写入（含续传前已写入）的字节数
+ * @param total    镜像总字节数，未知时为 0
+ * @param user_ctx 用户上下文
+ */
+typedef void (*http_ota_progress_cb_t)(uint32_t written, uint32_t total, void *user_ctx);
+
+/**
+ * @brief 下载引擎配置
+ *
+ * chunk_digests 为按 chunk_size 切分的镜像逐块 SHA-256（最后一块可不足 chunk_size），
+ * 为 NULL 时不做分块校验，仅依赖 ESP-IDF 的镜像整体校验。
+ * image_size / image_sha256 为清单声明的整包大小与摘要，提供时在设置启动分区前
+ * 从 Flash 回读整包比对，不一致则放弃本次镜像并从头下载。
+ */
+typedef struct {
+	const char *url;                    ///< 固件下载 URL
+	const char *version;                ///< 固件版本号（断点记录以 url + version 为键）
+	uint32_t    image_size;             ///< 镜像大小（0 表示以服务端 Content-Range 为准）
+	const uint8_t *image_sha256;        ///< 整包 SHA-256，可为 NULL
+	int         http_timeout_ms;        ///< HTTP 超时时间（毫秒）
+	uint32_t    request_size;           ///< 单次 Range 请求字节数（0 表示一次请求整个镜像）
+	uint32_t    chunk_size;             ///< 校验块大小，必须是 HTTP_OTA_RESUME_ALIGN 的整数倍
+	const uint8_t *chunk_digests;       ///< 分块摘要数组（chunk_count * 32 字节），可为 NULL
+	size_t      chunk_count;            ///< 分块数量
+	uint32_t    max_bytes_per_sec;      ///< 下载限速（字节/秒，0 表示不限速）
+	uint8_t     max_retries;            ///< 断线后自动续传的最大次数
+	http_ota_progress_cb_t progress_cb; ///< 进度回调，可为 NULL
+	void       *user_ctx;               ///< 进度回调上下文
+} http_ota_download_config_t;
+
+/**
+ * @brief 执行一次可续传的 OTA 下载（阻塞直到完成或失败）
+ *
+ * 若 NVS 中存在相同 url + version 的断点，从已校验的偏移继续下载；
+ * 成功后设置启动分区并清除断点记录。
+ *
+ * @param config 下载配置
+ *
+ * @return
+ *  - ESP_OK                 : 镜像下载、校验并设置为下次启动分区
+ *  - ESP_ERR_INVALID_ARG    : 参数非法
+ *  - ESP_ERR_INVALID_CRC    : 分块或整包校验反复失败
+ *  - ESP_ERR_INVALID_SIZE   : 服务端镜像大小与 image_size 不一致
+ *  - 其它 esp_err_t         : 网络或 OTA 写入失败（断点已保留，下次调用可续传）
+ */
+esp_err_t http_ota_download_run(const http_ota_download_config_t *config);
+
+/**
+ * @brief 清除断点记录（下一次下载从头开始）
+ *
+ * @return ESP_OK 成功
+ */
+esp_err_t http_ota_download_clear_resume(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HTTP_OTA_DOWNLOAD_H */
@@ -32,13 +32,37 @@ extern "C" {
  *    {"version":"1.0.4",
  *     "url":"http://your-domain/firmware/xxx.bin",
  *     "description":"第一次优化",
- *     "force":true}
+ *     "force":true,
+ *     "size":1048576,                                          // 可选
+ *     "sha256":"<64 位十六进制>",                               // 可选
+ *     "chunk_size":65536,                                      // 可选
+ *     "chunks_url":"http://your-domain/firmware/xxx.bin.sha256", // 可选
+ *     "delta_base":"1.0.3",                                    // 可选
+ *     "delta_url":"http://your-domain/firmware/1.0.3-1.0.4.xndp", // 可选
+ *     "model":{"version":"kws-1.1",                            // 可选
+ *              "url":"http://your-domain/firmware/kws-1.1.xnmb",
+ *              "size":45312,
+ *              "sha256":"<64 位十六进制>"}}
+ *
+ *    size 与 sha256 为整包大小与摘要，提供时下载完成后回读 Flash 比对，通过后才设置启动分区；
+ *    缺失时只依赖 ESP-IDF 的镜像校验（如 URL 指向外部服务器、服务端无法计算摘要）。
+ *    chunks_url 指向逐块 SHA-256 清单（按 chunk_size 切分，每块 32 字节原始摘要顺序拼接），
+ *    提供时下载过程中每写满一块即回读校验，断点只推进到已校验的位置。
+ *    本地版本等于 delta_base 时优先下载 delta_url 指向的差分补丁（见 http_ota_delta.h），
+ *    补丁应用失败时自动回退为整包下载。
+ *    model 描述独立的 KWS 模型通道（模型包格式见 model_bundle.h）：固件已是最新时，
+ *    若远端模型版本与本地活动模型不同，下载到模型分区的非活动槽并切换，无需刷写固件和重启。
  *
  *  - 模块内部完成：
- *      1) 访问 version_url，解析上述 JSON；
- *      2) 使用 CONFIG_APP_PROJECT_VER 作为本地版本，与 JSON.version 对比；
- *      3) 判定是否需要升级，并按 JSON.url 下载固件，走 ESP-IDF OTA 流程；
- *      4) 升级成功后按配置决定是否自动重启。
+ *      1) 访问 version_url，解析上述 JSON（携带 ETag / Last-Modified 条件请求，
+ *         清单未变化时服务端返回 304，沿用上次解析结果）；
+ *      2) 使用 CONFIG_APP_PROJECT_VER 作为本地版本，按语义化版本与 JSON.version 比较
+ *         （见 http_ota_version.h）；已下载但尚未重启生效的镜像（auto_reboot 为 false）
+ *         与 JSON.version 相同时不再重复下载；
+ *      3) 远端较新时按 JSON.url 下载固件，走 ESP-IDF OTA 流程；远端较旧时仅在
+ *         force 为 true 时执行降级，否则忽略；
+ *      4) 升级成功后按配置决定是否自动重启；
+ *      5) check_interval_sec > 0 时由后台任务按带随机抖动的间隔周期执行上述流程。
  */
 
 /**
@@ -47,17 +71,19 @@ extern "C" {
 #define HTTP_OTA_VERSION_MAX_LEN   32    ///< 远端版本号最大长度（含 '\0'）
 #define HTTP_OTA_URL_MAX_LEN       256   ///< URL 最大长度（含 '\0'）
 #define HTTP_OTA_DESC_MAX_LEN      128   ///< 描述最大长度（含 '\0'，超出将被截断）
+#define HTTP_OTA_MAX_CHUNKS        512   ///< 分块校验清单最大块数
 
 /**
  * @brief HTTP OTA 管理器状态（精简版）
  *
- * 仅区分“空闲 / 正在执行 / 成功 / 失败”四种结果，具体阶段通过日志查看。
+ * 区分“空闲 / 正在执行 / 成功 / 失败”四种结果，下载阶段额外以 DOWNLOADING 上报进度。
  */
 typedef enum {
     HTTP_OTA_STATE_IDLE = 0,   ///< 空闲，当前没有 OTA 任务
     HTTP_OTA_STATE_RUNNING,    ///< 正在检查版本或执行 OTA 升级
     HTTP_OTA_STATE_SUCCESS,    ///< 本次检查/升级流程成功结束（已是最新或升级成功）
     HTTP_OTA_STATE_FAILED,     ///< 本次检查/升级流程失败
+    HTTP_OTA_STATE_DOWNLOADING,///< 正在下载固件，每推进约 1% 回调一次，进度见 http_ota_manager_get_progress
 } http_ota_state_t;
 
 /**
@@ -71,6 +97,17 @@ typedef enum {
  */
 typedef void (*http_ota_state_cb_t)(http_ota_state_t state);
 
+/**
+ * @brief 模型更新完成回调
+ *
+ * 新模型已写入并切换为活动槽（待确认），应用层可在此重新调用 model_store_load()
+ * 热加载模型，首次推理成功后调用 model_store_mark_valid() 确认。
+ * 当前固件没有本地推理端，默认配置不设置此回调，模型不会被加载，也就不会触发回滚。
+ *
+ * @param version 新模型版本
+ */
+typedef void (*http_ota_model_cb_t)(const char *version);
+
 /**
  * @brief 远端版本信息快照
  *
@@ -78,15 +115,36 @@ typedef void (*http_ota_state_cb_t)(http_ota_state_t state);
  *  - version      ← JSON 中的 "version"；
  *  - url          ← JSON 中的 "url"；
  *  - description  ← JSON 中的 "description"（如过长会被截断）；
- *  - force        ← JSON 中的 "force"（缺失时默认为 false）。
+ *  - force        ← JSON 中的 "force"（缺失时默认为 false）；
+ *  - size / sha256 ← JSON 中的 "size" / "sha256"（整包大小与摘要，可选）。
  */
 typedef struct {
     char version[HTTP_OTA_VERSION_MAX_LEN];   ///< 远端固件版本号
     char url[HTTP_OTA_URL_MAX_LEN];          ///< 固件下载 URL
     char description[HTTP_OTA_DESC_MAX_LEN]; ///< 更新说明
     bool force;                              ///< 是否为“强制更新”
+    uint32_t size;                           ///< 镜像大小（0 表示未提供）
+    uint8_t sha256[32];                      ///< 镜像 SHA-256
+    bool has_sha256;                         ///< sha256 是否有效
+    uint32_t chunk_size;                     ///< 校验块大小（0 表示不做分块校验）
+    char chunks_url[HTTP_OTA_URL_MAX_LEN];   ///< 分块 SHA-256 清单 URL
+    char delta_base[HTTP_OTA_VERSION_MAX_LEN]; ///< 差分补丁的基准版本
+    char delta_url[HTTP_OTA_URL_MAX_LEN];    ///< 差分补丁 URL
+    char model_version[HTTP_OTA_VERSION_MAX_LEN]; ///< 远端模型版本（空串表示未提供模型通道）
+    char model_url[HTTP_OTA_URL_MAX_LEN];    ///< 模型包 URL
+    uint32_t model_size;                     ///< 模型包大小（0 表示未提供）
+    uint8_t model_sha256[32];                ///< 模型包 SHA-256
+    bool model_has_sha256;                   ///< model_sha256 是否有效
 } http_ota_remote_info_t;
 
+/**
+ * @brief 下载进度快照
+ */
+typedef struct {
+    uint32_t written;                        ///< 已写入字节数（含续传前已写入部分）
+    uint32_t total;                          ///< 镜像总字节数，未知时为 0
+} http_ota_progress_t;
+
 /**
  * @brief HTTP OTA 管理模块配置
  *
@@ -107,10 +165,15 @@ typedef struct {
  */
 typedef struct {
     char  version_url[HTTP_OTA_URL_MAX_LEN]; ///< 版本配置 JSON 地址，如 "http://host/firmware/version.json"
-    int   check_interval_sec;                ///< 预留字段，当前实现未启用自动周期检查，建议填 0
+    int   check_interval_sec;                ///< 周期检查间隔（秒），0 表示不自动检查
+    uint8_t check_jitter_pct;                ///< 周期检查间隔的随机抖动幅度（±百分比，上限 50）
     int   http_timeout_ms;                   ///< HTTP 请求超时时间（毫秒）
     bool  auto_reboot;                       ///< OTA 升级成功后是否自动 esp_restart()
     http_ota_state_cb_t state_cb;            ///< 状态变化回调，可为 NULL 表示不关心
+    uint32_t request_size;                   ///< 单次 HTTP Range 请求字节数（0 表示整包一次请求）
+    uint32_t max_bytes_per_sec;              ///< 下载限速（字节/秒，0 表示不限速）
+    uint8_t  max_retries;                    ///< 断线后自动续传次数，超过后保留断点等待下次检查
+    http_ota_model_cb_t model_cb;            ///< 模型更新完成回调，可为 NULL
 } http_ota_manager_config_t;
 
 /**
@@ -118,18 +181,26 @@ typedef struct {
  *
  * 默认行为：
  *  - version_url 为空字符串，需要上层在初始化前填充；
- *  - 不自动周期检查（check_interval_sec = 0，需要调用 http_ota_manager_check_now 手动触发）；
+ *  - 不自动周期检查（check_interval_sec = 0，需要调用 http_ota_manager_check_now 手动触发），
+ *    启用后每次间隔叠加 ±10% 随机抖动；
  *  - HTTP 超时 15000 ms；
  *  - OTA 成功后自动重启（auto_reboot = true）；
- *  - 不注册状态回调（state_cb = NULL）。
+ *  - 不注册状态回调（state_cb = NULL）；
+ *  - 每次 Range 请求 16KB，不限速，断线自动续传 3 次；
+ *  - 不注册模型更新回调（model_cb = NULL）。
  */
 #define HTTP_OTA_MANAGER_DEFAULT_CONFIG()              \
     (http_ota_manager_config_t){                        \
         .version_url        = "",                      \
         .check_interval_sec = 0,                        \
+        .check_jitter_pct   = 10,                       \
         .http_timeout_ms    = 15000,                    \
         .auto_reboot        = true,                     \
         .state_cb           = NULL,                     \
+        .request_size       = 16 * 1024,                \
+        .max_bytes_per_sec  = 0,                        \
+        .max_retries        = 3,                        \
+        .model_cb           = NULL,                     \
     }
 
 /**
@@ -137,6 +208,7 @@ typedef struct {
  *
  * 功能概览：
  *  - 保存配置参数，准备内部 HTTP 客户端等资源；
+ *  - check_interval_sec > 0 时创建后台周期检查任务（首次检查在一个间隔之后）；
  *  - 可多次调用，仅首次生效，后续调用直接返回 ESP_OK。
  *
  * 使用建议：
@@ -157,14 +229,15 @@ esp_err_t http_ota_manager_init(const http_ota_manager_config_t *config);
  * @brief 立即触发一次 OTA 检查 / 升级流程
  *
  * 流程概览：
- *  1) HTTP GET version_url，解析 JSON；
- *  2) 使用 CONFIG_APP_PROJECT_VER 与 JSON.version 比较；
- *  3) 若无需升级：仅记录远端信息并返回成功；
- *  4) 若需要升级：按 JSON.url 下载固件并执行 OTA 流程。
+ *  1) HTTP GET version_url（条件请求），解析 JSON，304 时沿用上次结果；
+ *  2) 使用 CONFIG_APP_PROJECT_VER 与 JSON.version 按语义化版本比较；
+ *  3) 版本相同：检查模型通道，模型版本不同时下载新模型包；
+ *  4) 远端较新，或远端较旧且 force 为 true：按 JSON.url 下载固件并执行 OTA 流程；
+ *  5) 远端较旧且未设置 force：忽略，视为成功。
  *
  * - 调用期间内部会将状态设置为 HTTP_OTA_STATE_RUNNING，结束后根据结果切换为
  *   HTTP_OTA_STATE_SUCCESS 或 HTTP_OTA_STATE_FAILED。
- * - 若当前已有 OTA 在执行，则立即返回 ESP_ERR_INVALID_STATE。
+ * - 若当前已有 OTA 在执行（包括后台周期检查），则立即返回 ESP_ERR_INVALID_STATE。
  *
  * @return
  *  - ESP_OK                 : 本次检查/升级流程执行完成（不一定发生升级）
@@ -196,6 +269,19 @@ http_ota_state_t http_ota_manager_get_state(void);
  */
 esp_err_t http_ota_manager_get_last_remote_info(http_ota_remote_info_t *info);
 
+/**
+ * @brief 获取当前下载进度
+ *
+ * 一般在 state_cb 收到 HTTP_OTA_STATE_DOWNLOADING 时调用。
+ *
+ * @param[out] progress 调用方提供的结构体指针，不可为 NULL
+ *
+ * @return
+ *  - ESP_OK              : 拷贝成功
+ *  - ESP_ERR_INVALID_ARG : progress 为 NULL
+ */
+esp_err_t http_ota_manager_get_progress(http_ota_progress_t *progress);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,59 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-12
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-12
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\include\http_ota_model.h
+ * @Description: 模型 OTA - 下载 KWS 模型包写入模型分区的非活动槽，无需刷写固件
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef HTTP_OTA_MODEL_H
+#define HTTP_OTA_MODEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "http_ota_download.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 模型下载配置
+ *
+ * 模型包格式见 model_bundle.h；写入、校验与 A/B 切换由 model_store 完成。
+ */
+typedef struct {
+	const char    *url;                 ///< 模型包下载 URL
+	uint32_t       size;                ///< 模型包大小（0 表示以 Content-Length 为准）
+	const uint8_t *sha256;              ///< 整包 SHA-256，可为 NULL（仅校验包内摘要）
+	int            http_timeout_ms;     ///< HTTP 超时时间（毫秒）
+	uint8_t        max_retries;         ///< 失败后重新下载的最大次数
+	http_ota_progress_cb_t progress_cb; ///< 进度回调，可为 NULL
+	void          *user_ctx;            ///< 进度回调上下文
+} http_ota_model_config_t;
+
+/**
+ * @brief 下载模型包并切换到新模型（阻塞直到完成或失败）
+ *
+ * 成功后新模型处于待确认状态，下一次 model_store_load() 时生效；
+ * 失败时活动槽保持不变。
+ *
+ * @param config 下载配置
+ *
+ * @return
+ *  - ESP_OK              : 下载并校验成功
+ *  - ESP_ERR_INVALID_CRC : 摘要不一致
+ *  - 其它 esp_err_t      : HTTP 或写入失败，具体见日志
+ */
+esp_err_t http_ota_model_run(const http_ota_model_config_t *config);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HTTP_OTA_MODEL_H */
@@ -0,0 +1,51 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-13
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-13
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\include\http_ota_version.h
+ * @Description: 固件版本号比较 - 语义化版本（SemVer 2.0）
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef HTTP_OTA_VERSION_H
+#define HTTP_OTA_VERSION_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 比较两个语义化版本号
+ *
+ * 支持 "MAJOR.MINOR.PATCH[-PRERELEASE][+BUILD]"，可带 'v' 前缀，缺省的次版本 / 修订号按 0 处理：
+ *  - 数字部分逐级按数值比较（"1.0.10" > "1.0.9"）；
+ *  - 带预发布标识的版本低于对应正式版（"1.1.0-rc.1" < "1.1.0"），
+ *    预发布标识按点分段比较，数字段按数值、字母段按 ASCII，数字段低于字母段；
+ *  - 构建元数据（'+' 之后）不参与比较。
+ * 任一版本号无法解析时退化为字符串比较。
+ *
+ * @param a 版本号 a
+ * @param b 版本号 b
+ *
+ * @return 负数 a < b，0 相等，正数 a > b
+ */
+int http_ota_version_compare(const char *a, const char *b);
+
+/**
+ * @brief 检查版本号是否为合法的语义化版本
+ *
+ * @param version 版本号
+ *
+ * @return true 可按语义化版本比较
+ */
+bool http_ota_version_is_valid(const char *version);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HTTP_OTA_VERSION_H */
@@ -0,0 +1,523 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-11
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-11
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\src\http_ota_delta.c
+ * @Description: 差分 OTA 实现
+ *
+ * 补丁以流的方式到达，边解压边执行：
+ *  - ADD 从运行分区读取旧数据并逐字节叠加差值，INSERT 直接写入新数据；
+ *  - 解压使用 ROM 内置的 tinfl，字典 32KB + 解压器约 11KB，与镜像大小无关；
+ *  - 开始写入前校验运行分区前 old_size 字节的 SHA-256，确保补丁基准一致；
+ *  - 结束时校验新镜像 SHA-256，通过后才设置启动分区。
+ */
+
+#include "http_ota_delta.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_http_client.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "mbedtls/sha256.h"
+#include "rom/miniz.h"
+
+#include "http_ota_download.h"
+
+/* 本模块日志 TAG，用于 ESP_LOGx 宏输出 */
+static const char *TAG = "http_ota_delta";
+
+#define DELTA_IO_SIZE         1024      ///< 旧分区读取 / 新分区写入的缓冲大小
+#define DELTA_HTTP_BUF_SIZE   2048      ///< 补丁下载缓冲大小
+#define DELTA_SHA256_LEN      32
+
+/** 操作码 */
+enum {
+	DELTA_OP_END    = 0x00,
+	DELTA_OP_ADD    = 0x01,
+	DELTA_OP_INSERT = 0x02,
+};
+
+/** 解析状态 */
+typedef enum {
+	DELTA_ST_HEADER = 0,  ///< 收集 80 字节头部
+	DELTA_ST_OP,          ///< 等待操作码
+	DELTA_ST_ARGS,        ///< 收集操作参数
+	DELTA_ST_ADD,         ///< 处理 ADD 差值数据
+	DELTA_ST_INSERT,      ///< 处理 INSERT 原始数据
+	DELTA_ST_DONE,        ///< 已读到 END
+} delta_state_t;
+
+/**
+ * @brief 差分补丁应用器上下文
+ */
+typedef struct http_ota_delta_s {
+	delta_state_t st;                           ///< 解析状态
+	uint8_t       hdr[HTTP_OTA_DELTA_HEADER_SIZE]; ///< 头部缓存
+	size_t        hdr_len;                      ///< 已收集的头部字节数
+	uint32_t      old_size;                     ///< 基准镜像大小
+	uint32_t      new_size;                     ///< 新镜像大小
+	uint8_t       new_sha[DELTA_SHA256_LEN];    ///< 新镜像期望摘要
+
+	bool               compressed;              ///< 操作流是否 zlib 压缩
+	tinfl_decompressor *inflator;               ///< 解压器
+	uint8_t            *dict;                   ///< 解压环形字典
+	size_t             dict_ofs;                ///< 字典写入位置
+	bool               inflate_done;            ///< 压缩流是否结束
+
+	uint8_t  op;                                ///< 当前操作码
+	uint8_t  args[8];                           ///< 操作参数缓存
+	size_t   args_len;                          ///< 已收集参数字节数
+	size_t   args_need;                         ///< 当前操作所需参数字节数
+	uint32_t src_off;                           ///< ADD 当前旧数据偏移
+	uint32_t remaining;                         ///< 当前操作剩余数据字节数
+
+	const esp_partition_t *running;             ///< 运行分区（基准）
+	const esp_partition_t *update;              ///< 目标 OTA 分区
+	esp_ota_handle_t       ota;                 ///< OTA 写句柄
+	bool                   ota_started;         ///< 是否已 esp_ota_begin
+
+	mbedtls_sha256_context sha;                 ///< 新镜像摘要计算
+	uint32_t               written;             ///< 已产生的新镜像字节数
+	uint8_t                old_buf[DELTA_IO_SIZE]; ///< 旧数据读取缓冲
+	uint8_t                out_buf[DELTA_IO_SIZE]; ///< 写入合并缓冲
+	size_t                 out_len;             ///< 写入缓冲已用字节数
+} http_ota_delta_t;
+
+static uint32_t read_le32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief 计算运行分区前 len 字节的 SHA-256
+ */
+static esp_err_t partition_sha256(const esp_partition_t *part, uint32_t len, uint8_t *buf,
+				  uint8_t out[DELTA_SHA256_LEN])
+{
+	mbedtls_sha256_context sha;
+	esp_err_t              ret = ESP_OK;
+
+	mbedtls_sha256_init(&sha);
+	mbedtls_sha256_starts(&sha, 0);
+	for (uint32_t pos = 0; pos < len; pos += DELTA_IO_SIZE) {
+		uint32_t n = (len - pos) < DELTA_IO_SIZE ? (len - pos) : DELTA_IO_SIZE;
+		ret        = esp_partition_read(part, pos, buf, n);
+		if (ret != ESP_OK) {
+			break;
+		}
+		mbedtls_sha256_update(&sha, buf, n);
+	}
+	mbedtls_sha256_finish(&sha, out);
+	mbedtls_sha256_free(&sha);
+	return ret;
+}
+
+/**
+ * @brief 解析头部，校验基准并开始 OTA 写入
+ */
+static esp_err_t delta_begin(http_ota_delta_t *d)
+{
+	const uint8_t *h = d->hdr;
+	if (memcmp(h, HTTP_OTA_DELTA_MAGIC, 4) != 0 || h[4] != HTTP_OTA_DELTA_VERSION || h[5] > 1) {
+		ESP_LOGE(TAG, "invalid patch header");
+		return ESP_ERR_INVALID_RESPONSE;
+	}
+
+	d->compressed = h[5] == 1;
+	d->old_size   = read_le32(&h[8]);
+	d->new_size   = read_le32(&h[12]);
+	memcpy(d->new_sha, &h[48], DELTA_SHA256_LEN);
+
+	d->running = esp_ota_get_running_partition();
+	d->update  = esp_ota_get_next_update_partition(NULL);
+	if (!d->running || !d->update || d->old_size > d->running->size || d->new_size > d->update->size) {
+		ESP_LOGE(TAG, "patch size mismatch: old=%u new=%u", (unsigned)d->old_size, (unsigned)d->new_size);
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	/* 基准校验：补丁只能应用到生成它时使用的那个镜像上 */
+	uint8_t   digest[DELTA_SHA256_LEN];
+	esp_err_t ret = partition_sha256(d->running, d->old_size, d->old_buf, digest);
+	if (ret != ESP_OK || memcmp(digest, &h[16], DELTA_SHA256_LEN) != 0) {
+		ESP_LOGE(TAG, "running image does not match patch base");
+		return ESP_ERR_INVALID_VERSION;
+	}
+
+	if (d->compressed) {
+		d->inflator = (tinfl_decompressor *)malloc(sizeof(tinfl_decompressor));
+		d->dict     = (uint8_t *)malloc(TINFL_LZ_DICT_SIZE);
+		if (!d->inflator || !d->dict) {
+			return ESP_ERR_NO_MEM;
+		}
+		tinfl_init(d->inflator);
+	}
+
+	/* esp_ota_begin 会擦除更新分区，整包下载留下的断点记录随之失效，
+	 * 不清除的话下次整包下载会从该偏移续传到一个已被覆盖的分区 */
+	http_ota_download_clear_resume();
+
+	ret = esp_ota_begin(d->update, d->new_size, &d->ota);
+	if (ret != ESP_OK) {
+		ESP_LOGE(TAG, "esp_ota_begin failed: %s", esp_err_to_name(ret));
+		return ret;
+	}
+	d->ota_started = true;
+	mbedtls_sha256_starts(&d->sha, 0);
+
+	ESP_LOGI(TAG, "apply patch %s: %u -> %u bytes", d->compressed ? "(zlib)" : "",
+		 (unsigned)d->old_size, (unsigned)d->new_size);
+	return ESP_OK;
+}
+
+/**
+ * @brief 输出新镜像数据：计算摘要并合并写入 OTA 分区
+ */
+static esp_err_t delta_emit(http_ota_delta_t *d, const uint8_t *data, size_t len)
+{
+	if (d->written + len > d->new_size) {
+		ESP_LOGE(TAG, "patch produces more than %u bytes", (unsigned)d->new_size);
+		return ESP_ERR_INVALID_RESPONSE;
+	}
+	mbedtls_sha256_update(&d->sha, data, len);
+	d->written += len;
+
+	while (len > 0) {
+		size_t n = sizeof(d->out_buf) - d->out_len;
+		if (n > len) {
+			n = len;
+		}
+		memcpy(&d->out_buf[d->out_len], data, n);
+		d->out_len += n;
+		data += n;
+		len -= n;
+		if (d->out_len == sizeof(d->out_buf)) {
+			esp_err_t ret = esp_ota_write(d->ota, d->out_buf, d->out_len);
+			if (ret != ESP_OK) {
+				ESP_LOGE(TAG, "esp_ota_write failed: %s", esp_err_to_name(ret));
+				return ret;
+			}
+			d->out_len = 0;
+		}
+	}
+	return ESP_OK;
+}
+
+/**
+ * @brief 处理已解压的操作流
+ */
+static esp_err_t delta_feed_ops(http_ota_delta_t *d, const uint8_t *data, size_t len)
+{
+	esp_err_t ret = ESP_OK;
+
+	while (len > 0 && ret == ESP_OK) {
+		switch (d->st) {
+		case DELTA_ST_OP:
+			d->op       = *data++;
+			len--;
+			d->args_len = 0;
+			if (d->op == DELTA_OP_END) {
+				d->st = DELTA_ST_DONE;
+			} else if (d->op == DELTA_OP_ADD || d->op == DELTA_OP_INSERT) {
+				d->args_need = d->op == DELTA_OP_ADD ? 8 : 4;
+				d->st        = DELTA_ST_ARGS;
+			} else {
+				ESP_LOGE(TAG, "unknown op 0x%02x", d->op);
+				ret = ESP_ERR_INVALID_RESPONSE;
+			}
+			break;
+
+		case DELTA_ST_ARGS: {
+			size_t n = d->args_need - d->args_len;
+			if (n > len) {
+				n = len;
+			}
+			memcpy(&d->args[d->args_len], data, n);
+			d->args_len += n;
+			data += n;
+			len -= n;
+			if (d->args_len < d->args_need) {
+				break;
+			}
+			if (d->op == DELTA_OP_ADD) {
+				d->src_off   = read_le32(&d->args[0]);
+				d->remaining = read_le32(&d->args[4]);
+				if ((uint64_t)d->src_off + d->remaining > d->old_size) {
+					ESP_LOGE(TAG, "ADD out of base range");
+					ret = ESP_ERR_INVALID_RESPONSE;
+					break;
+				}
+				d->st = DELTA_ST_ADD;
+			} else {
+				d->remaining = read_le32(&d->args[0]);
+				d->st        = DELTA_ST_INSERT;
+			}
+			if (d->remaining == 0) {
+				d->st = DELTA_ST_OP;
+			}
+			break;
+		}
+
+		case DELTA_ST_ADD: {
+			size_t n = d->remaining < len ? d->remaining : len;
+			if (n > DELTA_IO_SIZE) {
+				n = DELTA_IO_SIZE;
+			}
+			ret = esp_partition_read(d->running, d->src_off, d->old_buf, n);
+			if (ret != ESP_OK) {
+				break;
+			}
+			for (size_t i = 0; i < n; i++) {
+				d->old_buf[i] = (uint8_t)(d->old_buf[i] + data[i]);
+			}
+			ret = delta_emit(d, d->old_buf, n);
+			d->src_off += n;
+			d->remaining -= n;
+			data += n;
+			len -= n;
+			if (d->remaining == 0) {
+				d->st = DELTA_ST_OP;
+			}
+			break;
+		}
+
+		case DELTA_ST_INSERT: {
+			size_t n = d->remaining < len ? d->remaining : len;
+			ret      = delta_emit(d, data, n);
+			d->remaining -= n;
+			data += n;
+			len -= n;
+			if (d->remaining == 0) {
+				d->st = DELTA_ST_OP;
+			}
+			break;
+		}
+
+		default:
+			ESP_LOGE(TAG, "unexpected data after END");
+			ret = ESP_ERR_INVALID_RESPONSE;
+			break;
+		}
+	}
+	return ret;
+}
+
+/**
+ * @brief 解压并处理操作流
+ */
+static esp_err_t delta_inflate(http_ota_delta_t *d, const uint8_t *data, size_t len)
+{
+	while (!d->inflate_done) {
+		size_t in_size  = len;
+		size_t out_size = TINFL_LZ_DICT_SIZE - d->dict_ofs;
+		tinfl_status status = tinfl_decompress(d->inflator, data, &in_size, d->dict, d->dict + d->dict_ofs,
+						       &out_size,
+						       TINFL_FLAG_HAS_MORE_INPUT | TINFL_FLAG_PARSE_ZLIB_HEADER);
+		data += in_size;
+		len -= in_size;
+
+		if (out_size > 0) {
+			esp_err_t ret = delta_feed_ops(d, d->dict + d->dict_ofs, out_size);
+			if (ret != ESP_OK) {
+				return ret;
+			}
+			d->dict_ofs = (d->dict_ofs + out_size) & (TINFL_LZ_DICT_SIZE - 1);
+		}
+
+		if (status < TINFL_STATUS_DONE) {
+			ESP_LOGE(TAG, "inflate failed: %d", (int)status);
+			return ESP_ERR_INVALID_RESPONSE;
+		}
+		if (status == TINFL_STATUS_DONE) {
+			d->inflate_done = true;
+		} else if (status == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0) {
+			break;
+		}
+	}
+	return ESP_OK;
+}
+
+http_ota_delta_handle_t http_ota_delta_create(void)
+{
+	http_ota_delta_t *d = (http_ota_delta_t *)calloc(1, sizeof(http_ota_delta_t));
+	if (!d) {
+		ESP_LOGE(TAG, "alloc delta context failed");
+		return NULL;
+	}
+	mbedtls_sha256_init(&d->sha);
+	return d;
+}
+
+/**
+ * @brief 流式写入补丁数据
+ *
+ * @param delta 句柄
+ * @param data  补丁数据
+ * @param len   数据长度
+ *
+ * @return ESP_OK 成功，其它为头部 / 基准 / 格式 / 写入错误
+ */
+esp_err_t http_ota_delta_write(http_ota_delta_handle_t delta, const void *data, size_t len)
+{
+	if (!delta || (!data && len > 0)) {
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	const uint8_t *p = (const uint8_t *)data;
+	if (delta->st == DELTA_ST_HEADER) {
+		size_t n = HTTP_OTA_DELTA_HEADER_SIZE - delta->hdr_len;
+		if (n > len) {
+			n = len;
+		}
+		memcpy(&delta->hdr[delta->hdr_len], p, n);
+		delta->hdr_len += n;
+		p += n;
+		len -= n;
+		if (delta->hdr_len < HTTP_OTA_DELTA_HEADER_SIZE) {
+			return ESP_OK;
+		}
+		esp_err_t ret = delta_begin(delta);
+		if (ret != ESP_OK) {
+			return ret;
+		}
+		delta->st = DELTA_ST_OP;
+	}
+
+	if (len == 0) {
+		return ESP_OK;
+	}
+	return delta->compressed ? delta_inflate(delta, p, len) : delta_feed_ops(delta, p, len);
+}
+
+static void delta_free(http_ota_delta_t *d)
+{
+	mbedtls_sha256_free(&d->sha);
+	free(d->inflator);
+	free(d->dict);
+	free(d);
+}
+
+/**
+ * @brief 结束补丁应用
+ *
+ * @param delta 句柄（无论成功与否都会被释放）
+ *
+ * @return ESP_OK 成功，ESP_ERR_INVALID_CRC 摘要不一致，其它为补丁不完整或写入失败
+ */
+esp_err_t http_ota_delta_finish(http_ota_delta_handle_t delta)
+{
+	if (!delta) {
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	esp_err_t ret = ESP_OK;
+	if (delta->st != DELTA_ST_DONE || delta->written != delta->new_size) {
+		ESP_LOGE(TAG, "patch incomplete: %u/%u bytes", (unsigned)delta->written, (unsigned)delta->new_size);
+		ret = ESP_ERR_INVALID_SIZE;
+	}
+	if (ret == ESP_OK && delta->out_len > 0) {
+		ret = esp_ota_write(delta->ota, delta->out_buf, delta->out_len);
+	}
+	if (ret == ESP_OK) {
+		uint8_t digest[DELTA_SHA256_LEN];
+		mbedtls_sha256_finish(&delta->sha, digest);
+		if (memcmp(digest, delta->new_sha, DELTA_SHA256_LEN) != 0) {
+			ESP_LOGE(TAG, "new image sha256 mismatch");
+			ret = ESP_ERR_INVALID_CRC;
+		}
+	}
+
+	if (ret != ESP_OK) {
+		http_ota_delta_abort(delta);
+		return ret;
+	}
+
+	ret = esp_ota_end(delta->ota);
+	if (ret == ESP_OK) {
+		ret = esp_ota_set_boot_partition(delta->update);
+	}
+	if (ret != ESP_OK) {
+		ESP_LOGE(TAG, "finish delta OTA failed: %s", esp_err_to_name(ret));
+	} else {
+		ESP_LOGI(TAG, "delta OTA applied, %u bytes", (unsigned)delta->written);
+	}
+	delta_free(delta);
+	return ret;
+}
+
+void http_ota_delta_abort(http_ota_delta_handle_t delta)
+{
+	if (!delta) {
+		return;
+	}
+	if (delta->ota_started) {
+		esp_ota_abort(delta->ota);
+	}
+	delta_free(delta);
+}
+
+/**
+ * @brief 下载并应用差分补丁
+ *
+ * @param url             补丁下载地址
+ * @param http_timeout_ms HTTP 超时时间（毫秒）
+ *
+ * @return ESP_OK 成功，其它见 http_ota_delta_write / http_ota_delta_finish
+ */
+esp_err_t http_ota_delta_run(const char *url, int http_timeout_ms)
+{
+	if (!url || url[0] == '\0') {
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	esp_http_client_config_t http_cfg = {
+		.url                         = url,
+		.timeout_ms                  = http_timeout_ms,
+		.method                      = HTTP_METHOD_GET,
+		/* 如需严格校验证书，可在此关闭 skip，并配置证书等信息 */
+		.skip_cert_common_name_check = true,
+	};
+
+	esp_http_client_handle_t client = esp_http_client_init(&http_cfg);
+	if (!client) {
+		ESP_LOGE(TAG, "esp_http_client_init failed");
+		return ESP_FAIL;
+	}
+
+	char                   *buf   = (char *)malloc(DELTA_HTTP_BUF_SIZE);
+	http_ota_delta_handle_t delta = http_ota_delta_create();
+	esp_err_t               err   = (buf && delta) ? esp_http_client_open(client, 0) : ESP_ERR_NO_MEM;
+	if (err == ESP_OK) {
+		esp_http_client_fetch_headers(client);
+		if (esp_http_client_get_status_code(client) != 200) {
+			ESP_LOGE(TAG, "unexpected HTTP status: %d", esp_http_client_get_status_code(client));
+			err = ESP_FAIL;
+		}
+	}
+
+	while (err == ESP_OK) {
+		int read_len = esp_http_client_read(client, buf, DELTA_HTTP_BUF_SIZE);
+		if (read_len < 0) {
+			ESP_LOGE(TAG, "read patch failed");
+			err = ESP_FAIL;
+		} else if (read_len == 0) {
+			break;
+		} else {
+			err = http_ota_delta_write(delta, buf, (size_t)read_len);
+		}
+	}
+
+	esp_http_client_close(client);
+	esp_http_client_cleanup(client);
+	free(buf);
+
+	if (err != ESP_OK) {
+		http_ota_delta_abort(delta);
+		return err;
+	}
+	return http_ota_delta_finish(delta);
+}
@@ -0,0 +1,396 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-10
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-10
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\src\http_ota_download.c
+ * @Description: 可续传的分块 OTA 下载引擎实现
+ *
+ * 基于 esp_https_ota_begin/perform：
+ *  - partial_http_download 按 request_size 发起 Range 请求，单次断线只影响一个请求；
+ *  - ota_resumption 从 NVS 记录的偏移继续写入，断电/重启后也能续传；
+ *  - 每写满一个校验块即从 Flash 回读计算 SHA-256，与服务端清单比对，
+ *    校验通过后才推进 NVS 中的断点偏移，因此断点之前的数据总是可信的；
+ *  - 按 max_bytes_per_sec 限速，避免挤占音频上行带宽。
+ */
+
+#include "http_ota_download.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_http_client.h"
+#include "esp_https_ota.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "nvs.h"
+#include "mbedtls/sha256.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "http_ota_manager.h"
+#include "metrics_trace.h"
+
+/* 本模块日志 TAG，用于 ESP_LOGx 宏输出 */
+static const char *TAG = "http_ota_download";
+
+#define OTA_RESUME_NVS_NAMESPACE  "ota_resume"    ///< 断点记录 NVS 命名空间
+#define OTA_RESUME_NVS_KEY        "state"         ///< 断点记录键名
+#define OTA_FLASH_WRITE_SLACK     16              ///< esp_ota_write 可能缓存未落盘的字节数（加密对齐）
+#define OTA_VERIFY_READ_SIZE      1024            ///< 回读校验的单次读取大小
+#define OTA_RETRY_BASE_DELAY_MS   1000            ///< 续传重试的初始退避时间
+
+/**
+ * @brief 持久化到 NVS 的断点记录
+ *
+ * 以单个 blob 保存，保证 url / version / offset 三者原子更新。
+ */
+typedef struct {
+	char     url[HTTP_OTA_URL_MAX_LEN];         ///< 正在下载的固件 URL
+	char     version[HTTP_OTA_VERSION_MAX_LEN]; ///< 正在下载的固件版本
+	uint32_t offset;                            ///< 已校验并落盘的字节数（扇区对齐）
+	uint32_t total;                             ///< 镜像总大小
+} ota_resume_state_t;
+
+/* -------------------- 断点记录 -------------------- */
+
+/**
+ * @brief 读取断点记录
+ *
+ * @param[out] state 断点记录
+ *
+ * @return
+ *  - ESP_OK                : 读取成功
+ *  - ESP_ERR_NVS_NOT_FOUND : 没有断点记录
+ */
+static esp_err_t resume_load(ota_resume_state_t *state)
+{
+	nvs_handle_t handle;
+	esp_err_t    ret = nvs_open(OTA_RESUME_NVS_NAMESPACE, NVS_READONLY, &handle);
+	if (ret != ESP_OK) {
+		return ret;
+	}
+
+	size_t len = sizeof(*state);
+	ret        = nvs_get_blob(handle, OTA_RESUME_NVS_KEY, state, &len);
+	nvs_close(handle);
+	if (ret == ESP_OK && len != sizeof(*state)) {
+		ret = ESP_ERR_NVS_INVALID_LENGTH;
+	}
+	return ret;
+}
+
+/**
+ * @brief 写入断点记录
+ *
+ * @param[in] state 断点记录
+ */
+static esp_err_t resume_save(const ota_resume_state_t *state)
+{
+	nvs_handle_t handle;
+	esp_err_t    ret = nvs_open(OTA_RESUME_NVS_NAMESPACE, NVS_READWRITE, &handle);
+	if (ret != ESP_OK) {
+		ESP_LOGE(TAG, "nvs_open(resume) failed: %s", esp_err_to_name(ret));
+		return ret;
+	}
+
+	ret = nvs_set_blob(handle, OTA_RESUME_NVS_KEY, state, sizeof(*state));
+	if (ret == ESP_OK) {
+		ret = nvs_commit(handle);
+	}
+	nvs_close(handle);
+	if (ret != ESP_OK) {
+		ESP_LOGE(TAG, "save resume state failed: %s", esp_err_to_name(ret));
+	}
+	return ret;
+}
+
+esp_err_t http_ota_download_clear_resume(void)
+{
+	nvs_handle_t handle;
+	esp_err_t    ret = nvs_open(OTA_RESUME_NVS_NAMESPACE, NVS_READWRITE, &handle);
+	if (ret != ESP_OK) {
+		return ret;
+	}
+
+	ret = nvs_erase_key(handle, OTA_RESUME_NVS_KEY);
+	if (ret == ESP_ERR_NVS_NOT_FOUND) {
+		ret = ESP_OK;
+	}
+	if (ret == ESP_OK) {
+		ret = nvs_commit(handle);
+	}
+	nvs_close(handle);
+	return ret;
+}
+
+/* -------------------- 分块校验 -------------------- */
+
+/**
+ * @brief 从 Flash 回读 [offset, offset + len) 并与期望摘要比对
+ *
+ * 校验的是实际落盘的数据，同时覆盖了网络传输错误和 Flash 写入错误。
+ *
+ * @return true 摘要一致
+ */
+static bool verify_flash_chunk(const esp_partition_t *part, uint32_t offset, uint32_t len,
+			       const uint8_t expected[HTTP_OTA_SHA256_LEN])
+{
+	uint8_t                buf[OTA_VERIFY_READ_SIZE];
+	uint8_t                digest[HTTP_OTA_SHA256_LEN];
+	mbedtls_sha256_context sha;
+	bool                   ok = true;
+
+	mbedtls_sha256_init(&sha);
+	mbedtls_sha256_starts(&sha, 0);
+	for (uint32_t pos = 0; pos < len; pos += sizeof(buf)) {
+		uint32_t n = (len - pos) < sizeof(buf) ? (len - pos) : sizeof(buf);
+		if (esp_partition_read(part, offset + pos, buf, n) != ESP_OK) {
+			ok = false;
+			break;
+		}
+		mbedtls_sha256_update(&sha, buf, n);
+	}
+	mbedtls_sha256_finish(&sha, digest);
+	mbedtls_sha256_free(&sha);
+
+	return ok && memcmp(digest, expected, HTTP_OTA_SHA256_LEN) == 0;
+}
+
+/**
+ * @brief 校验所有已完整落盘的块，并推进已校验偏移
+ *
+ * @param[in]     cfg      下载配置
+ * @param[in]     part     目标 OTA 分区
+ * @param[in]     durable  已确定落盘的字节数
+ * @param[in]     total    镜像总大小
+ * @param[in,out] verified 已校验偏移（块边界）
+ *
+ * @return
+ *  - ESP_OK              : 校验通过（或无新完整块）
+ *  - ESP_ERR_INVALID_CRC : 某块摘要不一致，verified 停在该块起点
+ */
+static esp_err_t verify_completed_chunks(const http_ota_download_config_t *cfg, const esp_partition_t *part,
+					 uint32_t durable, uint32_t total, uint32_t *verified)
+{
+	while (*verified < total) {
+		size_t   index = *verified / cfg->chunk_size;
+		uint32_t len   = total - *verified;
+		if (len > cfg->chunk_size) {
+			len = cfg->chunk_size;
+		}
+		if (*verified + len > durable || index >= cfg->chunk_count) {
+			break;
+		}
+		if (!verify_flash_chunk(part, *verified, len, &cfg->chunk_digests[index * HTTP_OTA_SHA256_LEN])) {
+			ESP_LOGE(TAG, "chunk %u sha256 mismatch", (unsigned)index);
+			return ESP_ERR_INVALID_CRC;
+		}
+		*verified += len;
+	}
+	return ESP_OK;
+}
+
+/* -------------------- 下载主流程 -------------------- */
+
+/**
+ * @brief 按限速要求延时
+ *
+ * @param session_bytes 本次会话已下载字节数
+ * @param start_us      会话开始时间
+ * @param rate          限速（字节/秒）
+ */
+static void throttle(uint32_t session_bytes, int64_t start_us, uint32_t rate)
+{
+	if (rate == 0) {
+		return;
+	}
+	int64_t expected_us = (int64_t)session_bytes * 1000000 / rate;
+	int64_t elapsed_us  = esp_timer_get_time() - start_us;
+	if (expected_us > elapsed_us) {
+		vTaskDelay(pdMS_TO_TICKS((expected_us - elapsed_us) / 1000) + 1);
+	}
+}
+
+/**
+ * @brief 执行一次下载会话（从 *resume_offset 开始，直到完成或出错）
+ *
+ * @param[in]     cfg           下载配置
+ * @param[in,out] state         断点记录，offset 随校验推进并持久化
+ *
+ * @return
+ *  - ESP_OK              : 镜像完整写入并通过校验
+ *  - ESP_ERR_INVALID_CRC : 分块校验失败，state->offset 已回退到失败块起点
+ *  - 其它 esp_err_t      : 网络或写入错误
+ */
+static esp_err_t download_session(const http_ota_download_config_t *cfg, ota_resume_state_t *state)
+{
+	esp_http_client_config_t http_cfg = {
+		.url                         = cfg->url,
+		.timeout_ms                  = cfg->http_timeout_ms,
+		.keep_alive_enable           = true,
+		/* 如需严格校验证书，可在此关闭 skip，并配置证书等信息 */
+		.skip_cert_common_name_check = true,
+	};
+
+	esp_https_ota_config_t ota_cfg = {
+		.http_config             = &http_cfg,
+		.partial_http_download   = cfg->request_size > 0,
+		.max_http_request_size   = (int)cfg->request_size,
+		.ota_resumption          = state->offset > 0,
+		.ota_image_bytes_written = state->offset,
+	};
+
+	esp_https_ota_handle_t handle = NULL;
+	esp_err_t              err    = esp_https_ota_begin(&ota_cfg, &handle);
+	if (err != ESP_OK) {
+		ESP_LOGE(TAG, "esp_https_ota_begin failed: %s", esp_err_to_name(err));
+		return err;
+	}
+
+	const esp_partition_t *part = esp_ota_get_next_update_partition(NULL);
+	int                    size = esp_https_ota_get_image_size(handle);
+	state->total                = size > 0 ? (uint32_t)size : 0;
+	if (cfg->image_size > 0 && state->total != cfg->image_size) {
+		ESP_LOGE(TAG, "image size %u != declared %u", (unsigned)state->total, (unsigned)cfg->image_size);
+		esp_https_ota_abort(handle);
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	bool     verify         = cfg->chunk_digests && cfg->chunk_size > 0 && state->total > 0;
+	uint32_t verified       = state->offset;
+	uint32_t session_start  = state->offset;
+	int64_t  start_us       = esp_timer_get_time();
+	uint32_t last_progress  = 0;
+
+	while (true) {
+		metrics_trace_begin("net", "ota_perform");
+		err = esp_https_ota_perform(handle);
+		metrics_trace_end("net", "ota_perform");
+		if (err != ESP_ERR_HTTPS_OTA_IN_PROGRESS) {
+			break;
+		}
+
+		int      read    = esp_https_ota_get_image_len_read(handle);
+		uint32_t written = read > 0 ? (uint32_t)read : 0;
+		uint32_t durable = written > OTA_FLASH_WRITE_SLACK ? written - OTA_FLASH_WRITE_SLACK : 0;
+		metrics_trace_counter("net", "ota_bytes", (int32_t)written);
+
+		/* 推进已校验偏移：有清单时按块校验，否则按扇区对齐直接信任已落盘数据 */
+		if (verify) {
+			err = verify_completed_chunks(cfg, part, durable, state->total, &verified);
+			if (err != ESP_OK) {
+				break;
+			}
+		} else {
+			verified = durable - durable % HTTP_OTA_RESUME_ALIGN;
+		}
+
+		uint32_t step = verify ? cfg->chunk_size : HTTP_OTA_RESUME_ALIGN * 16;
+		if (verified >= state->offset + step) {
+			state->offset = verified;
+			resume_save(state);
+		}
+
+		/* 进度变化超过 1% 才回调，避免刷屏 */
+		if (cfg->progress_cb && (state->total == 0 || written - last_progress >= state->total / 100)) {
+			last_progress = written;
+			cfg->progress_cb(written, state->total, cfg->user_ctx);
+		}
+
+		throttle(written > session_start ? written - session_start : 0, start_us, cfg->max_bytes_per_sec);
+	}
+
+	if (err == ESP_OK && !esp_https_ota_is_complete_data_received(handle)) {
+		ESP_LOGE(TAG, "image data incomplete");
+		err = ESP_ERR_INVALID_SIZE;
+	}
+
+	/* 数据已全部写入：校验剩余块（含最后一个不足 chunk_size 的块） */
+	if (err == ESP_OK && verify) {
+		err = verify_completed_chunks(cfg, part, state->total, state->total, &verified);
+	}
+
+	/* 整包校验：无法定位出错的块，回退到镜像起点整包重下 */
+	if (err == ESP_OK && cfg->image_sha256 &&
+	    !verify_flash_chunk(part, 0, state->total, cfg->image_sha256)) {
+		ESP_LOGE(TAG, "image sha256 mismatch");
+		verified = 0;
+		err      = ESP_ERR_INVALID_CRC;
+	}
+
+	if (err != ESP_OK) {
+		esp_https_ota_abort(handle);
+		if (err == ESP_ERR_INVALID_CRC) {
+			/* 回退到失败块起点，该块所在扇区在续传时会被重新擦除 */
+			state->offset = verified;
+			resume_save(state);
+		}
+		return err;
+	}
+
+	err = esp_https_ota_finish(handle);
+	if (err != ESP_OK) {
+		ESP_LOGE(TAG, "esp_https_ota_finish failed: %s", esp_err_to_name(err));
+		return err;
+	}
+
+	if (cfg->progress_cb) {
+		cfg->progress_cb(state->total, state->total, cfg->user_ctx);
+	}
+	return ESP_OK;
+}
+
+/**
+ * @brief 执行一次可续传的 OTA 下载
+ *
+ * 断线或校验失败后按指数退避自动续传，最多 max_retries 次；
+ * 超过次数仍失败时保留断点，留待下一次检查继续。
+ *
+ * @param[in] config 下载配置
+ *
+ * @return ESP_OK 成功，其它为最后一次会话的错误码
+ */
+esp_err_t http_ota_download_run(const http_ota_download_config_t *config)
+{
+	if (!config || !config->url || config->url[0] == '\0' || !config->version) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (config->chunk_digests && (config->chunk_size == 0 || config->chunk_size % HTTP_OTA_RESUME_ALIGN != 0)) {
+		ESP_LOGE(TAG, "chunk_size must be a multiple of %d", HTTP_OTA_RESUME_ALIGN);
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	/* 只有 url 与 version 都一致的断点才可续传，否则从头下载 */
+	ota_resume_state_t state = {0};
+	if (resume_load(&state) != ESP_OK || strcmp(state.url, config->url) != 0 ||
+	    strcmp(state.version, config->version) != 0 || state.offset % HTTP_OTA_RESUME_ALIGN != 0) {
+		memset(&state, 0, sizeof(state));
+		strncpy(state.url, config->url, sizeof(state.url) - 1);
+		strncpy(state.version, config->version, sizeof(state.version) - 1);
+	} else {
+		ESP_LOGI(TAG, "resume OTA at offset %u/%u", (unsigned)state.offset, (unsigned)state.total);
+	}
+
+	esp_err_t err      = ESP_FAIL;
+	uint32_t  delay_ms = OTA_RETRY_BASE_DELAY_MS;
+	for (int attempt = 0; attempt <= config->max_retries; attempt++) {
+		if (attempt > 0) {
+			ESP_LOGW(TAG, "retry %d/%d from offset %u in %u ms", attempt, config->max_retries,
+				 (unsigned)state.offset, (unsigned)delay_ms);
+			vTaskDelay(pdMS_TO_TICKS(delay_ms));
+			delay_ms *= 2;
+		}
+
+		err = download_session(config, &state);
+		if (err == ESP_OK) {
+			http_ota_download_clear_resume();
+			ESP_LOGI(TAG, "OTA download complete, %u bytes", (unsigned)state.total);
+			return ESP_OK;
+		}
+		ESP_LOGW(TAG, "OTA session failed: %s", esp_err_to_name(err));
+	}
+
+	return err;
+}
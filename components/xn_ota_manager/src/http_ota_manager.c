@@ -10,20 +10,49 @@
  */
 
 #include "http_ota_manager.h"
-
+#include "http_ota_download.h"
+#include "http_ota_delta.h"
+#include "http_ota_model.h"
+#include "http_ota_version.h"
+#include "model_store.h"
+
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 
 #include "sdkconfig.h"
 
 #include "esp_log.h"
 #include "esp_http_client.h"
-#include "esp_https_ota.h"
+#include "esp_ota_ops.h"
 #include "esp_system.h"
+#include "esp_random.h"
 #include "cJSON.h"
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
 /* 本模块日志 TAG，用于 ESP_LOGx 宏输出 */
 static const char *TAG = "http_ota_manager";
 
+#define OTA_MANIFEST_MAX_LEN     1536          ///< version.json 最大长度（含 '\0'）
+#define OTA_ETAG_MAX_LEN         64            ///< 缓存的 ETag 最大长度（含 '\0'）
+#define OTA_DATE_MAX_LEN         40            ///< 缓存的 Last-Modified 最大长度（含 '\0'）
+#define OTA_SCHED_TASK_STACK     (8 * 1024)    ///< 周期检查任务栈大小
+#define OTA_SCHED_TASK_PRIO      (tskIDLE_PRIORITY + 2)
+
+/**
+ * @brief 条件请求校验器
+ *
+ * 请求时作为 If-None-Match / If-Modified-Since 发送，响应时收集服务端返回的新值。
+ */
+typedef struct {
+	char etag[OTA_ETAG_MAX_LEN];               ///< ETag 响应头
+	char last_modified[OTA_DATE_MAX_LEN];      ///< Last-Modified 响应头
+} http_validators_t;
+
 /* -------------------- 静态上下文与工具函数 -------------------- */
 
 /* 上层传入的 OTA 管理配置副本，仅在 http_ota_manager_init 中赋值一次 */
@@ -36,6 +65,14 @@ static http_ota_state_t          s_state           = HTTP_OTA_STATE_IDLE;
 static http_ota_remote_info_t    s_last_remote_info;
 /* 标记 s_last_remote_info 中的数据是否有效 */
 static bool                      s_has_remote_info = false;
+/* 当前下载进度，由下载引擎回调更新 */
+static http_ota_progress_t       s_progress;
+/* 与 s_last_remote_info 对应的 version.json 校验器，仅在解析成功后更新 */
+static http_validators_t         s_manifest_validators;
+/* 串行化手动与周期检查，避免两个流程同时写 OTA 分区 */
+static SemaphoreHandle_t         s_check_lock      = NULL;
+/* 周期检查任务句柄，check_interval_sec 为 0 时不创建 */
+static TaskHandle_t              s_sched_task      = NULL;
 
 /**
  * @brief 内部状态切换辅助函数
@@ -54,34 +91,74 @@ static void ota_set_state(http_ota_state_t state)
 }
 
 /**
- * @brief 从配置中的 version_url 获取 version.json 文本
+ * @brief 拷贝响应头的值，超长时截断
+ */
+static void copy_header_value(char *dst, size_t dst_size, const char *value)
+{
+	strncpy(dst, value ? value : "", dst_size - 1);
+	dst[dst_size - 1] = '\0';
+}
+
+/**
+ * @brief HTTP 事件回调：收集条件请求所需的 ETag / Last-Modified 响应头
+ */
+static esp_err_t http_validator_event_handler(esp_http_client_event_t *evt)
+{
+	http_validators_t *out = (http_validators_t *)evt->user_data;
+	if (evt->event_id != HTTP_EVENT_ON_HEADER || !out || !evt->header_key) {
+		return ESP_OK;
+	}
+
+	if (strcasecmp(evt->header_key, "ETag") == 0) {
+		copy_header_value(out->etag, sizeof(out->etag), evt->header_value);
+	} else if (strcasecmp(evt->header_key, "Last-Modified") == 0) {
+		copy_header_value(out->last_modified, sizeof(out->last_modified), evt->header_value);
+	}
+	return ESP_OK;
+}
+
+/**
+ * @brief HTTP GET 指定 URL，把响应体读入缓冲区
  *
- * @param[out] buf       用于存放 version.json 字符串的缓冲区
- * @param[in]  buf_size  缓冲区大小（字节数）
+ * 提供 cond_in 时携带 If-None-Match / If-Modified-Since 发起条件请求，
+ * 服务端返回 304 时 *out_not_modified 置 true 且不读取响应体。
+ *
+ * @param[in]  url              请求地址
+ * @param[out] buf              响应体缓冲区
+ * @param[in]  buf_size         缓冲区大小（字节数），响应体超出部分被丢弃
+ * @param[out] out_len          实际读取的字节数
+ * @param[in]  cond_in          缓存的校验器，NULL 表示普通请求
+ * @param[out] cond_out         收集到的响应校验器，可为 NULL
+ * @param[out] out_not_modified 是否收到 304，可为 NULL（此时不接受 304）
  *
  * @return
- *  - ESP_OK              : 获取成功，buf 中为以 '\0' 结尾的 JSON 字符串
- *  - ESP_ERR_INVALID_ARG : 参数非法或 version_url 为空
+ *  - ESP_OK              : 获取成功（或资源未修改）
+ *  - ESP_ERR_INVALID_ARG : 参数非法
  *  - 其它 esp_err_t      : 底层 HTTP 访问失败，具体错误见日志
  */
-static esp_err_t fetch_version_json(char *buf, size_t buf_size)
+static esp_err_t http_get_body(const char *url, char *buf, size_t buf_size, size_t *out_len,
+			       const http_validators_t *cond_in, http_validators_t *cond_out,
+			       bool *out_not_modified)
 {
-	if (!buf || buf_size == 0) {
+	if (!url || url[0] == '\0' || !buf || buf_size == 0 || !out_len) {
 		return ESP_ERR_INVALID_ARG;
 	}
-
-	if (s_cfg.version_url[0] == '\0') {
-		ESP_LOGE(TAG, "version_url is empty");
-		return ESP_ERR_INVALID_ARG;
+	if (out_not_modified) {
+		*out_not_modified = false;
+	}
+	if (cond_out) {
+		memset(cond_out, 0, sizeof(*cond_out));
 	}
 
-	/* HTTP 客户端配置：使用 GET 方法，超时与 URL 由上层配置决定 */
+	/* HTTP 客户端配置：使用 GET 方法，超时由上层配置决定 */
 	esp_http_client_config_t http_cfg = {
-		.url                         = s_cfg.version_url,
+		.url                         = url,
 		.timeout_ms                  = s_cfg.http_timeout_ms,
 		.method                      = HTTP_METHOD_GET,
 		/* 若使用 HTTPS 且证书校验严格，可根据实际需求调整此选项 */
 		.skip_cert_common_name_check = true,
+		.event_handler               = cond_out ? http_validator_event_handler : NULL,
+		.user_data                   = cond_out,
 	};
 
 	esp_http_client_handle_t client = esp_http_client_init(&http_cfg);
@@ -90,20 +167,37 @@ static esp_err_t fetch_version_json(char *buf, size_t buf_size)
 		return ESP_FAIL;
 	}
 
+	/* 条件请求：服务端内容未变化时只返回 304 头部 */
+	if (cond_in) {
+		if (cond_in->etag[0] != '\0') {
+			esp_http_client_set_header(client, "If-None-Match", cond_in->etag);
+		}
+		if (cond_in->last_modified[0] != '\0') {
+			esp_http_client_set_header(client, "If-Modified-Since", cond_in->last_modified);
+		}
+	}
+
 	/* 打开连接并发送请求（GET 请求 body 长度为 0） */
 	esp_err_t err = esp_http_client_open(client, 0);
 	if (err != ESP_OK) {
-		ESP_LOGE(TAG, "open version_url failed: %s", esp_err_to_name(err));
+		ESP_LOGE(TAG, "open %s failed: %s", url, esp_err_to_name(err));
 		esp_http_client_cleanup(client);
 		return err;
 	}
 
-	/* 可选：获取 Content-Length，方便上层调试观察版本文件大小 */
+	/* 可选：获取 Content-Length，方便上层调试观察文件大小 */
 	int content_length = esp_http_client_fetch_headers(client);
-	ESP_LOGI(TAG, "version.json content_length=%d", content_length);
+	ESP_LOGI(TAG, "GET %s content_length=%d", url, content_length);
 
-	/* 校验 HTTP 响应状态码，要求为 200 OK */
+	/* 校验 HTTP 响应状态码，要求为 200 OK，条件请求另外接受 304 */
 	int status_code = esp_http_client_get_status_code(client);
+	if (status_code == 304 && out_not_modified) {
+		esp_http_client_close(client);
+		esp_http_client_cleanup(client);
+		*out_not_modified = true;
+		*out_len          = 0;
+		return ESP_OK;
+	}
 	if (status_code != 200) {
 		ESP_LOGE(TAG, "unexpected HTTP status: %d", status_code);
 		esp_http_client_close(client);
@@ -111,14 +205,12 @@ static esp_err_t fetch_version_json(char *buf, size_t buf_size)
 		return ESP_FAIL;
 	}
 
-	/* 循环读取响应体到缓冲区，注意保留 '\0' 结尾的空间 */
-	int total_read = 0;
-	while (total_read < (int)buf_size - 1) {
-		int read_len = esp_http_client_read(client,
-						buf + total_read,
-						buf_size - 1 - total_read);
+	/* 循环读取响应体到缓冲区 */
+	size_t total_read = 0;
+	while (total_read < buf_size) {
+		int read_len = esp_http_client_read(client, buf + total_read, buf_size - total_read);
 		if (read_len < 0) {
-			ESP_LOGE(TAG, "read version.json failed");
+			ESP_LOGE(TAG, "read %s failed", url);
 			esp_http_client_close(client);
 			esp_http_client_cleanup(client);
 			return ESP_FAIL;
@@ -130,14 +222,58 @@ static esp_err_t fetch_version_json(char *buf, size_t buf_size)
 		total_read += read_len;
 	}
 
+	esp_http_client_close(client);
+	esp_http_client_cleanup(client);
+
+	*out_len = total_read;
+	return ESP_OK;
+}
+
+/**
+ * @brief 从配置中的 version_url 获取 version.json 文本
+ *
+ * 已有解析成功的远端信息时发起条件请求，清单未变化只花费一次 304 往返。
+ *
+ * @param[out] buf              用于存放 version.json 字符串的缓冲区
+ * @param[in]  buf_size         缓冲区大小（字节数）
+ * @param[out] validators       本次响应携带的校验器（解析成功后再提交缓存）
+ * @param[out] out_not_modified 服务端返回 304 时置 true，buf 内容无效
+ *
+ * @return
+ *  - ESP_OK              : 获取成功，buf 中为以 '\0' 结尾的 JSON 字符串（或未修改）
+ *  - ESP_ERR_INVALID_ARG : 参数非法或 version_url 为空
+ *  - 其它 esp_err_t      : 底层 HTTP 访问失败，具体错误见日志
+ */
+static esp_err_t fetch_version_json(char *buf, size_t buf_size, http_validators_t *validators,
+				    bool *out_not_modified)
+{
+	if (!buf || buf_size == 0) {
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	if (s_cfg.version_url[0] == '\0') {
+		ESP_LOGE(TAG, "version_url is empty");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	/* 保留 '\0' 结尾的空间 */
+	size_t    total_read = 0;
+	esp_err_t err        = http_get_body(s_cfg.version_url, buf, buf_size - 1, &total_read,
+						 s_has_remote_info ? &s_manifest_validators : NULL,
+						 validators, out_not_modified);
+	if (err != ESP_OK) {
+		return err;
+	}
+	if (*out_not_modified) {
+		ESP_LOGI(TAG, "version.json not modified (304)");
+		return ESP_OK;
+	}
+
 	/* 补 '\0'，确保 buf 是一个 C 风格字符串 */
 	buf[total_read] = '\0';
 	ESP_LOGD(TAG, "version.json body: %s", buf);
 
-	esp_http_client_close(client);
-	esp_http_client_cleanup(client);
-
-	if (total_read <= 0) {
+	if (total_read == 0) {
 		ESP_LOGE(TAG, "empty version.json body");
 		return ESP_FAIL;
 	}
@@ -145,6 +281,48 @@ static esp_err_t fetch_version_json(char *buf, size_t buf_size)
 	return ESP_OK;
 }
 
+/**
+ * @brief 把 64 位十六进制字符串转换为 32 字节摘要
+ *
+ * @return true 转换成功
+ */
+static bool parse_sha256_hex(const char *hex, uint8_t *out)
+{
+	if (!hex || strlen(hex) != 64) {
+		return false;
+	}
+	for (int i = 0; i < 32; i++) {
+		unsigned int byte;
+		if (sscanf(hex + i * 2, "%2x", &byte) != 1) {
+			return false;
+		}
+		out[i] = (uint8_t)byte;
+	}
+	return true;
+}
+
+/**
+ * @brief 解析 version.json 中可选的 model 对象
+ *
+ * version 与 url 缺一不可，否则视为未提供模型通道；size / sha256 可选。
+ */
+static void parse_model_json(const cJSON *j_model, http_ota_remote_info_t *out)
+{
+	cJSON *j_version = cJSON_GetObjectItemCaseSensitive(j_model, "version");
+	cJSON *j_url     = cJSON_GetObjectItemCaseSensitive(j_model, "url");
+	cJSON *j_size    = cJSON_GetObjectItemCaseSensitive(j_model, "size");
+	cJSON *j_sha     = cJSON_GetObjectItemCaseSensitive(j_model, "sha256");
+
+	if (!cJSON_IsString(j_version) || !cJSON_IsString(j_url)) {
+		ESP_LOGW(TAG, "model version/url missing, ignore model channel");
+		return;
+	}
+	strncpy(out->model_version, j_version->valuestring, HTTP_OTA_VERSION_MAX_LEN - 1);
+	strncpy(out->model_url, j_url->valuestring, HTTP_OTA_URL_MAX_LEN - 1);
+	out->model_size = cJSON_IsNumber(j_size) && j_size->valuedouble > 0 ? (uint32_t)j_size->valuedouble : 0;
+	out->model_has_sha256 = cJSON_IsString(j_sha) && parse_sha256_hex(j_sha->valuestring, out->model_sha256);
+}
+
 /**
  * @brief 解析 version.json，并填充 http_ota_remote_info_t 结构体
  *
@@ -174,6 +352,13 @@ static esp_err_t parse_version_json(const char *json_str, http_ota_remote_info_t
 	cJSON *j_url     = cJSON_GetObjectItemCaseSensitive(root, "url");
 	cJSON *j_desc    = cJSON_GetObjectItemCaseSensitive(root, "description");
 	cJSON *j_force   = cJSON_GetObjectItemCaseSensitive(root, "force");
+	cJSON *j_size    = cJSON_GetObjectItemCaseSensitive(root, "size");
+	cJSON *j_sha     = cJSON_GetObjectItemCaseSensitive(root, "sha256");
+	cJSON *j_chunk   = cJSON_GetObjectItemCaseSensitive(root, "chunk_size");
+	cJSON *j_chunks  = cJSON_GetObjectItemCaseSensitive(root, "chunks_url");
+	cJSON *j_dbase   = cJSON_GetObjectItemCaseSensitive(root, "delta_base");
+	cJSON *j_durl    = cJSON_GetObjectItemCaseSensitive(root, "delta_url");
+	cJSON *j_model   = cJSON_GetObjectItemCaseSensitive(root, "model");
 
 	if (!cJSON_IsString(j_version) || !cJSON_IsString(j_url)) {
 		ESP_LOGE(TAG, "version/url missing or not string");
@@ -192,43 +377,125 @@ static esp_err_t parse_version_json(const char *json_str, http_ota_remote_info_t
 	}
 	/* force 字段不存在时默认 false，存在时根据布尔值设置 */
 	out->force = cJSON_IsBool(j_force) ? cJSON_IsTrue(j_force) : false;
+	/* 整包大小 / 摘要与分块校验相关字段均为可选，提供时才校验，缺失时退化为仅 ESP-IDF 镜像校验 */
+	out->size       = cJSON_IsNumber(j_size) && j_size->valuedouble > 0 && j_size->valuedouble <= UINT32_MAX
+				  ? (uint32_t)j_size->valuedouble : 0;
+	out->has_sha256 = cJSON_IsString(j_sha) && parse_sha256_hex(j_sha->valuestring, out->sha256);
+	out->chunk_size = cJSON_IsNumber(j_chunk) && j_chunk->valuedouble > 0 ? (uint32_t)j_chunk->valuedouble : 0;
+	if (cJSON_IsString(j_chunks) && j_chunks->valuestring) {
+		strncpy(out->chunks_url, j_chunks->valuestring, HTTP_OTA_URL_MAX_LEN - 1);
+	}
+	if (cJSON_IsString(j_dbase) && cJSON_IsString(j_durl)) {
+		strncpy(out->delta_base, j_dbase->valuestring, HTTP_OTA_VERSION_MAX_LEN - 1);
+		strncpy(out->delta_url, j_durl->valuestring, HTTP_OTA_URL_MAX_LEN - 1);
+	}
+	if (cJSON_IsObject(j_model)) {
+		parse_model_json(j_model, out);
+	}
 
 	cJSON_Delete(root);
 	return ESP_OK;
 }
 
 /**
- * @brief 使用给定的固件 URL 执行 OTA 升级
+ * @brief 下载引擎进度回调：记录进度并以 DOWNLOADING 通知上层
+ *
+ * 不修改 s_state，流程整体仍处于 RUNNING。
+ */
+static void ota_progress_cb(uint32_t written, uint32_t total, void *user_ctx)
+{
+	(void)user_ctx;
+	s_progress.written = written;
+	s_progress.total   = total;
+	if (total > 0) {
+		ESP_LOGI(TAG, "OTA progress %u/%u (%u%%)", (unsigned)written, (unsigned)total,
+			 (unsigned)((uint64_t)written * 100 / total));
+	}
+	if (s_cfg.state_cb) {
+		s_cfg.state_cb(HTTP_OTA_STATE_DOWNLOADING);
+	}
+}
+
+/**
+ * @brief 下载分块 SHA-256 清单
  *
- * @param[in] url 固件镜像下载地址
+ * @param[in]  remote    远端版本信息（需提供 size / chunk_size / chunks_url）
+ * @param[out] out_count 清单中的块数
+ *
+ * @return 清单缓冲区（调用方 free），不满足条件或下载失败时返回 NULL
+ */
+static uint8_t *fetch_chunk_digests(const http_ota_remote_info_t *remote, size_t *out_count)
+{
+	*out_count = 0;
+	if (remote->size == 0 || remote->chunk_size == 0 || remote->chunks_url[0] == '\0') {
+		return NULL;
+	}
+
+	size_t count = (remote->size + remote->chunk_size - 1) / remote->chunk_size;
+	if (count > HTTP_OTA_MAX_CHUNKS) {
+		ESP_LOGW(TAG, "too many chunks (%u), skip chunk verification", (unsigned)count);
+		return NULL;
+	}
+
+	uint8_t *digests = (uint8_t *)malloc(count * HTTP_OTA_SHA256_LEN);
+	if (!digests) {
+		return NULL;
+	}
+
+	size_t len = 0;
+	if (http_get_body(remote->chunks_url, (char *)digests, count * HTTP_OTA_SHA256_LEN, &len,
+			  NULL, NULL, NULL) != ESP_OK ||
+	    len != count * HTTP_OTA_SHA256_LEN) {
+		ESP_LOGW(TAG, "chunk manifest invalid (%u bytes), skip chunk verification", (unsigned)len);
+		free(digests);
+		return NULL;
+	}
+
+	*out_count = count;
+	return digests;
+}
+
+/**
+ * @brief 使用给定的远端信息执行可续传 OTA 升级
+ *
+ * @param[in] remote 远端版本信息
  *
  * @return
- *  - ESP_OK : OTA 更新完成（包括完整下载及写入）
- *  - 其它    : esp_https_ota 失败，具体错误码见日志
+ *  - ESP_OK : OTA 更新完成（包括完整下载、校验及写入）
+ *  - 其它    : 下载引擎失败，断点已保留，具体错误码见日志
  */
-static esp_err_t do_ota_with_url(const char *url)
+static esp_err_t do_ota_with_remote(const http_ota_remote_info_t *remote)
 {
-	if (!url || url[0] == '\0') {
+	if (remote->url[0] == '\0') {
 		ESP_LOGE(TAG, "OTA url is empty");
 		return ESP_ERR_INVALID_ARG;
 	}
 
-	/* OTA 使用的 HTTP 客户端配置，与获取 version.json 类似 */
-	esp_http_client_config_t http_cfg = {
-		.url                         = url,
-		.timeout_ms                  = s_cfg.http_timeout_ms,
-		/* 如需严格校验证书，可在此关闭 skip，并配置证书等信息 */
-		.skip_cert_common_name_check = true,
-	};
-
-	esp_https_ota_config_t ota_cfg = {
-		.http_config = &http_cfg,
+	size_t   chunk_count = 0;
+	uint8_t *digests     = fetch_chunk_digests(remote, &chunk_count);
+
+	http_ota_download_config_t dl_cfg = {
+		.url               = remote->url,
+		.version           = remote->version,
+		.image_size        = remote->size,
+		.image_sha256      = remote->has_sha256 ? remote->sha256 : NULL,
+		.http_timeout_ms   = s_cfg.http_timeout_ms,
+		.request_size      = s_cfg.request_size,
+		.chunk_size        = remote->chunk_size,
+		.chunk_digests     = digests,
+		.chunk_count       = chunk_count,
+		.max_bytes_per_sec = s_cfg.max_bytes_per_sec,
+		.max_retries       = s_cfg.max_retries,
+		.progress_cb       = ota_progress_cb,
+		.user_ctx          = NULL,
 	};
 
-	ESP_LOGI(TAG, "start OTA from: %s", url);
-	esp_err_t ret = esp_https_ota(&ota_cfg);
+	memset(&s_progress, 0, sizeof(s_progress));
+	ESP_LOGI(TAG, "start OTA from: %s (chunk verify: %s)", remote->url, digests ? "on" : "off");
+	esp_err_t ret = http_ota_download_run(&dl_cfg);
+	free(digests);
 	if (ret != ESP_OK) {
-		ESP_LOGE(TAG, "esp_https_ota failed: %s", esp_err_to_name(ret));
+		ESP_LOGE(TAG, "OTA download failed: %s", esp_err_to_name(ret));
 		return ret;
 	}
 
@@ -236,6 +503,224 @@ static esp_err_t do_ota_with_url(const char *url)
 	return ESP_OK;
 }
 
+/**
+ * @brief 检查模型通道，远端模型版本与本地活动模型不同时下载新模型包
+ *
+ * @param[in] remote 远端版本信息
+ *
+ * @return
+ *  - ESP_OK : 无需更新、设备无模型分区或更新成功
+ *  - 其它    : 模型下载或校验失败，活动模型保持不变
+ */
+static esp_err_t do_model_update(const http_ota_remote_info_t *remote)
+{
+	if (remote->model_url[0] == '\0') {
+		return ESP_OK;
+	}
+
+	/* 分区表中没有模型分区的旧设备跳过模型通道，不影响固件 OTA 结果 */
+	if (model_store_init() != ESP_OK) {
+		ESP_LOGW(TAG, "no model partitions, skip model update");
+		return ESP_OK;
+	}
+
+	model_store_info_t info;
+	model_store_get_info(&info);
+	ESP_LOGI(TAG, "local model=%s, remote model=%s", info.version[0] ? info.version : "-",
+		 remote->model_version);
+	if (strcmp(info.version, remote->model_version) == 0) {
+		return ESP_OK;
+	}
+
+	http_ota_model_config_t model_cfg = {
+		.url             = remote->model_url,
+		.size            = remote->model_size,
+		.sha256          = remote->model_has_sha256 ? remote->model_sha256 : NULL,
+		.http_timeout_ms = s_cfg.http_timeout_ms,
+		.max_retries     = s_cfg.max_retries,
+		.progress_cb     = ota_progress_cb,
+		.user_ctx        = NULL,
+	};
+
+	memset(&s_progress, 0, sizeof(s_progress));
+	ESP_LOGI(TAG, "start model update from: %s", remote->model_url);
+	esp_err_t err = http_ota_model_run(&model_cfg);
+	if (err != ESP_OK) {
+		ESP_LOGE(TAG, "model update failed: %s", esp_err_to_name(err));
+		return err;
+	}
+
+	ESP_LOGI(TAG, "model %s installed", remote->model_version);
+	if (s_cfg.model_cb) {
+		s_cfg.model_cb(remote->model_version);
+	}
+	return ESP_OK;
+}
+
+/**
+ * @brief 读取已下载、等待重启生效的固件版本
+ *
+ * auto_reboot 为 false 时，升级成功后设备继续运行旧固件，启动分区已指向新镜像。
+ *
+ * @param[out] buf      版本号缓冲区
+ * @param[in]  buf_size 缓冲区大小
+ *
+ * @return true 存在待生效的镜像且读取到版本号
+ */
+static bool ota_get_pending_version(char *buf, size_t buf_size)
+{
+	const esp_partition_t *boot    = esp_ota_get_boot_partition();
+	const esp_partition_t *running = esp_ota_get_running_partition();
+	if (!boot || boot == running) {
+		return false;
+	}
+
+	esp_app_desc_t desc;
+	if (esp_ota_get_partition_description(boot, &desc) != ESP_OK) {
+		return false;
+	}
+	strncpy(buf, desc.version, buf_size - 1);
+	buf[buf_size - 1] = '\0';
+	return true;
+}
+
+/**
+ * @brief 执行一次检查 / 升级流程（调用方已持有 s_check_lock）
+ *
+ * @param[out] out_upgraded 固件已写入新分区、需要重启生效时置 true
+ *
+ * @return
+ *  - ESP_OK : 流程执行结束（无论是否进行了实际升级）
+ *  - 其它    : HTTP 访问、JSON 解析或 OTA 过程中的错误码
+ */
+static esp_err_t ota_check_and_update(bool *out_upgraded)
+{
+	*out_upgraded = false;
+
+	/* 第一步：从远端拉取 version.json（条件请求，清单未变化时服务端返回 304） */
+	char *json_buf = (char *)malloc(OTA_MANIFEST_MAX_LEN);
+	if (!json_buf) {
+		return ESP_ERR_NO_MEM;
+	}
+
+	http_validators_t validators;
+	bool              not_modified = false;
+	esp_err_t         err = fetch_version_json(json_buf, OTA_MANIFEST_MAX_LEN, &validators, &not_modified);
+
+	/* 第二步：解析 JSON 为结构体形式；未修改时沿用上次解析结果 */
+	http_ota_remote_info_t remote = {0};
+	if (err == ESP_OK && not_modified) {
+		remote = s_last_remote_info;
+	} else if (err == ESP_OK) {
+		err = parse_version_json(json_buf, &remote);
+		if (err == ESP_OK) {
+			/* 记录最新一次获取到的远端版本信息快照，及其对应的校验器 */
+			s_last_remote_info    = remote;
+			s_has_remote_info     = true;
+			s_manifest_validators = validators;
+		}
+	}
+	free(json_buf);
+	if (err != ESP_OK) {
+		return err;
+	}
+
+	/* 本地版本号从 sdkconfig 中读取，若未配置则退化为空串 */
+	const char *local_ver = CONFIG_APP_PROJECT_VER;
+	if (!local_ver) {
+		local_ver = "";
+	}
+
+	int cmp = http_ota_version_compare(remote.version, local_ver);
+	ESP_LOGI(TAG,
+		 "local version=%s, remote version=%s, force=%d",
+		 local_ver,
+		 remote.version,
+		 remote.force);
+
+	/* 若本地版本号与远端版本号一致，则认为固件无需升级，只检查模型通道 */
+	if (cmp == 0) {
+		ESP_LOGI(TAG, "already on latest version, no OTA needed");
+		return do_model_update(&remote);
+	}
+
+	/* 远端版本已下载到启动分区、只待重启：不重复下载 */
+	char pending_ver[HTTP_OTA_VERSION_MAX_LEN];
+	if (ota_get_pending_version(pending_ver, sizeof(pending_ver)) &&
+	    http_ota_version_compare(remote.version, pending_ver) == 0) {
+		ESP_LOGI(TAG, "version %s already installed, pending reboot", remote.version);
+		return ESP_OK;
+	}
+
+	/* 远端版本较旧：仅在清单显式标记 force 时执行降级（回滚），否则忽略 */
+	if (cmp < 0 && !remote.force) {
+		ESP_LOGW(TAG, "remote version %s is older than local %s, ignored (set force to downgrade)",
+			 remote.version, local_ver);
+		return ESP_OK;
+	}
+
+	/* 开始执行 OTA 升级流程：本地版本恰为补丁基准时优先走差分升级 */
+	err = ESP_FAIL;
+	if (remote.delta_url[0] != '\0' && strcmp(remote.delta_base, local_ver) == 0) {
+		ESP_LOGI(TAG, "start delta OTA from: %s", remote.delta_url);
+		err = http_ota_delta_run(remote.delta_url, s_cfg.http_timeout_ms);
+		if (err != ESP_OK) {
+			ESP_LOGW(TAG, "delta OTA failed (%s), fall back to full image", esp_err_to_name(err));
+		}
+	}
+	if (err != ESP_OK) {
+		err = do_ota_with_remote(&remote);
+	}
+	if (err == ESP_OK) {
+		*out_upgraded = true;
+	}
+	return err;
+}
+
+/**
+ * @brief 计算下一次周期检查前的等待时间
+ *
+ * 在 check_interval_sec 基础上叠加 ±check_jitter_pct% 的随机抖动，
+ * 避免大量设备在同一时刻（如统一断电恢复后）集中访问服务端。
+ *
+ * @return 等待的 tick 数
+ */
+static TickType_t ota_next_check_delay(void)
+{
+	uint64_t interval_ms = (uint64_t)s_cfg.check_interval_sec * 1000;
+	uint64_t jitter_ms   = interval_ms * s_cfg.check_jitter_pct / 100;
+	uint64_t delay_ms    = interval_ms - jitter_ms;
+	if (jitter_ms > 0) {
+		delay_ms += ((uint64_t)esp_random() << 32 | esp_random()) % (2 * jitter_ms + 1);
+	}
+
+	/* pdMS_TO_TICKS 在 32 位下乘法会溢出（约 71 分钟以上），这里按 64 位换算 */
+	uint64_t ticks = delay_ms * configTICK_RATE_HZ / 1000;
+	if (ticks == 0) {
+		ticks = 1;
+	}
+	return ticks > portMAX_DELAY - 1 ? portMAX_DELAY - 1 : (TickType_t)ticks;
+}
+
+/**
+ * @brief 周期检查任务：按带抖动的间隔调用 http_ota_manager_check_now
+ */
+static void ota_sched_task(void *arg)
+{
+	(void)arg;
+	for (;;) {
+		TickType_t delay = ota_next_check_delay();
+		ESP_LOGI(TAG, "next OTA check in %u s", (unsigned)(delay / configTICK_RATE_HZ));
+		vTaskDelay(delay);
+
+		esp_err_t err = http_ota_manager_check_now();
+		if (err != ESP_OK) {
+			/* 失败不缩短间隔，服务端故障时不会被整个设备群集中重试 */
+			ESP_LOGW(TAG, "scheduled OTA check failed: %s", esp_err_to_name(err));
+		}
+	}
+}
+
 /* -------------------- 对外 API 实现 -------------------- */
 
 /**
@@ -246,6 +731,7 @@ static esp_err_t do_ota_with_url(const char *url)
  * @return
  *  - ESP_OK              : 初始化成功（或已完成初始化）
  *  - ESP_ERR_INVALID_ARG : config 为 NULL 或 version_url 为空
+ *  - ESP_ERR_NO_MEM      : 互斥锁或周期检查任务创建失败
  */
 esp_err_t http_ota_manager_init(const http_ota_manager_config_t *config)
 {
@@ -269,14 +755,36 @@ esp_err_t http_ota_manager_init(const http_ota_manager_config_t *config)
 	if (s_cfg.http_timeout_ms <= 0) {
 		s_cfg.http_timeout_ms = 15000;
 	}
+	if (s_cfg.check_jitter_pct > 50) {
+		s_cfg.check_jitter_pct = 50;
+	}
+
+	if (!s_check_lock) {
+		s_check_lock = xSemaphoreCreateMutex();
+		if (!s_check_lock) {
+			return ESP_ERR_NO_MEM;
+		}
+	}
 
 	s_state           = HTTP_OTA_STATE_IDLE;
 	s_has_remote_info = false;
-	s_inited          = true;
+	memset(&s_manifest_validators, 0, sizeof(s_manifest_validators));
+
+	if (s_cfg.check_interval_sec > 0 && !s_sched_task) {
+		if (xTaskCreate(ota_sched_task, "ota_sched", OTA_SCHED_TASK_STACK, NULL,
+				OTA_SCHED_TASK_PRIO, &s_sched_task) != pdPASS) {
+			ESP_LOGE(TAG, "create ota_sched task failed");
+			s_sched_task = NULL;
+			return ESP_ERR_NO_MEM;
+		}
+	}
+	s_inited = true;
 
-	ESP_LOGI(TAG, "http_ota_manager initialized, version_url=%s", s_cfg.version_url);
+	ESP_LOGI(TAG, "http_ota_manager initialized, version_url=%s, interval=%ds (±%u%%)",
+		 s_cfg.version_url, s_cfg.check_interval_sec, (unsigned)s_cfg.check_jitter_pct);
 	return ESP_OK;
 }
+
 /**
  * @brief 立即触发一次 OTA 检查 / 升级流程
  *
@@ -292,8 +800,8 @@ esp_err_t http_ota_manager_check_now(void)
 		return ESP_ERR_INVALID_STATE;
 	}
 
-	/* 若当前状态为运行中，说明已有 OTA 流程在进行，避免并发操作 */
-	if (s_state == HTTP_OTA_STATE_RUNNING) {
+	/* 手动与周期检查共用一把锁，已有 OTA 流程在进行时不等待，直接返回 */
+	if (xSemaphoreTake(s_check_lock, 0) != pdTRUE) {
 		ESP_LOGW(TAG, "OTA already running");
 		return ESP_ERR_INVALID_STATE;
 	}
@@ -301,66 +809,18 @@ esp_err_t http_ota_manager_check_now(void)
 	/* 标记开始进行 OTA 检查 / 升级流程 */
 	ota_set_state(HTTP_OTA_STATE_RUNNING);
 
-	esp_err_t err;
-	/* 用于存放从服务端获取到的 version.json 文本 */
-	char      json_buf[512];
-
-	/* 第一步：从远端拉取 version.json */
-	err = fetch_version_json(json_buf, sizeof(json_buf));
-	if (err != ESP_OK) {
-		/* HTTP 拉取失败则直接结束流程 */
-		ota_set_state(HTTP_OTA_STATE_FAILED);
-		return err;
-	}
-
-	/* 第二步：解析 JSON 为结构体形式，便于后续处理 */
-	http_ota_remote_info_t remote = {0};
-	err = parse_version_json(json_buf, &remote);
-	if (err != ESP_OK) {
-		ota_set_state(HTTP_OTA_STATE_FAILED);
-		return err;
-	}
-
-	/* 记录最新一次获取到的远端版本信息快照 */
-	s_last_remote_info = remote;
-	s_has_remote_info  = true;
-
-	/* 本地版本号从 sdkconfig 中读取，若未配置则退化为空串 */
-	const char *local_ver = CONFIG_APP_PROJECT_VER;
-	if (!local_ver) {
-		local_ver = "";
-	}
-
-	ESP_LOGI(TAG,
-		 "local version=%s, remote version=%s, force=%d",
-		 local_ver,
-		 remote.version,
-		 remote.force);
-
-	/* 若本地版本号与远端版本号一致，则认为无需升级 */
-	if (strcmp(remote.version, local_ver) == 0) {
-		ESP_LOGI(TAG, "already on latest version, no OTA needed");
-		ota_set_state(HTTP_OTA_STATE_SUCCESS);
-		return ESP_OK;
-	}
-
-	/* 版本不同，开始执行 OTA 升级流程 */
-	err = do_ota_with_url(remote.url);
-	if (err != ESP_OK) {
-		ota_set_state(HTTP_OTA_STATE_FAILED);
-		return err;
-	}
-
-	/* OTA 升级成功 */
-	ota_set_state(HTTP_OTA_STATE_SUCCESS);
+	bool      upgraded = false;
+	esp_err_t err      = ota_check_and_update(&upgraded);
+	ota_set_state(err == ESP_OK ? HTTP_OTA_STATE_SUCCESS : HTTP_OTA_STATE_FAILED);
+	xSemaphoreGive(s_check_lock);
 
 	/* 根据配置决定是否在升级成功后自动重启设备 */
-	if (s_cfg.auto_reboot) {
+	if (upgraded && s_cfg.auto_reboot) {
 		ESP_LOGI(TAG, "auto_reboot enabled, restarting...");
 		esp_restart();
 	}
 
-	return ESP_OK;
+	return err;
 }
 
 /**
@@ -397,3 +857,22 @@ esp_err_t http_ota_manager_get_last_remote_info(http_ota_remote_info_t *info)
 	*info = s_last_remote_info;
 	return ESP_OK;
 }
+
+/**
+ * @brief 获取当前下载进度
+ *
+ * @param[out] progress 调用方提供的结构体指针，不可为 NULL
+ *
+ * @return
+ *  - ESP_OK              : 拷贝成功
+ *  - ESP_ERR_INVALID_ARG : progress 为 NULL
+ */
+esp_err_t http_ota_manager_get_progress(http_ota_progress_t *progress)
+{
+	if (!progress) {
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	*progress = s_progress;
+	return ESP_OK;
+}
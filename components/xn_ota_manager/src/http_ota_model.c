@@ -0,0 +1,138 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-12
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-12
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\src\http_ota_model.c
+ * @Description: 模型 OTA 实现
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include "http_ota_model.h"
+#include "model_store.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_http_client.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "http_ota_model";
+
+#define MODEL_HTTP_BUF_SIZE        4096   ///< 单次读取缓冲区大小
+#define MODEL_RETRY_BASE_DELAY_MS  1000   ///< 首次重试等待时间，之后指数退避
+
+/**
+ * @brief 单次下载会话：GET 整个模型包并写入模型存储
+ */
+static esp_err_t model_download_session(const http_ota_model_config_t *config, char *buf)
+{
+	esp_http_client_config_t http_cfg = {
+		.url                         = config->url,
+		.timeout_ms                  = config->http_timeout_ms,
+		.method                      = HTTP_METHOD_GET,
+		/* 如需严格校验证书，可在此关闭 skip，并配置证书等信息 */
+		.skip_cert_common_name_check = true,
+	};
+
+	esp_http_client_handle_t client = esp_http_client_init(&http_cfg);
+	if (!client) {
+		ESP_LOGE(TAG, "esp_http_client_init failed");
+		return ESP_FAIL;
+	}
+
+	model_store_update_handle_t update = NULL;
+	uint32_t                    total  = config->size;
+	esp_err_t                   err    = esp_http_client_open(client, 0);
+	if (err == ESP_OK) {
+		int content_length = esp_http_client_fetch_headers(client);
+		int status_code    = esp_http_client_get_status_code(client);
+		if (status_code != 200) {
+			ESP_LOGE(TAG, "unexpected HTTP status: %d", status_code);
+			err = ESP_FAIL;
+		} else if (total == 0) {
+			total = content_length > 0 ? (uint32_t)content_length : 0;
+		} else if (content_length > 0 && (uint32_t)content_length != total) {
+			ESP_LOGE(TAG, "content length %d != declared size %u", content_length, (unsigned)total);
+			err = ESP_ERR_INVALID_SIZE;
+		}
+	}
+	if (err == ESP_OK && total == 0) {
+		ESP_LOGE(TAG, "model size unknown");
+		err = ESP_ERR_INVALID_SIZE;
+	}
+	if (err == ESP_OK) {
+		err = model_store_begin_update(total, config->sha256, &update);
+	}
+
+	uint32_t written      = 0;
+	uint32_t last_percent = 0;
+	while (err == ESP_OK && written < total) {
+		int read_len = esp_http_client_read(client, buf, MODEL_HTTP_BUF_SIZE);
+		if (read_len <= 0) {
+			ESP_LOGE(TAG, "read model failed at %u/%u", (unsigned)written, (unsigned)total);
+			err = ESP_FAIL;
+			break;
+		}
+		err = model_store_write(update, buf, (size_t)read_len);
+		written += (uint32_t)read_len;
+
+		uint32_t percent = (uint32_t)((uint64_t)written * 100 / total);
+		if (config->progress_cb && percent != last_percent) {
+			last_percent = percent;
+			config->progress_cb(written, total, config->user_ctx);
+		}
+	}
+
+	esp_http_client_close(client);
+	esp_http_client_cleanup(client);
+
+	if (update) {
+		if (err == ESP_OK) {
+			err = model_store_finish_update(update);
+		} else {
+			model_store_abort_update(update);
+		}
+	}
+	return err;
+}
+
+esp_err_t http_ota_model_run(const http_ota_model_config_t *config)
+{
+	if (!config || !config->url || config->url[0] == '\0') {
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	esp_err_t err = model_store_init();
+	if (err != ESP_OK) {
+		return err;
+	}
+
+	char *buf = (char *)malloc(MODEL_HTTP_BUF_SIZE);
+	if (!buf) {
+		return ESP_ERR_NO_MEM;
+	}
+
+	uint32_t delay_ms = MODEL_RETRY_BASE_DELAY_MS;
+	for (int attempt = 0; attempt <= config->max_retries; attempt++) {
+		if (attempt > 0) {
+			ESP_LOGW(TAG, "retry %d/%d in %u ms", attempt, config->max_retries, (unsigned)delay_ms);
+			vTaskDelay(pdMS_TO_TICKS(delay_ms));
+			delay_ms *= 2;
+		}
+
+		err = model_download_session(config, buf);
+		/* 摘要或包格式错误重试无意义，直接返回 */
+		if (err == ESP_OK || err == ESP_ERR_INVALID_CRC || err == ESP_ERR_INVALID_VERSION ||
+		    err == ESP_ERR_INVALID_SIZE) {
+			break;
+		}
+		ESP_LOGW(TAG, "model download failed: %s", esp_err_to_name(err));
+	}
+
+	free(buf);
+	return err;
+}
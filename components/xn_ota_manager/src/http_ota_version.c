@@ -0,0 +1,169 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-13
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-13
+ * @FilePath: \xn_voice_wake_up\components\xn_ota_manager\src\http_ota_version.c
+ * @Description: 语义化版本号比较实现
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include "http_ota_version.h"
+
+#include <ctype.h>
+#include <stdint.h>
+#include <string.h>
+
+/** 解析后的版本号（预发布标识指向原字符串） */
+typedef struct {
+	uint32_t    core[3];     ///< MAJOR / MINOR / PATCH
+	const char *pre;         ///< 预发布标识起点，无则为 NULL
+	size_t      pre_len;     ///< 预发布标识长度
+} semver_t;
+
+/**
+ * @brief 解析十进制数字段
+ *
+ * @return 解析后的位置，失败返回 NULL
+ */
+static const char *parse_number(const char *p, uint32_t *out)
+{
+	if (!isdigit((unsigned char)*p)) {
+		return NULL;
+	}
+	uint64_t v = 0;
+	while (isdigit((unsigned char)*p)) {
+		v = v * 10 + (uint64_t)(*p - '0');
+		if (v > UINT32_MAX) {
+			return NULL;
+		}
+		p++;
+	}
+	*out = (uint32_t)v;
+	return p;
+}
+
+static bool semver_parse(const char *s, semver_t *out)
+{
+	if (!s) {
+		return false;
+	}
+	memset(out, 0, sizeof(*out));
+	if (*s == 'v' || *s == 'V') {
+		s++;
+	}
+
+	for (int i = 0; i < 3; i++) {
+		s = parse_number(s, &out->core[i]);
+		if (!s) {
+			return false;
+		}
+		if (*s != '.') {
+			break;
+		}
+		if (i == 2) {
+			return false;
+		}
+		s++;
+	}
+
+	if (*s == '-') {
+		s++;
+		out->pre     = s;
+		out->pre_len = strcspn(s, "+");
+		if (out->pre_len == 0) {
+			return false;
+		}
+		s += out->pre_len;
+	}
+	if (*s == '+') {
+		return s[1] != '\0';
+	}
+	return *s == '\0';
+}
+
+/**
+ * @brief 判断预发布标识段是否全为数字
+ */
+static bool ident_is_numeric(const char *p, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		if (!isdigit((unsigned char)p[i])) {
+			return false;
+		}
+	}
+	return len > 0;
+}
+
+/**
+ * @brief 按 SemVer 规则比较预发布标识
+ */
+static int compare_prerelease(const semver_t *a, const semver_t *b)
+{
+	/* 没有预发布标识的正式版更高 */
+	if (!a->pre || !b->pre) {
+		return (a->pre ? -1 : 0) + (b->pre ? 1 : 0);
+	}
+
+	const char *pa = a->pre, *ea = a->pre + a->pre_len;
+	const char *pb = b->pre, *eb = b->pre + b->pre_len;
+	while (pa < ea && pb < eb) {
+		size_t la = strcspn(pa, ".+");
+		size_t lb = strcspn(pb, ".+");
+		if (la > (size_t)(ea - pa)) {
+			la = (size_t)(ea - pa);
+		}
+		if (lb > (size_t)(eb - pb)) {
+			lb = (size_t)(eb - pb);
+		}
+
+		bool na = ident_is_numeric(pa, la);
+		bool nb = ident_is_numeric(pb, lb);
+		int  cmp;
+		if (na && nb) {
+			/* 数字段：先比长度（无前导零时长者更大），再逐位比较 */
+			cmp = la != lb ? (la < lb ? -1 : 1) : memcmp(pa, pb, la);
+		} else if (na != nb) {
+			cmp = na ? -1 : 1;
+		} else {
+			cmp = memcmp(pa, pb, la < lb ? la : lb);
+			if (cmp == 0 && la != lb) {
+				cmp = la < lb ? -1 : 1;
+			}
+		}
+		if (cmp != 0) {
+			return cmp < 0 ? -1 : 1;
+		}
+
+		pa += la + 1;
+		pb += lb + 1;
+	}
+
+	/* 前缀相同时段数多者更大 */
+	bool more_a = pa < ea;
+	bool more_b = pb < eb;
+	return (more_a ? 1 : 0) - (more_b ? 1 : 0);
+}
+
+int http_ota_version_compare(const char *a, const char *b)
+{
+	semver_t va, vb;
+	if (!semver_parse(a, &va) || !semver_parse(b, &vb)) {
+		int cmp = strcmp(a ? a : "", b ? b : "");
+		return cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
+	}
+
+	for (int i = 0; i < 3; i++) {
+		if (va.core[i] != vb.core[i]) {
+			return va.core[i] < vb.core[i] ? -1 : 1;
+		}
+	}
+	return compare_prerelease(&va, &vb);
+}
+
+bool http_ota_version_is_valid(const char *version)
+{
+	semver_t v;
+	return semver_parse(version, &v);
+}
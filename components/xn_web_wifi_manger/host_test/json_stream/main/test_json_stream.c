@@ -0,0 +1,239 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-14
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-14
+ * @FilePath: \xn_voice_wake_up\components\xn_web_wifi_manger\host_test\json_stream\main\test_json_stream.c
+ * @Description: 流式 JSON 输出主机测试
+ *
+ * 输出回调把每个输出块追加到捕获缓冲区并记录块边界，检查：
+ *  - 引号、反斜杠与全部控制字符的转义；
+ *  - UTF-8 多字节字符原样输出（含被输出块切开的情况）；
+ *  - 转义序列跨越暂存缓冲区边界时拼接结果正确；
+ *  - 分隔符、定长字段、数值字面量与错误传递。
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "json_stream.h"
+
+#define CAPTURE_MAX_SIZE     4096    ///< 捕获缓冲区大小
+#define CAPTURE_MAX_CHUNKS   32      ///< 记录的输出块数上限
+
+/** 输出回调捕获的数据 */
+typedef struct {
+    char      data[CAPTURE_MAX_SIZE];
+    size_t    len;
+    size_t    chunk_lens[CAPTURE_MAX_CHUNKS];
+    int       chunks;
+    int       fail_at;                  ///< 第几次回调返回错误（-1 表示不失败）
+} capture_t;
+
+static capture_t s_cap;
+
+static esp_err_t capture_flush(void *ctx, const char *data, size_t len)
+{
+    capture_t *cap = (capture_t *)ctx;
+    TEST_ASSERT_NOT_EQUAL(0, len);
+    TEST_ASSERT_TRUE(cap->len + len < sizeof(cap->data));
+    if (cap->chunks == cap->fail_at) {
+        return ESP_FAIL;
+    }
+    memcpy(cap->data + cap->len, data, len);
+    cap->len += len;
+    cap->data[cap->len] = '\0';
+    if (cap->chunks < CAPTURE_MAX_CHUNKS) {
+        cap->chunk_lens[cap->chunks] = len;
+    }
+    cap->chunks++;
+    return ESP_OK;
+}
+
+static void capture_start(json_stream_t *js)
+{
+    memset(&s_cap, 0, sizeof(s_cap));
+    s_cap.fail_at = -1;
+    json_stream_init(js, capture_flush, &s_cap);
+}
+
+/**
+ * @brief 输出单个字符串值并与期望的 JSON 文本比对
+ */
+static void assert_string_json(const char *in, const char *expected)
+{
+    json_stream_t js;
+    capture_start(&js);
+    json_stream_string(&js, in);
+    TEST_ASSERT_EQUAL(ESP_OK, json_stream_finish(&js));
+    TEST_ASSERT_EQUAL_STRING(expected, s_cap.data);
+}
+
+TEST_CASE("quotes, backslashes and short escapes", "[json_stream]")
+{
+    assert_string_json("", "\"\"");
+    assert_string_json("a\"b\\c/", "\"a\\\"b\\\\c/\"");
+    assert_string_json("\b\f\n\r\t", "\"\\b\\f\\n\\r\\t\"");
+}
+
+TEST_CASE("every other control character uses \\u00XX", "[json_stream]")
+{
+    char in[2] = {0};
+    char expected[16];
+    for (int c = 0x01; c < 0x20; c++) {
+        if (c == '\b' || c == '\f' || c == '\n' || c == '\r' || c == '\t') {
+            continue;
+        }
+        in[0] = (char)c;
+        snprintf(expected, sizeof(expected), "\"\\u%04x\"", c);
+        assert_string_json(in, expected);
+    }
+    /* 0x7f 不属于 JSON 控制字符，原样输出 */
+    assert_string_json("\x7f", "\"\x7f\"");
+}
+
+TEST_CASE("UTF-8 passes through unchanged", "[json_stream]")
+{
+    assert_string_json("星年 Wi-Fi", "\"星年 Wi-Fi\"");
+    assert_string_json("\xf0\x9f\x93\xb6\n\xc3\xa9", "\"\xf0\x9f\x93\xb6\\n\xc3\xa9\"");
+}
+
+TEST_CASE("UTF-8 character split across output chunks", "[json_stream]")
+{
+    /* '"' + 254 个 'a' 之后是 3 字节的 "星"，第一个输出块在其第 1 字节后结束 */
+    char in[300];
+    char expected[310];
+    memset(in, 'a', 254);
+    strcpy(in + 254, "星x");
+    snprintf(expected, sizeof(expected), "\"%s\"", in);
+
+    assert_string_json(in, expected);
+    TEST_ASSERT_EQUAL(2, s_cap.chunks);
+    TEST_ASSERT_EQUAL(JSON_STREAM_BUF_SIZE, s_cap.chunk_lens[0]);
+}
+
+TEST_CASE("escape sequence split across output chunks", "[json_stream]")
+{
+    /* '"' + 252 个 'a' 占满输出偏移 0..252，"\u0001" 落在 253..258，跨越 256 边界 */
+    char in[300];
+    memset(in, 'a', 252);
+    in[252] = '\x01';
+    strcpy(in + 253, "b\"c");
+
+    char expected[320];
+    memset(expected, 0, sizeof(expected));
+    expected[0] = '"';
+    memset(expected + 1, 'a', 252);
+    strcat(expected, "\\u0001b\\\"c\"");
+
+    assert_string_json(in, expected);
+    TEST_ASSERT_EQUAL(2, s_cap.chunks);
+    TEST_ASSERT_EQUAL(JSON_STREAM_BUF_SIZE, s_cap.chunk_lens[0]);
+    TEST_ASSERT_EQUAL_STRING_LEN("\\u0", s_cap.data + JSON_STREAM_BUF_SIZE - 3, 3);
+
+    /* 两字符转义 "\n" 恰好被切成 '\\' | 'n' */
+    memset(in, 'a', 254);
+    strcpy(in + 254, "\n");
+    memset(expected, 0, sizeof(expected));
+    expected[0] = '"';
+    memset(expected + 1, 'a', 254);
+    strcat(expected, "\\n\"");
+
+    assert_string_json(in, expected);
+    TEST_ASSERT_EQUAL(2, s_cap.chunks);
+    TEST_ASSERT_EQUAL('\\', s_cap.data[JSON_STREAM_BUF_SIZE - 1]);
+}
+
+TEST_CASE("long output is split into full chunks", "[json_stream]")
+{
+    json_stream_t js;
+    capture_start(&js);
+    json_stream_begin_array(&js);
+    for (int i = 0; i < 200; i++) {
+        json_stream_string(&js, "net\t\xe6\x98\x9f");
+    }
+    json_stream_end_array(&js);
+    TEST_ASSERT_EQUAL(ESP_OK, json_stream_finish(&js));
+
+    /* 每个元素 "net\\t星"（含引号）为 10 字节，另加 199 个逗号 */
+    TEST_ASSERT_EQUAL(2 + 200 * 10 + 199, s_cap.len);
+    for (int i = 0; i < s_cap.chunks - 1; i++) {
+        TEST_ASSERT_EQUAL(JSON_STREAM_BUF_SIZE, s_cap.chunk_lens[i]);
+    }
+    TEST_ASSERT_EQUAL_STRING_LEN("[\"net\\t\xe6\x98\x9f\",\"", s_cap.data, 13);
+    TEST_ASSERT_EQUAL_STRING("\",\"net\\t\xe6\x98\x9f\"]", s_cap.data + s_cap.len - 13);
+}
+
+TEST_CASE("objects, separators and literals", "[json_stream]")
+{
+    json_stream_t js;
+    capture_start(&js);
+    json_stream_begin_object(&js);
+    json_stream_key(&js, "ssid");
+    json_stream_string_n(&js, "home-net-extra", 8);
+    json_stream_key(&js, "rssi");
+    json_stream_int(&js, -61);
+    json_stream_key(&js, "ch");
+    json_stream_uint(&js, 11);
+    json_stream_key(&js, "ok");
+    json_stream_bool(&js, true);
+    json_stream_key(&js, "nan");
+    json_stream_double(&js, NAN);
+    json_stream_key(&js, "list");
+    json_stream_begin_array(&js);
+    json_stream_null(&js);
+    json_stream_begin_object(&js);
+    json_stream_end_object(&js);
+    json_stream_string(&js, NULL);
+    json_stream_end_array(&js);
+    json_stream_end_object(&js);
+    TEST_ASSERT_EQUAL(ESP_OK, json_stream_finish(&js));
+    TEST_ASSERT_EQUAL_STRING("{\"ssid\":\"home-net\",\"rssi\":-61,\"ch\":11,\"ok\":true,"
+                             "\"nan\":null,\"list\":[null,{},null]}", s_cap.data);
+}
+
+TEST_CASE("unbalanced or too deep nesting is rejected", "[json_stream]")
+{
+    json_stream_t js;
+    capture_start(&js);
+    json_stream_begin_object(&js);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, json_stream_finish(&js));
+
+    capture_start(&js);
+    json_stream_end_array(&js);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, json_stream_finish(&js));
+
+    capture_start(&js);
+    for (int i = 0; i <= JSON_STREAM_MAX_DEPTH; i++) {
+        json_stream_begin_array(&js);
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, json_stream_finish(&js));
+}
+
+TEST_CASE("flush error stops further output", "[json_stream]")
+{
+    json_stream_t js;
+    capture_start(&js);
+    s_cap.fail_at = 1;
+    json_stream_begin_array(&js);
+    for (int i = 0; i < 100; i++) {
+        json_stream_string(&js, "0123456789");
+    }
+    json_stream_end_array(&js);
+    TEST_ASSERT_EQUAL(ESP_FAIL, json_stream_finish(&js));
+    TEST_ASSERT_EQUAL(1, s_cap.chunks);
+    TEST_ASSERT_EQUAL(JSON_STREAM_BUF_SIZE, s_cap.len);
+}
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    int failures = UNITY_END();
+    exit(failures == 0 ? 0 : 1);
+}
@@ -0,0 +1,131 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-14
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-14
+ * @FilePath: \xn_voice_wake_up\components\xn_web_wifi_manger\include\json_stream.h
+ * @Description: 流式 JSON 输出 - 固定暂存缓冲区，写满即交给输出回调（如 httpd_resp_send_chunk）
+ *
+ * 不做堆分配、不限制总长度，字符串按 RFC 8259 转义。典型用法：
+ * @code
+ * json_stream_t js;
+ * json_stream_init(&js, flush_fn, req);
+ * json_stream_begin_object(&js);
+ * json_stream_key(&js, "ssid");
+ * json_stream_string(&js, ssid);
+ * json_stream_end_object(&js);
+ * esp_err_t err = json_stream_finish(&js);
+ * @endcode
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define JSON_STREAM_BUF_SIZE    256     ///< 暂存缓冲区大小（字节），写满后整块输出
+#define JSON_STREAM_MAX_DEPTH   8       ///< 对象 / 数组最大嵌套深度
+
+/**
+ * @brief 输出回调
+ *
+ * @param ctx  json_stream_init 传入的上下文
+ * @param data 待输出数据
+ * @param len  数据长度（> 0）
+ *
+ * @return ESP_OK 成功，其它值使后续写入全部失效并由 json_stream_finish 返回
+ */
+typedef esp_err_t (*json_stream_flush_fn)(void *ctx, const char *data, size_t len);
+
+/**
+ * @brief 流式 JSON 写入器（通常放在调用方栈上）
+ */
+typedef struct {
+    json_stream_flush_fn flush;                         ///< 输出回调
+    void                *ctx;                           ///< 输出回调上下文
+    char                 buf[JSON_STREAM_BUF_SIZE];     ///< 暂存缓冲区
+    size_t               len;                           ///< 暂存数据长度
+    uint8_t              depth;                         ///< 当前嵌套深度
+    bool                 has_member[JSON_STREAM_MAX_DEPTH + 1]; ///< 各层是否已有成员（决定是否输出逗号）
+    bool                 after_key;                     ///< 刚写完 key，下一个值不加逗号
+    esp_err_t            err;                           ///< 首个错误，出错后忽略后续写入
+} json_stream_t;
+
+/**
+ * @brief 初始化写入器
+ *
+ * @param js    写入器
+ * @param flush 输出回调，不可为 NULL
+ * @param ctx   输出回调上下文
+ */
+void json_stream_init(json_stream_t *js, json_stream_flush_fn flush, void *ctx);
+
+/** @brief 开始对象 '{' */
+void json_stream_begin_object(json_stream_t *js);
+
+/** @brief 结束对象 '}' */
+void json_stream_end_object(json_stream_t *js);
+
+/** @brief 开始数组 '[' */
+void json_stream_begin_array(json_stream_t *js);
+
+/** @brief 结束数组 ']' */
+void json_stream_end_array(json_stream_t *js);
+
+/**
+ * @brief 写入对象成员名（之后必须紧跟一个值）
+ *
+ * @param js  写入器
+ * @param key 成员名（按字符串转义）
+ */
+void json_stream_key(json_stream_t *js, const char *key);
+
+/**
+ * @brief 写入字符串值（转义引号、反斜杠与控制字符，UTF-8 原样输出）
+ *
+ * @param js 写入器
+ * @param s  以 '\0' 结尾的字符串，NULL 输出 null
+ */
+void json_stream_string(json_stream_t *js, const char *s);
+
+/**
+ * @brief 写入最多 max_len 字节的字符串值（用于不保证 '\0' 结尾的定长字段，如 SSID）
+ *
+ * @param js      写入器
+ * @param s       字符串
+ * @param max_len 最大长度，遇到 '\0' 提前结束
+ */
+void json_stream_string_n(json_stream_t *js, const char *s, size_t max_len);
+
+/** @brief 写入整数值 */
+void json_stream_int(json_stream_t *js, int64_t v);
+
+/** @brief 写入无符号整数值 */
+void json_stream_uint(json_stream_t *js, uint64_t v);
+
+/** @brief 写入浮点数值（非有限值输出 null） */
+void json_stream_double(json_stream_t *js, double v);
+
+/** @brief 写入布尔值 */
+void json_stream_bool(json_stream_t *js, bool v);
+
+/** @brief 写入 null */
+void json_stream_null(json_stream_t *js);
+
+/**
+ * @brief 输出暂存缓冲区中的剩余数据
+ *
+ * @param js 写入器
+ *
+ * @return ESP_OK 全部输出成功，ESP_ERR_INVALID_STATE 对象 / 数组未闭合或嵌套过深，
+ *         其它值为输出回调返回的首个错误
+ */
+esp_err_t json_stream_finish(json_stream_t *js);
+
+#endif /* JSON_STREAM_H */
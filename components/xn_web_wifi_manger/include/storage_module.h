@@ -7,6 +7,17 @@
  * @Description: WiFi 存储模块（基于 NVS 的 WiFi 列表管理接口）
  *
  * 仅负责“存 / 取 / 删”WiFi 配置，不直接操作 WiFi 连接。
+ *
+ * 每条 wifi_config_t 除 SSID / 密码外，还在以下字段中记录最近一次成功连接的 AP，
+ * 供重连时跳过全信道扫描（sta.channel 为 0 表示尚无记录）：
+ *  - sta.bssid              : AP MAC 地址；
+ *  - sta.channel            : AP 主信道；
+ *  - sta.threshold.authmode : AP 加密方式。
+ * 保存时 sta.bssid_set 恒为 false，是否锁定 BSSID 由连接方决定。
+ *
+ * 列表在首次读取后缓存在 RAM 中，读写都只访问缓存；修改由后台低优先级任务延迟、
+ * 合并后写入 NVS（与上次落盘内容相同则不写），WiFi 事件路径上不会阻塞在 flash 写入上。
+ * 未提交的修改在 esp_restart() 前自动写入，断电时最多丢失一个提交期限内的排序变化。
  */
 
 #ifndef STORAGE_MODULE_H
@@ -21,12 +32,16 @@
 /**
  * @brief WiFi 存储模块配置
  *
- * - nvs_namespace : 使用的 NVS 命名空间（建议单独使用一个命名空间）；
- * - max_wifi_num  : 最多保存的 WiFi 条目数量（>0，按“最近成功连接优先”排序）。
+ * - nvs_namespace        : 使用的 NVS 命名空间（建议单独使用一个命名空间）；
+ * - max_wifi_num         : 最多保存的 WiFi 条目数量（>0，按“最近成功连接优先”排序）；
+ * - commit_delay_ms      : 列表成员 / 顺序 / 密码变化后延迟多久写入 NVS，期间的修改合并为一次写入；
+ * - hint_commit_delay_ms : 仅 AP 记录（BSSID / 信道）变化时的提交延迟，频繁漫游时减少擦写。
  */
 typedef struct {
-    const char *nvs_namespace;  ///< NVS 命名空间名（只保存字符串指针，不拷贝）
-    uint8_t     max_wifi_num;   ///< WiFi 最大保存数量（0 时内部会强制设为 1）
+    const char *nvs_namespace;         ///< NVS 命名空间名（只保存字符串指针，不拷贝）
+    uint8_t     max_wifi_num;          ///< WiFi 最大保存数量（0 时内部会强制设为 1）
+    uint32_t    commit_delay_ms;       ///< 一般修改的提交延迟（ms）
+    uint32_t    hint_commit_delay_ms;  ///< 仅 AP 记录变化时的提交延迟（ms）
 } wifi_storage_config_t;
 
 /**
@@ -34,11 +49,14 @@ typedef struct {
  *
  * - 命名空间： "wifi_store"
  * - 最多保存： 5 条 WiFi 配置
+ * - 提交延迟： 5 秒；仅 AP 记录变化时 10 分钟
  */
-#define WIFI_STORAGE_DEFAULT_CONFIG()        \
-    (wifi_storage_config_t){                 \
-        .nvs_namespace = "wifi_store",       \
-        .max_wifi_num  = 5,                  \
+#define WIFI_STORAGE_DEFAULT_CONFIG()                  \
+    (wifi_storage_config_t){                           \
+        .nvs_namespace        = "wifi_store",          \
+        .max_wifi_num         = 5,                     \
+        .commit_delay_ms      = 5000,                  \
+        .hint_commit_delay_ms = 10 * 60 * 1000,        \
     }
 
 /**
@@ -46,13 +64,15 @@ typedef struct {
  *
  * 负责：
  *  - 初始化 NVS（若空间不足或版本不兼容会自动擦除重建）；
- *  - 保存配置参数，用于后续读写 WiFi 列表。
+ *  - 保存配置参数，用于后续读写 WiFi 列表；
+ *  - 分配 max_wifi_num 条目的 RAM 缓存，创建后台提交任务。
  *
  * @param config 外部配置；可为 NULL，NULL 时使用 WIFI_STORAGE_DEFAULT_CONFIG。
  *
  * @return
  *  - ESP_OK                 : 成功（可重复调用，后续调用直接返回 ESP_OK）
  *  - ESP_ERR_INVALID_ARG    : 配置非法（理论上不会出现，内部已做兜底）
+ *  - ESP_ERR_NO_MEM         : 缓存 / 提交任务创建失败
  *  - 其它 esp_err_t         : NVS 初始化相关错误
  */
 esp_err_t wifi_storage_init(const wifi_storage_config_t *config);
@@ -63,6 +83,7 @@ esp_err_t wifi_storage_init(const wifi_storage_config_t *config);
  * 列表按“最近成功连接优先”排序：
  *  - 下标 0 为当前推荐优先尝试连接的 WiFi；
  *  - 返回数量不超过初始化时设置的 max_wifi_num。
+ * 首次调用从 NVS 读取并建立缓存，之后直接从 RAM 拷贝。
  *
  * @param[out] configs    调用方提供的数组，长度需 >= max_wifi_num
  * @param[out] count_out  实际读取到的条目数量（无数据时为 0）
@@ -81,18 +102,22 @@ esp_err_t wifi_storage_load_all(wifi_config_t *configs, uint8_t *count_out);
  * 一般在“STA 成功获取 IP”事件中调用，用于维护“最近成功连接”的有序列表。
  *
  * 策略：
- *  - 已存在同名 SSID：对应条目移动到首位，保持其余顺序不变；
+ *  - 已存在同名 SSID：用新配置（含密码与 AP 记录）替换该条目并移动到首位，保持其余顺序不变；
  *  - 不存在该 SSID：
  *      - 若列表未满：将该配置插入首位；
- *      - 若列表已满：将该配置插入首位并丢弃最后一条。
+ *      - 若列表已满：将该配置插入首位并丢弃最后一条；
+ *  - 更新后的列表与当前缓存完全一致时（如连回同一 AP）不安排提交；
+ *  - 只更新 RAM 缓存，NVS 写入由后台任务在 commit_delay_ms（仅 AP 记录变化时
+ *    hint_commit_delay_ms）后完成，可安全地在 WiFi 事件回调中调用。
  *
- * @param[in] config 本次成功连接使用的 wifi_config_t（完整结构体）
+ * @param[in] config 本次成功连接使用的 wifi_config_t（完整结构体，sta.bssid / sta.channel /
+ *                   sta.threshold.authmode 填写实际连接的 AP）
  *
  * @return
  *  - ESP_OK               : 更新成功
  *  - ESP_ERR_INVALID_ARG  : config 为空
  *  - ESP_ERR_INVALID_STATE: 模块未初始化
- *  - 其它 esp_err_t       : NVS 写失败等
+ *  - 其它 esp_err_t       : 首次加载时 NVS 读失败等
  */
 esp_err_t wifi_storage_on_connected(const wifi_config_t *config);
 
@@ -100,7 +125,7 @@ esp_err_t wifi_storage_on_connected(const wifi_config_t *config);
  * @brief 按 SSID 删除已保存的 WiFi 配置
  *
  * 精确匹配 SSID（区分大小写），忽略密码等其它字段。
- * 若删除后列表为空，将擦除对应 NVS key。
+ * 删除立即写入 NVS（同时提交其它待提交的修改）；若删除后列表为空，将擦除对应 NVS key。
  *
  * @param[in] ssid 要删除的 WiFi SSID（以 '\0' 结尾的字符串）
  *
@@ -112,4 +137,17 @@ esp_err_t wifi_storage_on_connected(const wifi_config_t *config);
  */
 esp_err_t wifi_storage_delete_by_ssid(const char *ssid);
 
+/**
+ * @brief 立即提交尚未写入 NVS 的修改
+ *
+ * 一般无需调用：后台任务会按提交延迟自动写入，esp_restart() 前也会自动提交。
+ * 适用于即将断电等场景。
+ *
+ * @return
+ *  - ESP_OK               : 成功（包括没有待提交修改的情况）
+ *  - ESP_ERR_INVALID_STATE: 模块未初始化
+ *  - 其它 esp_err_t       : NVS 写失败（修改保留，稍后自动重试）
+ */
+esp_err_t wifi_storage_flush(void);
+
 #endif /* STORAGE_MODULE_H */
@@ -0,0 +1,41 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-14
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-14
+ * @FilePath: \xn_voice_wake_up\components\xn_web_wifi_manger\include\web_assets.h
+ * @Description: 配网页面内嵌静态资源表（构建时由 tools/web_assets.py 生成）
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 单个内嵌静态资源
+ *
+ * 数据位于 flash 的只读段，直接作为响应体发送，无需文件系统与拷贝缓冲区。
+ */
+typedef struct {
+    const char    *uri;             ///< 访问路径，如 "/app.js"
+    const char    *content_type;    ///< Content-Type
+    const char    *cache_control;   ///< Cache-Control（HTML 每次重新验证，其余长期缓存）
+    const char    *etag_gzip;       ///< gzip 编码对应的强 ETag（含引号）
+    const char    *etag_identity;   ///< 原始编码对应的强 ETag（含引号）
+    const uint8_t *gzip;            ///< gzip 压缩后的数据
+    size_t         gzip_size;       ///< gzip 数据长度
+    const uint8_t *identity;        ///< 原始数据（客户端不支持 gzip 时使用）
+    size_t         identity_size;   ///< 原始数据长度
+} web_asset_t;
+
+/** 资源表（生成文件中定义） */
+extern const web_asset_t g_web_assets[];
+
+/** 资源数量 */
+extern const size_t g_web_asset_count;
+
+#endif /* WEB_ASSETS_H */
@@ -21,6 +21,9 @@
 
 #include "esp_err.h"
 
+#define WEB_MODULE_MAX_SAVED_ITEMS  16  ///< /api/wifi/saved 单次返回的最大条数
+#define WEB_MODULE_MAX_SCAN_ITEMS   32  ///< /api/wifi/scan 单次返回的最大条数
+
 /**
  * @brief Web 配网模块关注的 WiFi 状态视图
  *
@@ -134,8 +137,7 @@ typedef struct {
  * @brief 初始化 Web 配网模块
  *
  * 负责：
- * - 挂载 SPIFFS 分区（label: "wifi_spiffs"，base_path: "/spiffs"）；
- * - 启动 HTTP 服务器并注册静态文件路由；
+ * - 启动 HTTP 服务器并注册内嵌静态资源路由（gzip + ETag，见 web_assets.h）；
  * - 如配置了 get_status_cb，则注册 /api/wifi/status 接口。
  *
  * @param config 配置指针，可为 NULL，NULL 时使用 WEB_MODULE_DEFAULT_CONFIG。
@@ -143,7 +145,7 @@ typedef struct {
  * @return
  *  - ESP_OK                 : 初始化成功（可重复调用，后续调用直接返回 ESP_OK）
  *  - ESP_ERR_NO_MEM 等      : 内部资源不足
- *  - 其它 esp_err_t         : SPIFFS / HTTP 服务器相关错误
+ *  - 其它 esp_err_t         : HTTP 服务器相关错误
  */
 esp_err_t web_module_init(const web_module_config_t *config);
 
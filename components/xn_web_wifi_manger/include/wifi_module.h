@@ -9,6 +9,7 @@
  * 上层（如 wifi_manage）通过：
  *  - wifi_module_init()  配置并初始化 WiFi 驱动、STA/AP 接口；
  *  - wifi_module_connect()  发起一次 STA 连接流程；
+ *  - wifi_module_connect_hint() 按已知 BSSID / 信道发起单信道快速连接；
  *  - wifi_module_scan()     执行同步扫描，获取附近 AP 列表；
  * 以及注册的 event_cb 获取 WiFi 状态变化。
  */
@@ -74,10 +75,22 @@ typedef struct {
  * @brief WiFi 扫描结果中单个 AP 信息（精简版）
  */
 typedef struct {
-    char   ssid[32];   ///< SSID（UTF-8，<=31 字符，结尾自动补 '\0'）
-    int8_t rssi;       ///< RSSI（dBm）
+    char    ssid[32];  ///< SSID（UTF-8，<=31 字符，结尾自动补 '\0'）
+    int8_t  rssi;      ///< RSSI（dBm）
+    uint8_t bssid[6];  ///< AP MAC 地址
+    uint8_t channel;   ///< 主信道
+    uint8_t authmode;  ///< 加密方式（wifi_auth_mode_t）
 } wifi_module_scan_result_t;
 
+/**
+ * @brief 已知 AP 的定位信息，用于跳过全信道扫描直接连接
+ */
+typedef struct {
+    uint8_t bssid[6];  ///< 目标 AP MAC 地址
+    uint8_t channel;   ///< 目标 AP 主信道（1~14）
+    uint8_t authmode;  ///< 最低可接受的加密方式（wifi_auth_mode_t），防止被降级到更弱的加密
+} wifi_module_ap_hint_t;
+
 /* -------------------------------------------------------------------------- */
 /*                                  默认配置                                   */
 /* -------------------------------------------------------------------------- */
@@ -137,6 +150,21 @@ esp_err_t wifi_module_init(const wifi_module_config_t *config);
  */
 esp_err_t wifi_module_connect(const char *ssid, const char *password);
 
+/**
+ * @brief 按已知 BSSID / 信道连接指定 AP
+ *
+ * 驱动只在 hint->channel 上探测 hint->bssid，省去全信道扫描（约 2~3 秒），
+ * 适用于 AP 重启等“原地重连”场景；AP 已更换信道或 BSSID 时本次连接失败，
+ * 由上层回退到扫描流程。结果同样通过 event_cb 上报。
+ *
+ * @param ssid     目标 AP SSID，必须非 NULL 且非空
+ * @param password 目标 AP 密码，可为 NULL/空串 表示开放网络
+ * @param hint     AP 定位信息；为 NULL 或 channel 为 0 时等同于 wifi_module_connect()
+ * @return 同 wifi_module_connect()
+ */
+esp_err_t wifi_module_connect_hint(const char *ssid, const char *password,
+                                   const wifi_module_ap_hint_t *hint);
+
 /**
  * @brief 同步扫描附近可见的 WiFi 列表
  *
@@ -27,6 +27,19 @@
  */
 #define WIFI_MANAGE_STEP_INTERVAL_MS 1000
 
+/**
+ * @brief 重连时单次共享扫描保留的最大 AP 数量
+ */
+#define WIFI_MANAGE_SCAN_MAX_AP      20
+
+/**
+ * @brief 已连接状态下 RSSI 指标的采样周期（单位：ms）
+ *
+ * 采样结果写入 xn_wifi_rssi_dbm 仪表与 xn_wifi_rssi_samples_dbm 直方图（/api/metrics），
+ * 用于回看信号强度的历史分布。
+ */
+#define WIFI_MANAGE_RSSI_SAMPLE_MS   10000
+
 /**
  * @brief WiFi 管理层抽象的连接状态
  *
@@ -56,6 +69,7 @@ typedef void (*wifi_event_cb_t)(wifi_manage_state_t state);
 typedef struct {
     int  max_retry_count;          ///< 单个 AP 最多连续重试次数（<=0 表示只尝试一次）
     int  reconnect_interval_ms;    ///< 整轮失败后等待多久再自动重试；<0 表示关闭自动重试
+    int  fast_retry_interval_ms;   ///< 等待整轮重试期间，对最近连接的 AP 做单信道快速重连的间隔；<=0 表示关闭
     char ap_ssid[32];              ///< 配网 AP SSID（最长 31 字符，需手动保证 '\0' 结尾）
     char ap_password[64];          ///< 配网 AP 密码（8~63 字符，留 1 字节给 '\0'）
     char ap_ip[16];                ///< 配网 AP 网口 IP 地址，如 "192.168.4.1"
@@ -78,6 +92,7 @@ typedef struct {
     (wifi_manage_config_t){                                \
         .max_retry_count       = 5,                        \
         .reconnect_interval_ms = 10000,                    \
+        .fast_retry_interval_ms = 2000,                    \
         .ap_ssid               = "XN-ESP32-AP",            \
         .ap_password           = "12345678",               \
         .ap_ip                 = "192.168.4.1",            \
@@ -94,6 +109,13 @@ typedef struct {
  * - 创建管理任务并启动状态机；
  * - 根据配置启动 STA + AP 模式。
  *
+ * 断线重连策略（每轮）：
+ * 1. 最近连接的 WiFi 有 AP 记录（BSSID / 信道 / 加密方式）时，先做单信道快速连接；
+ * 2. 失败后执行一次共享扫描，将所有可见的已保存 WiFi 按 RSSI 从强到弱排序，
+ *    依次按扫描到的 BSSID / 信道定向连接（扫描不可见的 WiFi 本轮跳过）；
+ * 3. 整轮失败后进入 WIFI_MANAGE_STATE_CONNECT_FAILED，等待 reconnect_interval_ms 再开始下一轮，
+ *    其间每隔 fast_retry_interval_ms 重复一次第 1 步。
+ *
  * @param config 若为 NULL，则使用 @ref WIFI_MANAGE_DEFAULT_CONFIG
  *
  * @return
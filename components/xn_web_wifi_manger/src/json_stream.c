@@ -0,0 +1,243 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2026-01-14
+ * @LastEditors: xingnian j_xingnian@163.com
+ * @LastEditTime: 2026-01-14
+ * @FilePath: \xn_voice_wake_up\components\xn_web_wifi_manger\src\json_stream.c
+ * @Description: 流式 JSON 输出实现
+ *
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "json_stream.h"
+
+/**
+ * @brief 把暂存缓冲区交给输出回调
+ */
+static void json_stream_flush(json_stream_t *js)
+{
+    if (js->len == 0 || js->err != ESP_OK) {
+        return;
+    }
+    js->err = js->flush(js->ctx, js->buf, js->len);
+    js->len = 0;
+}
+
+/**
+ * @brief 追加原始字节，缓冲区写满时整块输出（数据可跨越多个输出块）
+ */
+static void json_stream_put(json_stream_t *js, const char *data, size_t len)
+{
+    while (len > 0 && js->err == ESP_OK) {
+        size_t n = sizeof(js->buf) - js->len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(js->buf + js->len, data, n);
+        js->len += n;
+        data    += n;
+        len     -= n;
+        if (js->len == sizeof(js->buf)) {
+            json_stream_flush(js);
+        }
+    }
+}
+
+static void json_stream_putc(json_stream_t *js, char c)
+{
+    json_stream_put(js, &c, 1);
+}
+
+/**
+ * @brief 值或成员之前的分隔符处理
+ */
+static void json_stream_before_value(json_stream_t *js)
+{
+    if (js->after_key) {
+        js->after_key = false;
+        return;
+    }
+    if (js->has_member[js->depth]) {
+        json_stream_putc(js, ',');
+    }
+    js->has_member[js->depth] = true;
+}
+
+/**
+ * @brief 输出转义后的字符串（含两侧引号）
+ */
+static void json_stream_put_escaped(json_stream_t *js, const char *s, size_t max_len)
+{
+    static const char HEX[] = "0123456789abcdef";
+
+    json_stream_putc(js, '"');
+    const char *run = s;
+    size_t      i   = 0;
+    for (; i < max_len && s[i] != '\0'; i++) {
+        unsigned char c   = (unsigned char)s[i];
+        char          esc = 0;
+        switch (c) {
+        case '"':  esc = '"';  break;
+        case '\\': esc = '\\'; break;
+        case '\b': esc = 'b';  break;
+        case '\f': esc = 'f';  break;
+        case '\n': esc = 'n';  break;
+        case '\r': esc = 'r';  break;
+        case '\t': esc = 't';  break;
+        default:
+            if (c >= 0x20) {
+                continue;
+            }
+            break;
+        }
+
+        /* 先输出前面无需转义的连续片段，再输出转义序列 */
+        json_stream_put(js, run, (size_t)(s + i - run));
+        run = s + i + 1;
+        if (esc != 0) {
+            char seq[2] = {'\\', esc};
+            json_stream_put(js, seq, sizeof(seq));
+        } else {
+            char seq[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0x0f]};
+            json_stream_put(js, seq, sizeof(seq));
+        }
+    }
+    json_stream_put(js, run, (size_t)(s + i - run));
+    json_stream_putc(js, '"');
+}
+
+void json_stream_init(json_stream_t *js, json_stream_flush_fn flush, void *ctx)
+{
+    memset(js, 0, sizeof(*js));
+    js->flush = flush;
+    js->ctx   = ctx;
+    js->err   = (flush != NULL) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+/**
+ * @brief 开始对象或数组
+ */
+static void json_stream_open(json_stream_t *js, char c)
+{
+    json_stream_before_value(js);
+    if (js->depth >= JSON_STREAM_MAX_DEPTH) {
+        js->err = ESP_ERR_INVALID_STATE;
+        return;
+    }
+    json_stream_putc(js, c);
+    js->depth++;
+    js->has_member[js->depth] = false;
+}
+
+/**
+ * @brief 结束对象或数组
+ */
+static void json_stream_close(json_stream_t *js, char c)
+{
+    if (js->depth == 0 || js->after_key) {
+        js->err = ESP_ERR_INVALID_STATE;
+        return;
+    }
+    js->depth--;
+    json_stream_putc(js, c);
+}
+
+void json_stream_begin_object(json_stream_t *js)
+{
+    json_stream_open(js, '{');
+}
+
+void json_stream_end_object(json_stream_t *js)
+{
+    json_stream_close(js, '}');
+}
+
+void json_stream_begin_array(json_stream_t *js)
+{
+    json_stream_open(js, '[');
+}
+
+void json_stream_end_array(json_stream_t *js)
+{
+    json_stream_close(js, ']');
+}
+
+void json_stream_key(json_stream_t *js, const char *key)
+{
+    json_stream_before_value(js);
+    json_stream_put_escaped(js, key, SIZE_MAX);
+    json_stream_putc(js, ':');
+    js->after_key = true;
+}
+
+void json_stream_string(json_stream_t *js, const char *s)
+{
+    json_stream_string_n(js, s, SIZE_MAX);
+}
+
+void json_stream_string_n(json_stream_t *js, const char *s, size_t max_len)
+{
+    if (s == NULL) {
+        json_stream_null(js);
+        return;
+    }
+    json_stream_before_value(js);
+    json_stream_put_escaped(js, s, max_len);
+}
+
+/**
+ * @brief 输出一段格式化后的数值字面量
+ */
+static void json_stream_put_literal(json_stream_t *js, const char *text, int len)
+{
+    json_stream_before_value(js);
+    if (len > 0) {
+        json_stream_put(js, text, (size_t)len);
+    }
+}
+
+void json_stream_int(json_stream_t *js, int64_t v)
+{
+    char num[24];
+    json_stream_put_literal(js, num, snprintf(num, sizeof(num), "%" PRId64, v));
+}
+
+void json_stream_uint(json_stream_t *js, uint64_t v)
+{
+    char num[24];
+    json_stream_put_literal(js, num, snprintf(num, sizeof(num), "%" PRIu64, v));
+}
+
+void json_stream_double(json_stream_t *js, double v)
+{
+    if (!isfinite(v)) {
+        json_stream_null(js);
+        return;
+    }
+    char num[32];
+    json_stream_put_literal(js, num, snprintf(num, sizeof(num), "%.6g", v));
+}
+
+void json_stream_bool(json_stream_t *js, bool v)
+{
+    json_stream_put_literal(js, v ? "true" : "false", v ? 4 : 5);
+}
+
+void json_stream_null(json_stream_t *js)
+{
+    json_stream_put_literal(js, "null", 4);
+}
+
+esp_err_t json_stream_finish(json_stream_t *js)
+{
+    if (js->err == ESP_OK && (js->depth != 0 || js->after_key)) {
+        js->err = ESP_ERR_INVALID_STATE;
+    }
+    json_stream_flush(js);
+    return js->err;
+}
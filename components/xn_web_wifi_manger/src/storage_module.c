@@ -12,9 +12,15 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
 #include "esp_log.h"
+#include "esp_system.h"
 #include "nvs_flash.h"
 
+#include "metrics_registry.h"
 #include "storage_module.h"
 
 /* 本模块日志 TAG */
@@ -24,9 +30,34 @@ static const char *TAG = "wifi_storage";
 static wifi_storage_config_t s_storage_cfg;
 static bool                  s_storage_inited = false;
 
+/*
+ * WiFi 列表的 RAM 缓存是唯一的数据源：读写都只访问缓存，修改后标记脏并设定提交期限，
+ * 由低优先级的提交任务在期限到达时统一写入 NVS。期限内的多次修改合并为一次写入，
+ * 写入前再与上次落盘的内容比较，结果相同（如 A -> B -> A 漫游）则不写。
+ */
+static wifi_config_t   *s_cache          = NULL;   /* 当前列表（max_wifi_num 条） */
+static uint8_t          s_cache_count    = 0;
+static bool             s_cache_loaded   = false;
+static wifi_config_t   *s_flushed        = NULL;   /* 最近一次落盘的列表 */
+static uint8_t          s_flushed_count  = 0;
+static wifi_config_t   *s_flush_buf      = NULL;   /* 提交时的快照，避免持锁写 flash */
+static bool             s_dirty          = false;
+static TickType_t       s_commit_deadline = 0;
+static SemaphoreHandle_t s_cache_lock    = NULL;   /* 保护缓存与脏标记 */
+static SemaphoreHandle_t s_flush_lock    = NULL;   /* 串行化 NVS 写入 */
+static TaskHandle_t     s_commit_task    = NULL;
+static metrics_handle_t s_metric_commits = NULL;
+
 /* NVS 中保存 WiFi 列表使用的 key 名称 */
 static const char *WIFI_LIST_KEY = "wifi_list";
 
+/* 提交任务参数：只做少量 NVS 操作，优先级低于 WiFi 管理任务 */
+#define WIFI_STORAGE_TASK_STACK     3072
+#define WIFI_STORAGE_TASK_PRIORITY  (tskIDLE_PRIORITY + 1)
+
+static const metrics_desc_t s_commit_metric_desc = {
+    "xn_wifi_storage_commits_total", NULL, "WiFi list NVS commits"};
+
 /**
  * @brief 初始化 NVS（供存储模块使用）
  *
@@ -56,6 +87,101 @@ static bool wifi_storage_is_same_ssid(const wifi_config_t *a, const wifi_config_
     return memcmp(a->sta.ssid, b->sta.ssid, sizeof(a->sta.ssid)) == 0;
 }
 
+/**
+ * @brief 判断两条配置是否只有 AP 记录（BSSID / 信道 / 加密方式）不同
+ */
+static bool wifi_storage_is_hint_only_change(const wifi_config_t *a, const wifi_config_t *b)
+{
+    wifi_config_t x = *a;
+    wifi_config_t y = *b;
+    memset(x.sta.bssid, 0, sizeof(x.sta.bssid));
+    memset(y.sta.bssid, 0, sizeof(y.sta.bssid));
+    x.sta.channel            = y.sta.channel            = 0;
+    x.sta.threshold.authmode = y.sta.threshold.authmode = 0;
+    return memcmp(&x, &y, sizeof(x)) == 0;
+}
+
+/**
+ * @brief 标记缓存为脏，并把提交期限提前到 now + delay_ms（已有更早期限时保持不变）
+ *
+ * @note 需持有 s_cache_lock
+ */
+static void wifi_storage_mark_dirty(uint32_t delay_ms)
+{
+    TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(delay_ms);
+    if (!s_dirty || (int32_t)(deadline - s_commit_deadline) < 0) {
+        s_commit_deadline = deadline;
+    }
+    s_dirty = true;
+}
+
+/**
+ * @brief 将列表写入 NVS（空列表时擦除 key）
+ */
+static esp_err_t wifi_storage_write_nvs(const wifi_config_t *list, uint8_t count)
+{
+    nvs_handle_t handle;
+    esp_err_t    ret = nvs_open(s_storage_cfg.nvs_namespace, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "nvs_open(write) failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    if (count == 0) {
+        ret = nvs_erase_key(handle, WIFI_LIST_KEY);
+        if (ret == ESP_ERR_NVS_NOT_FOUND) {
+            ret = ESP_OK;
+        }
+    } else {
+        ret = nvs_set_blob(handle, WIFI_LIST_KEY, list, count * sizeof(wifi_config_t));
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "write wifi list failed: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/**
+ * @brief 提交任务：等待提交期限到达后写入 NVS
+ *
+ * 期间的新修改只会把期限提前（或保持），不会无限推迟；写入失败时按 commit_delay_ms 重试。
+ */
+static void wifi_storage_commit_task(void *arg)
+{
+    (void)arg;
+
+    for (;;) {
+        TickType_t wait = portMAX_DELAY;
+
+        xSemaphoreTake(s_cache_lock, portMAX_DELAY);
+        if (s_dirty) {
+            int32_t remaining = (int32_t)(s_commit_deadline - xTaskGetTickCount());
+            wait = (remaining > 0) ? (TickType_t)remaining : 0;
+        }
+        xSemaphoreGive(s_cache_lock);
+
+        if (wait == 0) {
+            (void)wifi_storage_flush();
+            continue;
+        }
+        /* 有新修改时被唤醒并重新计算期限 */
+        (void)ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+
+/**
+ * @brief 重启前写入尚未提交的修改（esp_restart 关机回调）
+ */
+static void wifi_storage_shutdown_handler(void)
+{
+    (void)wifi_storage_flush();
+}
+
 /**
  * @brief 初始化 WiFi 存储模块
  *
@@ -84,27 +210,50 @@ esp_err_t wifi_storage_init(const wifi_storage_config_t *config)
         return ret;
     }
 
+    /* 缓存、落盘副本、提交快照一次分配 */
+    size_t n = s_storage_cfg.max_wifi_num;
+    s_cache  = (wifi_config_t *)calloc(3 * n, sizeof(wifi_config_t));
+    if (s_cache == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_flushed      = s_cache + n;
+    s_flush_buf    = s_cache + 2 * n;
+    s_cache_count  = 0;
+    s_cache_loaded = false;
+
+    s_cache_lock = xSemaphoreCreateMutex();
+    s_flush_lock = xSemaphoreCreateMutex();
+    if (s_cache_lock == NULL || s_flush_lock == NULL ||
+        xTaskCreate(wifi_storage_commit_task, "wifi_store", WIFI_STORAGE_TASK_STACK, NULL,
+                    WIFI_STORAGE_TASK_PRIORITY, &s_commit_task) != pdPASS) {
+        if (s_cache_lock != NULL) {
+            vSemaphoreDelete(s_cache_lock);
+            s_cache_lock = NULL;
+        }
+        if (s_flush_lock != NULL) {
+            vSemaphoreDelete(s_flush_lock);
+            s_flush_lock = NULL;
+        }
+        free(s_cache);
+        s_cache = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    (void)esp_register_shutdown_handler(wifi_storage_shutdown_handler);
+    (void)metrics_register_counter(&s_commit_metric_desc, &s_metric_commits);
+
     s_storage_inited = true;
     return ESP_OK;
 }
 
 /**
- * @brief 读取所有已保存 WiFi 配置
+ * @brief 从 NVS 读取 WiFi 列表
  *
  * @param configs    外部提供的数组缓冲，长度需 >= max_wifi_num
  * @param count_out  实际读取到的数量（可能小于 max_wifi_num）
- *
- * @note 若当前没有任何配置，返回 ESP_OK 且 *count_out = 0。
  */
-esp_err_t wifi_storage_load_all(wifi_config_t *configs, uint8_t *count_out)
+static esp_err_t wifi_storage_read_nvs(wifi_config_t *configs, uint8_t *count_out)
 {
-    if (!s_storage_inited) {
-        return ESP_ERR_INVALID_STATE;
-    }
-    if (configs == NULL || count_out == NULL) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
     *count_out = 0;
 
     nvs_handle_t handle;
@@ -155,13 +304,65 @@ esp_err_t wifi_storage_load_all(wifi_config_t *configs, uint8_t *count_out)
     return ESP_OK;
 }
 
+/**
+ * @brief 首次访问时从 NVS 建立缓存与落盘副本
+ *
+ * @note 需持有 s_cache_lock
+ */
+static esp_err_t wifi_storage_ensure_loaded(void)
+{
+    if (s_cache_loaded) {
+        return ESP_OK;
+    }
+    esp_err_t ret = wifi_storage_read_nvs(s_cache, &s_cache_count);
+    if (ret != ESP_OK) {
+        s_cache_count = 0;
+        return ret;
+    }
+    memcpy(s_flushed, s_cache, s_cache_count * sizeof(wifi_config_t));
+    s_flushed_count = s_cache_count;
+    s_cache_loaded  = true;
+    return ESP_OK;
+}
+
+/**
+ * @brief 读取所有已保存 WiFi 配置
+ *
+ * @param configs    外部提供的数组缓冲，长度需 >= max_wifi_num
+ * @param count_out  实际读取到的数量（可能小于 max_wifi_num）
+ *
+ * @note 若当前没有任何配置，返回 ESP_OK 且 *count_out = 0。
+ */
+esp_err_t wifi_storage_load_all(wifi_config_t *configs, uint8_t *count_out)
+{
+    if (!s_storage_inited) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (configs == NULL || count_out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(s_cache_lock, portMAX_DELAY);
+    esp_err_t ret = wifi_storage_ensure_loaded();
+    if (ret == ESP_OK) {
+        memcpy(configs, s_cache, s_cache_count * sizeof(wifi_config_t));
+        *count_out = s_cache_count;
+    } else {
+        *count_out = 0;
+    }
+    xSemaphoreGive(s_cache_lock);
+    return ret;
+}
+
 /**
  * @brief 在 STA 成功连接后更新 WiFi 列表
  *
  * 策略：
- * - 若该 SSID 已存在：移动到列表首位（保持其他顺序）；
+ * - 若该 SSID 已存在：替换为新配置并移动到列表首位（保持其他顺序）；
  * - 若不存在且列表未满：插入到首位；
  * - 若不存在且列表已满：插入到首位并丢弃最后一个。
+ *
+ * 只修改 RAM 缓存并安排延迟提交，不在 WiFi 事件路径上写 flash。
  */
 esp_err_t wifi_storage_on_connected(const wifi_config_t *config)
 {
@@ -172,84 +373,51 @@ esp_err_t wifi_storage_on_connected(const wifi_config_t *config)
         return ESP_ERR_INVALID_ARG;
     }
 
-    uint8_t max_num = s_storage_cfg.max_wifi_num;
-    if (max_num == 0) {
-        max_num = 1;
-    }
-
-    /* 分配工作缓冲，用于读写列表 */
-    wifi_config_t *list = (wifi_config_t *)calloc(max_num, sizeof(wifi_config_t));
-    if (list == NULL) {
-        return ESP_ERR_NO_MEM;
-    }
+    /* 只保留 AP 记录，不在存储中锁定 BSSID */
+    wifi_config_t entry = *config;
+    entry.sta.bssid_set = false;
 
-    uint8_t   count = 0;
-    esp_err_t ret   = wifi_storage_load_all(list, &count);
+    xSemaphoreTake(s_cache_lock, portMAX_DELAY);
+    esp_err_t ret = wifi_storage_ensure_loaded();
     if (ret != ESP_OK) {
-        free(list);
+        xSemaphoreGive(s_cache_lock);
         return ret;
     }
 
     /* 查找是否已存在相同 SSID */
     int existing_index = -1;
-    for (uint8_t i = 0; i < count; ++i) {
-        if (wifi_storage_is_same_ssid(&list[i], config)) {
+    for (uint8_t i = 0; i < s_cache_count; ++i) {
+        if (wifi_storage_is_same_ssid(&s_cache[i], &entry)) {
             existing_index = (int)i;
             break;
         }
     }
 
-    if (existing_index >= 0) {
-        /* 已存在：移动到首位 */
-        if (existing_index > 0) {
-            wifi_config_t tmp = list[existing_index];
-            memmove(&list[1], &list[0], existing_index * sizeof(wifi_config_t));
-            list[0] = tmp;
-        }
-    } else {
-        /* 不存在：插入到首位（可能挤掉最后一个） */
-        if (count < max_num) {
-            if (count > 0) {
-                memmove(&list[1], &list[0], count * sizeof(wifi_config_t));
-            }
-            list[0] = *config;
-            count++;
-        } else {
-            if (max_num > 1) {
-                memmove(&list[1], &list[0], (max_num - 1) * sizeof(wifi_config_t));
-            }
-            list[0] = *config;
-            count   = max_num;
-        }
+    /* 重连回同一 AP 时列表不变，无需提交 */
+    if (existing_index == 0 && memcmp(&s_cache[0], &entry, sizeof(entry)) == 0) {
+        xSemaphoreGive(s_cache_lock);
+        return ESP_OK;
     }
 
-    /* 写回 NVS */
-    nvs_handle_t handle;
-    ret = nvs_open(s_storage_cfg.nvs_namespace, NVS_READWRITE, &handle);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "nvs_open(write) failed: %s", esp_err_to_name(ret));
-        free(list);
-        return ret;
-    }
+    /* 同一 SSID 仍在首位、仅 AP 记录变化（漫游）时使用较长的提交期限 */
+    bool hint_only = (existing_index == 0 && wifi_storage_is_hint_only_change(&s_cache[0], &entry));
 
-    size_t blob_size = count * sizeof(wifi_config_t);
-    ret              = nvs_set_blob(handle, WIFI_LIST_KEY, list, blob_size);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "nvs_set_blob(write) failed: %s", esp_err_to_name(ret));
-        nvs_close(handle);
-        free(list);
-        return ret;
+    if (existing_index >= 0) {
+        /* 已存在：以新配置（密码、AP 记录可能变化）替换并移动到首位 */
+        memmove(&s_cache[1], &s_cache[0], existing_index * sizeof(wifi_config_t));
+    } else {
+        /* 不存在：插入到首位（列表已满时挤掉最后一个） */
+        uint8_t keep = (s_cache_count < s_storage_cfg.max_wifi_num) ? s_cache_count
+                                                                    : (uint8_t)(s_storage_cfg.max_wifi_num - 1);
+        memmove(&s_cache[1], &s_cache[0], keep * sizeof(wifi_config_t));
+        s_cache_count = keep + 1;
     }
+    s_cache[0] = entry;
 
-    ret = nvs_commit(handle);
-    nvs_close(handle);
-    free(list);
-
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "nvs_commit(write) failed: %s", esp_err_to_name(ret));
-        return ret;
-    }
+    wifi_storage_mark_dirty(hint_only ? s_storage_cfg.hint_commit_delay_ms : s_storage_cfg.commit_delay_ms);
+    xSemaphoreGive(s_cache_lock);
 
+    xTaskNotifyGive(s_commit_task);
     return ESP_OK;
 }
 
@@ -258,7 +426,7 @@ esp_err_t wifi_storage_on_connected(const wifi_config_t *config)
  *
  * @param ssid  需要删除的 SSID 字符串（以 '\0' 结尾）
  *
- * 若删除后列表为空，则直接擦除 WIFI_LIST_KEY。
+ * 删除是用户的显式操作，立即提交（连同其它尚未提交的修改）；未找到目标时不写 flash。
  */
 esp_err_t wifi_storage_delete_by_ssid(const char *ssid)
 {
@@ -269,83 +437,83 @@ esp_err_t wifi_storage_delete_by_ssid(const char *ssid)
         return ESP_ERR_INVALID_ARG;
     }
 
-    uint8_t max_num = s_storage_cfg.max_wifi_num;
-    if (max_num == 0) {
-        max_num = 1;
-    }
-
-    wifi_config_t *list = (wifi_config_t *)calloc(max_num, sizeof(wifi_config_t));
-    if (list == NULL) {
-        return ESP_ERR_NO_MEM;
-    }
-
-    uint8_t   count = 0;
-    esp_err_t ret   = wifi_storage_load_all(list, &count);
-    if (ret != ESP_OK) {
-        free(list);
-        return ret;
-    }
-
-    if (count == 0) {
-        free(list);
-        return ESP_OK;
-    }
-
     /* 构造一个只设置 SSID 的临时配置，复用比较函数 */
     wifi_config_t target;
     memset(&target, 0, sizeof(target));
     strncpy((char *)target.sta.ssid, ssid, sizeof(target.sta.ssid) - 1);
 
+    xSemaphoreTake(s_cache_lock, portMAX_DELAY);
+    esp_err_t ret = wifi_storage_ensure_loaded();
+    if (ret != ESP_OK) {
+        xSemaphoreGive(s_cache_lock);
+        return ret;
+    }
+
     /* 过滤出保留的条目 */
     uint8_t write_idx = 0;
-    for (uint8_t i = 0; i < count; ++i) {
-        if (wifi_storage_is_same_ssid(&list[i], &target)) {
+    for (uint8_t i = 0; i < s_cache_count; ++i) {
+        if (wifi_storage_is_same_ssid(&s_cache[i], &target)) {
             /* 跳过待删除条目 */
             continue;
         }
         if (write_idx != i) {
-            list[write_idx] = list[i];
+            s_cache[write_idx] = s_cache[i];
         }
         write_idx++;
     }
 
-    nvs_handle_t handle;
-    ret = nvs_open(s_storage_cfg.nvs_namespace, NVS_READWRITE, &handle);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "nvs_open(delete) failed: %s", esp_err_to_name(ret));
-        free(list);
-        return ret;
+    bool removed = (write_idx != s_cache_count);
+    if (removed) {
+        s_cache_count = write_idx;
+        wifi_storage_mark_dirty(0);
     }
+    xSemaphoreGive(s_cache_lock);
 
-    if (write_idx == 0) {
-        /* 已无任何配置：擦除 key */
-        ret = nvs_erase_key(handle, WIFI_LIST_KEY);
-        if (ret != ESP_OK && ret != ESP_ERR_NVS_NOT_FOUND) {
-            ESP_LOGE(TAG, "nvs_erase_key failed: %s", esp_err_to_name(ret));
-            nvs_close(handle);
-            free(list);
-            return ret;
-        }
-    } else {
-        /* 仍有剩余配置：回写精简后的列表 */
-        size_t blob_size = write_idx * sizeof(wifi_config_t);
-        ret              = nvs_set_blob(handle, WIFI_LIST_KEY, list, blob_size);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "nvs_set_blob(delete) failed: %s", esp_err_to_name(ret));
-            nvs_close(handle);
-            free(list);
-            return ret;
-        }
+    return removed ? wifi_storage_flush() : ESP_OK;
+}
+
+/**
+ * @brief 立即提交尚未写入 NVS 的修改
+ *
+ * 在调用者任务中完成写入。快照在持锁时拷贝，写 flash 期间不阻塞缓存读写；
+ * 与上次落盘内容相同时不访问 NVS。
+ */
+esp_err_t wifi_storage_flush(void)
+{
+    if (!s_storage_inited) {
+        return ESP_ERR_INVALID_STATE;
     }
 
-    ret = nvs_commit(handle);
-    nvs_close(handle);
-    free(list);
+    xSemaphoreTake(s_flush_lock, portMAX_DELAY);
 
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "nvs_commit(delete) failed: %s", esp_err_to_name(ret));
-        return ret;
+    xSemaphoreTake(s_cache_lock, portMAX_DELAY);
+    if (!s_dirty) {
+        xSemaphoreGive(s_cache_lock);
+        xSemaphoreGive(s_flush_lock);
+        return ESP_OK;
+    }
+    uint8_t count = s_cache_count;
+    memcpy(s_flush_buf, s_cache, count * sizeof(wifi_config_t));
+    s_dirty = false;
+    xSemaphoreGive(s_cache_lock);
+
+    esp_err_t ret = ESP_OK;
+    if (count != s_flushed_count || memcmp(s_flush_buf, s_flushed, count * sizeof(wifi_config_t)) != 0) {
+        ret = wifi_storage_write_nvs(s_flush_buf, count);
+        if (ret == ESP_OK) {
+            memcpy(s_flushed, s_flush_buf, count * sizeof(wifi_config_t));
+            s_flushed_count = count;
+            metrics_counter_inc(s_metric_commits);
+        } else {
+            /* 写入失败：保留脏标记，唤醒提交任务按新期限重试
+             * （删除等路径在调用者任务中提交，提交任务此时可能在无限期等待） */
+            xSemaphoreTake(s_cache_lock, portMAX_DELAY);
+            wifi_storage_mark_dirty(s_storage_cfg.commit_delay_ms);
+            xSemaphoreGive(s_cache_lock);
+            xTaskNotifyGive(s_commit_task);
+        }
     }
 
-    return ESP_OK;
+    xSemaphoreGive(s_flush_lock);
+    return ret;
 }
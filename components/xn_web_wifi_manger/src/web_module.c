@@ -4,24 +4,31 @@
  * @LastEditors: xingnian jixingnian@gmail.com
  * @LastEditTime: 2025-11-23 11:39:20
  * @FilePath: \xn_web_wifi_config\components\xn_web_wifi_manger\src\web_module.c
- * @Description: Web 配网模块实现（HTTP 服务器 + SPIFFS 静态资源）
+ * @Description: Web 配网模块实现（HTTP 服务器 + 内嵌静态资源）
  *
  * 仅负责：
- *  - 挂载 SPIFFS 分区并暴露静态网页资源；
- *  - 根据回调提供简单的状态查询接口；
+ *  - 暴露构建时压缩内嵌的静态网页资源（见 web_assets.h）；
+ *  - 根据回调提供简单的状态查询接口（JSON 经 json_stream 流式分块输出）；
+ *  - /api/metrics 导出 xn_metrics 注册表中的运行指标；
+ *  - /api/trace 控制 xn_metrics 时间线追踪并导出 Chrome trace JSON；
  *
  * 不直接依赖 WiFi / 存储模块，由上层通过回调注入所需能力。
  */
 
+#include <inttypes.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
 #include "esp_log.h"
-#include "esp_spiffs.h"
 #include "esp_http_server.h"
 
 #include "web_module.h"
+#include "web_assets.h"
+#include "json_stream.h"
+#include "metrics_registry.h"
+#include "metrics_trace.h"
 
 /* 日志 TAG */
 static const char *TAG = "web_module";
@@ -31,104 +38,130 @@ static bool               s_web_inited = false;
 static web_module_config_t s_web_cfg;        /* 保存一份配置副本 */
 static httpd_handle_t      s_http_server = NULL;
 
-/* -------------------- SPIFFS 挂载辅助 -------------------- */
+/* -------------------- 静态资源响应辅助 -------------------- */
 
 /**
- * @brief 挂载存放网页资源的 SPIFFS 分区
+ * @brief 检查请求头中是否包含指定 token（逗号分隔列表，如 Accept-Encoding / If-None-Match）
  *
- * 分区在 partitions.csv 中命名为 "wifi_spiffs"：
- * - base_path:  "/spiffs"（HTTP 处理函数按此路径访问文件）
- * - max_files:  4（当前仅三个静态文件，预留 1 个）
+ * @param req   HTTP 请求对象
+ * @param field 请求头名称
+ * @param token 需要查找的值
  */
-static esp_err_t web_module_mount_spiffs(void)
+static bool web_module_header_has_token(httpd_req_t *req, const char *field, const char *token)
 {
-    esp_vfs_spiffs_conf_t conf = {
-        .base_path              = "/spiffs",
-        .partition_label        = "wifi_spiffs",
-        .max_files              = 4,
-        .format_if_mount_failed = true,
-    };
+    char value[128];
+    if (httpd_req_get_hdr_value_str(req, field, value, sizeof(value)) != ESP_OK) {
+        return false;
+    }
+    return strstr(value, token) != NULL || strcmp(value, "*") == 0;
+}
 
-    esp_err_t ret = esp_vfs_spiffs_register(&conf);
+/**
+ * @brief 发送一个内嵌静态资源
+ *
+ * - 客户端支持 gzip 时直接发送预压缩数据（Content-Encoding: gzip）；
+ * - If-None-Match 命中当前编码的 ETag 时仅返回 304；
+ * - 数据位于 flash 只读段，一次 httpd_resp_send 带 Content-Length 发出，无分块拷贝。
+ */
+static esp_err_t web_module_asset_get_handler(httpd_req_t *req)
+{
+    const web_asset_t *asset = (const web_asset_t *)req->user_ctx;
 
-    if (ret == ESP_ERR_INVALID_STATE) {
-        /* 已经挂载，直接视为成功 */
-        return ESP_OK;
-    }
+    bool        use_gzip = web_module_header_has_token(req, "Accept-Encoding", "gzip");
+    const char *etag     = use_gzip ? asset->etag_gzip : asset->etag_identity;
 
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "spiffs register failed: %s", esp_err_to_name(ret));
+    httpd_resp_set_type(req, asset->content_type);
+    httpd_resp_set_hdr(req, "Cache-Control", asset->cache_control);
+    httpd_resp_set_hdr(req, "ETag", etag);
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+
+    if (web_module_header_has_token(req, "If-None-Match", etag)) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
     }
 
-    return ret;
+    if (use_gzip) {
+        httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+        return httpd_resp_send(req, (const char *)asset->gzip, (ssize_t)asset->gzip_size);
+    }
+    return httpd_resp_send(req, (const char *)asset->identity, (ssize_t)asset->identity_size);
 }
 
-/* -------------------- 静态文件响应辅助 -------------------- */
+/* -------------------- JSON 响应辅助 -------------------- */
+
+/*
+ * httpd 在单个服务器任务中串行执行所有处理函数，回调结果缓存可以在请求间复用，
+ * 不必每个请求重新分配。
+ */
+static web_saved_wifi_info_t s_saved_items[WEB_MODULE_MAX_SAVED_ITEMS];
+static web_scan_result_t     s_scan_items[WEB_MODULE_MAX_SCAN_ITEMS];
 
 /**
- * @brief 以分块响应的方式发送一个静态文件
- *
- * @param req          HTTP 请求对象
- * @param file_path    文件在 SPIFFS 上的完整路径（如 "/spiffs/index.html"）
- * @param content_type Content-Type 头部值
+ * @brief json_stream 输出回调：每个暂存块作为一个 HTTP chunk 发出
  */
-static esp_err_t web_module_serve_file(httpd_req_t *req,
-                                       const char  *file_path,
-                                       const char  *content_type)
+static esp_err_t web_module_json_flush(void *ctx, const char *data, size_t len)
 {
-    FILE *f = fopen(file_path, "r");
-    if (f == NULL) {
-        ESP_LOGE(TAG, "open file failed: %s", file_path);
-        httpd_resp_send_err(req,
-                            HTTPD_500_INTERNAL_SERVER_ERROR,
-                            "open file failed");
-        return ESP_FAIL;
-    }
+    return httpd_resp_send_chunk((httpd_req_t *)ctx, data, (ssize_t)len);
+}
 
-    httpd_resp_set_type(req, content_type);
+/**
+ * @brief 开始一个 JSON 响应（设置响应头并初始化写入器）
+ */
+static void web_module_json_begin(httpd_req_t *req, json_stream_t *js)
+{
+    httpd_resp_set_type(req, "application/json");
     httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
-
-    char  buf[512];
-    size_t n;
-    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
-        if (httpd_resp_send_chunk(req, buf, n) != ESP_OK) {
-            fclose(f);
-            httpd_resp_sendstr_chunk(req, NULL); /* 结束分块 */
-            return ESP_FAIL;
-        }
-    }
-
-    fclose(f);
-    httpd_resp_send_chunk(req, NULL, 0); /* 告知响应结束 */
-    return ESP_OK;
+    json_stream_init(js, web_module_json_flush, req);
 }
 
-/* -------------------- 具体 URI 处理函数 -------------------- */
-
 /**
- * @brief 根路径与 /index.html：返回主页面
+ * @brief 结束 JSON 响应：输出剩余数据并发送结束 chunk
+ *
+ * 响应头已随第一个 chunk 发出，中途出错只能中断连接，这里仅记录日志。
  */
-static esp_err_t web_module_root_get_handler(httpd_req_t *req)
+static esp_err_t web_module_json_end(httpd_req_t *req, json_stream_t *js)
 {
-    return web_module_serve_file(req, "/spiffs/index.html", "text/html");
+    esp_err_t ret = json_stream_finish(js);
+    if (ret == ESP_OK) {
+        ret = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "send json failed: %s", esp_err_to_name(ret));
+    }
+    return ret;
 }
 
 /**
- * @brief app.css：页面样式
+ * @brief 发送 {"items":[]} 空列表
  */
-static esp_err_t web_module_css_get_handler(httpd_req_t *req)
+static esp_err_t web_module_send_empty_list(httpd_req_t *req)
 {
-    return web_module_serve_file(req, "/spiffs/app.css", "text/css");
+    json_stream_t js;
+    web_module_json_begin(req, &js);
+    json_stream_begin_object(&js);
+    json_stream_key(&js, "items");
+    json_stream_begin_array(&js);
+    json_stream_end_array(&js);
+    json_stream_end_object(&js);
+    return web_module_json_end(req, &js);
 }
 
 /**
- * @brief app.js：前端脚本
+ * @brief 发送 {"ok":true}
  */
-static esp_err_t web_module_js_get_handler(httpd_req_t *req)
+static esp_err_t web_module_send_ok(httpd_req_t *req)
 {
-    return web_module_serve_file(req, "/spiffs/app.js", "application/javascript");
+    json_stream_t js;
+    web_module_json_begin(req, &js);
+    json_stream_begin_object(&js);
+    json_stream_key(&js, "ok");
+    json_stream_bool(&js, true);
+    json_stream_end_object(&js);
+    return web_module_json_end(req, &js);
 }
 
+/* -------------------- 具体 URI 处理函数 -------------------- */
+
 /**
  * @brief /api/wifi/status：查询当前 WiFi 状态（可选）
  *
@@ -137,7 +170,6 @@ static esp_err_t web_module_js_get_handler(httpd_req_t *req)
 static esp_err_t web_module_status_get_handler(httpd_req_t *req)
 {
     web_wifi_status_t status = {0};
-    char              json[192];
 
     if (s_web_cfg.get_status_cb) {
         if (s_web_cfg.get_status_cb(&status) != ESP_OK) {
@@ -159,30 +191,23 @@ static esp_err_t web_module_status_get_handler(httpd_req_t *req)
         status.mode[sizeof(status.mode) - 1] = '\0';
     }
 
-    /* 简单 JSON 序列化：假定 SSID/IP/mode 不包含引号等特殊字符 */
-    int len = snprintf(json,
-                       sizeof(json),
-                       "{\"connected\":%s,\"state\":%d,\"ssid\":\"%s\",\"ip\":\"%s\",\"rssi\":%d,\"mode\":\"%s\"}",
-                       status.connected ? "true" : "false",
-                       (int)status.state,
-                       status.ssid,
-                       status.ip,
-                       (int)status.rssi,
-                       status.mode);
-
-    if (len < 0) {
-        httpd_resp_send_err(req,
-                            HTTPD_500_INTERNAL_SERVER_ERROR,
-                            "format json failed");
-        return ESP_OK;
-    }
-    if (len >= (int)sizeof(json)) {
-        len = (int)sizeof(json) - 1;
-    }
-
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
-    httpd_resp_send(req, json, len);
+    json_stream_t js;
+    web_module_json_begin(req, &js);
+    json_stream_begin_object(&js);
+    json_stream_key(&js, "connected");
+    json_stream_bool(&js, status.connected);
+    json_stream_key(&js, "state");
+    json_stream_int(&js, (int)status.state);
+    json_stream_key(&js, "ssid");
+    json_stream_string_n(&js, status.ssid, sizeof(status.ssid));
+    json_stream_key(&js, "ip");
+    json_stream_string_n(&js, status.ip, sizeof(status.ip));
+    json_stream_key(&js, "rssi");
+    json_stream_int(&js, status.rssi);
+    json_stream_key(&js, "mode");
+    json_stream_string_n(&js, status.mode, sizeof(status.mode));
+    json_stream_end_object(&js);
+    web_module_json_end(req, &js);
     return ESP_OK;
 }
 
@@ -191,82 +216,41 @@ static esp_err_t web_module_status_get_handler(httpd_req_t *req)
  */
 static esp_err_t web_module_saved_get_handler(httpd_req_t *req)
 {
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
-
     /* 未提供回调时返回空列表，方便前端统一处理 */
     if (s_web_cfg.get_saved_list_cb == NULL) {
-        static const char *EMPTY_JSON = "{\"items\":[]}";
-        httpd_resp_send(req, EMPTY_JSON, strlen(EMPTY_JSON));
+        web_module_send_empty_list(req);
         return ESP_OK;
     }
 
-    /* 第一次调用仅查询需要的条目数量，避免多余的堆分配 */
-    size_t    cnt = 0;
-    esp_err_t ret = s_web_cfg.get_saved_list_cb(NULL, &cnt);
+    size_t    cnt = WEB_MODULE_MAX_SAVED_ITEMS;
+    esp_err_t ret = s_web_cfg.get_saved_list_cb(s_saved_items, &cnt);
     if (ret != ESP_OK) {
         httpd_resp_send_err(req,
                             HTTPD_500_INTERNAL_SERVER_ERROR,
                             "load saved wifi failed");
         return ESP_OK;
     }
-
-    if (cnt == 0) {
-        static const char *EMPTY_JSON = "{\"items\":[]}";
-        httpd_resp_send(req, EMPTY_JSON, strlen(EMPTY_JSON));
-        return ESP_OK;
-    }
-
-    web_saved_wifi_info_t *list = (web_saved_wifi_info_t *)malloc(cnt * sizeof(web_saved_wifi_info_t));
-    if (list == NULL) {
-        httpd_resp_send_err(req,
-                            HTTPD_500_INTERNAL_SERVER_ERROR,
-                            "no memory");
-        return ESP_OK;
-    }
-
-    size_t cap = cnt;
-    ret        = s_web_cfg.get_saved_list_cb(list, &cap);
-    if (ret != ESP_OK) {
-        free(list);
-        httpd_resp_send_err(req,
-                            HTTPD_500_INTERNAL_SERVER_ERROR,
-                            "load saved wifi failed");
-        return ESP_OK;
-    }
-
-    if (cap > cnt) {
-        cap = cnt;
-    }
-
-    /* 序列化为形如 {"items":[{"index":0,"ssid":"xxx"}, ...]} 的 JSON */
-    char  json[512];
-    size_t offset = 0;
-
-    offset += (size_t)snprintf(json + offset, sizeof(json) - offset, "{\"items\":[");
-
-    for (size_t i = 0; i < cap && offset < sizeof(json); i++) {
-        const char *comma = (i == 0) ? "" : ",";
-        offset += (size_t)snprintf(json + offset,
-                                   sizeof(json) - offset,
-                                   "%s{\"index\":%u,\"ssid\":\"%s\"}",
-                                   comma,
-                                   (unsigned)i,
-                                   list[i].ssid);
-    }
-
-    free(list);
-
-    if (offset >= sizeof(json)) {
-        /* 理论上不会超出，若超出则截断为一个空列表作为兜底 */
-        const char *FALLBACK = "{\"items\":[]}";
-        httpd_resp_send(req, FALLBACK, strlen(FALLBACK));
-        return ESP_OK;
-    }
-
-    offset += (size_t)snprintf(json + offset, sizeof(json) - offset, "]}");
-
-    httpd_resp_send(req, json, (int)offset);
+    if (cnt > WEB_MODULE_MAX_SAVED_ITEMS) {
+        cnt = WEB_MODULE_MAX_SAVED_ITEMS;
+    }
+
+    /* 形如 {"items":[{"index":0,"ssid":"xxx"}, ...]}，边序列化边分块发送 */
+    json_stream_t js;
+    web_module_json_begin(req, &js);
+    json_stream_begin_object(&js);
+    json_stream_key(&js, "items");
+    json_stream_begin_array(&js);
+    for (size_t i = 0; i < cnt; i++) {
+        json_stream_begin_object(&js);
+        json_stream_key(&js, "index");
+        json_stream_uint(&js, i);
+        json_stream_key(&js, "ssid");
+        json_stream_string_n(&js, s_saved_items[i].ssid, sizeof(s_saved_items[i].ssid));
+        json_stream_end_object(&js);
+    }
+    json_stream_end_array(&js);
+    json_stream_end_object(&js);
+    web_module_json_end(req, &js);
     return ESP_OK;
 }
 
@@ -275,85 +259,43 @@ static esp_err_t web_module_saved_get_handler(httpd_req_t *req)
  */
 static esp_err_t web_module_scan_get_handler(httpd_req_t *req)
 {
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
-
     /* 未提供回调时返回空列表，方便前端统一处理 */
     if (s_web_cfg.scan_cb == NULL) {
-        static const char *EMPTY_JSON = "{\"items\":[]}";
-        httpd_resp_send(req, EMPTY_JSON, strlen(EMPTY_JSON));
-        return ESP_OK;
-    }
-
-    /* 使用堆缓冲区承载扫描结果，具体数量由回调实现控制 */
-    enum { WEB_MAX_SCAN_RESULT = 32 };
-    web_scan_result_t *list = (web_scan_result_t *)malloc(WEB_MAX_SCAN_RESULT * sizeof(web_scan_result_t));
-    if (list == NULL) {
-        httpd_resp_send_err(req,
-                            HTTPD_500_INTERNAL_SERVER_ERROR,
-                            "no memory");
+        web_module_send_empty_list(req);
         return ESP_OK;
     }
 
-    size_t    cnt = WEB_MAX_SCAN_RESULT;
-    esp_err_t ret = s_web_cfg.scan_cb(list, &cnt);
+    size_t    cnt = WEB_MODULE_MAX_SCAN_ITEMS;
+    esp_err_t ret = s_web_cfg.scan_cb(s_scan_items, &cnt);
     if (ret != ESP_OK) {
         httpd_resp_send_err(req,
                             HTTPD_500_INTERNAL_SERVER_ERROR,
                             "scan failed");
-        free(list);
-        return ESP_OK;
-    }
-
-    if (cnt == 0) {
-        static const char *EMPTY_JSON = "{\"items\":[]}";
-        httpd_resp_send(req, EMPTY_JSON, strlen(EMPTY_JSON));
-        free(list);
-        return ESP_OK;
-    }
-
-    /* 序列化为形如 {"items":[{"index":0,"ssid":"xxx","rssi":-60}, ...]} 的 JSON
-     * 最多 32 条结果，每条包括 SSID 与 RSSI。为避免占用过多栈空间，
-     * 这里改为在堆上分配缓冲区。 */
-    const size_t json_buf_size = 3072; /* 足够容纳 32 条典型记录 */
-    char        *json          = (char *)malloc(json_buf_size);
-    if (json == NULL) {
-        httpd_resp_send_err(req,
-                            HTTPD_500_INTERNAL_SERVER_ERROR,
-                            "no memory");
-        free(list);
-        return ESP_OK;
-    }
-
-    size_t offset = 0;
-
-    offset += (size_t)snprintf(json + offset, json_buf_size - offset, "{\"items\":[");
-
-    for (size_t i = 0; i < cnt && offset < json_buf_size; i++) {
-        const char *comma = (i == 0) ? "" : ",";
-        offset += (size_t)snprintf(json + offset,
-                                   json_buf_size - offset,
-                                   "%s{\"index\":%u,\"ssid\":\"%s\",\"rssi\":%d}",
-                                   comma,
-                                   (unsigned)i,
-                                   list[i].ssid,
-                                   (int)list[i].rssi);
-    }
-
-    if (offset >= json_buf_size) {
-        /* 理论上不会超出，若超出则截断为一个空列表作为兜底 */
-        const char *FALLBACK = "{\"items\":[]}";
-        httpd_resp_send(req, FALLBACK, strlen(FALLBACK));
-        free(list);
-        free(json);
         return ESP_OK;
     }
-
-    offset += (size_t)snprintf(json + offset, json_buf_size - offset, "]}");
-
-    httpd_resp_send(req, json, (int)offset);
-    free(json);
-    free(list);
+    if (cnt > WEB_MODULE_MAX_SCAN_ITEMS) {
+        cnt = WEB_MODULE_MAX_SCAN_ITEMS;
+    }
+
+    /* 形如 {"items":[{"index":0,"ssid":"xxx","rssi":-60}, ...]}，边序列化边分块发送 */
+    json_stream_t js;
+    web_module_json_begin(req, &js);
+    json_stream_begin_object(&js);
+    json_stream_key(&js, "items");
+    json_stream_begin_array(&js);
+    for (size_t i = 0; i < cnt; i++) {
+        json_stream_begin_object(&js);
+        json_stream_key(&js, "index");
+        json_stream_uint(&js, i);
+        json_stream_key(&js, "ssid");
+        json_stream_string_n(&js, s_scan_items[i].ssid, sizeof(s_scan_items[i].ssid));
+        json_stream_key(&js, "rssi");
+        json_stream_int(&js, s_scan_items[i].rssi);
+        json_stream_end_object(&js);
+    }
+    json_stream_end_array(&js);
+    json_stream_end_object(&js);
+    web_module_json_end(req, &js);
     return ESP_OK;
 }
 
@@ -397,8 +339,7 @@ static esp_err_t web_module_connect_handler(httpd_req_t *req)
         return ESP_OK;
     }
 
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, "{\"ok\":true}", strlen("{\"ok\":true}"));
+    web_module_send_ok(req);
     return ESP_OK;
 }
 
@@ -434,8 +375,7 @@ static esp_err_t web_module_saved_delete_handler(httpd_req_t *req)
         return ESP_OK;
     }
 
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, "{\"ok\":true}", strlen("{\"ok\":true}"));
+    web_module_send_ok(req);
     return ESP_OK;
 }
 
@@ -474,8 +414,262 @@ static esp_err_t web_module_saved_connect_handler(httpd_req_t *req)
         return ESP_OK;
     }
 
+    web_module_send_ok(req);
+    return ESP_OK;
+}
+
+/* -------------------- 指标导出 -------------------- */
+
+/**
+ * @brief 纯文本分块输出缓冲（Prometheus 文本格式）
+ */
+typedef struct {
+    httpd_req_t *req;        ///< HTTP 请求
+    char         buf[512];   ///< 暂存缓冲区，写满后作为一个 chunk 发出
+    size_t       len;        ///< 暂存数据长度
+    esp_err_t    err;        ///< 首个发送错误
+} web_text_stream_t;
+
+static void web_text_flush(web_text_stream_t *ts)
+{
+    if (ts->len > 0 && ts->err == ESP_OK) {
+        ts->err = httpd_resp_send_chunk(ts->req, ts->buf, (ssize_t)ts->len);
+    }
+    ts->len = 0;
+}
+
+/**
+ * @brief 追加一行格式化文本，放不下时先发出已有内容（单行超过缓冲区时截断）
+ */
+static void web_text_printf(web_text_stream_t *ts, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static void web_text_printf(web_text_stream_t *ts, const char *fmt, ...)
+{
+    if (ts->err != ESP_OK) {
+        return;
+    }
+    for (int attempt = 0; attempt < 2; attempt++) {
+        size_t  room = sizeof(ts->buf) - ts->len;
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(ts->buf + ts->len, room, fmt, ap);
+        va_end(ap);
+        if (n < 0) {
+            return;
+        }
+        if ((size_t)n < room) {
+            ts->len += (size_t)n;
+            return;
+        }
+        if (ts->len == 0) {
+            ts->len = sizeof(ts->buf) - 1;
+            return;
+        }
+        web_text_flush(ts);
+    }
+}
+
+static const char *web_module_metric_type_str(metrics_type_t type)
+{
+    switch (type) {
+    case METRICS_TYPE_COUNTER:
+        return "counter";
+    case METRICS_TYPE_GAUGE:
+        return "gauge";
+    default:
+        return "histogram";
+    }
+}
+
+/**
+ * @brief 以 Prometheus 文本格式输出一个指标
+ */
+static void web_module_metrics_prom_visit(const metrics_sample_t *sample, void *ctx)
+{
+    web_text_stream_t *ts     = (web_text_stream_t *)ctx;
+    const char        *name   = sample->desc->name;
+    const char        *labels = sample->desc->labels ? sample->desc->labels : "";
+    const char        *open   = labels[0] ? "{" : "";
+    const char        *close  = labels[0] ? "}" : "";
+
+    if (sample->first_of_family) {
+        if (sample->desc->help) {
+            web_text_printf(ts, "# HELP %s %s\n", name, sample->desc->help);
+        }
+        web_text_printf(ts, "# TYPE %s %s\n", name, web_module_metric_type_str(sample->type));
+    }
+
+    if (sample->type != METRICS_TYPE_HISTOGRAM) {
+        web_text_printf(ts, "%s%s%s%s %" PRId64 "\n", name, open, labels, close, sample->value);
+        return;
+    }
+
+    const char *sep = labels[0] ? "," : "";
+    for (size_t i = 0; i < sample->bound_count; i++) {
+        web_text_printf(ts, "%s_bucket{%s%sle=\"%" PRId32 "\"} %" PRIu32 "\n",
+                        name, labels, sep, sample->bounds[i], sample->buckets[i]);
+    }
+    web_text_printf(ts, "%s_bucket{%s%sle=\"+Inf\"} %" PRIu32 "\n",
+                    name, labels, sep, sample->buckets[sample->bound_count]);
+    web_text_printf(ts, "%s_sum%s%s%s %" PRId64 "\n", name, open, labels, close, sample->sum);
+    web_text_printf(ts, "%s_count%s%s%s %" PRIu64 "\n", name, open, labels, close, sample->count);
+}
+
+/**
+ * @brief 把 k="v",k2="v2" 形式的标签串输出为 JSON 对象
+ */
+static void web_module_metrics_json_labels(json_stream_t *js, const char *labels)
+{
+    json_stream_begin_object(js);
+    const char *p = labels;
+    while (p != NULL && *p != '\0') {
+        const char *eq = strchr(p, '=');
+        if (eq == NULL || eq[1] != '"') {
+            break;
+        }
+        const char *end = strchr(eq + 2, '"');
+        if (end == NULL) {
+            break;
+        }
+
+        char   key[32];
+        size_t key_len = (size_t)(eq - p);
+        if (key_len >= sizeof(key)) {
+            key_len = sizeof(key) - 1;
+        }
+        memcpy(key, p, key_len);
+        key[key_len] = '\0';
+        json_stream_key(js, key);
+        json_stream_string_n(js, eq + 2, (size_t)(end - eq - 2));
+
+        p = (end[1] == ',') ? end + 2 : end + 1;
+    }
+    json_stream_end_object(js);
+}
+
+/**
+ * @brief 以 JSON 输出一个指标
+ */
+static void web_module_metrics_json_visit(const metrics_sample_t *sample, void *ctx)
+{
+    json_stream_t *js = (json_stream_t *)ctx;
+
+    json_stream_begin_object(js);
+    json_stream_key(js, "name");
+    json_stream_string(js, sample->desc->name);
+    json_stream_key(js, "labels");
+    web_module_metrics_json_labels(js, sample->desc->labels);
+    json_stream_key(js, "type");
+    json_stream_string(js, web_module_metric_type_str(sample->type));
+
+    if (sample->type != METRICS_TYPE_HISTOGRAM) {
+        json_stream_key(js, "value");
+        json_stream_int(js, sample->value);
+    } else {
+        json_stream_key(js, "sum");
+        json_stream_int(js, sample->sum);
+        json_stream_key(js, "count");
+        json_stream_uint(js, sample->count);
+        json_stream_key(js, "buckets");
+        json_stream_begin_array(js);
+        for (size_t i = 0; i <= sample->bound_count; i++) {
+            json_stream_begin_object(js);
+            json_stream_key(js, "le");
+            if (i < sample->bound_count) {
+                json_stream_int(js, sample->bounds[i]);
+            } else {
+                json_stream_string(js, "+Inf");
+            }
+            json_stream_key(js, "count");
+            json_stream_uint(js, sample->buckets[i]);
+            json_stream_end_object(js);
+        }
+        json_stream_end_array(js);
+    }
+    json_stream_end_object(js);
+}
+
+/**
+ * @brief /api/metrics：导出指标注册表
+ *
+ * 默认 Prometheus 文本格式；?format=json 或 Accept 含 application/json 时输出 JSON。
+ * 指标在遍历时即时读取并分块发送，采集开销只在请求时产生。
+ */
+static esp_err_t web_module_metrics_get_handler(httpd_req_t *req)
+{
+    bool json = web_module_header_has_token(req, "Accept", "application/json");
+    char query[32];
+    char format[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "format", format, sizeof(format)) == ESP_OK) {
+        json = (strcmp(format, "json") == 0);
+    }
+
+    if (json) {
+        json_stream_t js;
+        web_module_json_begin(req, &js);
+        json_stream_begin_object(&js);
+        json_stream_key(&js, "metrics");
+        json_stream_begin_array(&js);
+        metrics_foreach(web_module_metrics_json_visit, &js);
+        json_stream_end_array(&js);
+        json_stream_end_object(&js);
+        web_module_json_end(req, &js);
+        return ESP_OK;
+    }
+
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+    web_text_stream_t ts = {.req = req, .len = 0, .err = ESP_OK};
+    metrics_foreach(web_module_metrics_prom_visit, &ts);
+    web_text_flush(&ts);
+    if (ts.err == ESP_OK) {
+        ts.err = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    if (ts.err != ESP_OK) {
+        ESP_LOGW(TAG, "send metrics failed: %s", esp_err_to_name(ts.err));
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief GET /api/trace：导出时间线（Chrome trace JSON，可直接拖入 chrome://tracing / ui.perfetto.dev）
+ */
+static esp_err_t web_module_trace_get_handler(httpd_req_t *req)
+{
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, "{\"ok\":true}", strlen("{\"ok\":true}"));
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"trace.json\"");
+
+    esp_err_t ret = metrics_trace_dump(web_module_json_flush, req);
+    if (ret == ESP_OK) {
+        ret = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "send trace failed: %s", esp_err_to_name(ret));
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief POST /api/trace?enable=1|0：清空并开始记录 / 停止记录
+ */
+static esp_err_t web_module_trace_post_handler(httpd_req_t *req)
+{
+    char query[32];
+    char enable[4];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        httpd_query_key_value(query, "enable", enable, sizeof(enable)) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "missing enable");
+        return ESP_OK;
+    }
+
+    if (strcmp(enable, "1") == 0) {
+        metrics_trace_start();
+    } else {
+        metrics_trace_stop();
+    }
+    web_module_send_ok(req);
     return ESP_OK;
 }
 
@@ -489,7 +683,7 @@ static esp_err_t web_module_start_server(void)
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
 
     /* 默认 max_uri_handlers 较小，这里适当调大以容纳所有静态资源与 API */
-    config.max_uri_handlers = 12;
+    config.max_uri_handlers = 14;
 
     if (s_web_cfg.http_port > 0) {
         config.server_port = (uint16_t)s_web_cfg.http_port;
@@ -509,39 +703,23 @@ static esp_err_t web_module_start_server(void)
         return ret;
     }
 
-    /* 静态文件路由：根路径与 /index.html 指向同一处理函数 */
-    static const httpd_uri_t uri_root = {
-        .uri      = "/",
-        .method   = HTTP_GET,
-        .handler  = web_module_root_get_handler,
-        .user_ctx = NULL,
-    };
-
-    static const httpd_uri_t uri_index = {
-        .uri      = "/index.html",
-        .method   = HTTP_GET,
-        .handler  = web_module_root_get_handler,
-        .user_ctx = NULL,
-    };
-
-    static const httpd_uri_t uri_css = {
-        .uri      = "/app.css",
-        .method   = HTTP_GET,
-        .handler  = web_module_css_get_handler,
-        .user_ctx = NULL,
-    };
-
-    static const httpd_uri_t uri_js = {
-        .uri      = "/app.js",
-        .method   = HTTP_GET,
-        .handler  = web_module_js_get_handler,
-        .user_ctx = NULL,
-    };
+    /* 静态资源路由：每个内嵌资源一条，根路径额外指向 /index.html
+     * （httpd_register_uri_handler 会拷贝 httpd_uri_t，局部变量即可） */
+    for (size_t i = 0; i < g_web_asset_count; i++) {
+        const web_asset_t *asset = &g_web_assets[i];
+        httpd_uri_t        uri   = {
+            .uri      = asset->uri,
+            .method   = HTTP_GET,
+            .handler  = web_module_asset_get_handler,
+            .user_ctx = (void *)asset,
+        };
+        httpd_register_uri_handler(s_http_server, &uri);
 
-    httpd_register_uri_handler(s_http_server, &uri_root);
-    httpd_register_uri_handler(s_http_server, &uri_index);
-    httpd_register_uri_handler(s_http_server, &uri_css);
-    httpd_register_uri_handler(s_http_server, &uri_js);
+        if (strcmp(asset->uri, "/index.html") == 0) {
+            uri.uri = "/";
+            httpd_register_uri_handler(s_http_server, &uri);
+        }
+    }
 
     /* 仅在配置了回调的前提下注册状态接口，保持职责清晰 */
     if (s_web_cfg.get_status_cb != NULL) {
@@ -609,6 +787,32 @@ static esp_err_t web_module_start_server(void)
         httpd_register_uri_handler(s_http_server, &uri_saved_connect);
     }
 
+    /* 运行指标导出接口（Prometheus 文本 / JSON） */
+    static const httpd_uri_t uri_metrics = {
+        .uri      = "/api/metrics",
+        .method   = HTTP_GET,
+        .handler  = web_module_metrics_get_handler,
+        .user_ctx = NULL,
+    };
+    httpd_register_uri_handler(s_http_server, &uri_metrics);
+
+    /* 时间线追踪：POST 开始 / 停止，GET 导出 */
+    static const httpd_uri_t uri_trace_get = {
+        .uri      = "/api/trace",
+        .method   = HTTP_GET,
+        .handler  = web_module_trace_get_handler,
+        .user_ctx = NULL,
+    };
+    httpd_register_uri_handler(s_http_server, &uri_trace_get);
+
+    static const httpd_uri_t uri_trace_post = {
+        .uri      = "/api/trace",
+        .method   = HTTP_POST,
+        .handler  = web_module_trace_post_handler,
+        .user_ctx = NULL,
+    };
+    httpd_register_uri_handler(s_http_server, &uri_trace_post);
+
     return ESP_OK;
 }
 
@@ -628,12 +832,7 @@ esp_err_t web_module_init(const web_module_config_t *config)
         return ESP_OK;
     }
 
-    esp_err_t ret = web_module_mount_spiffs();
-    if (ret != ESP_OK) {
-        return ret;
-    }
-
-    ret = web_module_start_server();
+    esp_err_t ret = web_module_start_server();
     if (ret != ESP_OK) {
         return ret;
     }
@@ -358,6 +358,19 @@ esp_err_t wifi_module_init(const wifi_module_config_t *config)
  * @param password AP 密码，可为 NULL/空串 表示开放网络
  */
 esp_err_t wifi_module_connect(const char *ssid, const char *password)
+{
+    return wifi_module_connect_hint(ssid, password, NULL);
+}
+
+/**
+ * @brief 按已知 BSSID / 信道连接指定 AP
+ *
+ * @param ssid     目标 AP SSID，必须非 NULL 且非空
+ * @param password AP 密码，可为 NULL/空串 表示开放网络
+ * @param hint     AP 定位信息，可为 NULL
+ */
+esp_err_t wifi_module_connect_hint(const char *ssid, const char *password,
+                                   const wifi_module_ap_hint_t *hint)
 {
     if (!s_wifi_inited) {
         return ESP_ERR_INVALID_STATE;
@@ -383,6 +396,15 @@ esp_err_t wifi_module_connect(const char *ssid, const char *password)
         sta_cfg.sta.password[sizeof(sta_cfg.sta.password) - 1] = '\0';
     }
 
+    /* 已知 AP 位置：锁定 BSSID 并只在该信道上探测 */
+    if (hint != NULL && hint->channel != 0) {
+        memcpy(sta_cfg.sta.bssid, hint->bssid, sizeof(sta_cfg.sta.bssid));
+        sta_cfg.sta.bssid_set          = true;
+        sta_cfg.sta.channel            = hint->channel;
+        sta_cfg.sta.scan_method        = WIFI_FAST_SCAN;
+        sta_cfg.sta.threshold.authmode = (wifi_auth_mode_t)hint->authmode;
+    }
+
     esp_err_t   ret;
     wifi_mode_t mode = WIFI_MODE_NULL;
 
@@ -490,7 +512,10 @@ esp_err_t wifi_module_scan(wifi_module_scan_result_t *results, uint16_t *count_i
         strncpy(results[i].ssid,
                 (const char *)ap_list[i].ssid,
                 sizeof(results[i].ssid) - 1);
-        results[i].rssi = ap_list[i].rssi;
+        results[i].rssi     = ap_list[i].rssi;
+        memcpy(results[i].bssid, ap_list[i].bssid, sizeof(results[i].bssid));
+        results[i].channel  = ap_list[i].primary;
+        results[i].authmode = (uint8_t)ap_list[i].authmode;
     }
 
     *count_inout = ap_num;
@@ -23,6 +23,8 @@
 #include "storage_module.h"
 #include "web_module.h"
 #include "xn_wifi_manage.h"
+#include "metrics_registry.h"
+#include "metrics_trace.h"
 
 /* 日志 TAG（如需日志输出，使用 ESP_LOGx(TAG, ...)） */
 static const char *TAG = "wifi_manage";
@@ -44,10 +46,84 @@ static void wifi_manage_notify_state(wifi_manage_state_t new_state)
     }
 }
 
+/**
+ * @brief 一轮重连中的候选连接
+ */
+typedef struct {
+    uint8_t               saved_index;  ///< 在 s_saved 中的下标
+    int8_t                rssi;         ///< 扫描到的 RSSI（快速连接候选无意义）
+    bool                  has_hint;     ///< hint 是否有效（否则走全信道扫描连接）
+    wifi_module_ap_hint_t hint;         ///< 目标 AP 定位信息
+} wifi_manage_candidate_t;
+
+/* -------------------- 运行指标 -------------------- */
+
+/* RSSI 直方图桶上界（dBm），大致对应 差 / 一般 / 良好 / 很好 */
+static const int32_t s_rssi_bounds[] = {-90, -80, -70, -67, -60, -50};
+
+static const metrics_desc_t s_rssi_gauge_desc = {
+    "xn_wifi_rssi_dbm", NULL, "Current STA RSSI (0 when disconnected)"};
+static const metrics_desc_t s_rssi_hist_desc = {
+    "xn_wifi_rssi_samples_dbm", NULL, "STA RSSI sampled every WIFI_MANAGE_RSSI_SAMPLE_MS"};
+static const metrics_desc_t s_disconnect_desc = {
+    "xn_wifi_disconnects_total", NULL, "STA disconnect events"};
+
+static metrics_handle_t s_metric_rssi         = NULL;
+static metrics_handle_t s_metric_rssi_hist    = NULL;
+static metrics_handle_t s_metric_disconnects  = NULL;
+static TickType_t       s_rssi_sample_ts      = 0;
+
+/**
+ * @brief 注册 WiFi 指标（失败不影响联网功能）
+ */
+static void wifi_manage_register_metrics(void)
+{
+    esp_err_t ret = metrics_register_gauge(&s_rssi_gauge_desc, &s_metric_rssi);
+    if (ret == ESP_OK) {
+        ret = metrics_register_histogram(&s_rssi_hist_desc,
+                                         s_rssi_bounds,
+                                         sizeof(s_rssi_bounds) / sizeof(s_rssi_bounds[0]),
+                                         &s_metric_rssi_hist);
+    }
+    if (ret == ESP_OK) {
+        ret = metrics_register_counter(&s_disconnect_desc, &s_metric_disconnects);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "register wifi metrics failed: %s", esp_err_to_name(ret));
+    }
+}
+
+/**
+ * @brief 已连接状态下按 WIFI_MANAGE_RSSI_SAMPLE_MS 采样一次 RSSI
+ */
+static void wifi_manage_sample_rssi(void)
+{
+    TickType_t now = xTaskGetTickCount();
+    if (s_rssi_sample_ts != 0 && now - s_rssi_sample_ts < pdMS_TO_TICKS(WIFI_MANAGE_RSSI_SAMPLE_MS)) {
+        return;
+    }
+    s_rssi_sample_ts = now;
+
+    int rssi = 0;
+    if (esp_wifi_sta_get_rssi(&rssi) == ESP_OK) {
+        metrics_gauge_set(s_metric_rssi, rssi);
+        metrics_histogram_observe(s_metric_rssi_hist, rssi);
+    }
+}
+
 /* 遍历已保存 WiFi 时的状态 */
 static bool       s_wifi_connecting   = false;  /* 当前是否有一次 STA 连接正在进行 */
-static uint8_t    s_wifi_try_index    = 0;      /* 本轮遍历中，正在尝试的 WiFi 下标 */
+static uint8_t    s_wifi_try_index    = 0;      /* 本轮遍历中，正在尝试的候选下标 */
 static TickType_t s_connect_failed_ts = 0;      /* 最近一次全轮尝试失败的时间戳 */
+static TickType_t s_fast_retry_ts     = 0;      /* 最近一次失败期间快速重连的时间戳 */
+static bool       s_round_active      = false;  /* 当前是否处于一轮重连中 */
+static bool       s_round_scanned     = false;  /* 本轮是否已执行过共享扫描 */
+
+/* 本轮使用的已保存列表与候选列表（初始化时按 save_wifi_count 一次性分配） */
+static wifi_config_t           *s_saved           = NULL;
+static uint8_t                  s_saved_count     = 0;
+static wifi_manage_candidate_t *s_candidates      = NULL;
+static uint8_t                  s_candidate_count = 0;
 
 /* -------------------- Web 回调：查询当前 WiFi 状态 -------------------- */
 /**
@@ -360,8 +436,26 @@ static esp_err_t wifi_manage_connect_web_form(const char *ssid, const char *pass
 }
 
 /* -------------------- WiFi 模块事件回调 -------------------- */
+/**
+ * @brief 从已保存配置中提取 AP 记录
+ *
+ * @return true 该配置记录过成功连接的 AP
+ */
+static bool wifi_manage_get_saved_hint(const wifi_config_t *cfg, wifi_module_ap_hint_t *hint)
+{
+    if (cfg->sta.channel == 0) {
+        return false;
+    }
+    memcpy(hint->bssid, cfg->sta.bssid, sizeof(hint->bssid));
+    hint->channel  = cfg->sta.channel;
+    hint->authmode = (uint8_t)cfg->sta.threshold.authmode;
+    return true;
+}
+
 /**
  * @brief 供 WiFi 模块调用的事件回调，用于驱动管理状态机
+ *
+ * 状态变化后立即唤醒管理任务，不必等待下一个 WIFI_MANAGE_STEP_INTERVAL_MS 周期。
  */
 static void wifi_manage_on_wifi_event(wifi_module_event_t event)
 {
@@ -376,10 +470,18 @@ static void wifi_manage_on_wifi_event(wifi_module_event_t event)
         s_wifi_connecting   = false;
         s_wifi_try_index    = 0;      /* 下次自动重连从首选 WiFi 开始 */
         s_connect_failed_ts = 0;
+        s_round_active      = false;
 
-        /* 将当前配置上报给存储模块，用于调整优先级等策略 */
-        wifi_config_t current_cfg = {0};
+        /* 将当前配置连同实际连接的 AP（BSSID / 信道 / 加密方式）上报给存储模块，
+         * 用于调整优先级，以及下次断线时的单信道快速重连 */
+        wifi_config_t    current_cfg = {0};
+        wifi_ap_record_t ap_info     = {0};
         if (esp_wifi_get_config(WIFI_IF_STA, &current_cfg) == ESP_OK) {
+            if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
+                memcpy(current_cfg.sta.bssid, ap_info.bssid, sizeof(current_cfg.sta.bssid));
+                current_cfg.sta.channel            = ap_info.primary;
+                current_cfg.sta.threshold.authmode = ap_info.authmode;
+            }
             (void)wifi_storage_on_connected(&current_cfg);
         }
         break;
@@ -387,23 +489,139 @@ static void wifi_manage_on_wifi_event(wifi_module_event_t event)
 
     case WIFI_MODULE_EVENT_STA_DISCONNECTED:
         /* 连接断开，等待管理任务按策略进行重连 */
+        metrics_counter_inc(s_metric_disconnects);
+        metrics_gauge_set(s_metric_rssi, 0);
+        metrics_trace_instant("net", "wifi_disconnected");
+        s_rssi_sample_ts = 0;
         wifi_manage_notify_state(WIFI_MANAGE_STATE_DISCONNECTED);
         s_wifi_connecting   = false;
         s_wifi_try_index    = 0;
+        s_round_active      = false;
         break;
 
     case WIFI_MODULE_EVENT_STA_CONNECT_FAILED:
-        /* 本次尝试失败，简单移动到下一条配置 */
+        /* 本次尝试失败，简单移动到下一个候选 */
         s_wifi_connecting = false;
         s_wifi_try_index++;
         break;
 
     default:
         /* 其他事件暂不关心 */
-        break;
+        return;
+    }
+
+    if (s_wifi_manage_task != NULL) {
+        xTaskNotifyGive(s_wifi_manage_task);
     }
 }
 
+/* -------------------- 重连候选 -------------------- */
+/**
+ * @brief 开始新一轮重连：刷新已保存列表，首个候选为最近连接 AP 的快速连接
+ *
+ * @return true 有可尝试的已保存 WiFi
+ */
+static bool wifi_manage_begin_round(void)
+{
+    s_saved_count     = 0;
+    s_candidate_count = 0;
+    s_wifi_try_index  = 0;
+    s_round_scanned   = false;
+
+    /* 存储模块已在 RAM 中缓存列表，这里只是一次内存拷贝 */
+    if (wifi_storage_load_all(s_saved, &s_saved_count) != ESP_OK || s_saved_count == 0) {
+        return false;
+    }
+
+    wifi_manage_candidate_t *c = &s_candidates[0];
+    if (s_saved[0].sta.ssid[0] != '\0' && wifi_manage_get_saved_hint(&s_saved[0], &c->hint)) {
+        c->saved_index    = 0;
+        c->has_hint       = true;
+        s_candidate_count = 1;
+    }
+
+    s_round_active = true;
+    return true;
+}
+
+/**
+ * @brief 执行一次共享扫描，按 RSSI 从强到弱排列所有可见的已保存 WiFi
+ *
+ * 每个 SSID 取信号最强的 BSSID 作为连接目标；扫描不可见的 WiFi 不加入候选。
+ */
+static void wifi_manage_rank_by_scan(void)
+{
+    s_candidate_count = 0;
+    s_wifi_try_index  = 0;
+    s_round_scanned   = true;
+
+    wifi_module_scan_result_t *results =
+        (wifi_module_scan_result_t *)malloc(WIFI_MANAGE_SCAN_MAX_AP * sizeof(wifi_module_scan_result_t));
+    if (results == NULL) {
+        return;
+    }
+
+    uint16_t count = WIFI_MANAGE_SCAN_MAX_AP;
+    if (wifi_module_scan(results, &count) != ESP_OK) {
+        free(results);
+        return;
+    }
+
+    for (uint8_t i = 0; i < s_saved_count; i++) {
+        const char *ssid = (const char *)s_saved[i].sta.ssid;
+        int         best = -1;
+        for (uint16_t j = 0; j < count && ssid[0] != '\0'; j++) {
+            if (strncmp(results[j].ssid, ssid, sizeof(results[j].ssid)) == 0 &&
+                (best < 0 || results[j].rssi > results[best].rssi)) {
+                best = (int)j;
+            }
+        }
+        if (best < 0) {
+            continue;
+        }
+
+        /* 插入排序：候选数量不超过 save_wifi_count */
+        wifi_manage_candidate_t cand = {
+            .saved_index = i,
+            .rssi        = results[best].rssi,
+            .has_hint    = true,
+            .hint        = {
+                .channel  = results[best].channel,
+                .authmode = results[best].authmode,
+            },
+        };
+        memcpy(cand.hint.bssid, results[best].bssid, sizeof(cand.hint.bssid));
+
+        uint8_t pos = s_candidate_count;
+        while (pos > 0 && s_candidates[pos - 1].rssi < cand.rssi) {
+            s_candidates[pos] = s_candidates[pos - 1];
+            pos--;
+        }
+        s_candidates[pos] = cand;
+        s_candidate_count++;
+    }
+
+    ESP_LOGI(TAG, "reconnect scan: %u AP(s), %u saved visible", (unsigned)count, (unsigned)s_candidate_count);
+    free(results);
+}
+
+/**
+ * @brief 对候选发起连接
+ */
+static esp_err_t wifi_manage_connect_candidate(const wifi_manage_candidate_t *c)
+{
+    const wifi_config_t *cfg      = &s_saved[c->saved_index];
+    const char          *ssid     = (const char *)cfg->sta.ssid;
+    const char          *password = (cfg->sta.password[0] == '\0')
+                                        ? NULL
+                                        : (const char *)cfg->sta.password;
+
+    if (c->has_hint) {
+        ESP_LOGI(TAG, "connect %s on channel %u", ssid, (unsigned)c->hint.channel);
+    }
+    return wifi_module_connect_hint(ssid, password, c->has_hint ? &c->hint : NULL);
+}
+
 /* -------------------- 状态机核心逻辑 -------------------- */
 /**
  * @brief 单步执行 WiFi 管理状态机
@@ -414,69 +632,46 @@ static void wifi_manage_step(void)
 {
     switch (s_wifi_manage_state) {
     case WIFI_MANAGE_STATE_DISCONNECTED: {
-        /* 断开状态：按顺序遍历已保存 WiFi，逐个尝试连接 */
+        /* 断开状态：快速连接 -> 共享扫描按 RSSI 排序 -> 依次定向连接 */
 
         if (s_wifi_connecting) {
             /* 已经有一个连接操作在进行，等待事件回调给结果 */
             break;
         }
 
-        /* 从存储模块加载全部配置，数量受 save_wifi_count 限制 */
-        uint8_t max_num = (s_wifi_cfg.save_wifi_count <= 0)
-                              ? 1
-                              : (uint8_t)s_wifi_cfg.save_wifi_count;
-
-        /* 为避免在任务栈上分配大数组，这里通过堆申请临时缓冲区 */
-        wifi_config_t *list = (wifi_config_t *)malloc(max_num * sizeof(wifi_config_t));
-        if (list == NULL) {
-            /* 内存不足时保留在断开状态，等待下次循环再尝试 */
+        if (!s_round_active && !wifi_manage_begin_round()) {
+            /* 没有可用配置，交由上层决定是否启用纯 AP 配网等逻辑 */
             break;
         }
 
-        uint8_t count = 0;
-
-        if (wifi_storage_load_all(list, &count) != ESP_OK || count == 0) {
-            /* 没有可用配置，交由上层决定是否启用纯 AP 配网等逻辑 */
-            free(list);
-            break;
+        if (s_wifi_try_index >= s_candidate_count && !s_round_scanned) {
+            /* 快速连接失败或没有 AP 记录：扫描一次，得到全部可见候选 */
+            wifi_manage_rank_by_scan();
         }
 
-        if (s_wifi_try_index >= count) {
-            /* 本轮所有配置均尝试过，仍未连接成功，进入“整轮失败”状态 */
+        if (s_wifi_try_index >= s_candidate_count) {
+            /* 本轮所有候选均尝试过，仍未连接成功，进入“整轮失败”状态 */
             wifi_manage_notify_state(WIFI_MANAGE_STATE_CONNECT_FAILED);
             s_connect_failed_ts = xTaskGetTickCount();
+            s_fast_retry_ts     = s_connect_failed_ts;
             s_wifi_try_index    = 0;
             s_wifi_connecting   = false;
-            free(list);
-            break;
-        }
-
-        wifi_config_t *cfg = &list[s_wifi_try_index];
-        if (cfg->sta.ssid[0] == '\0') {
-            /* 跳过无效 SSID */
-            s_wifi_try_index++;
-            free(list);
+            s_round_active      = false;
             break;
         }
 
-        const char *ssid     = (const char *)cfg->sta.ssid;
-        const char *password = (cfg->sta.password[0] == '\0')
-                                   ? NULL
-                                   : (const char *)cfg->sta.password;
-
-        /* 尝试发起连接，成功则等待事件回调，失败则立即切换到下一条 */
-        if (wifi_module_connect(ssid, password) == ESP_OK) {
+        /* 尝试发起连接，成功则等待事件回调，失败则立即切换到下一个候选 */
+        if (wifi_manage_connect_candidate(&s_candidates[s_wifi_try_index]) == ESP_OK) {
             s_wifi_connecting = true;
         } else {
             s_wifi_try_index++;
         }
-
-        free(list);
         break;
     }
 
     case WIFI_MANAGE_STATE_CONNECTED:
-        /* 已连接状态下，当前不做周期性操作，保持静默 */
+        /* 已连接状态下仅周期性采样 RSSI 指标 */
+        wifi_manage_sample_rssi();
         break;
 
     case WIFI_MANAGE_STATE_CONNECT_FAILED: {
@@ -497,7 +692,23 @@ static void wifi_manage_step(void)
             /* 到达重试时间，从头开始新一轮遍历 */
             s_wifi_try_index    = 0;
             s_wifi_connecting   = false;
+            s_round_active      = false;
             wifi_manage_notify_state(WIFI_MANAGE_STATE_DISCONNECTED);
+            break;
+        }
+
+        /* 等待期间定期对最近连接的 AP 做单信道探测，AP 恢复后无需等满整轮间隔 */
+        wifi_module_ap_hint_t hint;
+        if (!s_wifi_connecting && s_wifi_cfg.fast_retry_interval_ms > 0 && s_saved_count > 0 &&
+            now - s_fast_retry_ts >= pdMS_TO_TICKS(s_wifi_cfg.fast_retry_interval_ms) &&
+            wifi_manage_get_saved_hint(&s_saved[0], &hint)) {
+            s_fast_retry_ts = now;
+            const char *password = (s_saved[0].sta.password[0] == '\0')
+                                       ? NULL
+                                       : (const char *)s_saved[0].sta.password;
+            if (wifi_module_connect_hint((const char *)s_saved[0].sta.ssid, password, &hint) == ESP_OK) {
+                s_wifi_connecting = true;
+            }
         }
         break;
     }
@@ -518,7 +729,8 @@ static void wifi_manage_task(void *arg)
 
     for (;;) {
         wifi_manage_step();
-        vTaskDelay(pdMS_TO_TICKS(WIFI_MANAGE_STEP_INTERVAL_MS));
+        /* 事件回调会提前唤醒，断线后立即进入重连流程 */
+        (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(WIFI_MANAGE_STEP_INTERVAL_MS));
     }
 }
 
@@ -542,6 +754,8 @@ esp_err_t wifi_manage_init(const wifi_manage_config_t *config)
         s_wifi_cfg = *config;
     }
 
+    wifi_manage_register_metrics();
+
     /* ---- 初始化 WiFi 模块 ---- */
     wifi_module_config_t wifi_cfg = WIFI_MODULE_DEFAULT_CONFIG();
 
@@ -588,6 +802,20 @@ esp_err_t wifi_manage_init(const wifi_manage_config_t *config)
         return ret;
     }
 
+    /* 重连使用的已保存列表与候选列表，避免状态机每步申请堆内存 */
+    if (s_saved == NULL) {
+        s_saved      = (wifi_config_t *)calloc(storage_cfg.max_wifi_num, sizeof(wifi_config_t));
+        s_candidates = (wifi_manage_candidate_t *)calloc(storage_cfg.max_wifi_num,
+                                                         sizeof(wifi_manage_candidate_t));
+        if (s_saved == NULL || s_candidates == NULL) {
+            free(s_saved);
+            free(s_candidates);
+            s_saved      = NULL;
+            s_candidates = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
     /* ---- 初始化 Web 配网模块 ---- */
     {
         web_module_config_t web_cfg = WEB_MODULE_DEFAULT_CONFIG();
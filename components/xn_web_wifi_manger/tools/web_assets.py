@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+配网页面静态资源打包工具：构建时把 wifi_spiffs/ 下的网页压缩并生成 C 源文件，
+与 components/xn_web_wifi_manger/include/web_assets.h 配套，由 CMakeLists.txt 自动调用。
+
+用法：
+    python3 web_assets.py <out.c> <asset> [<asset> ...]
+
+处理规则：
+    - 每个资源同时生成 gzip（mtime 固定为 0，输出可复现）与原始两份数据，
+      客户端不支持 gzip 时回退为原始数据；
+    - ETag 取原始内容 SHA-256 前 16 位十六进制，两种编码分别加 "-gz" / "-id" 后缀，保证强校验语义；
+    - HTML 中对其它资源的引用（如 href="app.css"）改写为 "app.css?v=<hash>"，
+      因此 css / js 可以长期缓存（max-age 一年 + immutable），HTML 本身每次用 ETag 重新验证。
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+CONTENT_TYPES = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".ico": "image/x-icon",
+}
+
+CACHE_REVALIDATE = "no-cache"
+CACHE_IMMUTABLE = "public, max-age=31536000, immutable"
+
+
+def _hash(data):
+    return hashlib.sha256(data).hexdigest()[:16]
+
+
+def _c_array(name, data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "static const uint8_t %s[%d] = {\n%s\n};\n" % (name, len(data), "\n".join(lines))
+
+
+def build(paths):
+    assets = []
+    for path in paths:
+        with open(path, "rb") as f:
+            assets.append({"name": os.path.basename(path), "data": f.read()})
+
+    # 先计算非 HTML 资源的摘要，再改写 HTML 中的引用
+    versions = {a["name"]: _hash(a["data"]) for a in assets if not a["name"].endswith(".html")}
+    for a in assets:
+        if a["name"].endswith(".html"):
+            for name, ver in versions.items():
+                pattern = r'((?:href|src)=")(/?%s)(")' % re.escape(name)
+                a["data"] = re.sub(pattern.encode(), lambda m: m.group(1) + m.group(2) +
+                                   ("?v=" + ver).encode() + m.group(3), a["data"])
+
+    out = []
+    out.append("/* 由 tools/web_assets.py 自动生成，请勿手动修改 */\n")
+    out.append('#include "web_assets.h"\n')
+    entries = []
+    for i, a in enumerate(assets):
+        ext = os.path.splitext(a["name"])[1]
+        if ext not in CONTENT_TYPES:
+            raise ValueError("unknown asset type: %s" % a["name"])
+        digest = _hash(a["data"])
+        gz = gzip.compress(a["data"], compresslevel=9, mtime=0)
+        out.append(_c_array("s_asset_%d_gz" % i, gz))
+        out.append(_c_array("s_asset_%d_raw" % i, a["data"]))
+        entries.append(
+            "    {\n"
+            '        .uri           = "/%s",\n'
+            '        .content_type  = "%s",\n'
+            '        .cache_control = "%s",\n'
+            '        .etag_gzip     = "\\"%s-gz\\"",\n'
+            '        .etag_identity = "\\"%s-id\\"",\n'
+            "        .gzip          = s_asset_%d_gz,\n"
+            "        .gzip_size     = sizeof(s_asset_%d_gz),\n"
+            "        .identity      = s_asset_%d_raw,\n"
+            "        .identity_size = sizeof(s_asset_%d_raw),\n"
+            "    },\n" % (a["name"], CONTENT_TYPES[ext],
+                         CACHE_REVALIDATE if ext == ".html" else CACHE_IMMUTABLE,
+                         digest, digest, i, i, i, i))
+        print("web asset %-12s %6d -> %6d bytes (gzip)" % (a["name"], len(a["data"]), len(gz)))
+
+    out.append("const web_asset_t g_web_assets[] = {\n%s};\n" % "".join(entries))
+    out.append("const size_t g_web_asset_count = sizeof(g_web_assets) / sizeof(g_web_assets[0]);\n")
+    return "\n".join(out)
+
+
+def main(argv):
+    if len(argv) < 3:
+        print(__doc__)
+        return 1
+    source = build(argv[2:])
+    # 内容不变时不改写文件，避免触发无谓的重新编译
+    if os.path.exists(argv[1]):
+        with open(argv[1], "r", encoding="utf-8") as f:
+            if f.read() == source:
+                return 0
+    with open(argv[1], "w", encoding="utf-8") as f:
+        f.write(source)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
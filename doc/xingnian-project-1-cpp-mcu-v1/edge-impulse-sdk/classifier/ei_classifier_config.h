@@ -95,6 +95,38 @@
     #define ESP_NN                                  1
 #endif
 
+// record per-layer timing of EON compiled models (see ei_layer_profiler.h)
+#ifndef EI_CLASSIFIER_PROFILE_LAYERS
+#define EI_CLASSIFIER_PROFILE_LAYERS                0
+#endif // EI_CLASSIFIER_PROFILE_LAYERS
+
+// host only: split the reference int8 CONV_2D / FULLY_CONNECTED kernels across a thread pool,
+// threads and cost threshold are set per impulse handle (ei_impulse_handle_t::parallel_kernels)
+#ifndef EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
+#define EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS       0
+#endif // EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
+#ifndef EI_CLASSIFIER_TFLITE_PARALLEL_THREADS
+#define EI_CLASSIFIER_TFLITE_PARALLEL_THREADS       4       // default threads per layer
+#endif // EI_CLASSIFIER_TFLITE_PARALLEL_THREADS
+#ifndef EI_CLASSIFIER_TFLITE_PARALLEL_MIN_COST
+#define EI_CLASSIFIER_TFLITE_PARALLEL_MIN_COST      100000  // MACs below which a layer stays single-threaded
+#endif // EI_CLASSIFIER_TFLITE_PARALLEL_MIN_COST
+
+// continuous MFCC models with an int8 input (EON): normalize the feature window and quantize it
+// straight into the input tensor instead of through a float copy (see run_nn_inference_mfcc_quantized)
+#ifndef EI_CLASSIFIER_CONTINUOUS_QUANTIZED_INPUT
+#define EI_CLASSIFIER_CONTINUOUS_QUANTIZED_INPUT    1
+#endif // EI_CLASSIFIER_CONTINUOUS_QUANTIZED_INPUT
+
+// timeline hooks around DSP extraction, CMVN and NN inference (static string arguments),
+// e.g. define them as metrics_trace_begin / metrics_trace_end to record into the firmware tracer
+#ifndef EI_CLASSIFIER_TRACE_BEGIN
+#define EI_CLASSIFIER_TRACE_BEGIN(cat, name)
+#endif // EI_CLASSIFIER_TRACE_BEGIN
+#ifndef EI_CLASSIFIER_TRACE_END
+#define EI_CLASSIFIER_TRACE_END(cat, name)
+#endif // EI_CLASSIFIER_TRACE_END
+
 // no include checks in the compiler? then just include metadata and then ops_define (optional if on EON model)
 #ifndef __has_include
     #include "model-parameters/model_metadata.h"
@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2024 EdgeImpulse Inc.
+ *
+ * Generated by Edge Impulse and licensed under the applicable Edge Impulse
+ * Terms of Service. Community and Professional Terms of Service
+ * (https://edgeimpulse.com/legal/terms-of-service) or Enterprise Terms of
+ * Service (https://edgeimpulse.com/legal/enterprise-terms-of-service),
+ * according to your product plan subscription (the “License”).
+ *
+ * This software, documentation and other associated files (collectively referred
+ * to as the “Software”) is a single SDK variation generated by the Edge Impulse
+ * platform and requires an active paid Edge Impulse subscription to use this
+ * Software for any purpose.
+ *
+ * You may NOT use this Software unless you have an active Edge Impulse subscription
+ * that meets the eligibility requirements for the applicable License, subject to
+ * your full and continued compliance with the terms and conditions of the License,
+ * including without limitation any usage restrictions under the applicable License.
+ *
+ * If you do not have an active Edge Impulse product plan subscription, or if use
+ * of this Software exceeds the usage limitations of your Edge Impulse product plan
+ * subscription, you are not permitted to use this Software and must immediately
+ * delete and erase all copies of this Software within your control or possession.
+ * Edge Impulse reserves all rights and remedies available to enforce its rights.
+ *
+ * Unless required by applicable law or agreed to in writing, the Software is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language governing
+ * permissions, disclaimers and limitations under the License.
+ */
+
+#ifndef _EI_CLASSIFIER_LAYER_PROFILER_H_
+#define _EI_CLASSIFIER_LAYER_PROFILER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "edge-impulse-sdk/classifier/ei_classifier_config.h"
+#include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+#include "edge-impulse-sdk/tensorflow/lite/c/common.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/micro_profiler_interface.h"
+
+/**
+ * Per-layer timing for EON compiled models
+ *
+ * The compiled graph calls BeginEvent/EndEvent around every node it invokes (see
+ * <model>_set_profiler). Events are numbered in invoke order, so event i is node i. The
+ * profiler keeps the timeline of the last invocation plus per-node totals over all
+ * invocations since reset(), and prints them as CSV, JSON or Chrome trace JSON (load the
+ * latter in chrome://tracing or ui.perfetto.dev). Timestamps come from ei_read_timer_us().
+ *
+ * Enabled with EI_CLASSIFIER_PROFILE_LAYERS=1; run_classifier then profiles every EON
+ * inference and prints the CSV table in debug mode.
+ */
+
+// Maximum number of nodes profiled per invocation, later nodes are counted as dropped
+#ifndef EI_LAYER_PROFILER_MAX_NODES
+#define EI_LAYER_PROFILER_MAX_NODES     64
+#endif
+
+typedef TfLiteStatus (*ei_layer_node_info_fn)(size_t, const char**, const TfLiteIntArray**,
+                                              const TfLiteIntArray**);
+
+class EiLayerProfiler : public tflite::MicroProfilerInterface {
+public:
+    EiLayerProfiler() {
+        reset();
+    }
+
+    /**
+     * Clear the accumulated totals and the last timeline.
+     */
+    void reset() {
+        memset(nodes_, 0, sizeof(nodes_));
+        node_count_ = 0;
+        event_count_ = 0;
+        runs_ = 0;
+        dropped_ = 0;
+        run_start_us_ = 0;
+        node_info_ = nullptr;
+    }
+
+    /**
+     * Mark the start of an invocation.
+     * @param node_info Optional, used to label the exports with tensor shapes
+     */
+    void start_run(ei_layer_node_info_fn node_info) {
+        node_info_ = node_info;
+        event_count_ = 0;
+        run_start_us_ = ei_read_timer_us();
+        runs_++;
+    }
+
+    uint32_t BeginEvent(const char* tag) override {
+        if (event_count_ >= EI_LAYER_PROFILER_MAX_NODES) {
+            dropped_++;
+            return EI_LAYER_PROFILER_MAX_NODES;
+        }
+        uint32_t ix = event_count_++;
+        if (event_count_ > node_count_) {
+            node_count_ = event_count_;
+        }
+        nodes_[ix].tag = tag;
+        nodes_[ix].start_us = ei_read_timer_us();
+        return ix;
+    }
+
+    void EndEvent(uint32_t event_handle) override {
+        if (event_handle >= EI_LAYER_PROFILER_MAX_NODES) {
+            return;
+        }
+        node_t *node = &nodes_[event_handle];
+        node->last_us = (uint32_t)(ei_read_timer_us() - node->start_us);
+        node->total_us += node->last_us;
+        node->runs++;
+        if (node->last_us > node->max_us) {
+            node->max_us = node->last_us;
+        }
+    }
+
+    size_t get_node_count() const {
+        return node_count_;
+    }
+
+    uint32_t get_dropped() const {
+        return dropped_;
+    }
+
+    /**
+     * Last, mean and max time of a node in microseconds.
+     * @return false if the node was never profiled
+     */
+    bool get_node(size_t node, const char **tag, uint32_t *last_us, uint32_t *avg_us,
+                  uint32_t *max_us) const {
+        if (node >= node_count_ || nodes_[node].runs == 0) {
+            return false;
+        }
+        *tag = nodes_[node].tag;
+        *last_us = nodes_[node].last_us;
+        *avg_us = (uint32_t)(nodes_[node].total_us / nodes_[node].runs);
+        *max_us = nodes_[node].max_us;
+        return true;
+    }
+
+    /**
+     * One row per node: node,op,input_shape,output_shape,last_us,avg_us,max_us,runs
+     */
+    void print_csv() const {
+        ei_printf("node,op,input_shape,output_shape,last_us,avg_us,max_us,runs\n");
+        for (size_t ix = 0; ix < node_count_; ix++) {
+            const node_t *node = &nodes_[ix];
+            if (node->runs == 0) {
+                continue;
+            }
+            ei_printf("%u,%s,", (unsigned)ix, node->tag);
+            print_shape(ix, true);
+            ei_printf(",");
+            print_shape(ix, false);
+            ei_printf(",%lu,%lu,%lu,%lu\n", (unsigned long)node->last_us,
+                (unsigned long)(node->total_us / node->runs), (unsigned long)node->max_us,
+                (unsigned long)node->runs);
+        }
+    }
+
+    /**
+     * Per-node rows plus the mean time per invocation spent in each op type.
+     */
+    void print_json() const {
+        ei_printf("{\"runs\":%lu,\"dropped_events\":%lu,\"nodes\":[", (unsigned long)runs_,
+            (unsigned long)dropped_);
+        bool first = true;
+        for (size_t ix = 0; ix < node_count_; ix++) {
+            const node_t *node = &nodes_[ix];
+            if (node->runs == 0) {
+                continue;
+            }
+            ei_printf("%s{\"node\":%u,\"op\":\"%s\",\"input_shape\":\"", first ? "" : ",",
+                (unsigned)ix, node->tag);
+            print_shape(ix, true);
+            ei_printf("\",\"output_shape\":\"");
+            print_shape(ix, false);
+            ei_printf("\",\"last_us\":%lu,\"avg_us\":%lu,\"max_us\":%lu}",
+                (unsigned long)node->last_us, (unsigned long)(node->total_us / node->runs),
+                (unsigned long)node->max_us);
+            first = false;
+        }
+
+        // op tags are string literals from the compiled model, so group on the first
+        // node of each tag
+        ei_printf("],\"ops\":{");
+        first = true;
+        for (size_t ix = 0; ix < node_count_; ix++) {
+            if (nodes_[ix].runs == 0 || seen_before(ix)) {
+                continue;
+            }
+            uint64_t total_us = 0;
+            uint32_t count = 0;
+            for (size_t jx = ix; jx < node_count_; jx++) {
+                if (nodes_[jx].runs != 0 && same_tag(nodes_[jx].tag, nodes_[ix].tag)) {
+                    total_us += nodes_[jx].total_us / nodes_[jx].runs;
+                    count++;
+                }
+            }
+            ei_printf("%s\"%s\":{\"nodes\":%lu,\"avg_us\":%lu}", first ? "" : ",",
+                nodes_[ix].tag, (unsigned long)count, (unsigned long)total_us);
+            first = false;
+        }
+        ei_printf("}}\n");
+    }
+
+    /**
+     * Timeline of the last invocation in Chrome trace event format.
+     */
+    void print_chrome_trace() const {
+        ei_printf("{\"traceEvents\":[");
+        for (size_t ix = 0; ix < event_count_; ix++) {
+            const node_t *node = &nodes_[ix];
+            ei_printf("%s{\"name\":\"%s\",\"cat\":\"nn\",\"ph\":\"X\",\"pid\":0,\"tid\":0,"
+                "\"ts\":%lu,\"dur\":%lu,\"args\":{\"node\":%u,\"input_shape\":\"",
+                ix == 0 ? "" : ",", node->tag,
+                (unsigned long)(node->start_us - run_start_us_), (unsigned long)node->last_us,
+                (unsigned)ix);
+            print_shape(ix, true);
+            ei_printf("\",\"output_shape\":\"");
+            print_shape(ix, false);
+            ei_printf("\"}}");
+        }
+        ei_printf("],\"displayTimeUnit\":\"ms\"}\n");
+    }
+
+private:
+    typedef struct {
+        const char *tag;
+        uint64_t start_us;
+        uint32_t last_us;
+        uint32_t max_us;
+        uint64_t total_us;
+        uint32_t runs;
+    } node_t;
+
+    static bool same_tag(const char *a, const char *b) {
+        return a == b || (a && b && strcmp(a, b) == 0);
+    }
+
+    bool seen_before(size_t ix) const {
+        for (size_t jx = 0; jx < ix; jx++) {
+            if (nodes_[jx].runs != 0 && same_tag(nodes_[jx].tag, nodes_[ix].tag)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void print_shape(size_t ix, bool input) const {
+        const char *op_name;
+        const TfLiteIntArray *input_dims, *output_dims;
+        if (!node_info_ || node_info_(ix, &op_name, &input_dims, &output_dims) != kTfLiteOk) {
+            return;
+        }
+        const TfLiteIntArray *dims = input ? input_dims : output_dims;
+        for (int d = 0; d < dims->size; d++) {
+            ei_printf(d == 0 ? "%d" : "x%d", dims->data[d]);
+        }
+    }
+
+    node_t nodes_[EI_LAYER_PROFILER_MAX_NODES];
+    size_t node_count_;
+    size_t event_count_;
+    uint32_t runs_;
+    uint32_t dropped_;
+    uint64_t run_start_us_;
+    ei_layer_node_info_fn node_info_;
+};
+
+/**
+ * Profiler shared by all EON graphs when EI_CLASSIFIER_PROFILE_LAYERS is set.
+ */
+inline EiLayerProfiler& ei_layer_profiler_get() {
+    static EiLayerProfiler profiler;
+    return profiler;
+}
+
+#endif // _EI_CLASSIFIER_LAYER_PROFILER_H_
@@ -37,6 +37,7 @@
 
 #include <stdint.h>
 
+#include "edge-impulse-sdk/classifier/ei_classifier_config.h"
 #include "edge-impulse-sdk/classifier/ei_classifier_types.h"
 #include "edge-impulse-sdk/dsp/ei_dsp_handle.h"
 #include "edge-impulse-sdk/dsp/numpy.hpp"
@@ -45,6 +46,13 @@
 #else
 #include "edge-impulse-sdk/tensorflow/lite/c/common.h"
 #endif // EI_CLASSIFIER_USE_FULL_TFLITE
+#if EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
+#include "edge-impulse-sdk/tensorflow/lite/micro/kernels/parallel_kernels.h"
+#endif // EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
+
+namespace tflite {
+class MicroProfilerInterface;
+}
 
 #define EI_CLASSIFIER_NONE                       255
 #define EI_CLASSIFIER_UTENSOR                    1
@@ -304,6 +312,14 @@ typedef struct {
     TfLiteStatus (*model_reset)(void (*free)(void* ptr));
     TfLiteStatus (*model_input)(int, TfLiteTensor*);
     TfLiteStatus (*model_output)(int, TfLiteTensor*);
+    // optional, reports arena size, tensor, persistent, scratch and heap overflow bytes
+    TfLiteStatus (*model_arena_usage)(size_t*, size_t*, size_t*, size_t*, size_t*);
+    // optional, per-node profiler hook and node description (op name, first input/output dims)
+    void (*model_set_profiler)(tflite::MicroProfilerInterface*);
+    TfLiteStatus (*model_node_info)(size_t, const char**, const TfLiteIntArray**, const TfLiteIntArray**);
+    // optional, arena size and binding of an external arena (see ei_shared_arena.h)
+    size_t (*model_arena_size)();
+    TfLiteStatus (*model_bind_arena)(uint8_t*);
 } ei_config_tflite_eon_graph_t;
 
 typedef struct {
@@ -477,6 +493,9 @@ public:
 #if EI_CLASSIFIER_FREEFORM_OUTPUT
         , freeform_outputs(nullptr)
 #endif //EI_CLASSIFIER_FREEFORM_OUTPUT
+#if EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
+        , parallel_kernels{ EI_CLASSIFIER_TFLITE_PARALLEL_THREADS, EI_CLASSIFIER_TFLITE_PARALLEL_MIN_COST }
+#endif // EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
         { /* ei_impulse_handle_t ctor */};
 
     ei_impulse_state_t state;
@@ -485,6 +504,11 @@ public:
 #if EI_CLASSIFIER_FREEFORM_OUTPUT == 1
     ei::matrix_t *freeform_outputs;
 #endif // EI_CLASSIFIER_FREEFORM_OUTPUT
+#if EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
+    // threads and cost threshold for the host CONV_2D / FULLY_CONNECTED kernels,
+    // may be changed between inferences
+    tflite::micro::ParallelKernelOptions parallel_kernels;
+#endif // EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
 };
 
 typedef struct {
@@ -36,6 +36,7 @@
 #define _EDGE_IMPULSE_RUN_CLASSIFIER_H_
 
 #include "ei_model_types.h"
+#include "edge-impulse-sdk/classifier/ei_classifier_config.h"
 #include "model-parameters/model_metadata.h"
 
 #include "ei_run_dsp.h"
@@ -103,6 +104,16 @@ extern "C" EI_IMPULSE_ERROR run_inference(ei_impulse_handle_t *handle, ei_featur
 extern "C" EI_IMPULSE_ERROR run_classifier_image_quantized(const ei_impulse_t *impulse, signal_t *signal, ei_impulse_result_t *result, bool debug);
 static EI_IMPULSE_ERROR can_run_classifier_image_quantized(const ei_impulse_t *impulse, ei_learning_block_t block_ptr);
 
+#if EI_CLASSIFIER_CONTINUOUS_QUANTIZED_INPUT == 1 && EI_CLASSIFIER_QUANTIZATION_ENABLED == 1 && \
+    (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED == 1) && \
+    (EI_CLASSIFIER_TFLITE_INPUT_DATATYPE == EI_CLASSIFIER_DATATYPE_INT8)
+#define EI_CLASSIFIER_HAS_CONTINUOUS_QUANTIZED  1
+static EI_IMPULSE_ERROR can_run_classifier_continuous_quantized(const ei_impulse_t *impulse);
+extern "C" EI_IMPULSE_ERROR run_classifier_continuous_quantized(ei_impulse_handle_t *handle, ei::matrix_t *features_matrix, ei_impulse_result_t *result, bool debug);
+#else
+#define EI_CLASSIFIER_HAS_CONTINUOUS_QUANTIZED  0
+#endif
+
 #if EI_CLASSIFIER_LOAD_IMAGE_SCALING
 EI_IMPULSE_ERROR ei_scale_fmatrix(ei_learning_block_t *block, ei::matrix_t *fmatrix);
 EI_IMPULSE_ERROR ei_unscale_fmatrix(ei_learning_block_t *block, ei::matrix_t *fmatrix);
@@ -145,6 +156,9 @@ extern "C" EI_IMPULSE_ERROR run_inference(
     bool debug = false)
 {
     auto& impulse = handle->impulse;
+#if EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
+    tflite::micro::SetParallelKernelOptions(&handle->parallel_kernels);
+#endif
     for (size_t ix = 0; ix < impulse->learning_blocks_size; ix++) {
 
         ei_learning_block_t block = impulse->learning_blocks[ix];
@@ -158,7 +172,15 @@ extern "C" EI_IMPULSE_ERROR run_inference(
         }
 #endif
 
+#if EIDSP_PROFILE_MEMORY
+        ei_memory_profile_begin("nn", block.blockId);
+#endif
+        EI_CLASSIFIER_TRACE_BEGIN("nn", "inference");
         EI_IMPULSE_ERROR res = block.infer_fn(impulse, fmatrix, ix, (uint32_t*)block.input_block_ids, block.input_block_ids_size, result, block.config, debug);
+        EI_CLASSIFIER_TRACE_END("nn", "inference");
+#if EIDSP_PROFILE_MEMORY
+        ei_memory_profile_end();
+#endif
         if (res != EI_IMPULSE_OK) {
             return res;
         }
@@ -181,6 +203,127 @@ extern "C" EI_IMPULSE_ERROR run_inference(
     return EI_IMPULSE_OK;
 }
 
+/**
+ * @brief      Run all DSP blocks (and data normalization) of an impulse over a signal
+ *
+ * @param      handle       Impulse handle
+ * @param      signal       Sample data
+ * @param      features     One entry per DSP block, filled with the output matrices
+ * @param      matrix_ptrs  One entry per DSP block, owns the output matrices
+ * @param      result       Result passed to stateful DSP blocks
+ *
+ * @return     The ei impulse error.
+ */
+static EI_IMPULSE_ERROR extract_impulse_features(ei_impulse_handle_t *handle,
+                                                 signal_t *signal,
+                                                 ei_feature_t *features,
+                                                 std::unique_ptr<ei::matrix_t> *matrix_ptrs,
+                                                 ei_impulse_result_t *result)
+{
+    size_t out_features_index = 0;
+
+#if EIDSP_PROFILE_MEMORY
+    ei_memory_profile_reset();
+#endif
+
+    for (size_t ix = 0; ix < handle->impulse->dsp_blocks_size; ix++) {
+        ei_model_dsp_t block = handle->impulse->dsp_blocks[ix];
+
+#if EIDSP_PROFILE_MEMORY
+        ei_memory_profile_begin("dsp", block.blockId);
+#endif
+
+        matrix_ptrs[ix] = std::unique_ptr<ei::matrix_t>(new ei::matrix_t(1, block.n_output_features));
+        if (matrix_ptrs[ix] == nullptr) {
+            ei_printf("ERR: Out of memory, can't allocate matrix_ptrs[%lu]\n", (unsigned long)ix);
+            return EI_IMPULSE_ALLOC_FAILED;
+        }
+
+        if (matrix_ptrs[ix]->buffer == nullptr) {
+            ei_printf("ERR: Out of memory, can't allocate matrix_ptrs[%lu]\n", (unsigned long)ix);
+            return EI_IMPULSE_ALLOC_FAILED;
+        }
+
+        features[ix].matrix = matrix_ptrs[ix].get();
+        features[ix].blockId = block.blockId;
+
+        if (out_features_index + block.n_output_features > handle->impulse->nn_input_frame_size) {
+            ei_printf("ERR: Would write outside feature buffer\n");
+            return EI_IMPULSE_DSP_ERROR;
+        }
+
+#if EIDSP_SIGNAL_C_FN_POINTER
+        if (block.axes_size != handle->impulse->raw_samples_per_frame) {
+            ei_printf("ERR: EIDSP_SIGNAL_C_FN_POINTER can only be used when all axes are selected for DSP blocks\n");
+            return EI_IMPULSE_DSP_ERROR;
+        }
+        auto internal_signal = signal;
+#else
+        SignalWithAxes swa(signal, block.axes, block.axes_size, handle->impulse);
+        auto internal_signal = swa.get_signal();
+#endif
+
+        int ret;
+        EI_CLASSIFIER_TRACE_BEGIN("dsp", "extract");
+        if (block.factory) { // ie, if we're using state
+            // Msg user
+            static bool has_printed = false;
+            if (!has_printed) {
+                EI_LOGI("Impulse maintains state. Call run_classifier_init() to reset state (e.g. if data stream is interrupted.)\n");
+                has_printed = true;
+            }
+
+            // getter has a lazy init, so we can just call it
+            auto dsp_handle = handle->state.get_dsp_handle(ix);
+            if(dsp_handle) {
+                ret = dsp_handle->extract(
+                    internal_signal,
+                    features[ix].matrix,
+                    block.config,
+                    handle->impulse->frequency,
+                    result);
+            }
+            else {
+                return EI_IMPULSE_OUT_OF_MEMORY;
+            }
+        } else {
+#if EIDSP_USE_ARENA
+            ei_dsp_arena_begin();
+#endif
+            ret = block.extract_fn(internal_signal, features[ix].matrix, block.config, handle->impulse->frequency);
+#if EIDSP_USE_ARENA
+            ei_dsp_arena_end();
+#endif
+        }
+        EI_CLASSIFIER_TRACE_END("dsp", "extract");
+
+#if EIDSP_PROFILE_MEMORY
+        ei_memory_profile_end();
+#endif
+
+        if (ret != EIDSP_OK) {
+            ei_printf("ERR: Failed to run DSP process (%d)\n", ret);
+            return EI_IMPULSE_DSP_ERROR;
+        }
+
+        if (ei_run_impulse_check_canceled() == EI_IMPULSE_CANCELED) {
+            return EI_IMPULSE_CANCELED;
+        }
+
+        out_features_index += block.n_output_features;
+    }
+
+#if EI_CLASSIFIER_HAS_DATA_NORMALIZATION
+    EI_IMPULSE_ERROR dn_error = run_data_normalization(handle, features);
+    if (dn_error != EI_IMPULSE_OK) {
+        ei_printf("ERR: Failed to run Data Normalization process (%d)\n", dn_error);
+        return dn_error;
+    }
+#endif
+
+    return EI_IMPULSE_OK;
+}
+
 /**
  * @brief      Process a complete impulse
  *
@@ -276,91 +419,24 @@ extern "C" EI_IMPULSE_ERROR process_impulse(ei_impulse_handle_t *handle,
 
     uint64_t dsp_start_us = ei_read_timer_us();
 
-    size_t out_features_index = 0;
-
-    for (size_t ix = 0; ix < handle->impulse->dsp_blocks_size; ix++) {
-        ei_model_dsp_t block = handle->impulse->dsp_blocks[ix];
-
-        matrix_ptrs[ix] = std::unique_ptr<ei::matrix_t>(new ei::matrix_t(1, block.n_output_features));
-        if (matrix_ptrs[ix] == nullptr) {
-            ei_printf("ERR: Out of memory, can't allocate matrix_ptrs[%lu]\n", (unsigned long)ix);
-            return EI_IMPULSE_ALLOC_FAILED;
-        }
-
-        if (matrix_ptrs[ix]->buffer == nullptr) {
-            ei_printf("ERR: Out of memory, can't allocate matrix_ptrs[%lu]\n", (unsigned long)ix);
-            delete[] matrix_ptrs;
-            return EI_IMPULSE_ALLOC_FAILED;
-        }
-
-        features[ix].matrix = matrix_ptrs[ix].get();
-        features[ix].blockId = block.blockId;
-
-        if (out_features_index + block.n_output_features > handle->impulse->nn_input_frame_size) {
-            ei_printf("ERR: Would write outside feature buffer\n");
-            return EI_IMPULSE_DSP_ERROR;
-        }
-
-#if EIDSP_SIGNAL_C_FN_POINTER
-        if (block.axes_size != handle->impulse->raw_samples_per_frame) {
-            ei_printf("ERR: EIDSP_SIGNAL_C_FN_POINTER can only be used when all axes are selected for DSP blocks\n");
-            return EI_IMPULSE_DSP_ERROR;
-        }
-        auto internal_signal = signal;
-#else
-        SignalWithAxes swa(signal, block.axes, block.axes_size, handle->impulse);
-        auto internal_signal = swa.get_signal();
-#endif
-
-        int ret;
-        if (block.factory) { // ie, if we're using state
-            // Msg user
-            static bool has_printed = false;
-            if (!has_printed) {
-                EI_LOGI("Impulse maintains state. Call run_classifier_init() to reset state (e.g. if data stream is interrupted.)\n");
-                has_printed = true;
-            }
-
-            // getter has a lazy init, so we can just call it
-            auto dsp_handle = handle->state.get_dsp_handle(ix);
-            if(dsp_handle) {
-                ret = dsp_handle->extract(
-                    internal_signal,
-                    features[ix].matrix,
-                    block.config,
-                    handle->impulse->frequency,
-                    result);
-            }
-            else {
-                return EI_IMPULSE_OUT_OF_MEMORY;
-            }
-        } else {
-            ret = block.extract_fn(internal_signal, features[ix].matrix, block.config, handle->impulse->frequency);
-        }
-
-        if (ret != EIDSP_OK) {
-            ei_printf("ERR: Failed to run DSP process (%d)\n", ret);
-            return EI_IMPULSE_DSP_ERROR;
-        }
-
-        if (ei_run_impulse_check_canceled() == EI_IMPULSE_CANCELED) {
-            return EI_IMPULSE_CANCELED;
-        }
-
-        out_features_index += block.n_output_features;
-    }
-
-#if EI_CLASSIFIER_HAS_DATA_NORMALIZATION
-    EI_IMPULSE_ERROR dn_error = run_data_normalization(handle, features);
-    if (dn_error != EI_IMPULSE_OK) {
-        ei_printf("ERR: Failed to run Data Normalization process (%d)\n", dn_error);
-        return dn_error;
+    EI_IMPULSE_ERROR dsp_res = extract_impulse_features(handle, signal, features, matrix_ptrs, result);
+    if (dsp_res != EI_IMPULSE_OK) {
+        return dsp_res;
     }
-#endif
 
     result->timing.dsp_us = ei_read_timer_us() - dsp_start_us;
     result->timing.dsp = (int)(result->timing.dsp_us / 1000);
 
+#if EIDSP_USE_ARENA
+    if (debug) {
+        ei_dsp_arena_stats_t arena_stats;
+        ei_dsp_arena_get_stats(&arena_stats);
+        ei_printf("DSP arena: %u / %u bytes high-water, %u allocations, %u heap fallbacks\n",
+            (unsigned)arena_stats.high_water, (unsigned)arena_stats.capacity,
+            (unsigned)arena_stats.allocations, (unsigned)arena_stats.fallbacks);
+    }
+#endif
+
     if (debug) {
         ei_printf("Features (%d ms.): ", result->timing.dsp);
         for (size_t ix = 0; ix < block_num; ix++) {
@@ -383,6 +459,11 @@ extern "C" EI_IMPULSE_ERROR process_impulse(ei_impulse_handle_t *handle,
     return EI_IMPULSE_OK;
 #else
     EI_IMPULSE_ERROR res = run_inference(handle, features, result, debug);
+#if EIDSP_PROFILE_MEMORY
+    if (debug) {
+        ei_memory_profile_print_json();
+    }
+#endif
     if (res != EI_IMPULSE_OK) {
         return res;
     }
@@ -481,9 +562,17 @@ extern "C" EI_IMPULSE_ERROR process_impulse_continuous(ei_impulse_handle_t *hand
 
     size_t out_features_index = 0;
 
+#if EIDSP_PROFILE_MEMORY
+    ei_memory_profile_reset();
+#endif
+
     for (size_t ix = 0; ix < impulse->dsp_blocks_size; ix++) {
         ei_model_dsp_t block = impulse->dsp_blocks[ix];
 
+#if EIDSP_PROFILE_MEMORY
+        ei_memory_profile_begin("dsp", block.blockId);
+#endif
+
         if (out_features_index + block.n_output_features > impulse->nn_input_frame_size) {
             ei_printf("ERR: Would write outside feature buffer\n");
             return EI_IMPULSE_DSP_ERROR;
@@ -510,17 +599,31 @@ extern "C" EI_IMPULSE_ERROR process_impulse_continuous(ei_impulse_handle_t *hand
         }
 
         matrix_size_t features_written;
+        EI_CLASSIFIER_TRACE_BEGIN("dsp", "extract_slice");
 
 #if EIDSP_SIGNAL_C_FN_POINTER
         if (block.axes_size != impulse->raw_samples_per_frame) {
             ei_printf("ERR: EIDSP_SIGNAL_C_FN_POINTER can only be used when all axes are selected for DSP blocks\n");
             return EI_IMPULSE_DSP_ERROR;
         }
+#if EIDSP_USE_ARENA
+        ei_dsp_arena_begin();
+#endif
         int ret = extract_fn_slice(signal, &fm, block.config, impulse->frequency, &features_written);
 #else
         SignalWithAxes swa(signal, block.axes, block.axes_size, impulse);
+#if EIDSP_USE_ARENA
+        ei_dsp_arena_begin();
+#endif
         int ret = extract_fn_slice(swa.get_signal(), &fm, block.config, impulse->frequency, &features_written);
 #endif
+#if EIDSP_USE_ARENA
+        ei_dsp_arena_end();
+#endif
+        EI_CLASSIFIER_TRACE_END("dsp", "extract_slice");
+#if EIDSP_PROFILE_MEMORY
+        ei_memory_profile_end();
+#endif
 
         if (ret != EIDSP_OK) {
             ei_printf("ERR: Failed to run DSP process (%d)\n", ret);
@@ -540,6 +643,22 @@ extern "C" EI_IMPULSE_ERROR process_impulse_continuous(ei_impulse_handle_t *hand
     result->timing.dsp = (int)(result->timing.dsp_us / 1000);
 
     if (classifier_continuous_features_written >= impulse->nn_input_frame_size) {
+#if EI_CLASSIFIER_HAS_CONTINUOUS_QUANTIZED
+        // Shortcut for quantized MFCC models, normalizes the window straight into the input tensor
+        if (can_run_classifier_continuous_quantized(impulse) == EI_IMPULSE_OK) {
+            ei_impulse_error = run_classifier_continuous_quantized(handle, &static_features_matrix, result, debug);
+#if EIDSP_PROFILE_MEMORY
+            if (debug) {
+                ei_memory_profile_print_json();
+            }
+#endif
+            if (ei_impulse_error != EI_IMPULSE_OK) {
+                return ei_impulse_error;
+            }
+            return run_postprocessing(handle, result);
+        }
+#endif // EI_CLASSIFIER_HAS_CONTINUOUS_QUANTIZED
+
         dsp_start_us = ei_read_timer_us();
 
         uint32_t block_num = impulse->dsp_blocks_size + impulse->learning_blocks_size;
@@ -585,6 +704,10 @@ extern "C" EI_IMPULSE_ERROR process_impulse_continuous(ei_impulse_handle_t *hand
                 features[ix].matrix->buffer[m_ix] = static_features_matrix.buffer[out_features_index + m_ix];
             }
 
+            EI_CLASSIFIER_TRACE_BEGIN("dsp", "cmvn");
+#if EIDSP_USE_ARENA
+            ei_dsp_arena_begin();
+#endif
             if (block.extract_fn == extract_mfcc_features) {
                 calc_cepstral_mean_and_var_normalization_mfcc(features[ix].matrix, block.config);
             }
@@ -594,6 +717,10 @@ extern "C" EI_IMPULSE_ERROR process_impulse_continuous(ei_impulse_handle_t *hand
             else if (block.extract_fn == extract_mfe_features) {
                 calc_cepstral_mean_and_var_normalization_mfe(features[ix].matrix, block.config);
             }
+#if EIDSP_USE_ARENA
+            ei_dsp_arena_end();
+#endif
+            EI_CLASSIFIER_TRACE_END("dsp", "cmvn");
             out_features_index += block.n_output_features;
         }
 
@@ -611,6 +738,11 @@ extern "C" EI_IMPULSE_ERROR process_impulse_continuous(ei_impulse_handle_t *hand
         }
 
         ei_impulse_error = run_inference(handle, features, result, debug);
+#if EIDSP_PROFILE_MEMORY
+        if (debug) {
+            ei_memory_profile_print_json();
+        }
+#endif
         if (ei_impulse_error != EI_IMPULSE_OK) {
             return ei_impulse_error;
         }
@@ -680,6 +812,75 @@ extern "C" EI_IMPULSE_ERROR run_classifier_image_quantized(
 
 #endif // #if EI_CLASSIFIER_QUANTIZATION_ENABLED == 1 && (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE || EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TENSAIFLOW || EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_DRPAI)
 
+#if EI_CLASSIFIER_HAS_CONTINUOUS_QUANTIZED
+
+/**
+ * Check if the current impulse could be used by 'run_classifier_continuous_quantized'
+ */
+__attribute__((unused)) static EI_IMPULSE_ERROR can_run_classifier_continuous_quantized(const ei_impulse_t *impulse) {
+
+    // anomaly blocks read the float features
+    if (impulse->has_anomaly || impulse->learning_blocks_size != 1) {
+        return EI_IMPULSE_UNSUPPORTED_INFERENCING_ENGINE;
+    }
+
+    // one MFCC block feeding a quantized tflite graph
+    if (impulse->dsp_blocks_size != 1 || impulse->dsp_blocks[0].extract_fn != extract_mfcc_features) {
+        return EI_IMPULSE_UNSUPPORTED_INFERENCING_ENGINE;
+    }
+
+    ei_learning_block_t block = impulse->learning_blocks[0];
+    if (block.infer_fn != run_nn_inference) {
+        return EI_IMPULSE_UNSUPPORTED_INFERENCING_ENGINE;
+    }
+
+    ei_learning_block_config_tflite_graph_t *block_config = (ei_learning_block_config_tflite_graph_t*)block.config;
+    if (block_config->quantized != 1) {
+        return EI_IMPULSE_UNSUPPORTED_INFERENCING_ENGINE;
+    }
+
+    return EI_IMPULSE_OK;
+}
+
+/**
+ * Run the classifier on the sliding window of continuous MFCC features, normalizing and quantizing
+ * the window straight into the input tensor. This only works if 'can_run_classifier_continuous_quantized'
+ * returns EI_IMPULSE_OK.
+ */
+extern "C" EI_IMPULSE_ERROR run_classifier_continuous_quantized(
+    ei_impulse_handle_t *handle,
+    ei::matrix_t *features_matrix,
+    ei_impulse_result_t *result,
+    bool debug = false)
+{
+    auto impulse = handle->impulse;
+    ei_learning_block_t block = impulse->learning_blocks[0];
+
+#if EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
+    tflite::micro::SetParallelKernelOptions(&handle->parallel_kernels);
+#endif
+#if EIDSP_PROFILE_MEMORY
+    ei_memory_profile_begin("nn", block.blockId);
+#endif
+    EI_CLASSIFIER_TRACE_BEGIN("nn", "inference");
+    EI_IMPULSE_ERROR res = run_nn_inference_mfcc_quantized(impulse, features_matrix, 0, result, block.config, debug);
+    EI_CLASSIFIER_TRACE_END("nn", "inference");
+#if EIDSP_PROFILE_MEMORY
+    ei_memory_profile_end();
+#endif
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+
+    if (ei_run_impulse_check_canceled() == EI_IMPULSE_CANCELED) {
+        return EI_IMPULSE_CANCELED;
+    }
+
+    return EI_IMPULSE_OK;
+}
+
+#endif // EI_CLASSIFIER_HAS_CONTINUOUS_QUANTIZED
+
 #if EI_CLASSIFIER_LOAD_IMAGE_SCALING
 static const float torch_mean[] = { 0.485, 0.456, 0.406 };
 static const float torch_std[] = { 0.229, 0.224, 0.225 };
@@ -817,6 +1018,9 @@ extern "C" void run_classifier_init(void)
     classifier_continuous_features_written = 0;
     ei_dsp_clear_continuous_audio_state();
     init_impulse(&ei_default_impulse);
+#if EIDSP_USE_ARENA
+    ei_dsp_arena_init_for_impulse(ei_default_impulse.impulse);
+#endif
     init_postprocessing(&ei_default_impulse);
 #if EI_CLASSIFIER_HAS_DATA_NORMALIZATION
     init_data_normalization(&ei_default_impulse);
@@ -842,6 +1046,9 @@ __attribute__((unused)) void run_classifier_init(ei_impulse_handle_t *handle)
     classifier_continuous_features_written = 0;
     ei_dsp_clear_continuous_audio_state();
     init_impulse(handle);
+#if EIDSP_USE_ARENA
+    ei_dsp_arena_init_for_impulse(handle->impulse);
+#endif
     init_postprocessing(handle);
 #if EI_CLASSIFIER_HAS_DATA_NORMALIZATION
     init_data_normalization(handle);
@@ -862,11 +1069,17 @@ __attribute__((unused)) void run_classifier_init(ei_impulse_handle_t *handle)
 extern "C" void run_classifier_deinit(void)
 {
     deinit_postprocessing(&ei_default_impulse);
+#if EIDSP_USE_ARENA
+    ei_dsp_arena_deinit();
+#endif
 }
 
 __attribute__((unused)) void run_classifier_deinit(ei_impulse_handle_t *handle)
 {
     deinit_postprocessing(handle);
+#if EIDSP_USE_ARENA
+    ei_dsp_arena_deinit();
+#endif
 #if EI_CLASSIFIER_HAS_DATA_NORMALIZATION
     deinit_data_normalization(handle);
 #endif
@@ -0,0 +1,444 @@
+/*
+ * Copyright (c) 2024 EdgeImpulse Inc.
+ *
+ * Generated by Edge Impulse and licensed under the applicable Edge Impulse
+ * Terms of Service. Community and Professional Terms of Service
+ * (https://edgeimpulse.com/legal/terms-of-service) or Enterprise Terms of
+ * Service (https://edgeimpulse.com/legal/enterprise-terms-of-service),
+ * according to your product plan subscription (the “License”).
+ *
+ * This software, documentation and other associated files (collectively referred
+ * to as the “Software”) is a single SDK variation generated by the Edge Impulse
+ * platform and requires an active paid Edge Impulse subscription to use this
+ * Software for any purpose.
+ *
+ * You may NOT use this Software unless you have an active Edge Impulse subscription
+ * that meets the eligibility requirements for the applicable License, subject to
+ * your full and continued compliance with the terms and conditions of the License,
+ * including without limitation any usage restrictions under the applicable License.
+ *
+ * If you do not have an active Edge Impulse product plan subscription, or if use
+ * of this Software exceeds the usage limitations of your Edge Impulse product plan
+ * subscription, you are not permitted to use this Software and must immediately
+ * delete and erase all copies of this Software within your control or possession.
+ * Edge Impulse reserves all rights and remedies available to enforce its rights.
+ *
+ * Unless required by applicable law or agreed to in writing, the Software is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language governing
+ * permissions, disclaimers and limitations under the License.
+ */
+
+#ifndef _EI_CLASSIFIER_RUN_CLASSIFIER_BATCH_H_
+#define _EI_CLASSIFIER_RUN_CLASSIFIER_BATCH_H_
+
+/**
+ * Batch inference: classify many windows in one call, for offline evaluation, threshold
+ * sweeps or server-side verification of detections reported by devices. Host only (uses
+ * std::thread).
+ *
+ * - run_classifier_batch_features() takes an [N x nn_input_frame_size] feature matrix (row
+ *   major, one row per window, laid out like the DSP output that run_classifier() feeds the
+ *   learning blocks) and runs only the learning and post-processing blocks.
+ * - run_classifier_batch() takes N raw signals. A worker thread runs the DSP for window i+1
+ *   while the calling thread runs inference on window i (EI_CLASSIFIER_BATCH_PIPELINE_DEPTH
+ *   windows in flight; 1 runs them one after another on the calling thread). With the DSP
+ *   arena the worker owns the arena during each DSP scope and inference uses the heap. With
+ *   EIDSP_PROFILE_MEMORY the windows always run one after another, as the profiler keeps
+ *   global state that is not thread safe.
+ *
+ * EON graphs are initialized once per batch instead of once per window. results must hold
+ * count entries and get the same content run_classifier() would produce for each window.
+ *
+ * Example:
+ *
+ *     std::vector<ei_impulse_result_t> results(windows);
+ *     ei_batch_stats_t stats;
+ *     run_classifier_batch_features(&ei_default_impulse, features, windows, results.data(), &stats);
+ *     ei_printf("%u windows/s\n", (unsigned)stats.windows_per_second);
+ */
+
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// DSP output buffers in flight between the DSP worker and the inference thread
+#ifndef EI_CLASSIFIER_BATCH_PIPELINE_DEPTH
+#define EI_CLASSIFIER_BATCH_PIPELINE_DEPTH      2
+#endif
+
+typedef struct {
+    size_t windows;             // windows classified
+    uint64_t total_us;          // wall time of the batch
+    uint64_t dsp_us;            // DSP time summed over windows (overlaps with nn_us when pipelined)
+    uint64_t nn_us;             // inference and post-processing time summed over windows
+    float windows_per_second;
+} ei_batch_stats_t;
+
+/**
+ * DSP output of one window: one matrix per DSP block
+ */
+class ei_batch_features_t {
+public:
+    ei_batch_features_t(const ei_impulse_t *impulse)
+        : block_num(impulse->dsp_blocks_size)
+        , features(new ei_feature_t[impulse->dsp_blocks_size])
+        , matrices(new std::unique_ptr<ei::matrix_t>[impulse->dsp_blocks_size]) {
+        memset(features.get(), 0, sizeof(ei_feature_t) * block_num);
+    }
+
+    size_t block_num;
+    std::unique_ptr<ei_feature_t[]> features;
+    std::unique_ptr<std::unique_ptr<ei::matrix_t>[]> matrices;
+};
+
+/**
+ * Clear a result the way process_impulse() does
+ */
+static void ei_batch_reset_result(ei_impulse_handle_t *handle, ei_impulse_result_t *result,
+                                  ei_impulse_result_classification_t *classification) {
+    memset(result, 0, sizeof(ei_impulse_result_t));
+#if EI_IMPULSE_RESULT_CLASSIFICATION_IS_STATICALLY_ALLOCATED == 0
+    result->classification = classification;
+#else
+    (void)handle;
+    (void)classification;
+#endif
+}
+
+/**
+ * Per-window classification arrays for impulses without a statically allocated
+ * classification field; valid until the next batch call
+ */
+static ei_impulse_result_classification_t* ei_batch_classification(ei_impulse_handle_t *handle, size_t window, size_t count) {
+#if EI_IMPULSE_RESULT_CLASSIFICATION_IS_STATICALLY_ALLOCATED == 0
+    static std::vector<ei_impulse_result_classification_t> classification_results;
+#ifdef EI_DSP_RESULT_OVERRIDE
+    const size_t label_count = EI_DSP_RESULT_OVERRIDE;
+#else
+    const size_t label_count = handle->impulse->label_count;
+#endif
+    if (window == 0) {
+        classification_results.assign(label_count * count, ei_impulse_result_classification_t());
+        for (size_t ix = 0; ix < classification_results.size(); ix++) {
+#ifdef EI_DSP_RESULT_OVERRIDE
+            classification_results[ix].label = "";
+#else
+            classification_results[ix].label = handle->impulse->categories[ix % label_count];
+#endif
+        }
+    }
+    return classification_results.data() + window * label_count;
+#else
+    (void)handle;
+    (void)window;
+    (void)count;
+    return nullptr;
+#endif
+}
+
+/**
+ * Initialize (prepare = true) or reset the EON graphs of all learning blocks, so that
+ * the windows of a batch share one initialized graph
+ */
+static EI_IMPULSE_ERROR ei_batch_prepare_graphs(const ei_impulse_t *impulse, bool prepare) {
+#if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED == 1)
+    for (size_t ix = 0; ix < impulse->learning_blocks_size; ix++) {
+        const ei_learning_block_t &block = impulse->learning_blocks[ix];
+        if (block.infer_fn != run_nn_inference) {
+            continue;
+        }
+        const ei_config_tflite_eon_graph_t *graph_config = (const ei_config_tflite_eon_graph_t*)
+            ((ei_learning_block_config_tflite_graph_t*)block.config)->graph_config;
+        if (!prepare) {
+            ei_eon_release_graph(graph_config);
+            continue;
+        }
+        EI_IMPULSE_ERROR res = ei_eon_prepare_graph(graph_config);
+        if (res != EI_IMPULSE_OK) {
+            ei_batch_prepare_graphs(impulse, false);
+            return res;
+        }
+    }
+#else
+    (void)impulse;
+    (void)prepare;
+#endif
+    return EI_IMPULSE_OK;
+}
+
+/**
+ * Run the learning and post-processing blocks for one window
+ */
+static EI_IMPULSE_ERROR ei_batch_run_nn(ei_impulse_handle_t *handle, ei_feature_t *features,
+                                        ei_impulse_result_t *result, bool debug) {
+    uint8_t num_results = handle->impulse->output_tensors_size;
+    std::unique_ptr<ei_feature_t[]> raw_results_ptr(new ei_feature_t[num_results]);
+    result->_raw_outputs = raw_results_ptr.get();
+    memset(result->_raw_outputs, 0, sizeof(ei_feature_t) * num_results);
+
+    EI_IMPULSE_ERROR res = run_inference(handle, features, result, debug);
+    if (res == EI_IMPULSE_OK) {
+        res = run_postprocessing(handle, result);
+    }
+    result->_raw_outputs = nullptr;
+    return res;
+}
+
+static void ei_batch_finish_stats(ei_batch_stats_t *stats, size_t windows, uint64_t start_us, bool debug) {
+    stats->windows = windows;
+    stats->total_us = ei_read_timer_us() - start_us;
+    stats->windows_per_second = stats->total_us > 0 ?
+        (float)windows * 1000000.0f / (float)stats->total_us : 0.0f;
+    if (debug) {
+        ei_printf("Batch: %u windows in %u ms (DSP %u ms, NN %u ms), ", (unsigned)windows,
+            (unsigned)(stats->total_us / 1000), (unsigned)(stats->dsp_us / 1000),
+            (unsigned)(stats->nn_us / 1000));
+        ei_printf_float(stats->windows_per_second);
+        ei_printf(" windows/s\n");
+    }
+}
+
+/**
+ * @brief      Classify a batch of feature windows
+ *
+ * @param      handle    Impulse handle
+ * @param      features  count x nn_input_frame_size features, row major
+ * @param      count     Number of windows
+ * @param      results   Output, count entries
+ * @param      stats     Optional throughput statistics
+ * @param[in]  debug     Debug output enable (per window, and the batch summary)
+ *
+ * @return     The ei impulse error of the first window that failed, the batch stops there
+ */
+__attribute__((unused)) static EI_IMPULSE_ERROR run_classifier_batch_features(
+    ei_impulse_handle_t *handle,
+    const float *features,
+    size_t count,
+    ei_impulse_result_t *results,
+    ei_batch_stats_t *stats = nullptr,
+    bool debug = false)
+{
+    if ((handle == nullptr) || (handle->impulse == nullptr) || (features == nullptr) || (results == nullptr)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    const ei_impulse_t *impulse = handle->impulse;
+
+    ei_batch_stats_t local_stats = { };
+    if (stats == nullptr) {
+        stats = &local_stats;
+    }
+    memset(stats, 0, sizeof(ei_batch_stats_t));
+    uint64_t start_us = ei_read_timer_us();
+
+    // each DSP block's slice of a row, copied so learning blocks may scale it in place
+    ei_batch_features_t window(impulse);
+    size_t offset = 0;
+    for (size_t ix = 0; ix < window.block_num; ix++) {
+        size_t cols = impulse->dsp_blocks[ix].n_output_features;
+        if (offset + cols > impulse->nn_input_frame_size) {
+            ei_printf("ERR: Would read outside feature row\n");
+            return EI_IMPULSE_DSP_ERROR;
+        }
+        window.matrices[ix].reset(new ei::matrix_t(1, cols));
+        if (window.matrices[ix]->buffer == nullptr) {
+            return EI_IMPULSE_ALLOC_FAILED;
+        }
+        window.features[ix].matrix = window.matrices[ix].get();
+        window.features[ix].blockId = impulse->dsp_blocks[ix].blockId;
+        offset += cols;
+    }
+
+    EI_IMPULSE_ERROR res = ei_batch_prepare_graphs(impulse, true);
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+
+    size_t done = 0;
+    for (; done < count; done++) {
+        const float *row = features + done * impulse->nn_input_frame_size;
+        offset = 0;
+        for (size_t ix = 0; ix < window.block_num; ix++) {
+            memcpy(window.matrices[ix]->buffer, row + offset, window.matrices[ix]->cols * sizeof(float));
+            offset += window.matrices[ix]->cols;
+        }
+
+        ei_batch_reset_result(handle, &results[done], ei_batch_classification(handle, done, count));
+        uint64_t nn_start_us = ei_read_timer_us();
+        res = ei_batch_run_nn(handle, window.features.get(), &results[done], debug);
+        stats->nn_us += ei_read_timer_us() - nn_start_us;
+        if (res != EI_IMPULSE_OK) {
+            break;
+        }
+    }
+
+    ei_batch_prepare_graphs(impulse, false);
+    ei_batch_finish_stats(stats, done, start_us, debug);
+    return res;
+}
+
+/**
+ * @brief      Run the full impulse over a batch of signals, DSP of the next window
+ *             overlapping inference of the current one
+ *
+ * @param      handle   Impulse handle
+ * @param      signals  count signals, each like the one passed to run_classifier()
+ * @param      count    Number of windows
+ * @param      results  Output, count entries
+ * @param      stats    Optional throughput statistics
+ * @param[in]  debug    Debug output enable (per window, and the batch summary)
+ *
+ * @return     The ei impulse error of the first window that failed, the batch stops there
+ */
+__attribute__((unused)) static EI_IMPULSE_ERROR run_classifier_batch(
+    ei_impulse_handle_t *handle,
+    signal_t *signals,
+    size_t count,
+    ei_impulse_result_t *results,
+    ei_batch_stats_t *stats = nullptr,
+    bool debug = false)
+{
+    if ((handle == nullptr) || (handle->impulse == nullptr) || (signals == nullptr) || (results == nullptr)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    const ei_impulse_t *impulse = handle->impulse;
+
+    ei_batch_stats_t local_stats = { };
+    if (stats == nullptr) {
+        stats = &local_stats;
+    }
+    memset(stats, 0, sizeof(ei_batch_stats_t));
+    uint64_t start_us = ei_read_timer_us();
+
+    EI_IMPULSE_ERROR res = ei_batch_prepare_graphs(impulse, true);
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+
+    // the memory profiler keeps one begin/end stack, DSP and NN must not interleave with it
+    const size_t depth = (EIDSP_PROFILE_MEMORY || count < 2 || EI_CLASSIFIER_BATCH_PIPELINE_DEPTH < 2) ?
+        1 : EI_CLASSIFIER_BATCH_PIPELINE_DEPTH;
+    std::vector<std::unique_ptr<ei_batch_features_t>> slots;
+    std::vector<EI_IMPULSE_ERROR> slot_res(depth, EI_IMPULSE_OK);
+    for (size_t ix = 0; ix < depth; ix++) {
+        slots.emplace_back(new ei_batch_features_t(impulse));
+    }
+
+    auto extract = [&](size_t window) {
+        ei_batch_features_t *slot = slots[window % depth].get();
+        ei_batch_reset_result(handle, &results[window], ei_batch_classification(handle, window, count));
+        uint64_t dsp_start_us = ei_read_timer_us();
+        EI_IMPULSE_ERROR dsp_res = extract_impulse_features(handle, &signals[window],
+            slot->features.get(), slot->matrices.get(), &results[window]);
+        results[window].timing.dsp_us = ei_read_timer_us() - dsp_start_us;
+        results[window].timing.dsp = (int)(results[window].timing.dsp_us / 1000);
+        stats->dsp_us += results[window].timing.dsp_us;
+        slot_res[window % depth] = dsp_res;
+    };
+
+    size_t done = 0;
+    if (depth == 1) {
+        for (; done < count; done++) {
+            extract(done);
+            res = slot_res[0];
+            if (res != EI_IMPULSE_OK) {
+                break;
+            }
+            uint64_t nn_start_us = ei_read_timer_us();
+            res = ei_batch_run_nn(handle, slots[0]->features.get(), &results[done], debug);
+            stats->nn_us += ei_read_timer_us() - nn_start_us;
+            if (res != EI_IMPULSE_OK) {
+                break;
+            }
+        }
+    }
+    else {
+        // windows [consumed, produced) hold DSP output waiting for inference
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t produced = 0;
+        size_t consumed = 0;
+        bool abort = false;
+
+        std::thread dsp_worker([&]() {
+            for (size_t window = 0; window < count; window++) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [&]() { return abort || window - consumed < depth; });
+                    if (abort) {
+                        return;
+                    }
+                }
+                extract(window);
+                bool failed = slot_res[window % depth] != EI_IMPULSE_OK;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    produced = window + 1;
+                }
+                cv.notify_all();
+                if (failed) {
+                    return;
+                }
+            }
+        });
+
+        for (; done < count; done++) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]() { return produced > done; });
+            }
+            res = slot_res[done % depth];
+            if (res == EI_IMPULSE_OK) {
+                uint64_t nn_start_us = ei_read_timer_us();
+                res = ei_batch_run_nn(handle, slots[done % depth]->features.get(), &results[done], debug);
+                stats->nn_us += ei_read_timer_us() - nn_start_us;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                consumed = done + 1;
+                abort = res != EI_IMPULSE_OK;
+            }
+            cv.notify_all();
+            if (res != EI_IMPULSE_OK) {
+                break;
+            }
+        }
+        dsp_worker.join();
+    }
+
+    ei_batch_prepare_graphs(impulse, false);
+    ei_batch_finish_stats(stats, done, start_us, debug);
+    return res;
+}
+
+/**
+ * @brief      Classify a batch of feature windows with the default impulse
+ */
+__attribute__((unused)) static EI_IMPULSE_ERROR run_classifier_batch_features(
+    const float *features,
+    size_t count,
+    ei_impulse_result_t *results,
+    ei_batch_stats_t *stats = nullptr,
+    bool debug = false)
+{
+    return run_classifier_batch_features(&ei_default_impulse, features, count, results, stats, debug);
+}
+
+/**
+ * @brief      Run the default impulse over a batch of signals
+ */
+__attribute__((unused)) static EI_IMPULSE_ERROR run_classifier_batch(
+    signal_t *signals,
+    size_t count,
+    ei_impulse_result_t *results,
+    ei_batch_stats_t *stats = nullptr,
+    bool debug = false)
+{
+    return run_classifier_batch(&ei_default_impulse, signals, count, results, stats, debug);
+}
+
+#endif // _EI_CLASSIFIER_RUN_CLASSIFIER_BATCH_H_
@@ -285,6 +285,102 @@ __attribute__((unused)) int extract_mfcc_features(signal_t *signal, matrix_t *ou
 }
 
 
+#if EIDSP_USE_ARENA
+/**
+ * Worst-case DSP arena usage of extract_mfcc_features() for a signal.
+ * MFCC runs in three phases whose scratch buffers never overlap in time:
+ * the MFE frame loop, the per-row DCT and the sliding-window CMVN. The arena
+ * needs to hold the largest one, plus the block headers.
+ */
+__attribute__((unused)) static size_t ei_dsp_arena_size_mfcc(const ei_dsp_config_mfcc_t *config,
+    size_t signal_length, const float sampling_frequency)
+{
+    const uint32_t frequency = static_cast<uint32_t>(sampling_frequency);
+    matrix_size_t out_matrix_size = speechpy::feature::calculate_mfcc_buffer_size(
+        signal_length, frequency, config->frame_length, config->frame_stride, config->num_cepstral,
+        config->implementation_version);
+
+    auto block = [](size_t bytes) -> size_t {
+        return 16 + ((bytes + 15) & ~(size_t)15);
+    };
+
+    const size_t rows = out_matrix_size.rows;
+    const size_t num_filters = config->num_filters;
+    const size_t fft_out = config->fft_length / 2 + 1;
+    const size_t frame_samples = static_cast<size_t>(ceil(config->frame_length * sampling_frequency)) + 1;
+    const size_t pad = (config->win_size - 1) / 2;
+
+    // preemphasis history lives across the whole block
+    size_t common = 2 * block(config->pre_shift * sizeof(float));
+
+    // MFE: features + energies + frame offsets + mels + power spectrum + frame + rfft output and input
+    size_t mfe = block(rows * num_filters * sizeof(float)) + block(rows * sizeof(float)) +
+        block(rows * sizeof(uint32_t)) +
+        block((num_filters + 2) * sizeof(float)) + block(fft_out * sizeof(float)) +
+        block(frame_samples * sizeof(float)) + block(fft_out * sizeof(fft_complex_t)) +
+        block(config->fft_length * sizeof(float));
+
+    // DCT over each row of the filterbank energies
+    size_t dct = block(rows * num_filters * sizeof(float)) + block(rows * sizeof(float)) +
+        block((num_filters / 2 + 1) * sizeof(fft_complex_t)) + 2 * block(num_filters * sizeof(float));
+
+    // CMVN: padded copy + mean + variance
+    size_t cmvn = block((rows + 2 * pad) * config->num_cepstral * sizeof(float)) +
+        2 * block(config->num_cepstral * sizeof(float));
+
+    size_t peak = mfe;
+    if (dct > peak) {
+        peak = dct;
+    }
+    if (cmvn > peak) {
+        peak = cmvn;
+    }
+    return common + peak;
+}
+
+// Extra room on top of the MFCC estimate, for buffers it doesn't model (e.g. a
+// temporary kissfft config when the FFT plan pool is exhausted)
+#ifndef EI_DSP_ARENA_HEADROOM_PERCENT
+#define EI_DSP_ARENA_HEADROOM_PERCENT 25
+#endif
+
+/**
+ * Reserve the DSP arena for an impulse. The size is EI_DSP_ARENA_SIZE if
+ * defined, otherwise the largest MFCC block estimate plus
+ * EI_DSP_ARENA_HEADROOM_PERCENT. DSP blocks without an estimate use whatever
+ * fits and fall back to the heap for the rest.
+ */
+__attribute__((unused)) static int ei_dsp_arena_init_for_impulse(const ei_impulse_t *impulse)
+{
+#ifdef EI_DSP_ARENA_SIZE
+    size_t size = EI_DSP_ARENA_SIZE;
+#else
+    size_t size = 0;
+    for (size_t ix = 0; ix < impulse->dsp_blocks_size; ix++) {
+        const ei_model_dsp_t *block = &impulse->dsp_blocks[ix];
+        if (block->extract_fn != extract_mfcc_features) {
+            continue;
+        }
+        size_t block_size = ei_dsp_arena_size_mfcc((ei_dsp_config_mfcc_t *)block->config,
+            impulse->raw_sample_count, impulse->frequency);
+        if (block_size > size) {
+            size = block_size;
+        }
+    }
+    size += size * EI_DSP_ARENA_HEADROOM_PERCENT / 100;
+#endif
+
+    size = (size + 15) & ~(size_t)15;
+
+    ei_dsp_arena_stats_t stats;
+    ei_dsp_arena_get_stats(&stats);
+    if (size == 0 || stats.capacity >= size) {
+        return EIDSP_OK;
+    }
+    return ei_dsp_arena_init(NULL, size);
+}
+#endif // EIDSP_USE_ARENA
+
 __attribute__((unused)) static int extract_mfcc_run_slice(signal_t *signal, matrix_t *output_matrix, ei_dsp_config_mfcc_t *config, const float sampling_frequency, matrix_size_t *matrix_size_out, int implementation_version) {
     uint32_t frequency = (uint32_t)sampling_frequency;
 
@@ -1443,6 +1539,33 @@ __attribute__((unused)) void calc_cepstral_mean_and_var_normalization_mfcc(ei_ma
     matrix->cols = original_matrix_size;
 }
 
+/**
+ * @brief      Calculates the cepstral mean and variable normalization and quantizes the
+ *             result to int8, without modifying the source matrix.
+ *
+ * @param      matrix         Source matrix (MFCC features)
+ * @param      output_matrix  Destination matrix, e.g. mapped on an int8 input tensor
+ * @param      config_ptr     ei_dsp_config_mfcc_t struct pointer
+ * @param      scale          Quantization scale of the destination
+ * @param      zero_point     Quantization zero point of the destination
+ *
+ * @return     EIDSP_OK if successful
+ */
+__attribute__((unused)) int calc_cepstral_mean_and_var_normalization_mfcc_quantized(ei_matrix *matrix, matrix_i8_t *output_matrix,
+                                                                                     void *config_ptr, float scale, int32_t zero_point)
+{
+    ei_dsp_config_mfcc_t *config = (ei_dsp_config_mfcc_t *)config_ptr;
+
+    /* Normalize a view of the matrix with one row per frame */
+    matrix_t frames(matrix->rows * matrix->cols / config->num_cepstral, config->num_cepstral, matrix->buffer);
+
+    int ret = speechpy::processing::cmvnw_quantized(&frames, output_matrix, config->win_size, true, scale, zero_point);
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: cmvnw failed (%d)\n", ret);
+    }
+    return ret;
+}
+
 /**
  * @brief      Calculates the cepstral mean and variable normalization.
  *
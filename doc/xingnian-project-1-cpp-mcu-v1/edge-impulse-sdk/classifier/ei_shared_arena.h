@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2024 EdgeImpulse Inc.
+ *
+ * Generated by Edge Impulse and licensed under the applicable Edge Impulse
+ * Terms of Service. Community and Professional Terms of Service
+ * (https://edgeimpulse.com/legal/terms-of-service) or Enterprise Terms of
+ * Service (https://edgeimpulse.com/legal/enterprise-terms-of-service),
+ * according to your product plan subscription (the “License”).
+ *
+ * This software, documentation and other associated files (collectively referred
+ * to as the “Software”) is a single SDK variation generated by the Edge Impulse
+ * platform and requires an active paid Edge Impulse subscription to use this
+ * Software for any purpose.
+ *
+ * You may NOT use this Software unless you have an active Edge Impulse subscription
+ * that meets the eligibility requirements for the applicable License, subject to
+ * your full and continued compliance with the terms and conditions of the License,
+ * including without limitation any usage restrictions under the applicable License.
+ *
+ * If you do not have an active Edge Impulse product plan subscription, or if use
+ * of this Software exceeds the usage limitations of your Edge Impulse product plan
+ * subscription, you are not permitted to use this Software and must immediately
+ * delete and erase all copies of this Software within your control or possession.
+ * Edge Impulse reserves all rights and remedies available to enforce its rights.
+ *
+ * Unless required by applicable law or agreed to in writing, the Software is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language governing
+ * permissions, disclaimers and limitations under the License.
+ */
+
+#ifndef _EI_CLASSIFIER_SHARED_ARENA_H_
+#define _EI_CLASSIFIER_SHARED_ARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "edge-impulse-sdk/classifier/ei_aligned_malloc.h"
+#include "edge-impulse-sdk/classifier/ei_model_types.h"
+#include "edge-impulse-sdk/dsp/memory.hpp"
+#include "edge-impulse-sdk/dsp/returntypes.h"
+#include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+
+/**
+ * Shared tensor arena for several EON compiled graphs
+ *
+ * Every compiled graph normally allocates its own tensor arena in init and frees it in reset.
+ * When an application runs several graphs (e.g. a VAD and a KWS model, or several keyword
+ * models), only graphs that can execute at the same time need separate memory. Graphs are
+ * registered with the range of phases in which they may run; graphs whose phase ranges
+ * overlap get disjoint regions, all others are overlaid. The layout is computed with the
+ * TFLM greedy memory planner, each graph's arena being one buffer with a phase lifetime.
+ *
+ * The EON runtime re-creates persistent buffers (kernel op data, scratch buffers) at the top
+ * of the graph arena on every init. A graph's arena is therefore live from model_init to
+ * model_reset and holds nothing the next init needs, which is what allows whole arenas to
+ * be overlaid. Persistent buffers that do not fit are put on the heap as before.
+ *
+ * tflite_eon.h normally runs init -> invoke -> reset for every inference, so the arena is
+ * only live during one inference. A graph prepared with ei_eon_prepare_graph() (the batch
+ * API in ei_run_classifier_batch.h) stays initialized until ei_eon_release_graph(). Its
+ * arena is live for that whole window, across all inferences of the batch.
+ *
+ * Graphs with overlapping regions must never have live arenas at the same time; that is the
+ * contract expressed by the phases. For a prepared graph it covers the whole prepare ->
+ * release window, not only the individual inferences: ei_eon_prepare_graph() refuses a graph
+ * whose region overlaps one that is still prepared. Requires the graphs to be built with
+ * heap arena allocation.
+ *
+ *     ei_shared_arena_add(&ei_config_graph_vad, 0, 1);   // VAD runs all the time
+ *     ei_shared_arena_add(&ei_config_graph_kws_a, 0, 0); // the KWS models run one after
+ *     ei_shared_arena_add(&ei_config_graph_kws_b, 1, 1); // another, next to the VAD
+ *     ei_shared_arena_plan();
+ */
+
+// Maximum number of graphs sharing the arena
+#ifndef EI_SHARED_ARENA_MAX_GRAPHS
+#define EI_SHARED_ARENA_MAX_GRAPHS      8
+#endif
+
+typedef struct {
+    const ei_config_tflite_eon_graph_t *graph;
+    int first_phase;
+    int last_phase;
+    size_t arena_size;      // graph arena size, rounded up to 16 bytes
+    size_t offset;          // planned offset in the shared arena
+} ei_shared_arena_graph_t;
+
+typedef struct {
+    ei_shared_arena_graph_t graphs[EI_SHARED_ARENA_MAX_GRAPHS];
+    size_t graph_count;
+    uint8_t *arena;
+    size_t arena_size;
+    bool owns_arena;
+} ei_shared_arena_t;
+
+inline ei_shared_arena_t& ei_shared_arena_state() {
+    static ei_shared_arena_t state;
+    return state;
+}
+
+/**
+ * Register a graph. Must be called before ei_shared_arena_plan().
+ * @param graph EON graph config (model_arena_size and model_bind_arena are required)
+ * @param first_phase First phase in which the graph may run
+ * @param last_phase Last phase in which the graph may run (inclusive)
+ */
+inline EI_IMPULSE_ERROR ei_shared_arena_add(const ei_config_tflite_eon_graph_t *graph,
+                                            int first_phase, int last_phase) {
+    ei_shared_arena_t& state = ei_shared_arena_state();
+    if (!graph || !graph->model_arena_size || !graph->model_bind_arena ||
+            first_phase < 0 || last_phase < first_phase) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (state.arena) {
+        ei_printf("ERR: shared arena is already planned, call ei_shared_arena_release() first\n");
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (state.graph_count >= EI_SHARED_ARENA_MAX_GRAPHS) {
+        ei_printf("ERR: too many graphs for the shared arena (max %d)\n", EI_SHARED_ARENA_MAX_GRAPHS);
+        return EI_IMPULSE_OUT_OF_MEMORY;
+    }
+
+    ei_shared_arena_graph_t *g = &state.graphs[state.graph_count++];
+    g->graph = graph;
+    g->first_phase = first_phase;
+    g->last_phase = last_phase;
+    g->arena_size = (graph->model_arena_size() + 15) & ~(size_t)15;
+    g->offset = 0;
+    return EI_IMPULSE_OK;
+}
+
+/**
+ * Unbind all graphs and free the shared arena (if it was allocated by ei_shared_arena_plan).
+ * The registrations are dropped as well.
+ */
+inline void ei_shared_arena_release() {
+    ei_shared_arena_t& state = ei_shared_arena_state();
+    for (size_t ix = 0; ix < state.graph_count; ix++) {
+        state.graphs[ix].graph->model_bind_arena(nullptr);
+    }
+    if (state.owns_arena) {
+        ei_aligned_free(state.arena);
+    }
+    state.graph_count = 0;
+    state.arena = nullptr;
+    state.arena_size = 0;
+    state.owns_arena = false;
+}
+
+/**
+ * Plan the layout and bind every registered graph to its region.
+ * @param buffer Optional 16-byte aligned memory for the arena; allocated if nullptr
+ * @param buffer_size Size of buffer, at least the planned size
+ */
+inline EI_IMPULSE_ERROR ei_shared_arena_plan(uint8_t *buffer = nullptr, size_t buffer_size = 0) {
+    ei_shared_arena_t& state = ei_shared_arena_state();
+    if (state.graph_count == 0 || state.arena) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    // the planner works on its own scratch memory, only needed while planning
+    size_t scratch_size = state.graph_count * tflite::GreedyMemoryPlanner::per_buffer_size();
+    ei_unique_ptr_t planner_scratch(ei_malloc(scratch_size), ei_free);
+    if (!planner_scratch) {
+        return EI_IMPULSE_ALLOC_FAILED;
+    }
+    size_t arena_size;
+    {
+        tflite::GreedyMemoryPlanner planner;
+        if (planner.Init((unsigned char*)planner_scratch.get(), (int)scratch_size) != kTfLiteOk) {
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+        for (size_t ix = 0; ix < state.graph_count; ix++) {
+            const ei_shared_arena_graph_t *g = &state.graphs[ix];
+            if (planner.AddBuffer((int)g->arena_size, g->first_phase, g->last_phase) != kTfLiteOk) {
+                return EI_IMPULSE_INFERENCE_ERROR;
+            }
+        }
+
+        // sizes are multiples of 16, so every offset stays 16-byte aligned
+        arena_size = planner.GetMaximumMemorySize();
+        for (size_t ix = 0; ix < state.graph_count; ix++) {
+            int offset;
+            if (planner.GetOffsetForBuffer((int)ix, &offset) != kTfLiteOk) {
+                return EI_IMPULSE_INFERENCE_ERROR;
+            }
+            state.graphs[ix].offset = (size_t)offset;
+        }
+    }
+
+    if (buffer) {
+        if (buffer_size < arena_size || (uintptr_t)buffer % 16 != 0) {
+            ei_printf("ERR: shared arena buffer too small or unaligned (need %u bytes)\n",
+                (unsigned)arena_size);
+            return EI_IMPULSE_TFLITE_ARENA_ALLOC_FAILED;
+        }
+        state.arena = buffer;
+        state.owns_arena = false;
+    }
+    else {
+        state.arena = (uint8_t*)ei_aligned_calloc(16, arena_size);
+        if (!state.arena) {
+            return EI_IMPULSE_TFLITE_ARENA_ALLOC_FAILED;
+        }
+        state.owns_arena = true;
+    }
+    state.arena_size = arena_size;
+
+    for (size_t ix = 0; ix < state.graph_count; ix++) {
+        const ei_shared_arena_graph_t *g = &state.graphs[ix];
+        if (g->graph->model_bind_arena(state.arena + g->offset) != kTfLiteOk) {
+            ei_printf("ERR: graph %u cannot use an external arena (static allocation?)\n",
+                (unsigned)ix);
+            ei_shared_arena_release();
+            return EI_IMPULSE_TFLITE_ERROR;
+        }
+    }
+    return EI_IMPULSE_OK;
+}
+
+/**
+ * Whether two graphs were given overlapping regions of the planned shared arena.
+ * False if the arena is not planned or either graph is not registered.
+ */
+inline bool ei_shared_arena_regions_overlap(const ei_config_tflite_eon_graph_t *a,
+                                            const ei_config_tflite_eon_graph_t *b) {
+    const ei_shared_arena_t& state = ei_shared_arena_state();
+    if (!state.arena || a == b) {
+        return false;
+    }
+    const ei_shared_arena_graph_t *ga = nullptr;
+    const ei_shared_arena_graph_t *gb = nullptr;
+    for (size_t ix = 0; ix < state.graph_count; ix++) {
+        if (state.graphs[ix].graph == a) {
+            ga = &state.graphs[ix];
+        }
+        if (state.graphs[ix].graph == b) {
+            gb = &state.graphs[ix];
+        }
+    }
+    if (!ga || !gb) {
+        return false;
+    }
+    return ga->offset < gb->offset + gb->arena_size && gb->offset < ga->offset + ga->arena_size;
+}
+
+/**
+ * Size of the shared arena, 0 if not planned.
+ */
+inline size_t ei_shared_arena_get_size() {
+    return ei_shared_arena_state().arena_size;
+}
+
+/**
+ * Sum of the separate arenas of all registered graphs.
+ */
+inline size_t ei_shared_arena_get_separate_size() {
+    const ei_shared_arena_t& state = ei_shared_arena_state();
+    size_t total = 0;
+    for (size_t ix = 0; ix < state.graph_count; ix++) {
+        total += state.graphs[ix].arena_size;
+    }
+    return total;
+}
+
+/**
+ * Print the layout and the RAM saved compared to separate arenas.
+ */
+inline void ei_shared_arena_print_report() {
+    const ei_shared_arena_t& state = ei_shared_arena_state();
+    for (size_t ix = 0; ix < state.graph_count; ix++) {
+        const ei_shared_arena_graph_t *g = &state.graphs[ix];
+        ei_printf("graph %u: phases %d-%d, offset %u, size %u\n", (unsigned)ix, g->first_phase,
+            g->last_phase, (unsigned)g->offset, (unsigned)g->arena_size);
+    }
+    size_t separate = ei_shared_arena_get_separate_size();
+    ei_printf("shared arena: %u bytes, separate arenas: %u bytes, saved: %u bytes\n",
+        (unsigned)state.arena_size, (unsigned)separate,
+        (unsigned)(separate > state.arena_size ? separate - state.arena_size : 0));
+}
+
+#endif // _EI_CLASSIFIER_SHARED_ARENA_H_
@@ -56,6 +56,19 @@ public:
         }
 
         wrapped_signal.total_length = _range_end - _range_start;
+        // a range of a contiguous signal is still contiguous
+        switch (_original_signal->span_type) {
+            case EI_SIGNAL_SPAN_FLOAT:
+                wrapped_signal.span_data = static_cast<const float *>(_original_signal->span_data) + _range_start;
+                break;
+            case EI_SIGNAL_SPAN_INT16:
+                wrapped_signal.span_data = static_cast<const int16_t *>(_original_signal->span_data) + _range_start;
+                break;
+            default:
+                wrapped_signal.span_data = nullptr;
+                break;
+        }
+        wrapped_signal.span_type = _original_signal->span_type;
 #ifdef __MBED__
         wrapped_signal.get_data = mbed::callback(this, &SignalWithRange::get_data);
 #else
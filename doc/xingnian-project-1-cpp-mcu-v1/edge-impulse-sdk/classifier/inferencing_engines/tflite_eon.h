@@ -40,9 +40,79 @@
 #include "edge-impulse-sdk/tensorflow/lite/c/common.h"
 #include "edge-impulse-sdk/tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "edge-impulse-sdk/classifier/ei_aligned_malloc.h"
+#include "edge-impulse-sdk/classifier/ei_classifier_config.h"
 #include "edge-impulse-sdk/classifier/ei_model_types.h"
 #include "edge-impulse-sdk/classifier/inferencing_engines/tflite_helper.h"
 #include "edge-impulse-sdk/classifier/ei_run_dsp.h"
+#include "edge-impulse-sdk/classifier/ei_shared_arena.h"
+#if EI_CLASSIFIER_PROFILE_LAYERS
+#include "edge-impulse-sdk/classifier/ei_layer_profiler.h"
+#endif
+
+// Graphs kept initialized across inferences (see ei_run_classifier_batch.h). For these
+// the inference functions skip model_init / model_reset and only re-fetch the tensors.
+#ifndef EI_EON_MAX_PREPARED_GRAPHS
+#define EI_EON_MAX_PREPARED_GRAPHS      4
+#endif
+
+static const ei_config_tflite_eon_graph_t *ei_eon_prepared_graphs[EI_EON_MAX_PREPARED_GRAPHS];
+
+static bool ei_eon_graph_is_prepared(const ei_config_tflite_eon_graph_t *graph_config) {
+    for (size_t ix = 0; ix < EI_EON_MAX_PREPARED_GRAPHS; ix++) {
+        if (ei_eon_prepared_graphs[ix] == graph_config) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Initialize a graph once and keep it initialized until ei_eon_release_graph()
+ * A prepared graph keeps its arena live, so with a shared arena (ei_shared_arena.h) a graph
+ * whose region overlaps one that is already prepared is refused.
+ *
+ * @param      graph_config  EON graph
+ *
+ * @return  EI_IMPULSE_OK if successful
+ */
+__attribute__((unused)) static EI_IMPULSE_ERROR ei_eon_prepare_graph(const ei_config_tflite_eon_graph_t *graph_config) {
+    if (ei_eon_graph_is_prepared(graph_config)) {
+        return EI_IMPULSE_OK;
+    }
+    for (size_t ix = 0; ix < EI_EON_MAX_PREPARED_GRAPHS; ix++) {
+        if (ei_eon_prepared_graphs[ix] &&
+                ei_shared_arena_regions_overlap(ei_eon_prepared_graphs[ix], graph_config)) {
+            ei_printf("ERR: graph shares its arena region with a prepared graph, release that one first\n");
+            return EI_IMPULSE_TFLITE_ARENA_ALLOC_FAILED;
+        }
+    }
+    for (size_t ix = 0; ix < EI_EON_MAX_PREPARED_GRAPHS; ix++) {
+        if (ei_eon_prepared_graphs[ix] == nullptr) {
+            TfLiteStatus init_status = graph_config->model_init(ei_aligned_calloc);
+            if (init_status != kTfLiteOk) {
+                ei_printf("Failed to initialize the model (error code %d)\n", init_status);
+                return EI_IMPULSE_TFLITE_ARENA_ALLOC_FAILED;
+            }
+            ei_eon_prepared_graphs[ix] = graph_config;
+            return EI_IMPULSE_OK;
+        }
+    }
+    return EI_IMPULSE_TFLITE_ERROR;
+}
+
+/**
+ * Reset a graph prepared with ei_eon_prepare_graph() and free its arena
+ *
+ * @param      graph_config  EON graph
+ */
+__attribute__((unused)) static void ei_eon_release_graph(const ei_config_tflite_eon_graph_t *graph_config) {
+    for (size_t ix = 0; ix < EI_EON_MAX_PREPARED_GRAPHS; ix++) {
+        if (ei_eon_prepared_graphs[ix] == graph_config) {
+            graph_config->model_reset(ei_aligned_free);
+            ei_eon_prepared_graphs[ix] = nullptr;
+        }
+    }
+}
 
 /**
  * Setup the TFLite runtime
@@ -66,10 +136,12 @@ static EI_IMPULSE_ERROR inference_tflite_setup(
     TfLiteTensor *outputs = *output_arg;
     ei_config_tflite_eon_graph_t *graph_config = (ei_config_tflite_eon_graph_t*)block_config->graph_config;
 
-    TfLiteStatus init_status = graph_config->model_init(ei_aligned_calloc);
-    if (init_status != kTfLiteOk) {
-        ei_printf("Failed to initialize the model (error code %d)\n", init_status);
-        return EI_IMPULSE_TFLITE_ARENA_ALLOC_FAILED;
+    if (!ei_eon_graph_is_prepared(graph_config)) {
+        TfLiteStatus init_status = graph_config->model_init(ei_aligned_calloc);
+        if (init_status != kTfLiteOk) {
+            ei_printf("Failed to initialize the model (error code %d)\n", init_status);
+            return EI_IMPULSE_TFLITE_ARENA_ALLOC_FAILED;
+        }
     }
 
     TfLiteStatus status;
@@ -112,7 +184,26 @@ static EI_IMPULSE_ERROR inference_tflite_run(
 
     ei_config_tflite_eon_graph_t *graph_config = (ei_config_tflite_eon_graph_t*)block_config->graph_config;
 
-    if (graph_config->model_invoke() != kTfLiteOk) {
+#if EI_CLASSIFIER_PROFILE_LAYERS
+    EiLayerProfiler& profiler = ei_layer_profiler_get();
+    if (graph_config->model_set_profiler) {
+        profiler.start_run(graph_config->model_node_info);
+        graph_config->model_set_profiler(&profiler);
+    }
+#endif
+
+    TfLiteStatus invoke_status = graph_config->model_invoke();
+
+#if EI_CLASSIFIER_PROFILE_LAYERS
+    if (graph_config->model_set_profiler) {
+        graph_config->model_set_profiler(nullptr);
+        if (debug) {
+            profiler.print_csv();
+        }
+    }
+#endif
+
+    if (invoke_status != kTfLiteOk) {
         return EI_IMPULSE_TFLITE_ERROR;
     }
 
@@ -180,7 +271,8 @@ EI_IMPULSE_ERROR run_nn_inference_from_dsp(
         return output_res;
     }
 
-    if (graph_config->model_reset(ei_aligned_free) != kTfLiteOk) {
+    if (!ei_eon_graph_is_prepared(graph_config) &&
+            graph_config->model_reset(ei_aligned_free) != kTfLiteOk) {
         return EI_IMPULSE_TFLITE_ERROR;
     }
     ei_free(outputs);
@@ -251,6 +343,16 @@ EI_IMPULSE_ERROR run_nn_inference(
         &outputs,
         tensor_arena, result, debug);
 
+#if EIDSP_PROFILE_MEMORY
+    size_t arena_size, tensor_bytes, persistent_bytes, scratch_bytes, overflow_bytes;
+    if (graph_config->model_arena_usage &&
+        graph_config->model_arena_usage(&arena_size, &tensor_bytes, &persistent_bytes,
+                                        &scratch_bytes, &overflow_bytes) == kTfLiteOk) {
+        ei_memory_profile_set_arena(arena_size, tensor_bytes, persistent_bytes,
+                                    scratch_bytes, overflow_bytes);
+    }
+#endif
+
     for (uint32_t output_ix = 0; output_ix < block_config->output_tensors_size; output_ix++) {
         TfLiteTensor* output = &outputs[output_ix];
         // calculate the size of the output by iterating through dims
@@ -295,7 +397,9 @@ EI_IMPULSE_ERROR run_nn_inference(
         result->_raw_outputs[learn_block_index + output_ix].blockId = block_config->block_id + output_ix;
     }
 
-    graph_config->model_reset(ei_aligned_free);
+    if (!ei_eon_graph_is_prepared(graph_config)) {
+        graph_config->model_reset(ei_aligned_free);
+    }
     ei_free(outputs);
 
     if (run_res != EI_IMPULSE_OK) {
@@ -432,7 +536,9 @@ EI_IMPULSE_ERROR run_nn_inference_image_quantized(
         result->_raw_outputs[learn_block_index + output_ix].blockId = block_config->block_id + output_ix;
     }
 
-    graph_config->model_reset(ei_aligned_free);
+    if (!ei_eon_graph_is_prepared(graph_config)) {
+        graph_config->model_reset(ei_aligned_free);
+    }
     ei_free(outputs);
 
     if (run_res != EI_IMPULSE_OK) {
@@ -441,6 +547,176 @@ EI_IMPULSE_ERROR run_nn_inference_image_quantized(
 
     return EI_IMPULSE_OK;
 }
+
+/**
+ * Release what inference_tflite_setup acquired: the output tensor array, and the model
+ * itself unless the graph was prepared for a batch. Safe after a failed model_init, the
+ * generated init does not free its arena on error.
+ *
+ * @return  res, so early exits can be written as `return inference_tflite_release(...)`
+ */
+static EI_IMPULSE_ERROR inference_tflite_release(
+    ei_config_tflite_eon_graph_t *graph_config,
+    TfLiteTensor *outputs,
+    EI_IMPULSE_ERROR res) {
+
+    if (!ei_eon_graph_is_prepared(graph_config)) {
+        graph_config->model_reset(ei_aligned_free);
+    }
+    ei_free(outputs);
+    return res;
+}
+
+/**
+ * Special function for continuous MFCC models with an int8 input: normalizes the sliding window of
+ * MFCC features and quantizes it straight into the input tensor, instead of normalizing a float copy
+ * and quantizing that in fill_input_tensor_from_matrix. This only works if
+ * 'can_run_classifier_continuous_quantized' returns EI_IMPULSE_OK.
+ *
+ * @param      impulse            struct with information about model and DSP
+ * @param      features_matrix    Sliding window of (not normalized) MFCC features, left untouched
+ * @param      learn_block_index  Index of the learning block
+ * @param      result             Output classifier results
+ * @param      config_ptr         Learning block config
+ * @param[in]  debug              Debug output enable
+ *
+ * @return     The ei impulse error.
+ */
+EI_IMPULSE_ERROR run_nn_inference_mfcc_quantized(
+    const ei_impulse_t *impulse,
+    ei::matrix_t *features_matrix,
+    uint32_t learn_block_index,
+    ei_impulse_result_t *result,
+    void *config_ptr,
+    bool debug = false) {
+
+    ei_learning_block_config_tflite_graph_t *block_config = (ei_learning_block_config_tflite_graph_t*)config_ptr;
+    ei_config_tflite_eon_graph_t *graph_config = (ei_config_tflite_eon_graph_t*)block_config->graph_config;
+
+    uint64_t ctx_start_us;
+    TfLiteTensor input;
+    TfLiteTensor *outputs;
+
+    // allocate outputs
+    outputs = (TfLiteTensor*)ei_malloc(block_config->output_tensors_size * sizeof(TfLiteTensor));
+
+    ei_unique_ptr_t p_tensor_arena(nullptr, ei_aligned_free);
+
+    EI_IMPULSE_ERROR init_res = inference_tflite_setup(
+        block_config,
+        &ctx_start_us,
+        &input,
+        &outputs,
+        p_tensor_arena);
+
+    if (init_res != EI_IMPULSE_OK) {
+        return inference_tflite_release(graph_config, outputs, init_res);
+    }
+
+    if (input.type != TfLiteType::kTfLiteInt8) {
+        ei_printf("ERR: Cannot handle input type (%d)\n", input.type);
+        return inference_tflite_release(graph_config, outputs, EI_IMPULSE_INPUT_TENSOR_WAS_NULL);
+    }
+
+    if (input.bytes != features_matrix->rows * features_matrix->cols) {
+        ei_printf("ERR: input tensor has size %d bytes, but input matrix has has size %d bytes\n",
+            (int)input.bytes, (int)(features_matrix->rows * features_matrix->cols));
+        return inference_tflite_release(graph_config, outputs, EI_IMPULSE_INVALID_SIZE);
+    }
+
+    uint64_t dsp_start_us = ei_read_timer_us();
+
+    // features matrix maps around the input tensor to not allocate any memory
+    ei::matrix_i8_t quantized_matrix(1, input.bytes, input.data.int8);
+
+    // normalize and quantize in one pass
+    EI_CLASSIFIER_TRACE_BEGIN("dsp", "cmvn");
+#if EIDSP_USE_ARENA
+    ei_dsp_arena_begin();
+#endif
+    int ret = calc_cepstral_mean_and_var_normalization_mfcc_quantized(features_matrix, &quantized_matrix,
+        impulse->dsp_blocks[0].config, input.params.scale, input.params.zero_point);
+#if EIDSP_USE_ARENA
+    ei_dsp_arena_end();
+#endif
+    EI_CLASSIFIER_TRACE_END("dsp", "cmvn");
+
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to run DSP process (%d)\n", ret);
+        return inference_tflite_release(graph_config, outputs, EI_IMPULSE_DSP_ERROR);
+    }
+
+    result->timing.dsp_us += ei_read_timer_us() - dsp_start_us;
+    result->timing.dsp = (int)(result->timing.dsp_us / 1000);
+
+    if (debug) {
+        ei_printf("Feature Matrix: \n");
+        for (size_t ix = 0; ix < quantized_matrix.cols; ix++) {
+            ei_printf_float((quantized_matrix.buffer[ix] - input.params.zero_point) * input.params.scale);
+            ei_printf(" ");
+        }
+        ei_printf("\n");
+        ei_printf("Running impulse...\n");
+    }
+
+    ctx_start_us = ei_read_timer_us();
+
+    EI_IMPULSE_ERROR run_res = inference_tflite_run(
+        impulse,
+        block_config,
+        ctx_start_us,
+        &outputs,
+        static_cast<uint8_t*>(p_tensor_arena.get()),
+        result,
+        debug);
+
+    for (uint32_t output_ix = 0; output_ix < block_config->output_tensors_size; output_ix++) {
+        TfLiteTensor* output = &outputs[output_ix];
+        // calculate the size of the output by iterating through dims
+        size_t output_size = 1;
+        for (int dim_num = 0; dim_num < output->dims->size; dim_num++) {
+            output_size *= output->dims->data[dim_num];
+        }
+
+        switch (output->type) {
+            case kTfLiteFloat32: {
+                result->_raw_outputs[learn_block_index + output_ix].matrix = new matrix_t(1, output_size);
+                memcpy(result->_raw_outputs[learn_block_index + output_ix].matrix->buffer, output->data.f, output->bytes);
+                break;
+            }
+            case kTfLiteInt8: {
+                if (block_config->dequantize_output) {
+                    result->_raw_outputs[learn_block_index + output_ix].matrix = new matrix_t(1, output_size);
+                    fill_output_matrix_from_tensor(output, result->_raw_outputs[learn_block_index + output_ix].matrix);
+                }
+                else {
+                    result->_raw_outputs[learn_block_index + output_ix].matrix_i8 = new matrix_i8_t(1, output_size);
+                    memcpy(result->_raw_outputs[learn_block_index + output_ix].matrix_i8->buffer, output->data.int8, output->bytes);
+                }
+                break;
+            }
+            case kTfLiteUInt8: {
+                if (block_config->dequantize_output) {
+                    result->_raw_outputs[learn_block_index + output_ix].matrix = new matrix_t(1, output_size);
+                    fill_output_matrix_from_tensor(output, result->_raw_outputs[learn_block_index + output_ix].matrix);
+                }
+                else {
+                    result->_raw_outputs[learn_block_index + output_ix].matrix_u8 = new matrix_u8_t(1, output_size);
+                    memcpy(result->_raw_outputs[learn_block_index + output_ix].matrix_u8->buffer, output->data.uint8, output->bytes);
+                }
+                break;
+            }
+            default: {
+                ei_printf("ERR: Cannot handle output type (%d)\n", output->type);
+                return inference_tflite_release(graph_config, outputs, EI_IMPULSE_OUTPUT_TENSOR_WAS_NULL);
+            }
+        }
+
+        result->_raw_outputs[learn_block_index + output_ix].blockId = block_config->block_id + output_ix;
+    }
+
+    return inference_tflite_release(graph_config, outputs, run_res);
+}
 #endif // EI_CLASSIFIER_QUANTIZATION_ENABLED == 1
 
 __attribute__((unused)) int extract_tflite_eon_features(signal_t *signal, matrix_t *output_matrix, void *config_ptr, const float frequency) {
@@ -453,6 +729,12 @@ __attribute__((unused)) int extract_tflite_eon_features(signal_t *signal, matrix
         .model_reset = dsp_config->reset_fn,
         .model_input = dsp_config->input_fn,
         .model_output = dsp_config->output_fn,
+        // the DSP config only carries the core entry points, the optional hooks stay off
+        .model_arena_usage = nullptr,
+        .model_set_profiler = nullptr,
+        .model_node_info = nullptr,
+        .model_arena_size = nullptr,
+        .model_bind_arena = nullptr,
     };
 
     const uint8_t ei_output_tensor_indices[1] = { 0 };
@@ -465,7 +747,8 @@ __attribute__((unused)) int extract_tflite_eon_features(signal_t *signal, matrix
         .output_tensors_size = ei_output_tensor_size,
         .quantized = 0,
         .compiled = 1,
-        .graph_config = &ei_config_tflite_graph_0
+        .graph_config = &ei_config_tflite_graph_0,
+        .dequantize_output = false,
     };
 
     auto x = run_nn_inference_from_dsp(&ei_learning_block_config, signal, output_matrix);
@@ -186,6 +186,11 @@ static EI_IMPULSE_ERROR inference_tflite_setup(
         return EI_IMPULSE_TFLITE_ERROR;
     }
 
+#if EIDSP_PROFILE_MEMORY
+    // the interpreter only reports the total, persistent and scratch buffers included
+    ei_memory_profile_set_arena(graph_config->arena_size, interpreter->arena_used_bytes(), 0, 0, 0);
+#endif
+
     // Obtain pointers to the model's input and output tensors.
     *input = interpreter->input(0);
     for (uint8_t i = 0; i < block_config->output_tensors_size; i++) {
@@ -95,6 +95,24 @@
 #define EIDSP_QUANTIZE_FILTERBANK    1
 #endif // EIDSP_QUANTIZE_FILTERBANK
 
+// per-stage memory profile for DSP and NN (see ei_memory_profile_* in memory.hpp),
+// built on the allocation tracking below without printing every allocation
+#ifndef EIDSP_PROFILE_MEMORY
+#define EIDSP_PROFILE_MEMORY         0
+#endif // EIDSP_PROFILE_MEMORY
+
+#if EIDSP_PROFILE_MEMORY == 1
+#ifndef EIDSP_TRACK_ALLOCATIONS
+#define EIDSP_TRACK_ALLOCATIONS      1
+#endif
+#ifndef EIDSP_PRINT_ALLOCATIONS
+#define EIDSP_PRINT_ALLOCATIONS      0
+#endif
+#if EIDSP_TRACK_ALLOCATIONS == 0
+#error "EIDSP_PROFILE_MEMORY requires EIDSP_TRACK_ALLOCATIONS"
+#endif
+#endif // EIDSP_PROFILE_MEMORY == 1
+
 // prints buffer allocations to stdout, useful when debugging
 #ifndef EIDSP_TRACK_ALLOCATIONS
 #define EIDSP_TRACK_ALLOCATIONS      0
@@ -106,6 +124,12 @@
 #define EIDSP_PRINT_ALLOCATIONS      1
 #endif
 
+// route ei_dsp_malloc / ei_dsp_calloc / matrix buffers through a preallocated
+// scratch arena while a DSP block runs (see ei_dsp_arena_* in memory.hpp)
+#ifndef EIDSP_USE_ARENA
+#define EIDSP_USE_ARENA              0
+#endif // EIDSP_USE_ARENA
+
 #ifndef EIDSP_SIGNAL_C_FN_POINTER
 #define EIDSP_SIGNAL_C_FN_POINTER    0
 #endif // EIDSP_SIGNAL_C_FN_POINTER
@@ -185,27 +185,15 @@ static bool can_do_fft(size_t n_fft)
         n_fft == 1024 || n_fft == 2048 || n_fft == 4096;
 }
 
-static int arm_rfft(const float *input, float *output, size_t n_fft)
-{
-    // hardware acceleration only works for the powers above...
-    arm_rfft_fast_instance_f32 rfft_instance;
-    int status = cmsis_rfft_init_f32(&rfft_instance, n_fft);
-    if (status != ARM_MATH_SUCCESS) {
-        return status;
-    }
-
-    arm_rfft_fast_f32(&rfft_instance, const_cast<float *>(input), output, 0);
-    return 0;
-}
-
-static int hw_r2c_fft(const float *input, ei::fft_complex_t *output_as_complex, size_t n_fft)
+/**
+ * RFFT with an already initialized instance (e.g. a cached FFT plan)
+ */
+static int hw_r2c_fft(const arm_rfft_fast_instance_f32 *rfft_instance, const float *input,
+    ei::fft_complex_t *output_as_complex, size_t n_fft)
 {
-    if(!can_do_fft(n_fft)) { return ei::EIDSP_FFT_SIZE_NOT_SUPPORTED; }
-
     float *output = (float *)output_as_complex;
 
-    // non zero is fail
-    if(arm_rfft(input, output, n_fft)) { return ei::EIDSP_PARAMETER_INVALID; }
+    arm_rfft_fast_f32(rfft_instance, const_cast<float *>(input), output, 0);
 
     const size_t n_fft_out_features = n_fft / 2 + 1;
     // Take care of the Nyquist bin
@@ -216,6 +204,19 @@ static int hw_r2c_fft(const float *input, ei::fft_complex_t *output_as_complex,
     return ei::EIDSP_OK;
 }
 
+static int hw_r2c_fft(const float *input, ei::fft_complex_t *output_as_complex, size_t n_fft)
+{
+    if(!can_do_fft(n_fft)) { return ei::EIDSP_FFT_SIZE_NOT_SUPPORTED; }
+
+    // hardware acceleration only works for the powers above...
+    arm_rfft_fast_instance_f32 rfft_instance;
+    if (cmsis_rfft_init_f32(&rfft_instance, n_fft) != ARM_MATH_SUCCESS) {
+        return ei::EIDSP_PARAMETER_INVALID;
+    }
+
+    return hw_r2c_fft(&rfft_instance, input, output_as_complex, n_fft);
+}
+
 constexpr int MIN_FFT_SIZE = 32;
 constexpr int MAX_FFT_SIZE = 4096;
 
@@ -7,8 +7,11 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <atomic>
+#include <mutex>
 #include "edge-impulse-sdk/porting/espressif/esp-dsp/modules/fft/include/dsps_fft2r.h"
 #include "edge-impulse-sdk/porting/ei_logging.h"
+#include "edge-impulse-sdk/dsp/returntypes.hpp"
 
 namespace ei {
 namespace fft {
@@ -16,8 +19,6 @@ namespace fft {
 constexpr int MIN_FFT_SIZE = 4;
 constexpr int MAX_FFT_SIZE = 4096;
 
-static bool init_done = false;
-
 static bool can_do_fft(size_t n_fft) {
     // if power of 2 and within range
     if (n_fft < MIN_FFT_SIZE || n_fft > MAX_FFT_SIZE)
@@ -27,12 +28,10 @@ static bool can_do_fft(size_t n_fft) {
     return true;
 }
 
-static bool init_fft(size_t n_fft) {
-    if (init_done) {
-        return true; // Already initialized
-    }
+// n_fft is checked by the caller (hw_fft_prepare); the tables are always built for CONFIG_DSP_MAX_FFT_SIZE
+inline bool init_fft(size_t n_fft) {
+    (void)n_fft; // only logged
     EI_LOGD("Initializing ESP-DSP FFT with size %zu\n", n_fft);
-    if (!can_do_fft(n_fft)) { return false; /* EIDSP_FFT_SIZE_NOT_SUPPORTED */ }
 
     esp_err_t ret = dsps_fft2r_init_fc32(NULL, CONFIG_DSP_MAX_FFT_SIZE);
     if (ret != ESP_OK) {
@@ -42,33 +41,57 @@ static bool init_fft(size_t n_fft) {
     return true;
 }
 
-static int hw_r2c_fft(const float *input, ei::fft_complex_t *output_as_complex, size_t n_fft) {
-    if (!init_done) {
+/**
+ * Initialize the ESP-DSP twiddle tables exactly once.
+ * The tables are process-wide ESP-DSP globals and plans can be created from
+ * several inference tasks at once, so the first-time init is serialized.
+ * This is an inline (not static) function so every translation unit shares
+ * the same flag and lock. A failed init is retried by the next caller.
+ */
+inline bool hw_fft_init_once(size_t n_fft) {
+    static std::atomic<bool> init_done(false);
+    static std::mutex init_lock;
+
+    if (init_done.load(std::memory_order_acquire)) {
+        return true;
+    }
+    std::lock_guard<std::mutex> guard(init_lock);
+    if (!init_done.load(std::memory_order_relaxed)) {
         if (!init_fft(n_fft)) {
-            EI_LOGE("Failed to initialize FFT\n");
-            return -1; // EIDSP_FFT_INIT_FAILED
+            return false;
         }
-        init_done = true;
+        init_done.store(true, std::memory_order_release);
     }
-    // ESP-DSP expects input/output as float arrays, length must be power of 2
-    float *in = const_cast<float *>(input);
-    float *output = (float*)output_as_complex;
-    int err = 0;
+    return true;
+}
 
-    // Prepare input as complex numbers (real part, imaginary part)
-    float *complex_input = (float*)ei_malloc(n_fft * sizeof(float) * 2);
-    if (complex_input == nullptr) {
-        EI_LOGE("Failed to allocate memory for complex input\n");
-        goto out;
-        return -1; // EIDSP_MEMORY_ALLOC_FAILED
+/**
+ * Make sure the shared twiddle tables are initialized and cover n_fft
+ */
+static int hw_fft_prepare(size_t n_fft) {
+    if (!can_do_fft(n_fft) || n_fft > CONFIG_DSP_MAX_FFT_SIZE) {
+        return ei::EIDSP_FFT_SIZE_NOT_SUPPORTED;
     }
+    if (!hw_fft_init_once(n_fft)) {
+        EI_LOGE("Failed to initialize FFT\n");
+        return -1; // EIDSP_FFT_INIT_FAILED
+    }
+    return ei::EIDSP_OK;
+}
+
+/**
+ * RFFT using a caller-owned complex work buffer of 2 * n_fft floats (e.g. from a cached FFT plan)
+ */
+static int hw_r2c_fft(float *complex_input, const float *input, ei::fft_complex_t *output_as_complex, size_t n_fft) {
+    float *output = (float*)output_as_complex;
 
+    // Prepare input as complex numbers (real part, imaginary part)
     for (size_t i = 0; i < n_fft; i++) {
-        complex_input[i * 2 + 0] = in[i]; // Real part
+        complex_input[i * 2 + 0] = input[i]; // Real part
         complex_input[i * 2 + 1] = 0.0f; // Imaginary part
     }
 
-    err = dsps_fft2r_fc32(complex_input, n_fft);
+    int err = dsps_fft2r_fc32(complex_input, n_fft);
     if (err != 0) {
         EI_LOGE("Error in dsps_fft2r_fc32: %d\n", err);
         return err;
@@ -80,11 +103,26 @@ static int hw_r2c_fft(const float *input, ei::fft_complex_t *output_as_complex,
     for (size_t i = 0; i < n_fft + 2; i++) {
         output[i] = complex_input[i];
     }
-out:
-    ei_free(complex_input);
     return 0;
 }
 
+static int hw_r2c_fft(const float *input, ei::fft_complex_t *output_as_complex, size_t n_fft) {
+    int err = hw_fft_prepare(n_fft);
+    if (err != 0) {
+        return err;
+    }
+
+    float *complex_input = (float*)ei_malloc(n_fft * sizeof(float) * 2);
+    if (complex_input == nullptr) {
+        EI_LOGE("Failed to allocate memory for complex input\n");
+        return -1; // EIDSP_MEMORY_ALLOC_FAILED
+    }
+
+    err = hw_r2c_fft(complex_input, input, output_as_complex, n_fft);
+    ei_free(complex_input);
+    return err;
+}
+
 } // namespace fft
 } // namespace ei
 
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2024 EdgeImpulse Inc.
+ *
+ * Generated by Edge Impulse and licensed under the applicable Edge Impulse
+ * Terms of Service. Community and Professional Terms of Service
+ * (https://edgeimpulse.com/legal/terms-of-service) or Enterprise Terms of
+ * Service (https://edgeimpulse.com/legal/enterprise-terms-of-service),
+ * according to your product plan subscription (the “License”).
+ *
+ * This software, documentation and other associated files (collectively referred
+ * to as the “Software”) is a single SDK variation generated by the Edge Impulse
+ * platform and requires an active paid Edge Impulse subscription to use this
+ * Software for any purpose.
+ *
+ * You may NOT use this Software unless you have an active Edge Impulse subscription
+ * that meets the eligibility requirements for the applicable License, subject to
+ * your full and continued compliance with the terms and conditions of the License,
+ * including without limitation any usage restrictions under the applicable License.
+ *
+ * If you do not have an active Edge Impulse product plan subscription, or if use
+ * of this Software exceeds the usage limitations of your Edge Impulse product plan
+ * subscription, you are not permitted to use this Software and must immediately
+ * delete and erase all copies of this Software within your control or possession.
+ * Edge Impulse reserves all rights and remedies available to enforce its rights.
+ *
+ * Unless required by applicable law or agreed to in writing, the Software is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language governing
+ * permissions, disclaimers and limitations under the License.
+ */
+
+#ifndef _EIDSP_FFT_PLAN_H_
+#define _EIDSP_FFT_PLAN_H_
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include "edge-impulse-sdk/dsp/config.hpp"
+#include "edge-impulse-sdk/dsp/numpy_types.h"
+#include "edge-impulse-sdk/dsp/returntypes.hpp"
+#include "edge-impulse-sdk/dsp/kissfft/kiss_fftr.h"
+#include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+
+/**
+ * FFT plan cache
+ *
+ * Plans (twiddle tables, engine instances, work buffers) are created on first use for a given
+ * (n_fft, direction, precision) and kept for the lifetime of the process, so spectral blocks
+ * don't rebuild them for every frame. A plan is leased exclusively while it runs, which makes
+ * the cache safe for concurrent streams: a stream that finds every matching plan busy gets a
+ * new slot, and when the pool is exhausted the caller falls back to a temporary plan.
+ *
+ * Include after the DSP engine header (numpy.hpp does this).
+ */
+
+// Number of plans kept alive, one per size per concurrently running stream
+#ifndef EIDSP_FFT_PLAN_POOL_SIZE
+#define EIDSP_FFT_PLAN_POOL_SIZE    4
+#endif
+
+namespace ei {
+namespace fft {
+
+typedef enum {
+    EI_FFT_FORWARD = 0,             // real -> complex (rfft)
+    EI_FFT_INVERSE = 1              // complex -> real (irfft)
+} fft_direction_t;
+
+typedef enum {
+    EI_FFT_F32 = 0
+} fft_precision_t;
+
+typedef struct {
+    std::atomic<uint8_t> state;     // slot state, see plan_acquire()
+    uint16_t n_fft;
+    uint8_t direction;
+    uint8_t precision;
+    int hw_status;                  // EIDSP_OK while the HW engine handles this plan
+#if EIDSP_USE_CMSIS_DSP
+    arm_rfft_fast_instance_f32 cmsis;
+#elif EIDSP_USE_ESP_DSP
+    float *esp_scratch;             // complex work buffer, 2 * n_fft floats
+#endif
+    kiss_fftr_cfg kiss;             // software plan, created when the HW engine can't run it
+} fft_plan_t;
+
+enum {
+    EI_FFT_PLAN_EMPTY = 0,
+    EI_FFT_PLAN_BUSY,
+    EI_FFT_PLAN_IDLE
+};
+
+// inline (not static) so every translation unit shares the same pool
+inline fft_plan_t *plan_pool()
+{
+    static fft_plan_t pool[EIDSP_FFT_PLAN_POOL_SIZE];
+    return pool;
+}
+
+inline void plan_destroy(fft_plan_t *plan)
+{
+#if EIDSP_USE_ESP_DSP
+    if (plan->esp_scratch) {
+        ei_free(plan->esp_scratch);
+        plan->esp_scratch = nullptr;
+    }
+#endif
+    if (plan->kiss) {
+        kiss_fftr_free(plan->kiss);
+        plan->kiss = nullptr;
+    }
+}
+
+/**
+ * Set up a plan. The HW engine only implements forward transforms; everything
+ * else (sizes the engine doesn't support, or a failed engine setup) runs on kissfft.
+ * Engine setup failures are recorded in hw_status, they don't fail the plan.
+ */
+inline int plan_init(fft_plan_t *plan, size_t n_fft, fft_direction_t direction, fft_precision_t precision)
+{
+    plan->n_fft = static_cast<uint16_t>(n_fft);
+    plan->direction = static_cast<uint8_t>(direction);
+    plan->precision = static_cast<uint8_t>(precision);
+    plan->hw_status = EIDSP_NO_HW_ACCEL;
+    plan->kiss = nullptr;
+
+    if (direction == EI_FFT_FORWARD) {
+#if EIDSP_USE_CMSIS_DSP
+        if (!can_do_fft(n_fft)) {
+            plan->hw_status = EIDSP_FFT_SIZE_NOT_SUPPORTED;
+        }
+        else if (cmsis_rfft_init_f32(&plan->cmsis, n_fft) != ARM_MATH_SUCCESS) {
+            plan->hw_status = EIDSP_PARAMETER_INVALID;
+        }
+        else {
+            plan->hw_status = EIDSP_OK;
+        }
+#elif EIDSP_USE_ESP_DSP
+        plan->esp_scratch = nullptr;
+        plan->hw_status = hw_fft_prepare(n_fft);
+        if (plan->hw_status == EIDSP_OK) {
+            plan->esp_scratch = (float *)ei_malloc(n_fft * 2 * sizeof(float));
+            if (!plan->esp_scratch) {
+                // kissfft needs less memory than the complex work buffer
+                plan->hw_status = EIDSP_OUT_OF_MEM;
+            }
+        }
+#else
+        // stateless engine: try it on first use, see plan_execute_r2c()
+        plan->hw_status = EIDSP_OK;
+#endif
+    }
+#if EIDSP_USE_ESP_DSP
+    else {
+        plan->esp_scratch = nullptr;
+    }
+#endif
+
+    return EIDSP_OK;
+}
+
+inline int plan_ensure_kiss(fft_plan_t *plan)
+{
+#if EIDSP_INCLUDE_KISSFFT
+    if (!plan->kiss) {
+        plan->kiss = kiss_fftr_alloc(plan->n_fft, plan->direction == EI_FFT_INVERSE, nullptr, nullptr);
+        if (!plan->kiss) {
+            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        }
+    }
+    return EIDSP_OK;
+#else
+    return EIDSP_NOT_SUPPORTED;
+#endif
+}
+
+/**
+ * Lease a plan for (n_fft, direction, precision), creating it on first use.
+ * @returns the plan (release with plan_release()), or nullptr when the pool is exhausted
+ *          or the plan can't be created; callers then run a temporary plan.
+ */
+inline fft_plan_t *plan_acquire(size_t n_fft, fft_direction_t direction, fft_precision_t precision)
+{
+    if (n_fft == 0 || n_fft > UINT16_MAX) {
+        return nullptr;
+    }
+
+    fft_plan_t *pool = plan_pool();
+
+    // reuse an idle plan; the key is immutable once the slot has been published
+    for (size_t ix = 0; ix < EIDSP_FFT_PLAN_POOL_SIZE; ix++) {
+        fft_plan_t *plan = &pool[ix];
+        if (plan->state.load(std::memory_order_acquire) != EI_FFT_PLAN_IDLE ||
+            plan->n_fft != n_fft || plan->direction != direction || plan->precision != precision) {
+            continue;
+        }
+        uint8_t expected = EI_FFT_PLAN_IDLE;
+        if (plan->state.compare_exchange_strong(expected, EI_FFT_PLAN_BUSY, std::memory_order_acquire)) {
+            return plan;
+        }
+    }
+
+    // otherwise claim an empty slot (also when all matching plans are leased by other streams)
+    for (size_t ix = 0; ix < EIDSP_FFT_PLAN_POOL_SIZE; ix++) {
+        fft_plan_t *plan = &pool[ix];
+        uint8_t expected = EI_FFT_PLAN_EMPTY;
+        if (!plan->state.compare_exchange_strong(expected, EI_FFT_PLAN_BUSY, std::memory_order_acquire)) {
+            continue;
+        }
+        if (plan_init(plan, n_fft, direction, precision) != EIDSP_OK) {
+            plan_destroy(plan);
+            plan->state.store(EI_FFT_PLAN_EMPTY, std::memory_order_release);
+            return nullptr;
+        }
+        return plan;
+    }
+
+    return nullptr;
+}
+
+inline void plan_release(fft_plan_t *plan)
+{
+    plan->state.store(EI_FFT_PLAN_IDLE, std::memory_order_release);
+}
+
+/**
+ * Forward real FFT with a leased plan.
+ * @param input n_fft samples; may be used as scratch by the engine
+ * @param output n_fft / 2 + 1 complex bins
+ */
+inline int plan_execute_r2c(fft_plan_t *plan, float *input, fft_complex_t *output)
+{
+    if (plan->direction != EI_FFT_FORWARD) {
+        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+    }
+
+    if (plan->hw_status == EIDSP_OK) {
+#if EIDSP_USE_CMSIS_DSP
+        int res = hw_r2c_fft(&plan->cmsis, input, output, plan->n_fft);
+#elif EIDSP_USE_ESP_DSP
+        int res = hw_r2c_fft(plan->esp_scratch, input, output, plan->n_fft);
+#else
+        int res = hw_r2c_fft(input, output, plan->n_fft);
+#endif
+        if (res == EIDSP_OK) {
+            return EIDSP_OK;
+        }
+        // remember the failure, this plan runs in software from now on
+        plan->hw_status = res;
+    }
+
+    int ret = plan_ensure_kiss(plan);
+    if (ret != EIDSP_OK) {
+        return ret;
+    }
+    kiss_fftr(plan->kiss, input, (kiss_fft_cpx *)output);
+    return EIDSP_OK;
+}
+
+/**
+ * Inverse real FFT with a leased plan (software only).
+ * @param input n_fft / 2 + 1 complex bins
+ * @param output n_fft samples (unnormalized, as kissfft)
+ */
+inline int plan_execute_c2r(fft_plan_t *plan, const fft_complex_t *input, float *output)
+{
+    if (plan->direction != EI_FFT_INVERSE) {
+        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+    }
+
+    int ret = plan_ensure_kiss(plan);
+    if (ret != EIDSP_OK) {
+        return ret;
+    }
+    kiss_fftri(plan->kiss, (const kiss_fft_cpx *)input, output);
+    return EIDSP_OK;
+}
+
+} // namespace fft
+} // namespace ei
+
+#endif // _EIDSP_FFT_PLAN_H_
@@ -29,6 +29,352 @@
  * permissions, disclaimers and limitations under the License.
  */
 #include "memory.hpp"
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+#if EIDSP_USE_ARENA
+#include <mutex>
+#endif
+#include "edge-impulse-sdk/dsp/returntypes.hpp"
 
 size_t ei_memory_in_use = 0;
 size_t ei_memory_peak_use = 0;
+
+#if EIDSP_PROFILE_MEMORY
+
+static ei_memory_stage_t profile_stages[EI_MEMORY_PROFILE_MAX_STAGES];
+static size_t profile_stage_count = 0;
+static ei_memory_stage_t *profile_current = NULL;
+static size_t profile_run_base = 0;     // ei_memory_in_use when the profile was reset
+static size_t profile_stage_base = 0;   // ei_memory_in_use when the current stage began
+static size_t profile_peak = 0;         // highest usage since the reset
+static size_t profile_dropped = 0;      // stages that did not fit in profile_stages
+
+// Usage relative to a base. The global counters can drift when a buffer is freed
+// through a different matrix type than it was allocated with, so the difference
+// is taken modulo and anything below the base counts as zero.
+static inline size_t profile_usage_since(size_t base) {
+    ptrdiff_t usage = (ptrdiff_t)(ei_memory_in_use - base);
+    return usage > 0 ? (size_t)usage : 0;
+}
+
+void ei_memory_profile_reset(void) {
+    memset(profile_stages, 0, sizeof(profile_stages));
+    profile_stage_count = 0;
+    profile_current = NULL;
+    profile_dropped = 0;
+    profile_run_base = ei_memory_in_use;
+    profile_peak = 0;
+}
+
+void ei_memory_profile_begin(const char *name, uint32_t block_id) {
+    ei_memory_profile_end();
+
+    if (profile_stage_count >= EI_MEMORY_PROFILE_MAX_STAGES) {
+        profile_dropped++;
+        return;
+    }
+    profile_current = &profile_stages[profile_stage_count++];
+    profile_current->name = name;
+    profile_current->block_id = block_id;
+    profile_stage_base = ei_memory_in_use;
+}
+
+void ei_memory_profile_end(void) {
+    if (profile_current) {
+        profile_current->current_bytes = profile_usage_since(profile_stage_base);
+        profile_current = NULL;
+    }
+}
+
+void ei_memory_profile_set_arena(size_t arena_size, size_t tensor_bytes, size_t persistent_bytes,
+    size_t scratch_bytes, size_t overflow_bytes)
+{
+    if (!profile_current) {
+        return;
+    }
+    profile_current->arena_size = arena_size;
+    profile_current->arena_tensor_bytes = tensor_bytes;
+    profile_current->arena_persistent_bytes = persistent_bytes;
+    profile_current->arena_scratch_bytes = scratch_bytes;
+    profile_current->arena_overflow_bytes = overflow_bytes;
+}
+
+size_t ei_memory_profile_get_stages(const ei_memory_stage_t **stages) {
+    *stages = profile_stages;
+    return profile_stage_count;
+}
+
+void ei_memory_profile_on_alloc(size_t bytes) {
+    size_t usage = profile_usage_since(profile_run_base);
+    if (usage > profile_peak) {
+        profile_peak = usage;
+    }
+
+    if (!profile_current) {
+        return;
+    }
+    profile_current->allocations++;
+    if (bytes > profile_current->largest_allocation) {
+        profile_current->largest_allocation = bytes;
+    }
+    usage = profile_usage_since(profile_stage_base);
+    if (usage > profile_current->peak_bytes) {
+        profile_current->peak_bytes = usage;
+    }
+}
+
+void ei_memory_profile_on_free(size_t bytes) {
+    (void)bytes;
+    if (profile_current) {
+        profile_current->frees++;
+    }
+}
+
+typedef struct {
+    char *buffer;
+    size_t size;
+    size_t length;
+} profile_writer_t;
+
+static void profile_write(profile_writer_t *w, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    size_t left = w->length < w->size ? w->size - w->length : 0;
+    int n = vsnprintf(left ? w->buffer + w->length : NULL, left, format, args);
+    va_end(args);
+    if (n > 0) {
+        w->length += (size_t)n;
+    }
+}
+
+size_t ei_memory_profile_to_json(char *buffer, size_t size) {
+    profile_writer_t w = { buffer, size, 0 };
+
+    profile_write(&w, "{\"peak_bytes\":%lu,\"current_bytes\":%lu,\"dropped_stages\":%lu,\"stages\":[",
+        (unsigned long)profile_peak, (unsigned long)profile_usage_since(profile_run_base),
+        (unsigned long)profile_dropped);
+    for (size_t ix = 0; ix < profile_stage_count; ix++) {
+        const ei_memory_stage_t *st = &profile_stages[ix];
+        profile_write(&w, "%s{\"name\":\"%s\",\"block_id\":%lu,\"peak_bytes\":%lu,\"current_bytes\":%lu,"
+            "\"allocations\":%lu,\"frees\":%lu,\"largest_allocation\":%lu",
+            ix ? "," : "", st->name ? st->name : "", (unsigned long)st->block_id,
+            (unsigned long)st->peak_bytes, (unsigned long)st->current_bytes,
+            (unsigned long)st->allocations, (unsigned long)st->frees,
+            (unsigned long)st->largest_allocation);
+        if (st->arena_size) {
+            profile_write(&w, ",\"arena\":{\"size\":%lu,\"tensor_bytes\":%lu,\"persistent_bytes\":%lu,"
+                "\"scratch_bytes\":%lu,\"overflow_bytes\":%lu}",
+                (unsigned long)st->arena_size, (unsigned long)st->arena_tensor_bytes,
+                (unsigned long)st->arena_persistent_bytes, (unsigned long)st->arena_scratch_bytes,
+                (unsigned long)st->arena_overflow_bytes);
+        }
+        profile_write(&w, "}");
+    }
+    profile_write(&w, "]}");
+    return w.length;
+}
+
+void ei_memory_profile_print_json(void) {
+    size_t length = ei_memory_profile_to_json(NULL, 0);
+    char *json = (char *)ei_malloc(length + 1);
+    if (!json) {
+        return;
+    }
+    ei_memory_profile_to_json(json, length + 1);
+    ei_printf("%s\n", json);
+    ei_free(json);
+}
+#endif // EIDSP_PROFILE_MEMORY
+
+#if EIDSP_USE_ARENA
+
+// every block is preceded by a header; keeping it 16 bytes keeps the payload
+// aligned the same way as the arena buffer
+#define EI_DSP_ARENA_ALIGN      16
+
+typedef struct {
+    uint32_t size;          // payload size, rounded up to EI_DSP_ARENA_ALIGN
+    uint32_t prev;          // offset of the previous block header
+    uint32_t freed;         // block was released out of order
+    uint32_t reserved;
+} ei_dsp_arena_header_t;
+
+// The arena state below is only touched by the thread that holds arena_lock,
+// i.e. between ei_dsp_arena_begin() and ei_dsp_arena_end(), or by init / deinit /
+// stats under the same lock. arena_active tells a thread whether it is the owner;
+// everyone else allocates from the heap.
+static std::mutex arena_lock;
+static thread_local bool arena_active = false;
+
+static uint8_t *arena_buffer = NULL;
+static bool arena_owns_buffer = false;
+static size_t arena_capacity = 0;
+static size_t arena_top = 0;        // first free byte
+static size_t arena_last = 0;       // offset of the top block header (valid if arena_live > 0)
+static size_t arena_live = 0;       // blocks in the arena, including freed ones not yet popped
+static ei_dsp_arena_stats_t arena_stats = { 0, 0, 0, 0, 0, 0 };
+
+static inline bool arena_contains(const void *ptr) {
+    return arena_buffer != NULL &&
+        (const uint8_t *)ptr >= arena_buffer &&
+        (const uint8_t *)ptr < arena_buffer + arena_capacity;
+}
+
+static void arena_pop_freed(void) {
+    while (arena_live > 0) {
+        ei_dsp_arena_header_t *hdr = (ei_dsp_arena_header_t *)(arena_buffer + arena_last);
+        if (!hdr->freed) {
+            break;
+        }
+        arena_top = arena_last;
+        arena_last = hdr->prev;
+        arena_live--;
+    }
+    if (arena_live == 0) {
+        arena_top = 0;
+        arena_last = 0;
+    }
+    arena_stats.in_use = arena_top;
+}
+
+static void arena_release_locked(void) {
+    if (arena_owns_buffer) {
+        ei_free(arena_buffer);
+    }
+    arena_buffer = NULL;
+    arena_owns_buffer = false;
+    arena_capacity = 0;
+    arena_top = 0;
+    arena_last = 0;
+    arena_live = 0;
+    arena_stats.capacity = 0;
+    arena_stats.in_use = 0;
+}
+
+int ei_dsp_arena_init(void *buffer, size_t size) {
+    std::lock_guard<std::mutex> guard(arena_lock);
+    arena_release_locked();
+
+    size &= ~(size_t)(EI_DSP_ARENA_ALIGN - 1);
+    if (buffer == NULL) {
+        buffer = ei_malloc(size);
+        if (buffer == NULL) {
+            return ei::EIDSP_OUT_OF_MEM;
+        }
+        arena_owns_buffer = true;
+    }
+
+    arena_buffer = (uint8_t *)buffer;
+    arena_capacity = size;
+    memset(&arena_stats, 0, sizeof(arena_stats));
+    arena_stats.capacity = size;
+    return ei::EIDSP_OK;
+}
+
+void ei_dsp_arena_deinit(void) {
+    std::lock_guard<std::mutex> guard(arena_lock);
+    arena_release_locked();
+}
+
+void ei_dsp_arena_begin(void) {
+    arena_lock.lock();
+    if (arena_buffer == NULL) {
+        arena_lock.unlock();
+        return;
+    }
+    arena_active = true;
+}
+
+void ei_dsp_arena_end(void) {
+    if (!arena_active) {
+        return;
+    }
+    // hard reset: count the blocks the scope did not free, then drop everything
+    size_t offset = arena_last;
+    for (size_t ix = 0; ix < arena_live; ix++) {
+        ei_dsp_arena_header_t *hdr = (ei_dsp_arena_header_t *)(arena_buffer + offset);
+        if (!hdr->freed) {
+            arena_stats.discarded++;
+        }
+        offset = hdr->prev;
+    }
+    arena_top = 0;
+    arena_last = 0;
+    arena_live = 0;
+    arena_stats.in_use = 0;
+    arena_active = false;
+    arena_lock.unlock();
+}
+
+void ei_dsp_arena_get_stats(ei_dsp_arena_stats_t *stats) {
+    if (arena_active) {
+        *stats = arena_stats;
+        return;
+    }
+    std::lock_guard<std::mutex> guard(arena_lock);
+    *stats = arena_stats;
+}
+
+void ei_dsp_arena_reset_stats(void) {
+    std::unique_lock<std::mutex> guard(arena_lock, std::defer_lock);
+    if (!arena_active) {
+        guard.lock();
+    }
+    arena_stats.high_water = arena_stats.in_use;
+    arena_stats.allocations = 0;
+    arena_stats.fallbacks = 0;
+    arena_stats.discarded = 0;
+}
+
+void *ei_dsp_arena_malloc(size_t size) {
+    if (arena_active) {
+        size_t aligned = (size + EI_DSP_ARENA_ALIGN - 1) & ~(size_t)(EI_DSP_ARENA_ALIGN - 1);
+        size_t needed = sizeof(ei_dsp_arena_header_t) + aligned;
+        if (size > 0 && needed <= arena_capacity - arena_top) {
+            ei_dsp_arena_header_t *hdr = (ei_dsp_arena_header_t *)(arena_buffer + arena_top);
+            hdr->size = (uint32_t)aligned;
+            hdr->prev = (uint32_t)arena_last;
+            hdr->freed = 0;
+            arena_last = arena_top;
+            arena_top += needed;
+            arena_live++;
+            arena_stats.allocations++;
+            arena_stats.in_use = arena_top;
+            if (arena_top > arena_stats.high_water) {
+                arena_stats.high_water = arena_top;
+            }
+            return hdr + 1;
+        }
+        arena_stats.fallbacks++;
+    }
+    return ei_malloc(size);
+}
+
+void *ei_dsp_arena_calloc(size_t nitems, size_t size) {
+    if (!arena_active) {
+        return ei_calloc(nitems, size);
+    }
+    void *ptr = ei_dsp_arena_malloc(nitems * size);
+    if (ptr) {
+        memset(ptr, 0, nitems * size);
+    }
+    return ptr;
+}
+
+void ei_dsp_arena_free(void *ptr) {
+    if (!arena_contains(ptr)) {
+        ei_free(ptr);
+        return;
+    }
+    if (!arena_active) {
+        // already dropped by ei_dsp_arena_end()
+        return;
+    }
+    ei_dsp_arena_header_t *hdr = (ei_dsp_arena_header_t *)ptr - 1;
+    hdr->freed = 1;
+    if ((uint8_t *)hdr == arena_buffer + arena_last) {
+        arena_pop_freed();
+    }
+}
+#endif // EIDSP_USE_ARENA
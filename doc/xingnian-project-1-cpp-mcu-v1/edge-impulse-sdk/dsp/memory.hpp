@@ -42,6 +42,82 @@
 extern size_t ei_memory_in_use;
 extern size_t ei_memory_peak_use;
 
+#if EIDSP_PROFILE_MEMORY
+#ifndef EI_MEMORY_PROFILE_MAX_STAGES
+#define EI_MEMORY_PROFILE_MAX_STAGES    8
+#endif
+
+/**
+ * Memory used by one stage of an impulse (a DSP block or a learning block).
+ * Byte counts are relative to the tracked DSP heap usage when the stage began.
+ */
+typedef struct {
+    const char *name;           // "dsp" or "nn"
+    uint32_t block_id;
+    size_t peak_bytes;          // highest usage while the stage ran
+    size_t current_bytes;       // usage still held when the stage ended
+    uint32_t allocations;
+    uint32_t frees;
+    size_t largest_allocation;  // largest single allocation
+    // tensor arena, only filled in for "nn" stages
+    size_t arena_size;          // arena size
+    size_t arena_tensor_bytes;  // activation tensors
+    size_t arena_persistent_bytes; // persistent buffers, including scratch buffers
+    size_t arena_scratch_bytes; // scratch buffers requested by the kernels
+    size_t arena_overflow_bytes; // persistent buffers that did not fit and went to the heap
+} ei_memory_stage_t;
+
+/**
+ * Clear all stages and restart peak tracking (called at the start of every impulse run).
+ * The profile-wide peak_bytes / current_bytes in the JSON are relative to this point.
+ */
+void ei_memory_profile_reset(void);
+
+/**
+ * Start a new stage; ends the previous one if still open
+ */
+void ei_memory_profile_begin(const char *name, uint32_t block_id);
+
+/**
+ * End the current stage
+ */
+void ei_memory_profile_end(void);
+
+/**
+ * Record tensor arena usage for the current stage
+ */
+void ei_memory_profile_set_arena(size_t arena_size, size_t tensor_bytes, size_t persistent_bytes,
+    size_t scratch_bytes, size_t overflow_bytes);
+
+/**
+ * Get the recorded stages
+ * @param stages Out: pointer to the stage array
+ * @returns Number of stages
+ */
+size_t ei_memory_profile_get_stages(const ei_memory_stage_t **stages);
+
+/**
+ * Write the profile as JSON, snprintf-style
+ * @param buffer Output buffer (can be NULL if size is 0)
+ * @param size Size of the output buffer
+ * @returns Length of the full JSON document, excluding the terminator
+ */
+size_t ei_memory_profile_to_json(char *buffer, size_t size);
+
+/**
+ * Print the profile as JSON through ei_printf
+ */
+void ei_memory_profile_print_json(void);
+
+void ei_memory_profile_on_alloc(size_t bytes);
+void ei_memory_profile_on_free(size_t bytes);
+#define ei_dsp_profile_alloc(bytes) ei_memory_profile_on_alloc(bytes);
+#define ei_dsp_profile_free(bytes) ei_memory_profile_on_free(bytes);
+#else
+#define ei_dsp_profile_alloc(bytes)
+#define ei_dsp_profile_free(bytes)
+#endif // EIDSP_PROFILE_MEMORY
+
 #if EIDSP_PRINT_ALLOCATIONS == 1
 #define ei_dsp_printf           printf
 #else
@@ -50,6 +126,79 @@ extern size_t ei_memory_peak_use;
 
 typedef std::unique_ptr<void, std::function<void(void*)>> ei_unique_ptr_t;
 
+#if EIDSP_USE_ARENA
+/**
+ * DSP scratch arena. A single preallocated buffer that serves every
+ * ei_dsp_malloc / ei_dsp_calloc / matrix_t allocation made between
+ * ei_dsp_arena_begin() and ei_dsp_arena_end(). Blocks are carved off the top
+ * like a stack; freeing the top block releases it (and any already-freed
+ * blocks below it) immediately, so the allocate/free pattern of the DSP
+ * blocks runs in a fixed footprint. Requests that do not fit, or that are
+ * made outside a begin/end scope, fall back to ei_malloc and are counted.
+ * One thread owns the arena at a time: ei_dsp_arena_begin() waits until it is
+ * free and ei_dsp_arena_end() hands it back, so concurrent run_classifier()
+ * calls take turns for their DSP. Allocations from other threads meanwhile
+ * (e.g. inference next to the DSP worker in run_classifier_batch) go to the heap.
+ */
+typedef struct {
+    size_t capacity;        // usable bytes in the arena
+    size_t in_use;          // bytes currently allocated (including headers)
+    size_t high_water;      // largest in_use seen since init / reset_stats
+    uint32_t allocations;   // allocations served from the arena
+    uint32_t fallbacks;     // allocations that went to the heap instead
+    uint32_t discarded;     // blocks still alive at ei_dsp_arena_end(), dropped by the reset
+} ei_dsp_arena_stats_t;
+
+/**
+ * Reserve the arena.
+ * @param buffer Backing memory (16-byte aligned), or NULL to allocate it with ei_malloc
+ * @param size Size of the arena in bytes
+ * @returns EIDSP_OK, or EIDSP_OUT_OF_MEM if the buffer could not be allocated
+ */
+int ei_dsp_arena_init(void *buffer, size_t size);
+
+/**
+ * Release the arena (frees the backing buffer if it was allocated by ei_dsp_arena_init)
+ */
+void ei_dsp_arena_deinit(void);
+
+/**
+ * Take the arena for the calling thread and serve its DSP allocations from it.
+ * Blocks while another thread is between begin and end. Scopes don't nest.
+ */
+void ei_dsp_arena_begin(void);
+
+/**
+ * Stop serving DSP allocations from the arena, rewind it completely and hand it
+ * to the next thread. Free every block of the scope before this call; blocks
+ * still alive are dropped (counted in ei_dsp_arena_stats_t::discarded) and must
+ * not be used or freed afterwards.
+ */
+void ei_dsp_arena_end(void);
+
+/**
+ * Get usage statistics, including the high-water mark
+ */
+void ei_dsp_arena_get_stats(ei_dsp_arena_stats_t *stats);
+
+/**
+ * Reset the high-water mark and allocation counters
+ */
+void ei_dsp_arena_reset_stats(void);
+
+void *ei_dsp_arena_malloc(size_t size);
+void *ei_dsp_arena_calloc(size_t nitems, size_t size);
+void ei_dsp_arena_free(void *ptr);
+
+#define ei_dsp_raw_malloc        ei_dsp_arena_malloc
+#define ei_dsp_raw_calloc        ei_dsp_arena_calloc
+#define ei_dsp_raw_free          ei_dsp_arena_free
+#else
+#define ei_dsp_raw_malloc        ei_malloc
+#define ei_dsp_raw_calloc        ei_calloc
+#define ei_dsp_raw_free          ei_free
+#endif // EIDSP_USE_ARENA
+
 // deprecated, use the class ei_tracked_unique_ptr below instead
 // this version will NOT track memory usage
 #define EI_ALLOCATE_AUTO_POINTER(ptr, size) \
@@ -80,6 +229,7 @@ namespace ei {
         if (ei_memory_in_use > ei_memory_peak_use) { \
             ei_memory_peak_use = ei_memory_in_use; \
         } \
+        ei_dsp_profile_alloc(bytes) \
         ei_dsp_printf("alloc %lu bytes (in_use=%lu, peak=%lu) (%s@ %s:%d) %p\n", \
             (unsigned long)bytes, (unsigned long)ei_memory_in_use, (unsigned long)ei_memory_peak_use, fn, file, line, ptr);
 
@@ -95,6 +245,7 @@ namespace ei {
         if (ei_memory_in_use > ei_memory_peak_use) { \
             ei_memory_peak_use = ei_memory_in_use; \
         } \
+        ei_dsp_profile_alloc(rows * cols * type_size) \
         ei_dsp_printf("alloc matrix %lu x %lu = %lu bytes (in_use=%lu, peak=%lu) (%s@ %s:%d) %p\n", \
             (unsigned long)rows, (unsigned long)cols, (unsigned long)(rows * cols * type_size), (unsigned long)ei_memory_in_use, \
                 (unsigned long)ei_memory_peak_use, fn, file, line, ptr);
@@ -105,6 +256,7 @@ namespace ei {
      */
     #define ei_dsp_register_free_internal(fn, file, line, bytes, ptr) \
         ei_memory_in_use -= bytes; \
+        ei_dsp_profile_free(bytes) \
         ei_dsp_printf("free %lu bytes (in_use=%lu, peak=%lu) (%s@ %s:%d) %p\n", \
             (unsigned long)bytes, (unsigned long)ei_memory_in_use, (unsigned long)ei_memory_peak_use, fn, file, line, ptr);
 
@@ -117,6 +269,7 @@ namespace ei {
      */
     #define ei_dsp_register_matrix_free_internal(fn, file, line, rows, cols, type_size, ptr) \
         ei_memory_in_use -= (rows * cols * type_size); \
+        ei_dsp_profile_free(rows * cols * type_size) \
         ei_dsp_printf("free matrix %lu x %lu = %lu bytes (in_use=%lu, peak=%lu) (%s@ %s:%d) %p\n", \
             (unsigned long)rows, (unsigned long)cols, (unsigned long)(rows * cols * type_size), \
                 (unsigned long)ei_memory_in_use, (unsigned long)ei_memory_peak_use, fn, file, line, ptr);
@@ -138,9 +291,9 @@ namespace ei {
     #define ei_dsp_register_matrix_alloc(...) (void)0
     #define ei_dsp_register_free(...) (void)0
     #define ei_dsp_register_matrix_free(...) (void)0
-    #define ei_dsp_malloc ei_malloc
-    #define ei_dsp_calloc ei_calloc
-    #define ei_dsp_free(ptr, size) ei_free(ptr)
+    #define ei_dsp_malloc ei_dsp_raw_malloc
+    #define ei_dsp_calloc ei_dsp_raw_calloc
+    #define ei_dsp_free(ptr, size) ei_dsp_raw_free(ptr)
     #define EI_DSP_MATRIX(name, ...) matrix_t name(__VA_ARGS__); if (!name.buffer) { EIDSP_ERR(EIDSP_OUT_OF_MEM); }
     #define EI_DSP_MATRIX_B(name, ...) matrix_t name(__VA_ARGS__); if (!name.buffer) { EIDSP_ERR(EIDSP_OUT_OF_MEM); }
     #define EI_DSP_QUANTIZED_MATRIX(name, ...) quantized_matrix_t name(__VA_ARGS__); if (!name.buffer) { EIDSP_ERR(EIDSP_OUT_OF_MEM); }
@@ -157,7 +310,7 @@ public:
      * @param size The size of the memory block, in bytes.
      */
     static void *ei_wrapped_malloc(const char *fn, const char *file, int line, size_t size) {
-        void *ptr = ei_malloc(size);
+        void *ptr = ei_dsp_raw_malloc(size);
         if (ptr) {
             ei_dsp_register_alloc_internal(fn, file, line, size, ptr);
         }
@@ -171,7 +324,7 @@ public:
      * @param size Size of each element
      */
     static void *ei_wrapped_calloc(const char *fn, const char *file, int line, size_t num, size_t size) {
-        void *ptr = ei_calloc(num, size);
+        void *ptr = ei_dsp_raw_calloc(num, size);
         if (ptr) {
             ei_dsp_register_alloc_internal(fn, file, line, num * size, ptr);
         }
@@ -184,7 +337,7 @@ public:
      * @param size Size of the block of memory previously allocated.
      */
     static void ei_wrapped_free(const char *fn, const char *file, int line, void *ptr, size_t size) {
-        ei_free(ptr);
+        ei_dsp_raw_free(ptr);
         ei_dsp_register_free_internal(fn, file, line, size, ptr);
     }
 };
@@ -192,7 +345,7 @@ public:
 
 // This needs to be a real function so I can bind with a lambda
 __attribute__((unused)) static void ei_dsp_free_func(void *ptr, size_t size) {
-    ei_free(ptr);
+    ei_dsp_raw_free(ptr);
 #if EIDSP_TRACK_ALLOCATIONS
     ei_dsp_register_free_internal("unique_ptr free", "", 0, size, ptr);
 #endif
@@ -212,7 +365,7 @@ static ei_unique_ptr_t make_tracked_unique_ptr(void* ptr_in, size_t size) {
     auto ptr = reinterpret_cast<void**>(ptr_in);
     *ptr = ei_dsp_malloc(size);
     return ei_unique_ptr_t(*ptr, [size](void *ptr) {
-        ei_free(ptr);
+        ei_dsp_raw_free(ptr);
         ei_dsp_register_free_internal("unique_ptr", "", 0, size, ptr);
     });
 }
@@ -231,8 +384,8 @@ __attribute__((warn_unused_result)) __attribute__((unused))
 static ei_unique_ptr_t make_tracked_unique_ptr(void* ptr_in, size_t size)
 {
     auto ptr = reinterpret_cast<void**>(ptr_in);
-    *ptr = ei_malloc(size);
-    return ei_unique_ptr_t(*ptr, ei_free);
+    *ptr = ei_dsp_raw_malloc(size);
+    return ei_unique_ptr_t(*ptr, ei_dsp_raw_free);
 }
 #endif
 
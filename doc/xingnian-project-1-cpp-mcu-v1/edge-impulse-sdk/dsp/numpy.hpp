@@ -97,6 +97,8 @@
 
 #endif // EIDSP_INCLUDE_KISSFFT
 
+#include "edge-impulse-sdk/dsp/ei_fft_plan.h"
+
 // There are downstream builds that have become implicitly dependent on this, so keep
 #include "edge-impulse-sdk/CMSIS/DSP/Include/dsp/statistics_functions.h"
 
@@ -679,6 +681,7 @@ public:
      * @param pad_before Number of items to pad before
      * @param pad_after Number of items to pad after
      * @returns 0 if OK
+     * @note input may already sit at row pad_before of output (in-place padding)
      */
     static int pad_1d_symmetric(matrix_t *input, matrix_t *output, uint16_t pad_before, uint16_t pad_after) {
         if (output->cols != input->cols) {
@@ -715,9 +718,11 @@ public:
             }
         }
 
-        memcpy(output->buffer + (input->cols * pad_before),
-            input->buffer,
-            input->rows * input->cols * sizeof(float));
+        if (output->buffer + (input->cols * pad_before) != input->buffer) {
+            memcpy(output->buffer + (input->cols * pad_before),
+                input->buffer,
+                input->rows * input->cols * sizeof(float));
+        }
 
         int32_t pad_after_index = input->rows - 1;
         bool pad_after_direction_up = false;
@@ -1381,6 +1386,17 @@ public:
         // pad to the rigth with zeros
         memset(fft_input.buffer + src_size, 0, (n_fft - src_size) * sizeof(float));
 
+        // cached plan for this size (created once, shared by all spectral blocks)
+        ei::fft::fft_plan_t *plan = ei::fft::plan_acquire(n_fft, ei::fft::EI_FFT_FORWARD, ei::fft::EI_FFT_F32);
+        if (plan) {
+            int ret = ei::fft::plan_execute_r2c(plan, fft_input.buffer, output);
+            int hw_status = plan->hw_status;
+            ei::fft::plan_release(plan);
+            handle_fft_hw_failure(hw_status, n_fft);
+            return ret;
+        }
+
+        // plan pool exhausted, run with a temporary plan
         auto res = ei::fft::hw_r2c_fft(fft_input.buffer, output, n_fft);
         if (handle_fft_hw_failure(res, n_fft)) {
             // fallback to software
@@ -1510,6 +1526,8 @@ public:
     static int signal_from_buffer(const float *data, size_t data_size, signal_t *signal)
     {
         signal->total_length = data_size;
+        signal->span_data = data;
+        signal->span_type = EI_SIGNAL_SPAN_FLOAT;
 #ifdef __MBED__
         signal->get_data = mbed::callback(&numpy::signal_get_data, data);
 #else
@@ -1520,8 +1538,57 @@ public:
         return EIDSP_OK;
     }
 
+    /**
+     * Create a signal structure from an int16 buffer (e.g. raw PCM audio).
+     * DSP blocks that understand spans (MFCC / MFE / spectrogram) convert the samples
+     * to float while reading each frame, so no float copy of the whole buffer is needed;
+     * other blocks go through the converting get_data callback.
+     * @param data Buffer, make sure to keep this pointer alive
+     * @param data_size Number of samples in the buffer
+     * @param signal Output signal
+     * @returns EIDSP_OK if ok
+     */
+    static int signal_from_int16_buffer(const EIDSP_i16 *data, size_t data_size, signal_t *signal)
+    {
+        signal->total_length = data_size;
+        signal->span_data = data;
+        signal->span_type = EI_SIGNAL_SPAN_INT16;
+        signal->get_data = [data](size_t offset, size_t length, float *out_ptr) {
+            return numpy::int16_to_float(data + offset, out_ptr, length);
+        };
+        return EIDSP_OK;
+    }
+
 #endif
 
+    /**
+     * Read samples from a signal. Signals with a contiguous buffer are read (and
+     * converted) directly, others through their get_data callback.
+     * @param signal Signal to read from
+     * @param offset Offset in the signal
+     * @param length Number of samples to read
+     * @param out_ptr Output buffer (length floats)
+     * @returns EIDSP_OK if ok
+     */
+    static int signal_read(const signal_t *signal, size_t offset, size_t length, float *out_ptr)
+    {
+        switch (signal->span_type) {
+            case EI_SIGNAL_SPAN_FLOAT:
+                if (offset + length > signal->total_length) {
+                    EIDSP_ERR(EIDSP_OUT_OF_BOUNDS);
+                }
+                memcpy(out_ptr, static_cast<const float *>(signal->span_data) + offset, length * sizeof(float));
+                return EIDSP_OK;
+            case EI_SIGNAL_SPAN_INT16:
+                if (offset + length > signal->total_length) {
+                    EIDSP_ERR(EIDSP_OUT_OF_BOUNDS);
+                }
+                return int16_to_float(static_cast<const EIDSP_i16 *>(signal->span_data) + offset, out_ptr, length);
+            default:
+                return signal->get_data(offset, length, out_ptr);
+        }
+    }
+
 #if defined ( __GNUC__ )
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wstrict-aliasing"
@@ -326,7 +326,8 @@ public:
                     (stack_frame_info.signal->total_length - (signal_offset + signal_length));
             }
 
-            ret = stack_frame_info.signal->get_data(
+            ret = numpy::signal_read(
+                stack_frame_info.signal,
                 signal_offset,
                 signal_length,
                 signal_frame.buffer
@@ -503,7 +504,8 @@ public:
                     (stack_frame_info.signal->total_length - (signal_offset + signal_length));
             }
 
-            ret = stack_frame_info.signal->get_data(
+            ret = numpy::signal_read(
+                stack_frame_info.signal,
                 signal_offset,
                 signal_length,
                 signal_frame.buffer
@@ -614,7 +616,8 @@ public:
                     (stack_frame_info.signal->total_length - (signal_offset + signal_length));
             }
 
-            ret = stack_frame_info.signal->get_data(
+            ret = numpy::signal_read(
+                stack_frame_info.signal,
                 signal_offset,
                 signal_length,
                 signal_frame.buffer
@@ -55,6 +55,17 @@ public:
         preemphasis(ei_signal_t *signal, int shift, float cof, bool rescale)
             : _signal(signal), _shift(shift), _cof(cof), _rescale(rescale)
         {
+            // contiguous signals are preemphasized straight from their buffer, no history needed
+            if (signal->span_type != EI_SIGNAL_SPAN_NONE) {
+                _prev_buffer = nullptr;
+                _end_of_signal_buffer = nullptr;
+                _next_offset_should_be = 0;
+                if (shift < 0) {
+                    _shift = signal->total_length + shift;
+                }
+                return;
+            }
+
             _prev_buffer = (float*)ei_dsp_calloc(shift * sizeof(float), 1);
             _end_of_signal_buffer = (float*)ei_dsp_calloc(shift * sizeof(float), 1);
             _next_offset_should_be = 0;
@@ -76,6 +87,13 @@ public:
          * @param length Length of the audio signal
          */
         int get_data(size_t offset, size_t length, float *out_buffer) {
+            if (_signal->span_type == EI_SIGNAL_SPAN_INT16) {
+                return get_data_span(static_cast<const EIDSP_i16 *>(_signal->span_data), offset, length, out_buffer);
+            }
+            if (_signal->span_type == EI_SIGNAL_SPAN_FLOAT) {
+                return get_data_span(static_cast<const float *>(_signal->span_data), offset, length, out_buffer);
+            }
+
             if (!_prev_buffer || !_end_of_signal_buffer) {
                 EIDSP_ERR(EIDSP_OUT_OF_MEM);
             }
@@ -141,6 +159,51 @@ public:
         }
 
 private:
+        /**
+         * Fused convert + preemphasis from a contiguous buffer:
+         * out[i] = x[j] - cof * x[j - shift], where the first `shift` samples take
+         * their history from the end of the signal (same as the callback path).
+         */
+        template<typename T>
+        int get_data_span(const T *x, size_t offset, size_t length, float *out_buffer) {
+            const size_t total = _signal->total_length;
+            const size_t shift = static_cast<size_t>(_shift);
+            if (offset + length > total) {
+                EIDSP_ERR(EIDSP_OUT_OF_BOUNDS);
+            }
+            if (_shift < 0 || shift > total) {
+                EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+            }
+
+            size_t ix = 0;
+            for (; ix < length && offset + ix < shift; ix++) {
+                out_buffer[ix] = static_cast<float>(x[offset + ix]) -
+                    _cof * static_cast<float>(x[total - shift + offset + ix]);
+            }
+            // hot loop: two linear reads, no history buffer, vectorizable
+            if (ix < length) {
+                const T *cur = x + offset + ix;
+                const T *prev = cur - shift;
+                float *out = out_buffer + ix;
+                const size_t n = length - ix;
+                for (size_t i = 0; i < n; i++) {
+                    out[i] = static_cast<float>(cur[i]) - _cof * static_cast<float>(prev[i]);
+                }
+            }
+
+            _next_offset_should_be += length;
+
+            if (_rescale) {
+                matrix_t scale_matrix(length, 1, out_buffer);
+                int ret = numpy::scale(&scale_matrix, 1.0f / 32768.0f);
+                if (ret != 0) {
+                    EIDSP_ERR(ret);
+                }
+            }
+
+            return EIDSP_OK;
+        }
+
         ei_signal_t *_signal;
         int _shift;
         float _cof;
@@ -486,6 +549,128 @@ namespace processing {
         return EIDSP_OK;
     }
 
+    /**
+     * Quantize a value to int8, same rounding and saturation as the TFLite input tensors
+     */
+    static int8_t quantize_i8(float value, float scale, int32_t zero_point) {
+        int32_t q = static_cast<int32_t>(round(value / scale)) + zero_point;
+        return static_cast<int8_t>(std::min(std::max(q, static_cast<int32_t>(-128)), static_cast<int32_t>(127)));
+    }
+
+    /**
+     * Same as cmvnw() (without scaling), but leaves the input untouched and writes the
+     * normalized features quantized to int8 (value / scale + zero_point, saturated) into
+     * output_matrix, e.g. straight into the input tensor of a quantized model.
+     * The mean-subtracted features are kept in the padding buffer, so no copy of the
+     * input is needed; results are identical to cmvnw() followed by quantization.
+     * @param features_matrix input feature matrix (one observation per row)
+     * @param output_matrix output matrix (same number of elements as the input)
+     * @param win_size The size of sliding window for local normalization.
+     * @param variance_normalization If the variance normilization should
+     *   be performed or not.
+     * @param scale Quantization scale
+     * @param zero_point Quantization zero point
+     * @returns 0 if OK
+     */
+    static int cmvnw_quantized(matrix_t *features_matrix, matrix_i8_t *output_matrix, uint16_t win_size,
+        bool variance_normalization, float scale, int32_t zero_point)
+    {
+        if (output_matrix->rows * output_matrix->cols != features_matrix->rows * features_matrix->cols) {
+            EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+        }
+
+        if (win_size == 0) {
+            for (size_t ix = 0; ix < features_matrix->rows * features_matrix->cols; ix++) {
+                output_matrix->buffer[ix] = quantize_i8(features_matrix->buffer[ix], scale, zero_point);
+            }
+            return EIDSP_OK;
+        }
+
+        uint16_t pad_size = (win_size - 1) / 2;
+
+        int ret;
+
+        // mean & variance normalization
+        EI_DSP_MATRIX(vec_pad, features_matrix->rows + (pad_size * 2), features_matrix->cols);
+        if (!vec_pad.buffer) {
+            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        }
+
+        ret = numpy::pad_1d_symmetric(features_matrix, &vec_pad, pad_size, pad_size);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+
+        EI_DSP_MATRIX(mean_matrix, vec_pad.cols, 1);
+        if (!mean_matrix.buffer) {
+            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        }
+
+        EI_DSP_MATRIX(window_variance, vec_pad.cols, 1);
+        if (!window_variance.buffer) {
+            return EIDSP_OUT_OF_MEM;
+        }
+
+        for (size_t ix = 0; ix < features_matrix->rows; ix++) {
+            // create a slice on the vec_pad
+            EI_DSP_MATRIX_B(window, win_size, vec_pad.cols, vec_pad.buffer + (ix * vec_pad.cols));
+            if (!window.buffer) {
+                EIDSP_ERR(EIDSP_OUT_OF_MEM);
+            }
+
+            ret = numpy::mean_axis0(&window, &mean_matrix);
+            if (ret != EIDSP_OK) {
+                EIDSP_ERR(ret);
+            }
+
+            // row ix of vec_pad is not part of any later window, store the centered row there
+            for (size_t fm_col = 0; fm_col < features_matrix->cols; fm_col++) {
+                vec_pad.buffer[(ix * vec_pad.cols) + fm_col] =
+                    features_matrix->buffer[(ix * features_matrix->cols) + fm_col] - mean_matrix.buffer[fm_col];
+            }
+        }
+
+        // move the centered rows in place and pad them again
+        float *centered = vec_pad.buffer + (pad_size * vec_pad.cols);
+        memmove(centered, vec_pad.buffer, features_matrix->rows * vec_pad.cols * sizeof(float));
+
+        matrix_t centered_matrix(features_matrix->rows, vec_pad.cols, centered);
+        ret = numpy::pad_1d_symmetric(&centered_matrix, &vec_pad, pad_size, pad_size);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+
+        for (size_t ix = 0; ix < features_matrix->rows; ix++) {
+            float *centered_row = centered + (ix * vec_pad.cols);
+            int8_t *output_row = output_matrix->buffer + (ix * vec_pad.cols);
+
+            if (variance_normalization == true) {
+                // create a slice on the vec_pad
+                EI_DSP_MATRIX_B(window, win_size, vec_pad.cols, vec_pad.buffer + (ix * vec_pad.cols));
+                if (!window.buffer) {
+                    EIDSP_ERR(EIDSP_OUT_OF_MEM);
+                }
+
+                ret = numpy::std_axis0(&window, &window_variance);
+                if (ret != EIDSP_OK) {
+                    EIDSP_ERR(ret);
+                }
+
+                for (size_t col = 0; col < vec_pad.cols; col++) {
+                    float value = centered_row[col] / (window_variance.buffer[col] + 1e-10);
+                    output_row[col] = quantize_i8(value, scale, zero_point);
+                }
+            }
+            else {
+                for (size_t col = 0; col < vec_pad.cols; col++) {
+                    output_row[col] = quantize_i8(centered_row[col], scale, zero_point);
+                }
+            }
+        }
+
+        return EIDSP_OK;
+    }
+
     /**
      * Perform normalization for MFE frames, this converts the signal to dB,
      * then add a hard filter, and quantize / dequantize the output
@@ -2063,9 +2063,76 @@ limitations under the License.
 #include "edge-impulse-sdk/tensorflow/lite/micro/kernels/kernel_util.h"
 #include "edge-impulse-sdk/tensorflow/lite/micro/micro_log.h"
 
+#if EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
+#include "edge-impulse-sdk/tensorflow/lite/micro/kernels/parallel_kernels.h"
+#endif
+
 namespace tflite {
 namespace {
 
+// Int8 convolution. With EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS the output
+// rows are split across the host thread pool; each range runs the reference
+// kernel on the input rows it needs with the top padding adjusted, so every
+// output element is computed exactly as in a single call.
+void ConvPerChannelInt8(const ConvParams& params,
+                        const int32_t* output_multiplier,
+                        const int32_t* output_shift,
+                        const RuntimeShape& input_shape,
+                        const int8_t* input_data,
+                        const RuntimeShape& filter_shape,
+                        const int8_t* filter_data,
+                        const RuntimeShape& bias_shape,
+                        const int32_t* bias_data,
+                        const RuntimeShape& output_shape,
+                        int8_t* output_data) {
+#if EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
+  const int batches = input_shape.Dims(0);
+  const int input_height = input_shape.Dims(1);
+  const int input_row_size = input_shape.Dims(2) * input_shape.Dims(3);
+  const int output_height = output_shape.Dims(1);
+  const int output_row_size = output_shape.Dims(2) * output_shape.Dims(3);
+  const int64_t cost = static_cast<int64_t>(output_height) * output_row_size *
+                       filter_shape.Dims(1) * filter_shape.Dims(2) *
+                       filter_shape.Dims(3);
+
+  for (int batch = 0; batch < batches; ++batch) {
+    const int8_t* batch_input =
+        input_data + batch * input_height * input_row_size;
+    int8_t* batch_output =
+        output_data + batch * output_height * output_row_size;
+
+    auto rows = [&](int begin, int end) {
+      const int in_y_origin =
+          begin * params.stride_height - params.padding_values.height;
+      const int skip = std::min(std::max(in_y_origin, 0), input_height);
+      ConvParams range_params = params;
+      range_params.padding_values.height =
+          static_cast<int16_t>(skip - in_y_origin);
+      const int32_t range_input_dims[4] = {1, input_height - skip,
+                                           input_shape.Dims(2),
+                                           input_shape.Dims(3)};
+      const int32_t range_output_dims[4] = {1, end - begin,
+                                            output_shape.Dims(2),
+                                            output_shape.Dims(3)};
+      reference_integer_ops::ConvPerChannel(
+          range_params, output_multiplier, output_shift,
+          RuntimeShape(4, range_input_dims),
+          batch_input + skip * input_row_size, filter_shape, filter_data,
+          bias_shape, bias_data, RuntimeShape(4, range_output_dims),
+          batch_output + begin * output_row_size);
+    };
+    if (!micro::ParallelFor(output_height, cost, rows)) {
+      rows(0, output_height);
+    }
+  }
+#else
+  reference_integer_ops::ConvPerChannel(
+      params, output_multiplier, output_shift, input_shape, input_data,
+      filter_shape, filter_data, bias_shape, bias_data, output_shape,
+      output_data);
+#endif  // EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
+}
+
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
   return context->AllocatePersistentBuffer(context, sizeof(OpDataConv));
@@ -2167,7 +2234,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
               tflite::micro::GetTensorData<int8_t>(filter),
               tflite::micro::GetTensorShape(filter).FlatSize(),
               unpacked_filter_data);
-          reference_integer_ops::ConvPerChannel(
+          ConvPerChannelInt8(
               ConvParamsQuantized(params, data),
               data.per_channel_output_multiplier, data.per_channel_output_shift,
               tflite::micro::GetTensorShape(input),
@@ -2180,7 +2247,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           break;
         }
         case kTfLiteInt8: {
-          reference_integer_ops::ConvPerChannel(
+          ConvPerChannelInt8(
               ConvParamsQuantized(params, data),
               data.per_channel_output_multiplier, data.per_channel_output_shift,
               tflite::micro::GetTensorShape(input),
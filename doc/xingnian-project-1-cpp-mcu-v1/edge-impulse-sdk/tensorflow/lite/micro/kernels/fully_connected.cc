@@ -1624,9 +1624,64 @@ limitations under the License.
 #include "edge-impulse-sdk/tensorflow/lite/micro/kernels/kernel_util.h"
 #include "edge-impulse-sdk/tensorflow/lite/micro/micro_log.h"
 
+#if EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
+#include "edge-impulse-sdk/tensorflow/lite/micro/kernels/parallel_kernels.h"
+#endif
+
 namespace tflite {
 namespace {
 
+// Int8 fully connected layer. With EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS the
+// batches (or, for a single batch, the output channels) are split across the
+// host thread pool; each range runs the reference kernel on its slice of the
+// input or filter, so every output is computed exactly as in a single call.
+void FullyConnectedInt8(const FullyConnectedParams& params,
+                        const RuntimeShape& input_shape,
+                        const int8_t* input_data,
+                        const RuntimeShape& filter_shape,
+                        const int8_t* filter_data,
+                        const RuntimeShape& bias_shape,
+                        const int32_t* bias_data,
+                        const RuntimeShape& output_shape,
+                        int8_t* output_data) {
+#if EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
+  const int output_dim_count = output_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dim_count - 1);
+  const int output_depth = output_shape.Dims(output_dim_count - 1);
+  const int accum_depth =
+      filter_shape.Dims(filter_shape.DimensionsCount() - 1);
+  const int64_t cost =
+      static_cast<int64_t>(batches) * output_depth * accum_depth;
+  const bool split_batches = batches > 1;
+
+  auto slice = [&](int begin, int end) {
+    if (split_batches) {
+      const int32_t range_output_dims[2] = {end - begin, output_depth};
+      reference_integer_ops::FullyConnected(
+          params, input_shape, input_data + begin * accum_depth,
+          filter_shape, filter_data, bias_shape, bias_data,
+          RuntimeShape(2, range_output_dims),
+          output_data + begin * output_depth);
+    } else {
+      const int32_t range_filter_dims[2] = {end - begin, accum_depth};
+      const int32_t range_output_dims[2] = {1, end - begin};
+      reference_integer_ops::FullyConnected(
+          params, input_shape, input_data, RuntimeShape(2, range_filter_dims),
+          filter_data + begin * accum_depth, bias_shape,
+          bias_data ? bias_data + begin : nullptr,
+          RuntimeShape(2, range_output_dims), output_data + begin);
+    }
+  };
+  if (micro::ParallelFor(split_batches ? batches : output_depth, cost,
+                         slice)) {
+    return;
+  }
+#endif  // EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
+  reference_integer_ops::FullyConnected(
+      params, input_shape, input_data, filter_shape, filter_data, bias_shape,
+      bias_data, output_shape, output_data);
+}
+
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
   return context->AllocatePersistentBuffer(context,
@@ -1732,7 +1787,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
               tflite::micro::GetTensorData<int8_t>(filter),
               tflite::micro::GetTensorShape(filter).FlatSize(),
               unpacked_filter_data);
-          tflite::reference_integer_ops::FullyConnected(
+          FullyConnectedInt8(
               FullyConnectedParamsQuantized(data),
               tflite::micro::GetTensorShape(input),
               tflite::micro::GetTensorData<int8_t>(input),
@@ -1744,7 +1799,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           break;
         }
         case kTfLiteInt8: {
-          tflite::reference_integer_ops::FullyConnected(
+          FullyConnectedInt8(
               FullyConnectedParamsQuantized(data),
               tflite::micro::GetTensorShape(input),
               tflite::micro::GetTensorData<int8_t>(input),
@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2024 EdgeImpulse Inc.
+ *
+ * Generated by Edge Impulse and licensed under the applicable Edge Impulse
+ * Terms of Service. Community and Professional Terms of Service
+ * (https://edgeimpulse.com/legal/terms-of-service) or Enterprise Terms of
+ * Service (https://edgeimpulse.com/legal/enterprise-terms-of-service),
+ * according to your product plan subscription (the “License”).
+ *
+ * This software, documentation and other associated files (collectively referred
+ * to as the “Software”) is a single SDK variation generated by the Edge Impulse
+ * platform and requires an active paid Edge Impulse subscription to use this
+ * Software for any purpose.
+ *
+ * You may NOT use this Software unless you have an active Edge Impulse subscription
+ * that meets the eligibility requirements for the applicable License, subject to
+ * your full and continued compliance with the terms and conditions of the License,
+ * including without limitation any usage restrictions under the applicable License.
+ *
+ * If you do not have an active Edge Impulse product plan subscription, or if use
+ * of this Software exceeds the usage limitations of your Edge Impulse product plan
+ * subscription, you are not permitted to use this Software and must immediately
+ * delete and erase all copies of this Software within your control or possession.
+ * Edge Impulse reserves all rights and remedies available to enforce its rights.
+ *
+ * Unless required by applicable law or agreed to in writing, the Software is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language governing
+ * permissions, disclaimers and limitations under the License.
+ */
+
+#include "edge-impulse-sdk/classifier/ei_classifier_config.h"
+#if EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
+
+#include "edge-impulse-sdk/tensorflow/lite/micro/kernels/parallel_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tflite {
+namespace micro {
+namespace {
+
+// Each thread starts with this many chunks; stealing evens out the rest.
+constexpr int kChunksPerThread = 4;
+
+// The chunks [begin, end) still queued on one thread, packed into one word
+// so the owner (taking from the front) and thieves (taking from the back)
+// race on a single compare-and-swap.
+class ChunkRange {
+ public:
+  void Reset(uint32_t begin, uint32_t end) {
+    range_.store(Pack(begin, end), std::memory_order_relaxed);
+  }
+
+  bool PopFront(uint32_t* chunk) {
+    uint64_t cur = range_.load(std::memory_order_acquire);
+    for (;;) {
+      const uint32_t begin = static_cast<uint32_t>(cur >> 32);
+      const uint32_t end = static_cast<uint32_t>(cur);
+      if (begin >= end) {
+        return false;
+      }
+      if (range_.compare_exchange_weak(cur, Pack(begin + 1, end),
+                                       std::memory_order_acq_rel)) {
+        *chunk = begin;
+        return true;
+      }
+    }
+  }
+
+  bool PopBack(uint32_t* chunk) {
+    uint64_t cur = range_.load(std::memory_order_acquire);
+    for (;;) {
+      const uint32_t begin = static_cast<uint32_t>(cur >> 32);
+      const uint32_t end = static_cast<uint32_t>(cur);
+      if (begin >= end) {
+        return false;
+      }
+      if (range_.compare_exchange_weak(cur, Pack(begin, end - 1),
+                                       std::memory_order_acq_rel)) {
+        *chunk = end - 1;
+        return true;
+      }
+    }
+  }
+
+ private:
+  static uint64_t Pack(uint32_t begin, uint32_t end) {
+    return (static_cast<uint64_t>(begin) << 32) | end;
+  }
+
+  std::atomic<uint64_t> range_{0};
+};
+
+// Work-stealing pool: num_threads - 1 workers plus the calling thread. Run()
+// deals the chunks out evenly, every thread drains its own range and then
+// steals from the back of the others until nothing is left.
+class ThreadPool {
+ public:
+  explicit ThreadPool(int num_threads)
+      : num_threads_(num_threads), ranges_(new ChunkRange[num_threads]) {
+    for (int ix = 1; ix < num_threads_; ix++) {
+      workers_.emplace_back(&ThreadPool::WorkerLoop, this, ix);
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  int num_threads() const { return num_threads_; }
+
+  void Run(int count, ParallelRangeFn fn, void* ctx) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      fn_ = fn;
+      ctx_ = ctx;
+      count_ = count;
+      num_chunks_ = std::min(count, num_threads_ * kChunksPerThread);
+      for (int ix = 0; ix < num_threads_; ix++) {
+        ranges_[ix].Reset(
+            static_cast<uint32_t>(ix * num_chunks_ / num_threads_),
+            static_cast<uint32_t>((ix + 1) * num_chunks_ / num_threads_));
+      }
+      busy_workers_ = static_cast<int>(workers_.size());
+      generation_++;
+    }
+    start_cv_.notify_all();
+
+    Work(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return busy_workers_ == 0; });
+  }
+
+ private:
+  void WorkerLoop(int index) {
+    uint64_t seen = 0;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        start_cv_.wait(lock,
+                       [&] { return stop_ || generation_ != seen; });
+        if (stop_) {
+          return;
+        }
+        seen = generation_;
+      }
+
+      Work(index);
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--busy_workers_ == 0) {
+        done_cv_.notify_one();
+      }
+    }
+  }
+
+  void Work(int index) {
+    uint32_t chunk;
+    for (;;) {
+      bool found = ranges_[index].PopFront(&chunk);
+      for (int ix = 1; !found && ix < num_threads_; ix++) {
+        found = ranges_[(index + ix) % num_threads_].PopBack(&chunk);
+      }
+      if (!found) {
+        return;
+      }
+      const int begin = static_cast<int>(
+          static_cast<int64_t>(chunk) * count_ / num_chunks_);
+      const int end = static_cast<int>(
+          static_cast<int64_t>(chunk + 1) * count_ / num_chunks_);
+      fn_(ctx_, begin, end);
+    }
+  }
+
+  const int num_threads_;
+  std::unique_ptr<ChunkRange[]> ranges_;
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  uint64_t generation_ = 0;
+  int busy_workers_ = 0;
+  bool stop_ = false;
+
+  // current job, written under mutex_ before generation_ is bumped
+  ParallelRangeFn fn_ = nullptr;
+  void* ctx_ = nullptr;
+  int count_ = 0;
+  int num_chunks_ = 1;
+};
+
+thread_local ParallelKernelOptions current_options = {0, 0};
+
+// One job at a time; the pool is rebuilt when the thread count changes.
+std::mutex pool_mutex;
+std::unique_ptr<ThreadPool> pool;
+
+}  // namespace
+
+void SetParallelKernelOptions(const ParallelKernelOptions* options) {
+  if (options) {
+    current_options = *options;
+  } else {
+    current_options = {0, 0};
+  }
+}
+
+bool ParallelFor(int count, int64_t total_cost, ParallelRangeFn fn,
+                 void* ctx) {
+  const ParallelKernelOptions options = current_options;
+  if (options.num_threads <= 1 || count < 2 ||
+      total_cost < options.min_parallel_cost) {
+    return false;
+  }
+
+  // another inference is using the pool; running inline is still exact
+  std::unique_lock<std::mutex> lock(pool_mutex, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return false;
+  }
+  if (!pool || pool->num_threads() != options.num_threads) {
+    pool.reset();
+    pool.reset(new ThreadPool(options.num_threads));
+  }
+  pool->Run(count, fn, ctx);
+  return true;
+}
+
+}  // namespace micro
+}  // namespace tflite
+
+#endif  // EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2024 EdgeImpulse Inc.
+ *
+ * Generated by Edge Impulse and licensed under the applicable Edge Impulse
+ * Terms of Service. Community and Professional Terms of Service
+ * (https://edgeimpulse.com/legal/terms-of-service) or Enterprise Terms of
+ * Service (https://edgeimpulse.com/legal/enterprise-terms-of-service),
+ * according to your product plan subscription (the “License”).
+ *
+ * This software, documentation and other associated files (collectively referred
+ * to as the “Software”) is a single SDK variation generated by the Edge Impulse
+ * platform and requires an active paid Edge Impulse subscription to use this
+ * Software for any purpose.
+ *
+ * You may NOT use this Software unless you have an active Edge Impulse subscription
+ * that meets the eligibility requirements for the applicable License, subject to
+ * your full and continued compliance with the terms and conditions of the License,
+ * including without limitation any usage restrictions under the applicable License.
+ *
+ * If you do not have an active Edge Impulse product plan subscription, or if use
+ * of this Software exceeds the usage limitations of your Edge Impulse product plan
+ * subscription, you are not permitted to use this Software and must immediately
+ * delete and erase all copies of this Software within your control or possession.
+ * Edge Impulse reserves all rights and remedies available to enforce its rights.
+ *
+ * Unless required by applicable law or agreed to in writing, the Software is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language governing
+ * permissions, disclaimers and limitations under the License.
+ */
+
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_PARALLEL_KERNELS_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_PARALLEL_KERNELS_H_
+
+#include <cstdint>
+
+namespace tflite {
+namespace micro {
+
+// Host-only multi-threaded execution of the reference int8 CONV_2D and
+// FULLY_CONNECTED kernels (EI_CLASSIFIER_TFLITE_PARALLEL_KERNELS).
+//
+// A kernel splits its output into independent ranges (output rows for
+// CONV_2D, output channels or batches for FULLY_CONNECTED) and hands them to
+// ParallelFor(). Every range still runs the unmodified reference loop, so the
+// results are bit-exact with the single-threaded kernel no matter which
+// thread ends up computing a range.
+
+struct ParallelKernelOptions {
+  // Threads used per layer, including the calling thread. <= 1 disables the
+  // pool.
+  int num_threads;
+  // Layers with fewer multiply-accumulates than this run single-threaded.
+  int64_t min_parallel_cost;
+};
+
+// Sets the options used by kernels invoked from the calling thread; nullptr
+// restores single-threaded execution. run_inference() sets them from the
+// impulse handle before running the learning blocks.
+void SetParallelKernelOptions(const ParallelKernelOptions* options);
+
+typedef void (*ParallelRangeFn)(void* ctx, int begin, int end);
+
+// Runs fn over [0, count) split into ranges spread over the thread pool and
+// returns true once all of them are done. Returns false without calling fn
+// when the work should stay on the calling thread (pool disabled, count < 2,
+// total_cost below the threshold or the pool busy with another inference).
+bool ParallelFor(int count, int64_t total_cost, ParallelRangeFn fn, void* ctx);
+
+template <typename Fn>
+bool ParallelFor(int count, int64_t total_cost, const Fn& fn) {
+  return ParallelFor(
+      count, total_cost,
+      [](void* ctx, int begin, int end) {
+        (*static_cast<const Fn*>(ctx))(begin, end);
+      },
+      const_cast<Fn*>(&fn));
+}
+
+}  // namespace micro
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_PARALLEL_KERNELS_H_
@@ -0,0 +1,163 @@
+/*
+ * Host test: run_classifier_batch() with the DSP scratch arena enabled
+ *
+ * The batch runs DSP on a worker thread next to inference, so the DSP worker holds the
+ * arena while inference allocates from the heap. Checks that every window gets exactly the
+ * result of a separate run_classifier() call, that the arena is back to empty afterwards,
+ * and that the graph is released so run_classifier() still works after the batch. Also
+ * runs DSP on several threads at once: the arena is handed from one thread to the next
+ * and the others use the heap.
+ */
+
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier_batch.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#if !EIDSP_USE_ARENA
+#error "this test must be built with EIDSP_USE_ARENA=1"
+#endif
+
+static const size_t test_windows = 12;
+static const size_t dsp_threads = 4;
+static const size_t dsp_rounds = 8;
+
+static int failures = 0;
+
+#define TEST_CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+static bool same_result(const ei_impulse_result_t &a, const ei_impulse_result_t &b) {
+    for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+        if (a.classification[ix].value != b.classification[ix].value ||
+            strcmp(a.classification[ix].label, b.classification[ix].label) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Run the first DSP block of the impulse on several threads at once, each inside its
+ * own arena scope, while another thread allocates through ei_dsp_calloc outside any
+ * scope (as inference does next to the DSP worker). Every thread must get the same
+ * features as a sequential run.
+ */
+static void test_concurrent_dsp(std::vector<signal_t> &signals) {
+    const ei_model_dsp_t &block = ei_default_impulse.impulse->dsp_blocks[0];
+    const float frequency = ei_default_impulse.impulse->frequency;
+
+    std::vector<std::vector<float>> expected(test_windows);
+    for (size_t w = 0; w < test_windows; w++) {
+        matrix_t features(1, block.n_output_features);
+        ei_dsp_arena_begin();
+        TEST_CHECK(block.extract_fn(&signals[w], &features, block.config, frequency) == EIDSP_OK);
+        ei_dsp_arena_end();
+        expected[w].assign(features.buffer, features.buffer + block.n_output_features);
+    }
+
+    std::vector<int> mismatches(dsp_threads, 0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < dsp_threads; t++) {
+        threads.emplace_back([&, t]() {
+            matrix_t features(1, block.n_output_features);
+            for (size_t r = 0; r < dsp_rounds; r++) {
+                size_t w = (t + r) % test_windows;
+                ei_dsp_arena_begin();
+                int ret = block.extract_fn(&signals[w], &features, block.config, frequency);
+                ei_dsp_arena_end();
+                if (ret != EIDSP_OK ||
+                    memcmp(features.buffer, expected[w].data(), expected[w].size() * sizeof(float)) != 0) {
+                    mismatches[t]++;
+                }
+            }
+        });
+    }
+    std::thread outside([&]() {
+        for (size_t r = 0; r < dsp_rounds * 16; r++) {
+            void *ptr = ei_dsp_calloc(1, 256);
+            TEST_CHECK(ptr != NULL);
+            ei_dsp_free(ptr, 256);
+        }
+    });
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    outside.join();
+
+    for (size_t t = 0; t < dsp_threads; t++) {
+        if (mismatches[t] != 0) {
+            printf("FAIL thread %u: %d DSP runs differ from the sequential run\n", (unsigned)t, mismatches[t]);
+            failures++;
+        }
+    }
+}
+
+int main(void) {
+    // deterministic windows: tones of different frequency and level over noise
+    std::vector<std::vector<int16_t>> pcm(test_windows);
+    std::vector<signal_t> signals(test_windows);
+    srand(49);
+    for (size_t w = 0; w < test_windows; w++) {
+        pcm[w].resize(EI_CLASSIFIER_RAW_SAMPLE_COUNT);
+        for (size_t ix = 0; ix < pcm[w].size(); ix++) {
+            pcm[w][ix] = (int16_t)((w % 3) * 3000 * sin(ix * 0.01 * (w + 1)) + rand() % 4000 - 2000);
+        }
+        TEST_CHECK(numpy::signal_from_int16_buffer(pcm[w].data(), pcm[w].size(), &signals[w]) == 0);
+    }
+
+    run_classifier_init();
+
+    std::vector<ei_impulse_result_t> expected(test_windows);
+    for (size_t w = 0; w < test_windows; w++) {
+        TEST_CHECK(run_classifier(&signals[w], &expected[w], false) == EI_IMPULSE_OK);
+    }
+
+    ei_dsp_arena_reset_stats();
+
+    std::vector<ei_impulse_result_t> results(test_windows);
+    ei_batch_stats_t stats;
+    TEST_CHECK(run_classifier_batch(signals.data(), test_windows, results.data(), &stats, false) == EI_IMPULSE_OK);
+    TEST_CHECK(stats.windows == test_windows);
+
+    for (size_t w = 0; w < test_windows; w++) {
+        if (!same_result(expected[w], results[w])) {
+            printf("FAIL window %u differs from run_classifier()\n", (unsigned)w);
+            failures++;
+        }
+    }
+
+    ei_dsp_arena_stats_t arena;
+    ei_dsp_arena_get_stats(&arena);
+    TEST_CHECK(arena.allocations > 0);
+    TEST_CHECK(arena.in_use == 0);
+    TEST_CHECK(arena.discarded == 0);
+    TEST_CHECK(arena.fallbacks == 0);
+    TEST_CHECK(arena.high_water <= arena.capacity);
+
+    test_concurrent_dsp(signals);
+    ei_dsp_arena_stats_t concurrent;
+    ei_dsp_arena_get_stats(&concurrent);
+    TEST_CHECK(concurrent.in_use == 0);
+    TEST_CHECK(concurrent.discarded == 0);
+
+    // the batch released its prepared graph
+    ei_impulse_result_t after;
+    TEST_CHECK(run_classifier(&signals[0], &after, false) == EI_IMPULSE_OK);
+    TEST_CHECK(same_result(expected[0], after));
+
+    run_classifier_deinit();
+
+    printf("batch with DSP arena: %u windows, %.1f windows/s, arena high water %u / %u bytes, %s\n",
+        (unsigned)stats.windows, stats.windows_per_second, (unsigned)arena.high_water,
+        (unsigned)arena.capacity, failures == 0 ? "OK" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
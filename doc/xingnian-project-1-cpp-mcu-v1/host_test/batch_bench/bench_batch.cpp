@@ -0,0 +1,102 @@
+/*
+ * Host bench: run_classifier_batch() throughput with the DSP scratch arena enabled
+ *
+ * Built once per pipeline depth (see CMakeLists.txt): at depth 1 every window runs DSP then
+ * NN on the calling thread, at the default depth DSP for the next window runs on a worker
+ * thread while the current one runs NN. Prints windows/s for the mode it was built for,
+ * taken from the best of several batches so a stray scheduler hiccup doesn't decide it.
+ *
+ * Fails if a batch returns an error, if any window differs from a separate run_classifier()
+ * call, or if the DSP arena is left in use or had to discard or fall back. The throughput
+ * itself is reported but not checked, it depends on the host's cores and load.
+ */
+
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier_batch.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if !EIDSP_USE_ARENA
+#error "this bench must be built with EIDSP_USE_ARENA=1"
+#endif
+
+#ifndef BATCH_BENCH_MODE
+#define BATCH_BENCH_MODE "default"
+#endif
+
+static const size_t bench_windows = 48;
+static const size_t bench_rounds = 5;
+
+static int failures = 0;
+
+#define TEST_CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+int main(void) {
+    // deterministic windows: tones of different frequency and level over noise
+    std::vector<std::vector<int16_t>> pcm(bench_windows);
+    std::vector<signal_t> signals(bench_windows);
+    srand(49);
+    for (size_t w = 0; w < bench_windows; w++) {
+        pcm[w].resize(EI_CLASSIFIER_RAW_SAMPLE_COUNT);
+        for (size_t ix = 0; ix < pcm[w].size(); ix++) {
+            pcm[w][ix] = (int16_t)((w % 3) * 3000 * sin(ix * 0.01 * (w + 1)) + rand() % 4000 - 2000);
+        }
+        TEST_CHECK(numpy::signal_from_int16_buffer(pcm[w].data(), pcm[w].size(), &signals[w]) == 0);
+    }
+
+    run_classifier_init();
+
+    std::vector<ei_impulse_result_t> expected(bench_windows);
+    for (size_t w = 0; w < bench_windows; w++) {
+        TEST_CHECK(run_classifier(&signals[w], &expected[w], false) == EI_IMPULSE_OK);
+    }
+
+    ei_dsp_arena_reset_stats();
+
+    // warm-up batch, then keep the fastest of bench_rounds
+    std::vector<ei_impulse_result_t> results(bench_windows);
+    ei_batch_stats_t stats;
+    ei_batch_stats_t best;
+    memset(&best, 0, sizeof(best));
+    TEST_CHECK(run_classifier_batch(signals.data(), bench_windows, results.data(), &stats, false) == EI_IMPULSE_OK);
+    for (size_t r = 0; r < bench_rounds; r++) {
+        TEST_CHECK(run_classifier_batch(signals.data(), bench_windows, results.data(), &stats, false) == EI_IMPULSE_OK);
+        TEST_CHECK(stats.windows == bench_windows);
+        if (stats.windows_per_second > best.windows_per_second) {
+            best = stats;
+        }
+    }
+
+    for (size_t w = 0; w < bench_windows; w++) {
+        for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+            if (results[w].classification[ix].value != expected[w].classification[ix].value) {
+                printf("FAIL window %u label %u: batch %f, run_classifier %f\n", (unsigned)w, (unsigned)ix,
+                    results[w].classification[ix].value, expected[w].classification[ix].value);
+                failures++;
+            }
+        }
+    }
+
+    ei_dsp_arena_stats_t arena;
+    ei_dsp_arena_get_stats(&arena);
+    TEST_CHECK(arena.in_use == 0);
+    TEST_CHECK(arena.discarded == 0);
+    TEST_CHECK(arena.fallbacks == 0);
+
+    run_classifier_deinit();
+
+    printf("batch bench (%s, depth %u): %u windows, %.1f windows/s, total %.2f ms, dsp %.2f ms, nn %.2f ms, %s\n",
+        BATCH_BENCH_MODE, (unsigned)EI_CLASSIFIER_BATCH_PIPELINE_DEPTH, (unsigned)best.windows,
+        best.windows_per_second, best.total_us / 1000.0f, best.dsp_us / 1000.0f, best.nn_us / 1000.0f,
+        failures == 0 ? "OK" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+/*
+ * Host bench: KWS cold start from a memory-mapped model bundle
+ *
+ * Mirrors the device path: model_bundle_map_file() stands in for esp_partition_mmap() in
+ * model_store_load(), tflite_learn_863593_6_bind_weights() points the constant tensors at the
+ * mapped weights, then the first run_classifier() call runs DSP and inference. Prints the time
+ * from mapping to the first result and the heap it needed (weights stay in the mapping), with
+ * and without the payload hash check that only pending models pay for.
+ *
+ * Fails if the bundle gives a different result than the built-in weights, or if weights are
+ * accepted with a wrong graph fingerprint.
+ */
+
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+#include "model_bundle.h"
+#include "mbedtls/sha256.h"
+
+#include <malloc.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Heap accounting: interpose the allocator so the peak covers everything the SDK allocates
+// (tensor arena, DSP matrices, TFLM persistent buffers), not only ei_dsp_malloc().
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t nmemb, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+}
+
+static std::atomic<size_t> heap_in_use(0);
+static std::atomic<size_t> heap_peak(0);
+
+static void *track_alloc(void *ptr) {
+    if (ptr) {
+        size_t now = heap_in_use += malloc_usable_size(ptr);
+        size_t peak = heap_peak.load();
+        while (now > peak && !heap_peak.compare_exchange_weak(peak, now)) {
+        }
+    }
+    return ptr;
+}
+
+static void track_free(void *ptr) {
+    if (ptr) {
+        heap_in_use -= malloc_usable_size(ptr);
+    }
+}
+
+extern "C" void *malloc(size_t size) {
+    return track_alloc(__libc_malloc(size));
+}
+
+extern "C" void *calloc(size_t nmemb, size_t size) {
+    return track_alloc(__libc_calloc(nmemb, size));
+}
+
+extern "C" void *realloc(void *ptr, size_t size) {
+    track_free(ptr);
+    return track_alloc(__libc_realloc(ptr, size));
+}
+
+extern "C" void *memalign(size_t alignment, size_t size) {
+    return track_alloc(__libc_memalign(alignment, size));
+}
+
+extern "C" void *aligned_alloc(size_t alignment, size_t size) {
+    return track_alloc(__libc_memalign(alignment, size));
+}
+
+extern "C" int posix_memalign(void **memptr, size_t alignment, size_t size) {
+    void *ptr = track_alloc(__libc_memalign(alignment, size));
+    if (!ptr) {
+        return ENOMEM;
+    }
+    *memptr = ptr;
+    return 0;
+}
+
+extern "C" void free(void *ptr) {
+    track_free(ptr);
+    __libc_free(ptr);
+}
+
+static int failures = 0;
+
+#define TEST_CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+static bool same_result(const ei_impulse_result_t &a, const ei_impulse_result_t &b) {
+    for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+        if (a.classification[ix].value != b.classification[ix].value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int64_t elapsed_us(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+// Map the bundle, bind it and run the first inference, as model_store_load() + the KWS task would
+static void cold_start(const char *path, bool verify_hash, signal_t *signal, const ei_impulse_result_t &expected) {
+    model_bundle_mapping_t map = {};
+    model_bundle_t bundle;
+    ei_impulse_result_t result = {};
+
+    size_t heap_base = heap_in_use.load();
+    heap_peak = heap_base;
+    auto t0 = std::chrono::steady_clock::now();
+
+    if (model_bundle_map_file(path, verify_hash, &map, &bundle) != ESP_OK) {
+        printf("FAIL cannot map %s\n", path);
+        failures++;
+        return;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    TEST_CHECK(tflite_learn_863593_6_bind_weights(bundle.weights, bundle.weights_size,
+                                                  bundle.graph_fingerprint) == kTfLiteOk);
+    run_classifier_init();
+    TEST_CHECK(run_classifier(signal, &result, false) == EI_IMPULSE_OK);
+    auto t2 = std::chrono::steady_clock::now();
+
+    printf("cold start (%s hash check):\n", verify_hash ? "with" : "without");
+    printf("  map + parse bundle     %8lld us\n", (long long)elapsed_us(t0, t1));
+    printf("  bind + first inference %8lld us\n", (long long)elapsed_us(t1, t2));
+    printf("  total                  %8lld us\n", (long long)elapsed_us(t0, t2));
+    printf("  mapped (flash)         %8u bytes, weights %u bytes\n",
+           (unsigned)map.size, (unsigned)bundle.weights_size);
+    printf("  tensor arena           %8u bytes\n", (unsigned)tflite_learn_863593_6_arena_size());
+    printf("  heap peak              %8u bytes (includes the tensor arena)\n",
+           (unsigned)(heap_peak.load() - heap_base));
+
+    if (!same_result(expected, result)) {
+        printf("FAIL bundle weights give a different result than the built-in weights\n");
+        failures++;
+    }
+
+    run_classifier_deinit();
+    tflite_learn_863593_6_bind_weights(nullptr, 0, 0);
+    model_bundle_unmap_file(&map);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        printf("usage: %s <bundle.xnmb>\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<int16_t> pcm(EI_CLASSIFIER_RAW_SAMPLE_COUNT);
+    srand(34);
+    for (size_t ix = 0; ix < pcm.size(); ix++) {
+        pcm[ix] = (int16_t)(3000 * sin(ix * 0.05) + rand() % 2000 - 1000);
+    }
+    signal_t signal;
+    TEST_CHECK(numpy::signal_from_int16_buffer(pcm.data(), pcm.size(), &signal) == 0);
+
+    // reference result with the weights compiled into the model
+    ei_impulse_result_t expected = {};
+    run_classifier_init();
+    TEST_CHECK(run_classifier(&signal, &expected, false) == EI_IMPULSE_OK);
+    run_classifier_deinit();
+
+    // the host SHA-256 (OpenSSL) sets up its tables on first use; keep that out of the numbers
+    unsigned char digest[32];
+    mbedtls_sha256((const unsigned char *)pcm.data(), 64, digest, 0);
+
+    cold_start(argv[1], false, &signal, expected);
+    cold_start(argv[1], true, &signal, expected);
+
+    // weights exported from another graph (or a bundle without a GRAPH section) must not bind
+    model_bundle_mapping_t map = {};
+    model_bundle_t bundle;
+    if (model_bundle_map_file(argv[1], false, &map, &bundle) == ESP_OK) {
+        TEST_CHECK(bundle.graph_fingerprint == tflite_learn_863593_6_weights_fingerprint());
+        TEST_CHECK(tflite_learn_863593_6_bind_weights(bundle.weights, bundle.weights_size,
+                                                      bundle.graph_fingerprint ^ 1) == kTfLiteError);
+        TEST_CHECK(tflite_learn_863593_6_bind_weights(bundle.weights, bundle.weights_size, 0) == kTfLiteError);
+        model_bundle_unmap_file(&map);
+    }
+    else {
+        TEST_CHECK(false);
+    }
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,18 @@
+/*
+ * Host shim: the esp_err_t codes used by components/xn_model_manager/src/model_bundle.c
+ */
+
+#ifndef XN_HOST_ESP_ERR_H
+#define XN_HOST_ESP_ERR_H
+
+typedef int esp_err_t;
+
+#define ESP_OK                   0
+#define ESP_FAIL                 -1
+#define ESP_ERR_INVALID_ARG      0x102
+#define ESP_ERR_INVALID_SIZE     0x104
+#define ESP_ERR_NOT_FOUND        0x105
+#define ESP_ERR_INVALID_CRC      0x109
+#define ESP_ERR_INVALID_VERSION  0x10A
+
+#endif // XN_HOST_ESP_ERR_H
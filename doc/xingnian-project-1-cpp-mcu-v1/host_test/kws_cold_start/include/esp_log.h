@@ -0,0 +1,14 @@
+/*
+ * Host shim: ESP_LOGx print to stderr
+ */
+
+#ifndef XN_HOST_ESP_LOG_H
+#define XN_HOST_ESP_LOG_H
+
+#include <stdio.h>
+
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) fprintf(stderr, "W %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) fprintf(stderr, "I %s: " fmt "\n", tag, ##__VA_ARGS__)
+
+#endif // XN_HOST_ESP_LOG_H
@@ -0,0 +1,18 @@
+/*
+ * Host shim: model_bundle.c only uses the one-shot mbedtls_sha256(), backed by OpenSSL here
+ */
+
+#ifndef XN_HOST_MBEDTLS_SHA256_H
+#define XN_HOST_MBEDTLS_SHA256_H
+
+#include <stddef.h>
+#include <openssl/sha.h>
+
+static inline int mbedtls_sha256(const unsigned char *input, size_t ilen, unsigned char output[32], int is224)
+{
+    (void)is224;
+    SHA256(input, ilen, output);
+    return 0;
+}
+
+#endif // XN_HOST_MBEDTLS_SHA256_H
@@ -0,0 +1,104 @@
+/*
+ * Host bench: per-stage memory profile of the impulse (EIDSP_PROFILE_MEMORY=1)
+ *
+ * Runs run_classifier() over a few windows and prints ei_memory_profile_to_json() for the
+ * last one, plus the largest stage peaks seen over all windows. With a path argument the
+ * JSON is also written to that file, so it can be diffed between builds or models.
+ *
+ * Fails if the profile is missing a DSP or NN stage, if the NN stage has no tensor arena
+ * usage, or if the JSON length reported by the sizing call doesn't match the rendered text.
+ */
+
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if !EIDSP_PROFILE_MEMORY
+#error "this bench must be built with EIDSP_PROFILE_MEMORY=1"
+#endif
+
+static const size_t bench_windows = 8;
+
+static int failures = 0;
+
+#define TEST_CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+int main(int argc, char **argv) {
+    std::vector<int16_t> pcm(EI_CLASSIFIER_RAW_SAMPLE_COUNT);
+    signal_t signal;
+    TEST_CHECK(numpy::signal_from_int16_buffer(pcm.data(), pcm.size(), &signal) == 0);
+
+    run_classifier_init();
+
+    // largest peak per stage over all windows; the stage order is the same for every run
+    std::vector<size_t> stage_peak;
+    srand(44);
+    for (size_t w = 0; w < bench_windows; w++) {
+        for (size_t ix = 0; ix < pcm.size(); ix++) {
+            pcm[ix] = (int16_t)((w % 3) * 3000 * sin(ix * 0.01 * (w + 1)) + rand() % 4000 - 2000);
+        }
+        ei_impulse_result_t result;
+        TEST_CHECK(run_classifier(&signal, &result, false) == EI_IMPULSE_OK);
+
+        const ei_memory_stage_t *stages;
+        size_t count = ei_memory_profile_get_stages(&stages);
+        stage_peak.resize(count, 0);
+        for (size_t ix = 0; ix < count; ix++) {
+            if (stages[ix].peak_bytes > stage_peak[ix]) {
+                stage_peak[ix] = stages[ix].peak_bytes;
+            }
+        }
+    }
+
+    const ei_memory_stage_t *stages;
+    size_t count = ei_memory_profile_get_stages(&stages);
+    bool has_dsp = false;
+    bool has_nn = false;
+    for (size_t ix = 0; ix < count; ix++) {
+        if (strcmp(stages[ix].name, "dsp") == 0) {
+            has_dsp = true;
+        }
+        if (strcmp(stages[ix].name, "nn") == 0) {
+            has_nn = true;
+            TEST_CHECK(stages[ix].arena_size > 0);
+            TEST_CHECK(stages[ix].arena_tensor_bytes <= stages[ix].arena_size);
+        }
+    }
+    TEST_CHECK(has_dsp);
+    TEST_CHECK(has_nn);
+
+    size_t length = ei_memory_profile_to_json(NULL, 0);
+    std::vector<char> json(length + 1);
+    TEST_CHECK(ei_memory_profile_to_json(json.data(), json.size()) == length);
+    TEST_CHECK(strlen(json.data()) == length);
+
+    run_classifier_deinit();
+
+    printf("%s\n", json.data());
+    for (size_t ix = 0; ix < count && ix < stage_peak.size(); ix++) {
+        printf("stage %u (%s, block %u): peak %u bytes over %u windows\n", (unsigned)ix,
+            stages[ix].name, (unsigned)stages[ix].block_id, (unsigned)stage_peak[ix],
+            (unsigned)bench_windows);
+    }
+
+    if (argc > 1) {
+        FILE *f = fopen(argv[1], "w");
+        TEST_CHECK(f != NULL);
+        if (f) {
+            fprintf(f, "%s\n", json.data());
+            fclose(f);
+        }
+    }
+
+    printf("memory profile: %u stages, %s\n", (unsigned)count, failures == 0 ? "OK" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -93,6 +93,11 @@ const ei_config_tflite_eon_graph_t ei_config_graph_863593_6 = {
     .model_reset = &tflite_learn_863593_6_reset,
     .model_input = &tflite_learn_863593_6_input,
     .model_output = &tflite_learn_863593_6_output,
+    .model_arena_usage = &tflite_learn_863593_6_arena_usage,
+    .model_set_profiler = &tflite_learn_863593_6_set_profiler,
+    .model_node_info = &tflite_learn_863593_6_node_info,
+    .model_arena_size = &tflite_learn_863593_6_arena_size,
+    .model_bind_arena = &tflite_learn_863593_6_bind_arena,
 };
 
 const uint8_t ei_output_tensors_indices_863593_6[1] = { 0 };
@@ -35,6 +35,7 @@
 #include "edge-impulse-sdk/tensorflow/lite/c/builtin_op_data.h"
 #include "edge-impulse-sdk/tensorflow/lite/c/common.h"
 #include "edge-impulse-sdk/tensorflow/lite/micro/micro_mutable_op_resolver.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/micro_profiler_interface.h"
 #include "edge-impulse-sdk/porting/ei_classifier_porting.h"
 
 #if EI_CLASSIFIER_PRINT_STATE
@@ -114,6 +115,8 @@ uint8_t tensor_arena[kTensorArenaSize] ALIGN(16) __attribute__((section(".tensor
 #else
 #define EI_CLASSIFIER_ALLOCATION_HEAP 1
 uint8_t* tensor_arena = NULL;
+// external arena set by bind_arena, used by init instead of alloc_fnc and not freed by reset
+static uint8_t* bound_arena = NULL;
 #endif
 
 static uint8_t* tensor_boundary;
@@ -127,6 +130,10 @@ enum used_operators_e {
   OP_RESHAPE, OP_CONV_2D, OP_MAX_POOL_2D, OP_FULLY_CONNECTED, OP_SOFTMAX,  OP_LAST
 };
 
+static const char* const op_names[OP_LAST] = {
+  "RESHAPE", "CONV_2D", "MAX_POOL_2D", "FULLY_CONNECTED", "SOFTMAX",
+};
+
 struct TensorInfo_t { // subset of TfLiteTensor used for initialization from constant memory
   TfLiteAllocationType allocation_type;
   TfLiteType type;
@@ -351,6 +358,8 @@ static const int out_tensor_indices[] = {
 
 size_t current_subgraph_index = 0;
 
+static tflite::MicroProfilerInterface* profiler = nullptr;
+
 static void init_tflite_tensor(size_t i, TfLiteTensor *tensor) {
   tensor->type = tensorData[i].type;
   tensor->is_variable = false;
@@ -407,6 +416,7 @@ static void init_tflite_eval_tensor(int i, TfLiteEvalTensor *tensor) {
 
 static void* overflow_buffers[EI_MAX_OVERFLOW_BUFFER_COUNT];
 static size_t overflow_buffers_ix = 0;
+static size_t overflow_buffers_bytes = 0;
 static void * AllocatePersistentBufferImpl(struct TfLiteContext* ctx,
                                        size_t bytes) {
   void *ptr;
@@ -427,6 +437,7 @@ static void * AllocatePersistentBufferImpl(struct TfLiteContext* ctx,
       return NULL;
     }
     overflow_buffers[overflow_buffers_ix++] = ptr;
+    overflow_buffers_bytes += bytes;
     return ptr;
   }
 
@@ -579,9 +590,99 @@ class EonMicroContext : public MicroContext {
 
 } // namespace
 
+uint32_t tflite_learn_863593_6_weights_fingerprint() {
+  static const size_t tensor_count = sizeof(tensorData) / sizeof(tensorData[0]);
+  // FNV-1a over little-endian u32 words, same as xn_model_bundle.py graph_fingerprint()
+  uint32_t hash = 0x811C9DC5u;
+  auto mix = [&hash](uint32_t value) {
+    for (int b = 0; b < 4; ++b) {
+      hash = (hash ^ ((value >> (8 * b)) & 0xFFu)) * 0x01000193u;
+    }
+  };
+
+  mix((uint32_t)tensor_count);
+  for (size_t i = 0; i < tensor_count; ++i) {
+    if (tensorData[i].allocation_type != kTfLiteMmapRo) {
+      continue;
+    }
+    const TfLiteIntArray* dims = tensorData[i].dims;
+    mix((uint32_t)i);
+    mix((uint32_t)tensorData[i].type);
+    mix((uint32_t)tensorData[i].bytes);
+    mix((uint32_t)dims->size);
+    for (int d = 0; d < dims->size; ++d) {
+      mix((uint32_t)dims->data[d]);
+    }
+  }
+  return hash;
+}
+
+TfLiteStatus tflite_learn_863593_6_bind_weights(const uint8_t* weights, size_t size, uint32_t fingerprint) {
+  static const size_t tensor_count = sizeof(tensorData) / sizeof(tensorData[0]);
+  static void* builtin_data[sizeof(tensorData) / sizeof(tensorData[0])];
+  static bool builtin_saved = false;
+
+  if (!builtin_saved) {
+    for (size_t i = 0; i < tensor_count; ++i) {
+      builtin_data[i] = tensorData[i].data;
+    }
+    builtin_saved = true;
+  }
+
+  if (weights == nullptr) {
+    for (size_t i = 0; i < tensor_count; ++i) {
+      if (tensorData[i].allocation_type == kTfLiteMmapRo) {
+        tensorData[i].data = builtin_data[i];
+      }
+    }
+    return kTfLiteOk;
+  }
+
+  if ((uintptr_t)weights % 16 != 0) {
+    ei_printf("ERR: external weights must be 16-byte aligned\n");
+    return kTfLiteError;
+  }
+
+  // A blob exported from another graph can have the same total size but a different layout
+  if (fingerprint != tflite_learn_863593_6_weights_fingerprint()) {
+    ei_printf("ERR: external weights graph fingerprint mismatch (expected 0x%08x, got 0x%08x)\n",
+              (unsigned)tflite_learn_863593_6_weights_fingerprint(), (unsigned)fingerprint);
+    return kTfLiteError;
+  }
+
+  // Validate the whole layout first so a mismatched blob leaves the built-in weights in place
+  size_t offset = 0;
+  for (size_t i = 0; i < tensor_count; ++i) {
+    if (tensorData[i].allocation_type == kTfLiteMmapRo) {
+      offset = (offset + 15) & ~(size_t)15;
+      offset += tensorData[i].bytes;
+    }
+  }
+  if (offset != size) {
+    ei_printf("ERR: external weights size mismatch (expected %d, got %d)\n", (int)offset, (int)size);
+    return kTfLiteError;
+  }
+
+  offset = 0;
+  for (size_t i = 0; i < tensor_count; ++i) {
+    if (tensorData[i].allocation_type == kTfLiteMmapRo) {
+      offset = (offset + 15) & ~(size_t)15;
+      tensorData[i].data = const_cast<uint8_t*>(weights + offset);
+      offset += tensorData[i].bytes;
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus tflite_learn_863593_6_init( void*(*alloc_fnc)(size_t,size_t) ) {
 #ifdef EI_CLASSIFIER_ALLOCATION_HEAP
-  tensor_arena = (uint8_t*) alloc_fnc(16, kTensorArenaSize);
+  if (bound_arena) {
+    tensor_arena = bound_arena;
+    memset(tensor_arena, 0, kTensorArenaSize);
+  }
+  else {
+    tensor_arena = (uint8_t*) alloc_fnc(16, kTensorArenaSize);
+  }
   if (!tensor_arena) {
     ei_printf("ERR: failed to allocate tensor arena\n");
     return kTfLiteError;
@@ -668,7 +769,11 @@ TfLiteStatus tflite_learn_863593_6_invoke() {
   for (size_t i = 0; i < 11; ++i) {
     ResetTensors();
 
+    uint32_t event_handle = profiler ? profiler->BeginEvent(op_names[used_ops[i]]) : 0;
     TfLiteStatus status = registrations[used_ops[i]].invoke(&ctx, &tflNodes[i]);
+    if (profiler) {
+      profiler->EndEvent(event_handle);
+    }
 
 #if EI_CLASSIFIER_PRINT_STATE
     ei_printf("layer %lu\n", i);
@@ -738,7 +843,9 @@ TfLiteStatus tflite_learn_863593_6_invoke() {
 
 TfLiteStatus tflite_learn_863593_6_reset( void (*free_fnc)(void* ptr) ) {
 #ifdef EI_CLASSIFIER_ALLOCATION_HEAP
-  free_fnc(tensor_arena);
+  if (tensor_arena != bound_arena) {
+    free_fnc(tensor_arena);
+  }
 #endif
 
   // scratch buffers are allocated within the arena, so just reset the counter so memory can be reused
@@ -749,5 +856,59 @@ TfLiteStatus tflite_learn_863593_6_reset( void (*free_fnc)(void* ptr) ) {
     ei_free(overflow_buffers[ix]);
   }
   overflow_buffers_ix = 0;
+  overflow_buffers_bytes = 0;
+  tensor_boundary = nullptr;
+  return kTfLiteOk;
+}
+
+TfLiteStatus tflite_learn_863593_6_arena_usage(size_t* arena_size, size_t* tensor_bytes,
+                                               size_t* persistent_bytes, size_t* scratch_bytes,
+                                               size_t* overflow_bytes) {
+  if (!tensor_boundary) {
+    return kTfLiteError;
+  }
+
+  size_t scratch = 0;
+  for (size_t ix = 0; ix < scratch_buffers_ix; ix++) {
+    scratch += scratch_buffers[ix].bytes;
+  }
+
+  *arena_size = kTensorArenaSize;
+  *tensor_bytes = (size_t)(tensor_boundary - tensor_arena);
+  *persistent_bytes = (size_t)(tensor_arena + kTensorArenaSize - current_location);
+  *scratch_bytes = scratch;
+  *overflow_bytes = overflow_buffers_bytes;
+  return kTfLiteOk;
+}
+
+void tflite_learn_863593_6_set_profiler(tflite::MicroProfilerInterface* p) {
+  profiler = p;
+}
+
+TfLiteStatus tflite_learn_863593_6_node_info(size_t node, const char** op_name,
+                                             const TfLiteIntArray** input_dims,
+                                             const TfLiteIntArray** output_dims) {
+  if (node >= 11) {
+    return kTfLiteError;
+  }
+  *op_name = op_names[used_ops[node]];
+  *input_dims = tensorData[tflNodes[node].inputs->data[0]].dims;
+  *output_dims = tensorData[tflNodes[node].outputs->data[0]].dims;
+  return kTfLiteOk;
+}
+
+size_t tflite_learn_863593_6_arena_size() {
+  return kTensorArenaSize;
+}
+
+TfLiteStatus tflite_learn_863593_6_bind_arena(uint8_t* arena) {
+#ifdef EI_CLASSIFIER_ALLOCATION_HEAP
+  if ((uintptr_t)arena % 16 != 0) {
+    return kTfLiteError;
+  }
+  bound_arena = arena;
   return kTfLiteOk;
+#else
+  return arena ? kTfLiteError : kTfLiteOk;
+#endif
 }
@@ -34,7 +34,19 @@
 #define tflite_learn_863593_6_GEN_H
 
 #include "edge-impulse-sdk/tensorflow/lite/c/common.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/micro_profiler_interface.h"
 
+// Points the constant (kTfLiteMmapRo) tensors at an external, 16-byte aligned weights blob,
+// e.g. a memory-mapped model partition, instead of the weights compiled into this file.
+// The blob holds every constant tensor in tensor index order, each starting on a 16-byte
+// boundary (see ota_server/tools/xn_model_bundle.py eon-weights). fingerprint must equal
+// tflite_learn_863593_6_weights_fingerprint() (the bundle's GRAPH section), so weights exported
+// from another graph are rejected. Pass nullptr to restore the built-in weights. Must be called
+// before init; only the tensor arena is allocated in RAM.
+TfLiteStatus tflite_learn_863593_6_bind_weights(const uint8_t* weights, size_t size, uint32_t fingerprint);
+// Fingerprint of the constant tensor layout (tensor count, and index / type / bytes / shape of
+// every constant tensor), FNV-1a 32 as computed by xn_model_bundle.py.
+uint32_t tflite_learn_863593_6_weights_fingerprint();
 // Sets up the model with init and prepare steps.
 TfLiteStatus tflite_learn_863593_6_init( void*(*alloc_fnc)(size_t,size_t) );
 // Returns the input tensor with the given index.
@@ -45,6 +57,25 @@ TfLiteStatus tflite_learn_863593_6_output(int index, TfLiteTensor* tensor);
 TfLiteStatus tflite_learn_863593_6_invoke();
 //Frees memory allocated
 TfLiteStatus tflite_learn_863593_6_reset( void (*free)(void* ptr) );
+// Reports tensor arena usage between init and reset: the arena size, bytes planned for
+// activation tensors, bytes taken by persistent buffers (scratch buffers included), the
+// scratch buffer bytes, and persistent buffers that did not fit and were put on the heap.
+TfLiteStatus tflite_learn_863593_6_arena_usage(size_t* arena_size, size_t* tensor_bytes,
+                                               size_t* persistent_bytes, size_t* scratch_bytes,
+                                               size_t* overflow_bytes);
+// Installs a profiler that gets one BeginEvent/EndEvent pair per node during invoke, tagged
+// with the op name. Pass nullptr to disable.
+void tflite_learn_863593_6_set_profiler(tflite::MicroProfilerInterface* profiler);
+// Returns the op name and the dims of the first input and output tensor of a node.
+TfLiteStatus tflite_learn_863593_6_node_info(size_t node, const char** op_name,
+                                             const TfLiteIntArray** input_dims,
+                                             const TfLiteIntArray** output_dims);
+// Returns the tensor arena size, including persistent and scratch buffers.
+size_t tflite_learn_863593_6_arena_size();
+// Makes init use an external, 16-byte aligned arena of arena_size() bytes instead of allocating
+// one, e.g. a region of an arena shared with other graphs; reset then leaves it alone. Pass
+// nullptr to allocate again. Only available when the arena is heap allocated.
+TfLiteStatus tflite_learn_863593_6_bind_arena(uint8_t* arena);
 
 
 // Returns the number of input tensors.
@@ -55,5 +86,9 @@ inline size_t tflite_learn_863593_6_inputs() {
 inline size_t tflite_learn_863593_6_outputs() {
   return 1;
 }
+// Returns the number of nodes in the graph.
+inline size_t tflite_learn_863593_6_nodes() {
+  return 11;
+}
 
 #endif
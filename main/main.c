@@ -18,6 +18,7 @@
 #include "xn_wifi_manage.h"
 #include "http_ota_manager.h"
 #include "audio_manager.h"
+#include "metrics_system.h"
 
 static const char *TAG = "app_main";
 
@@ -60,6 +61,7 @@ static void ota_init_task(void *arg)
     http_ota_manager_config_t cfg = HTTP_OTA_MANAGER_DEFAULT_CONFIG();
     snprintf(cfg.version_url, sizeof(cfg.version_url),
              "http://win.xingnian.vip:16623/firmware/version.json");
+    cfg.check_interval_sec = 6 * 3600;     // 启动时检查一次，之后每 6 小时（±10%）后台检查
 
     esp_err_t ret = http_ota_manager_init(&cfg);
     if (ret != ESP_OK) {
@@ -104,6 +106,9 @@ void app_main(void)
 {
     printf("esp32 语音唤醒组件 By.星年 - FunASR 云端唤醒词识别\n");
 
+    // 系统运行指标（堆 / PSRAM / CPU 空闲），通过 http://<设备IP>/api/metrics 查看
+    metrics_system_register();
+
     // 初始化音频管理器
     audio_mgr_config_t audio_cfg = AUDIO_MANAGER_DEFAULT_CONFIG();
     
@@ -13,6 +13,9 @@ header('Content-Type: application/json; charset=utf-8');
 $action = $_GET['action'] ?? '';
 $firmware_dir = __DIR__ . '/firmware';
 
+// 分块校验块大小，需为 4096 的整数倍（与设备端 HTTP_OTA_RESUME_ALIGN 对齐）
+const OTA_CHUNK_SIZE = 65536;
+
 // 确保 firmware 目录存在
 if (!is_dir($firmware_dir)) {
     mkdir($firmware_dir, 0755, true);
@@ -65,6 +68,38 @@ function saveConfig()
         'force' => $config['force'] ?? false,
     ];
 
+    // 可选：差分补丁（由 tools/xn_delta.py 生成），设备版本等于 delta_base 时优先下载
+    if (!empty($config['delta_base']) && !empty($config['delta_url'])) {
+        $version_config['delta_base'] = $config['delta_base'];
+        $version_config['delta_url'] = $config['delta_url'];
+    }
+
+    // 可选：KWS 模型通道（模型包由 tools/xn_model_bundle.py 生成），固件已是最新时设备按版本号独立更新模型
+    if (!empty($config['model_version']) && !empty($config['model_url'])) {
+        $model = [
+            'version' => $config['model_version'],
+            'url' => $config['model_url'],
+        ];
+        $model_path = $firmware_dir . '/' . basename(parse_url($config['model_url'], PHP_URL_PATH) ?? '');
+        if (is_file($model_path)) {
+            $model['size'] = filesize($model_path);
+            $model['sha256'] = hash_file('sha256', $model_path);
+        }
+        $version_config['model'] = $model;
+    }
+
+    // URL 指向本服务器上的固件时，附带整包 size / sha256 与分块校验信息，设备据此校验下载结果；
+    // 指向外部地址（或只更新模型、固件不在本服务器）时照常保存，设备只做 ESP-IDF 镜像校验
+    $local_path = $firmware_dir . '/' . basename(parse_url($config['url'], PHP_URL_PATH) ?? '');
+    if (is_file($local_path)) {
+        $version_config['size'] = filesize($local_path);
+        $version_config['sha256'] = hash_file('sha256', $local_path);
+        if (is_file($local_path . '.sha256')) {
+            $version_config['chunk_size'] = OTA_CHUNK_SIZE;
+            $version_config['chunks_url'] = $config['url'] . '.sha256';
+        }
+    }
+
     $version_file = $firmware_dir . '/version.json';
     $json = json_encode(
         $version_config,
@@ -79,7 +114,7 @@ function saveConfig()
 }
 
 /**
- * 上传固件（仅允许 .bin，默认最大 10MB）
+ * 上传固件（仅允许 .bin / .xndp / .xnmb，默认最大 10MB）
  */
 function uploadFirmware()
 {
@@ -98,8 +133,8 @@ function uploadFirmware()
     }
 
     $ext = strtolower(pathinfo($file['name'], PATHINFO_EXTENSION));
-    if ($ext !== 'bin') {
-        echo json_encode(['success' => false, 'message' => '只支持.bin格式的固件文件']);
+    if ($ext !== 'bin' && $ext !== 'xndp' && $ext !== 'xnmb') {
+        echo json_encode(['success' => false, 'message' => '只支持.bin格式的固件文件、.xndp差分补丁或.xnmb模型包']);
         return;
     }
 
@@ -117,12 +152,15 @@ function uploadFirmware()
     $target_path = $firmware_dir . '/' . $filename;
     if (file_exists($target_path)) {
         $name = pathinfo($filename, PATHINFO_FILENAME);
-        $filename = $name . '_' . time() . '.bin';
+        $filename = $name . '_' . time() . '.' . $ext;
         $target_path = $firmware_dir . '/' . $filename;
     }
 
     if (move_uploaded_file($file['tmp_name'], $target_path)) {
         @chmod($target_path, 0644);
+        if ($ext === 'bin') {
+            writeChunkManifest($target_path);
+        }
 
         $scheme = (!empty($_SERVER['HTTPS']) && $_SERVER['HTTPS'] !== 'off') ? 'https' : 'http';
         $host = $_SERVER['HTTP_HOST'] ?? '';
@@ -140,6 +178,29 @@ function uploadFirmware()
     }
 }
 
+/**
+ * 生成分块 SHA-256 清单（<固件>.sha256）：按 OTA_CHUNK_SIZE 切分，每块 32 字节原始摘要顺序拼接
+ */
+function writeChunkManifest($path)
+{
+    $in = fopen($path, 'rb');
+    if (!$in) {
+        return false;
+    }
+
+    $manifest = '';
+    while (!feof($in)) {
+        $chunk = fread($in, OTA_CHUNK_SIZE);
+        if ($chunk === false || $chunk === '') {
+            break;
+        }
+        $manifest .= hash('sha256', $chunk, true);
+    }
+    fclose($in);
+
+    return file_put_contents($path . '.sha256', $manifest) !== false;
+}
+
 /**
  * 删除固件文件（不允许删除 version.json）
  */
@@ -174,6 +235,7 @@ function deleteFirmware()
     }
 
     if (unlink($filepath)) {
+        @unlink($filepath . '.sha256');
         echo json_encode(['success' => true, 'message' => '删除成功']);
     } else {
         echo json_encode(['success' => false, 'message' => '删除失败']);
@@ -20,6 +20,10 @@ $current_config = [
     'url' => '',
     'description' => '',
     'force' => false,
+    'delta_base' => '',
+    'delta_url' => '',
+    'model_version' => '',
+    'model_url' => '',
 ];
 
 if (file_exists($version_file)) {
@@ -27,6 +31,10 @@ if (file_exists($version_file)) {
     $data = json_decode($json, true);
     if ($data) {
         $current_config = array_merge($current_config, $data);
+        if (isset($data['model']) && is_array($data['model'])) {
+            $current_config['model_version'] = $data['model']['version'] ?? '';
+            $current_config['model_url'] = $data['model']['url'] ?? '';
+        }
     }
 }
 
@@ -258,6 +266,26 @@ if (is_dir($firmware_dir)) {
                         <textarea name="description" rows="3" placeholder="修复了若干bug，优化了性能"><?php echo htmlspecialchars($current_config['description']); ?></textarea>
                     </div>
 
+                    <div class="form-group">
+                        <label>差分补丁基准版本（可选）</label>
+                        <input type="text" name="delta_base" value="<?php echo htmlspecialchars($current_config['delta_base']); ?>" placeholder="1.0.3">
+                    </div>
+
+                    <div class="form-group">
+                        <label>差分补丁URL（可选，由 tools/xn_delta.py 生成）</label>
+                        <input type="text" name="delta_url" value="<?php echo htmlspecialchars($current_config['delta_url']); ?>" placeholder="http://your-server.com/firmware/1.0.3-1.0.4.xndp">
+                    </div>
+
+                    <div class="form-group">
+                        <label>唤醒模型版本（可选）</label>
+                        <input type="text" name="model_version" value="<?php echo htmlspecialchars($current_config['model_version']); ?>" placeholder="kws-1.1">
+                    </div>
+
+                    <div class="form-group">
+                        <label>唤醒模型包URL（可选，由 tools/xn_model_bundle.py 生成）</label>
+                        <input type="text" name="model_url" value="<?php echo htmlspecialchars($current_config['model_url']); ?>" placeholder="http://your-server.com/firmware/kws-1.1.xnmb">
+                    </div>
+
                     <div class="form-group">
                         <div class="checkbox-group">
                             <input type="checkbox" name="force" id="force" <?php echo $current_config['force'] ? 'checked' : ''; ?>>
@@ -278,9 +306,9 @@ if (is_dir($firmware_dir)) {
                 <div class="upload-area" id="uploadArea" onclick="document.getElementById('fileInput').click()">
                     <div style="font-size: 3em; margin-bottom: 10px;">📁</div>
                     <div style="font-size: 1.2em; color: #374151; margin-bottom: 5px;">点击或拖拽文件到此处上传</div>
-                    <div style="color: #6b7280; font-size: 0.9em;">支持 .bin 格式的固件文件</div>
+                    <div style="color: #6b7280; font-size: 0.9em;">支持 .bin 格式的固件文件、.xndp 差分补丁和 .xnmb 模型包</div>
                 </div>
-                <input type="file" id="fileInput" class="file-input" accept=".bin" onchange="uploadFirmware(this.files[0])">
+                <input type="file" id="fileInput" class="file-input" accept=".bin,.xndp,.xnmb" onchange="uploadFirmware(this.files[0])">
 
                 <div class="progress-bar" id="progressBar">
                     <div class="progress-fill" id="progressFill">0%</div>
@@ -327,6 +355,10 @@ if (is_dir($firmware_dir)) {
                 url: formData.get('url'),
                 description: formData.get('description'),
                 force: formData.get('force') === 'on',
+                delta_base: formData.get('delta_base'),
+                delta_url: formData.get('delta_url'),
+                model_version: formData.get('model_version'),
+                model_url: formData.get('model_url'),
             };
 
             try {
@@ -355,6 +387,10 @@ if (is_dir($firmware_dir)) {
                 url: formData.get('url'),
                 description: formData.get('description'),
                 force: formData.get('force') === 'on',
+                delta_base: formData.get('delta_base'),
+                delta_url: formData.get('delta_url'),
+                model_version: formData.get('model_version'),
+                model_url: formData.get('model_url'),
             };
 
             const preview = document.getElementById('configPreview');
@@ -366,8 +402,8 @@ if (is_dir($firmware_dir)) {
         async function uploadFirmware(file) {
             if (!file) return;
 
-            if (!file.name.endsWith('.bin')) {
-                showMessage('error', '❌ 只支持 .bin 格式的固件文件');
+            if (!file.name.endsWith('.bin') && !file.name.endsWith('.xndp') && !file.name.endsWith('.xnmb')) {
+                showMessage('error', '❌ 只支持 .bin 格式的固件文件、.xndp 差分补丁或 .xnmb 模型包');
                 return;
             }
 
@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+差分 OTA 补丁工具（XNDP v1），与设备端 components/xn_ota_manager/src/http_ota_delta.c 配套。
+
+用法：
+    python3 xn_delta.py diff  <old.bin> <new.bin> <patch.xndp>   生成补丁（生成后自动回放校验）
+    python3 xn_delta.py apply <old.bin> <patch.xndp> <out.bin>   在主机上应用补丁
+
+格式（小端序）：
+    头部 80 字节：magic "XNDP" | u8 version | u8 compression | u16 reserved
+                  u32 old_size | u32 new_size | old_sha256[32] | new_sha256[32]
+    操作流（compression=1 时 zlib 压缩）：
+        0x01 ADD    u32 src_off u32 len + len 字节差值 new[i] = old[src_off+i] + diff[i]
+        0x02 INSERT u32 len + len 字节原始数据
+        0x00 END
+
+匹配策略与 bsdiff 类似：按 BLOCK 字节对旧镜像建索引，在新镜像中逐字节查找精确匹配，
+再向前后扩展；向后扩展允许少量不同字节（如重定位后的跳转地址），差值大多为 0，
+经 zlib 压缩后补丁通常只有新镜像的一小部分。
+"""
+
+import hashlib
+import struct
+import sys
+import zlib
+
+MAGIC = b"XNDP"
+VERSION = 1
+OP_END, OP_ADD, OP_INSERT = 0, 1, 2
+BLOCK = 32            # 索引块大小
+FUZZ_TOLERANCE = 32   # 近似扩展时允许的得分回落
+
+
+def _extend_forward(old, new, o, n):
+    """从 (o, n) 向后扩展，相同字节 +1、不同字节 -1，取得分最高处为匹配终点。"""
+    limit = min(len(old) - o, len(new) - n)
+    score = best_score = best_len = 0
+    i = 0
+    while i < limit:
+        score += 1 if old[o + i] == new[n + i] else -1
+        if score > best_score:
+            best_score, best_len = score, i + 1
+        elif score < best_score - FUZZ_TOLERANCE:
+            break
+        i += 1
+    return best_len
+
+
+def make_ops(old, new):
+    index = {}
+    for i in range(0, len(old) - BLOCK + 1, BLOCK):
+        index.setdefault(old[i:i + BLOCK], i)
+
+    ops = []
+    lit_start = 0
+    p = 0
+    while p <= len(new) - BLOCK:
+        o = index.get(new[p:p + BLOCK])
+        if o is None:
+            p += 1
+            continue
+        # 向前精确扩展，吞掉字面量尾部
+        while p > lit_start and o > 0 and new[p - 1] == old[o - 1]:
+            p -= 1
+            o -= 1
+        length = _extend_forward(old, new, o, p)
+        if p > lit_start:
+            ops.append((OP_INSERT, new[lit_start:p]))
+        diff = bytes((new[p + i] - old[o + i]) & 0xFF for i in range(length))
+        ops.append((OP_ADD, o, diff))
+        p += length
+        lit_start = p
+    if lit_start < len(new):
+        ops.append((OP_INSERT, new[lit_start:]))
+    return ops
+
+
+def encode(old, new, ops, compress=True):
+    body = bytearray()
+    for op in ops:
+        if op[0] == OP_ADD:
+            body += struct.pack("<BII", OP_ADD, op[1], len(op[2])) + op[2]
+        else:
+            body += struct.pack("<BI", OP_INSERT, len(op[1])) + op[1]
+    body += bytes([OP_END])
+    if compress:
+        body = zlib.compress(bytes(body), 9)
+    header = MAGIC + struct.pack("<BBHII", VERSION, 1 if compress else 0, 0, len(old), len(new))
+    header += hashlib.sha256(old).digest() + hashlib.sha256(new).digest()
+    return header + bytes(body)
+
+
+def apply(old, patch):
+    if patch[:4] != MAGIC or patch[4] != VERSION:
+        raise ValueError("invalid patch header")
+    compression = patch[5]
+    old_size, new_size = struct.unpack_from("<II", patch, 8)
+    old_sha, new_sha = patch[16:48], patch[48:80]
+    if len(old) < old_size or hashlib.sha256(old[:old_size]).digest() != old_sha:
+        raise ValueError("base image does not match patch")
+    body = patch[80:]
+    if compression == 1:
+        body = zlib.decompress(body)
+
+    out = bytearray()
+    pos = 0
+    while True:
+        op = body[pos]
+        pos += 1
+        if op == OP_END:
+            break
+        if op == OP_ADD:
+            src, length = struct.unpack_from("<II", body, pos)
+            pos += 8
+            out += bytes((old[src + i] + body[pos + i]) & 0xFF for i in range(length))
+        elif op == OP_INSERT:
+            (length,) = struct.unpack_from("<I", body, pos)
+            pos += 4
+            out += body[pos:pos + length]
+        else:
+            raise ValueError("unknown op 0x%02x" % op)
+        pos += length
+    if len(out) != new_size or hashlib.sha256(out).digest() != new_sha:
+        raise ValueError("patched image sha256 mismatch")
+    return bytes(out)
+
+
+def main(argv):
+    if len(argv) != 5 or argv[1] not in ("diff", "apply"):
+        print(__doc__)
+        return 1
+    with open(argv[2], "rb") as f:
+        old = f.read()
+    with open(argv[3], "rb") as f:
+        second = f.read()
+
+    if argv[1] == "diff":
+        patch = encode(old, second, make_ops(old, second))
+        if apply(old, patch) != second:
+            raise SystemExit("round-trip verification failed")
+        with open(argv[4], "wb") as f:
+            f.write(patch)
+        print("patch %d bytes (new image %d bytes, %.1f%%)"
+              % (len(patch), len(second), 100.0 * len(patch) / max(1, len(second))))
+    else:
+        with open(argv[4], "wb") as f:
+            f.write(apply(old, second))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,253 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+KWS 模型包工具（XNMB v1），与设备端 components/xn_model_manager/src/model_bundle.c 配套。
+
+用法：
+    python3 xn_model_bundle.py pack <weights> <params.json> <out.xnmb> [xxx_compiled.cpp]
+                                                                         打包模型
+    python3 xn_model_bundle.py info <bundle.xnmb>                        查看并校验模型包
+    python3 xn_model_bundle.py eon-weights <xxx_compiled.cpp> <out.bin>  从 EON 编译模型中导出常量张量
+
+eon-weights 按张量序号依次导出所有 kTfLiteMmapRo 张量，每个张量 16 字节对齐，
+与 tflite_learn_*_bind_weights() 期望的布局一致；设备端映射模型分区后直接绑定，权重不进 RAM。
+pack 时给出同一个 EON 编译模型源码，会写入 GRAPH 段（常量张量布局指纹），bind_weights() 用它拒绝
+为另一个计算图导出的权重；没有 GRAPH 段的模型包不能绑定到 EON 编译模型。
+
+params.json 示例（取值对应 Edge Impulse 导出的 model_variables.h / model_metadata.h）：
+    {
+        "version": "kws-1.1",
+        "quant": {"input_scale": 0.0, "input_zero_point": 0,
+                  "output_scale": 0.00390625, "output_zero_point": -128},
+        "dsp": {"num_cepstral": 13, "frame_length": 0.02, "frame_stride": 0.02,
+                "num_filters": 32, "fft_length": 256, "win_size": 101,
+                "low_frequency": 0, "high_frequency": 0, "pre_cof": 0.98, "pre_shift": 1},
+        "labels": ["noise", "wake_word"],
+        "threshold": 0.6
+    }
+
+格式（小端序）：
+    头部 64 字节：magic "XNMB" | u16 format_version | u16 section_count | u32 payload_size
+                  payload_sha256[32] | model_version[16] | u32 reserved
+    段表：section_count 个 { u16 type | u16 flags | u32 offset | u32 size }，offset 相对负载起点
+    负载：各段数据，WEIGHTS 段 16 字节对齐
+    GRAPH 段：u32 指纹 = FNV-1a 32 覆盖 u32 张量总数，以及每个常量张量的 u32 序号 / 类型 / 字节数 /
+              维数和各维大小（与 tflite_learn_*_weights_fingerprint() 相同）
+"""
+
+import hashlib
+import json
+import re
+import struct
+import sys
+
+MAGIC = b"XNMB"
+FORMAT_VERSION = 1
+HEADER_SIZE = 64
+SECTION_SIZE = 12
+VERSION_LEN = 16
+WEIGHTS_ALIGN = 16
+MAX_LABELS = 8
+
+SEC_WEIGHTS, SEC_QUANT, SEC_DSP, SEC_LABELS, SEC_THRESHOLD, SEC_GRAPH = 1, 2, 3, 4, 5, 6
+SECTION_NAMES = {SEC_WEIGHTS: "weights", SEC_QUANT: "quant", SEC_DSP: "dsp",
+                 SEC_LABELS: "labels", SEC_THRESHOLD: "threshold", SEC_GRAPH: "graph"}
+
+DSP_FIELDS = (("num_cepstral", "I"), ("frame_length", "f"), ("frame_stride", "f"),
+              ("num_filters", "I"), ("fft_length", "I"), ("win_size", "I"),
+              ("low_frequency", "I"), ("high_frequency", "I"), ("pre_cof", "f"),
+              ("pre_shift", "I"))
+
+
+def _align(n, a):
+    return (n + a - 1) // a * a
+
+
+def pack(weights, params, fingerprint=None):
+    version = params["version"].encode()
+    if len(version) > VERSION_LEN:
+        raise ValueError("version longer than %d bytes" % VERSION_LEN)
+    labels = params["labels"]
+    if not 0 < len(labels) <= MAX_LABELS:
+        raise ValueError("label count must be 1..%d" % MAX_LABELS)
+
+    q = params["quant"]
+    dsp = params.get("dsp", {})
+    sections = [
+        (SEC_QUANT, struct.pack("<fifi", q["input_scale"], q["input_zero_point"],
+                                q["output_scale"], q["output_zero_point"])),
+        (SEC_DSP, struct.pack("<" + "".join(t for _, t in DSP_FIELDS),
+                              *[dsp.get(name, 0) for name, _ in DSP_FIELDS])),
+        (SEC_LABELS, struct.pack("<I", len(labels)) +
+         b"".join(l.encode() + b"\0" for l in labels)),
+        (SEC_THRESHOLD, struct.pack("<f", params.get("threshold", 0.5))),
+        (SEC_WEIGHTS, weights),
+    ]
+    if fingerprint is not None:
+        sections.insert(-1, (SEC_GRAPH, struct.pack("<I", fingerprint)))
+
+    # 段表之后依次排布数据；负载起点在头部之后（64 字节），相对负载 16 字节对齐即绝对对齐
+    table = b""
+    body = b""
+    data_start = _align(len(sections) * SECTION_SIZE, WEIGHTS_ALIGN)
+    for sec_type, data in sections:
+        offset = _align(data_start + len(body), WEIGHTS_ALIGN if sec_type == SEC_WEIGHTS else 4)
+        body += b"\0" * (offset - data_start - len(body)) + data
+        table += struct.pack("<HHII", sec_type, 0, offset, len(data))
+
+    payload = table + b"\0" * (data_start - len(table)) + body
+    header = (MAGIC + struct.pack("<HHI", FORMAT_VERSION, len(sections), len(payload)) +
+              hashlib.sha256(payload).digest() + version.ljust(VERSION_LEN, b"\0") +
+              struct.pack("<I", 0))
+    assert len(header) == HEADER_SIZE
+    return header + payload
+
+
+EON_CTYPES = {"int8_t": "b", "uint8_t": "B", "int16_t": "h", "int32_t": "i", "float": "f"}
+# TfLiteType 枚举值（tensorflow/lite/c/common.h）
+TFLITE_TYPES = {"kTfLiteFloat32": 1, "kTfLiteInt32": 2, "kTfLiteUInt8": 3, "kTfLiteInt64": 4,
+                "kTfLiteBool": 6, "kTfLiteInt16": 7, "kTfLiteInt8": 9}
+FNV_OFFSET, FNV_PRIME = 0x811C9DC5, 0x01000193
+
+
+def eon_tensors(source):
+    """按序号返回 tensorData 表中的张量：(分配类型, 类型, 数据表达式, 形状, 字节数)。"""
+    dims = {}
+    for name, count, values in re.findall(
+            r"TfArray<\d+, int> (tensor_dimension\d+) = \{ (\d+), \{ ([^}]*) \} \};", source):
+        dims[name] = [int(v) for v in values.split(",")[:int(count)] if v.strip()]
+
+    table = re.search(r"TensorInfo_t tensorData\[\] = \{(.*?)\n\};", source, re.S)
+    if not table:
+        raise ValueError("tensorData table not found")
+
+    tensors = []
+    for alloc, ttype, data, dim_name, nbytes in re.findall(
+            r"\{\s*(kTfLite\w+),\s*(kTfLite\w+),\s*\(int32_t\*\)\s*(.+?),\s*"
+            r"\(TfLiteIntArray\*\)&(?:\w+::)?(tensor_dimension\d+),\s*(\d+),",
+            table.group(1)):
+        if dim_name not in dims:
+            raise ValueError("dimension %s not found" % dim_name)
+        tensors.append((alloc, ttype, data.strip(), dims[dim_name], int(nbytes)))
+    return tensors
+
+
+def graph_fingerprint(source):
+    """常量张量布局指纹，与设备端 tflite_learn_*_weights_fingerprint() 的计算方式一致。"""
+    tensors = eon_tensors(source)
+    words = [len(tensors)]
+    for index, (alloc, ttype, _, shape, nbytes) in enumerate(tensors):
+        if alloc != "kTfLiteMmapRo":
+            continue
+        if ttype not in TFLITE_TYPES:
+            raise ValueError("unsupported tensor type %s" % ttype)
+        words += [index, TFLITE_TYPES[ttype], nbytes, len(shape)] + [d & 0xFFFFFFFF for d in shape]
+
+    h = FNV_OFFSET
+    for b in struct.pack("<%dI" % len(words), *words):
+        h = ((h ^ b) * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def eon_weights(source):
+    """从 EON 编译模型源码中按张量序号导出常量张量（kTfLiteMmapRo），16 字节对齐拼接。"""
+    arrays = {}
+    for ctype, name, body in re.findall(
+            r"\b(int8_t|uint8_t|int16_t|int32_t|float)\s+(tensor_data\d+)\[[^\]]*\]\s*=\s*\{(.*?)\};",
+            source, re.S):
+        body = re.sub(r"/\*.*?\*/", "", body, flags=re.S)
+        values = [v for v in (x.strip() for x in body.split(",")) if v]
+        fmt = EON_CTYPES[ctype]
+        conv = float if fmt == "f" else (lambda v: int(v, 0))
+        arrays[name] = struct.pack("<%d%s" % (len(values), fmt), *[conv(v) for v in values])
+
+    blob = b""
+    for alloc, _, data, _, nbytes in eon_tensors(source):
+        if alloc != "kTfLiteMmapRo":
+            continue
+        name = data.split("::")[-1]
+        if name not in arrays or len(arrays[name]) != nbytes:
+            raise ValueError("constant tensor %s size mismatch" % name)
+        blob += b"\0" * (_align(len(blob), WEIGHTS_ALIGN) - len(blob)) + arrays[name]
+    return blob
+
+
+def parse(bundle):
+    if len(bundle) < HEADER_SIZE or bundle[:4] != MAGIC:
+        raise ValueError("bad magic")
+    fmt, count, payload_size = struct.unpack_from("<HHI", bundle, 4)
+    if fmt != FORMAT_VERSION:
+        raise ValueError("unsupported format version %d" % fmt)
+    payload = bundle[HEADER_SIZE:HEADER_SIZE + payload_size]
+    if len(payload) != payload_size:
+        raise ValueError("bundle truncated")
+    if hashlib.sha256(payload).digest() != bundle[12:44]:
+        raise ValueError("payload sha256 mismatch")
+
+    info = {"version": bundle[44:60].rstrip(b"\0").decode(), "sections": []}
+    for i in range(count):
+        sec_type, _, offset, size = struct.unpack_from("<HHII", payload, i * SECTION_SIZE)
+        if offset + size > payload_size:
+            raise ValueError("section %d out of range" % i)
+        data = payload[offset:offset + size]
+        info["sections"].append((SECTION_NAMES.get(sec_type, str(sec_type)), offset, size))
+        if sec_type == SEC_LABELS:
+            n = struct.unpack_from("<I", data)[0]
+            info["labels"] = [l.decode() for l in data[4:].split(b"\0")[:n]]
+        elif sec_type == SEC_THRESHOLD:
+            info["threshold"] = struct.unpack_from("<f", data)[0]
+        elif sec_type == SEC_GRAPH:
+            info["graph_fingerprint"] = struct.unpack_from("<I", data)[0]
+        elif sec_type == SEC_WEIGHTS and (HEADER_SIZE + offset) % WEIGHTS_ALIGN:
+            raise ValueError("weights not aligned")
+    return info
+
+
+def main(argv):
+    if len(argv) in (5, 6) and argv[1] == "pack":
+        with open(argv[2], "rb") as f:
+            weights = f.read()
+        with open(argv[3], "r", encoding="utf-8") as f:
+            params = json.load(f)
+        fingerprint = None
+        if len(argv) == 6:
+            with open(argv[5], "r", encoding="utf-8") as f:
+                source = f.read()
+            if eon_weights(source) != weights:
+                raise SystemExit("weights were not exported from %s" % argv[5])
+            fingerprint = graph_fingerprint(source)
+        bundle = pack(weights, params, fingerprint)
+        parse(bundle)
+        with open(argv[4], "wb") as f:
+            f.write(bundle)
+        print("version=%s size=%d sha256=%s" % (params["version"], len(bundle),
+                                                hashlib.sha256(bundle).hexdigest()))
+        return 0
+    if len(argv) == 4 and argv[1] == "eon-weights":
+        with open(argv[2], "r", encoding="utf-8") as f:
+            source = f.read()
+        blob = eon_weights(source)
+        with open(argv[3], "wb") as f:
+            f.write(blob)
+        print("eon weights: %d bytes, graph fingerprint 0x%08x" % (len(blob), graph_fingerprint(source)))
+        return 0
+    if len(argv) == 3 and argv[1] == "info":
+        with open(argv[2], "rb") as f:
+            bundle = f.read()
+        info = parse(bundle)
+        print("version:   %s" % info["version"])
+        print("size:      %d" % len(bundle))
+        print("sha256:    %s" % hashlib.sha256(bundle).hexdigest())
+        print("labels:    %s" % ", ".join(info.get("labels", [])))
+        print("threshold: %.3f" % info.get("threshold", 0.0))
+        if "graph_fingerprint" in info:
+            print("graph:     0x%08x" % info["graph_fingerprint"])
+        for name, offset, size in info["sections"]:
+            print("  %-10s offset=%-8d size=%d" % (name, offset, size))
+        return 0
+    print(__doc__)
+    return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))